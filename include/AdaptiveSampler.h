@@ -0,0 +1,60 @@
+/**
+ * @file AdaptiveSampler.h
+ * @brief Per-channel adaptive sampling interval scheduler for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Plain C++ (no Arduino dependencies) so the scheduling logic can be built
+ * and exercised on the host.
+ */
+
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <stdint.h>
+
+#define SAMPLER_HISTORY_HOURS 24
+
+class AdaptiveSampler {
+private:
+    // Interval bounds
+    uint32_t minIntervalMs;
+    uint32_t maxIntervalMs;
+    uint32_t currentIntervalMs;
+
+    // Activity tracking (EWMA of absolute change, scaled by 16)
+    int32_t activityThreshold;
+    int32_t activity;
+    int32_t lastValue;
+    bool hasValue;
+
+    uint32_t lastSampleTime;
+    bool boosted;
+    uint8_t slowdown;
+
+    // Samples taken in each of the last SAMPLER_HISTORY_HOURS uptime hours
+    uint16_t hourlyCounts[SAMPLER_HISTORY_HOURS];
+    uint32_t currentHour;
+    uint32_t totalSamples;
+
+    void advanceHour(uint32_t hour);
+
+public:
+    AdaptiveSampler(uint32_t minMs, uint32_t maxMs, uint32_t initialMs, int32_t threshold);
+
+    // Scheduling
+    bool isDue(uint32_t now) const;
+    void recordSample(uint32_t now, int32_t value);
+    void setBoost(bool fast) { boosted = fast; }
+    bool isBoosted() const { return boosted; }
+    void setSlowdown(uint8_t factor) { slowdown = factor ? factor : 1; }
+    uint32_t getInterval() const { return (boosted ? minIntervalMs : currentIntervalMs) * slowdown; }
+    int32_t getActivity() const { return activity / 16; }
+
+    // Statistics
+    uint32_t getSamplesLastHour(uint32_t now);
+    uint32_t getSamplesInHour(uint32_t now, uint8_t hoursAgo);
+    uint32_t getTotalSamples() const { return totalSamples; }
+};
+
+#endif // ADAPTIVE_SAMPLER_H
@@ -14,6 +14,9 @@
 #include <Preferences.h>
 #include "config.h"
 #include "Logger.h"
+#include "EventBus.h"
+#include "FadePlanner.h"
+#include "SeqLockSnapshot.h"
 
 // Alarm structure
 struct Alarm {
@@ -25,9 +28,38 @@ struct Alarm {
     String label;
     bool repeating;         // True for recurring alarms, false for one-time
     time_t oneTimeDate;     // Unix timestamp for one-time alarms
+    String sound;           // Built-in or uploaded pattern name; empty = "alarm"
+    uint16_t rampSeconds;   // Wake-up crescendo length, 0 = full volume at once
+    uint8_t rampShape;      // RampShape
     
     Alarm() : id(0), hour(0), minute(0), dayMask(0), enabled(false), 
-              label(""), repeating(true), oneTimeDate(0) {}
+              label(""), repeating(true), oneTimeDate(0), sound(""),
+              rampSeconds(0), rampShape(RAMP_PERCEPTUAL) {}
+    
+    RampProfile ramp() const {
+        RampProfile profile = {rampSeconds, ALARM_RAMP_START_LEVEL, rampSeconds > 0 ? rampShape : (uint8_t)RAMP_NONE};
+        return profile;
+    }
+};
+
+// Fixed-size copy of one alarm for readers on other tasks (the web API)
+struct AlarmSummary {
+    uint8_t id;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t dayMask;
+    bool enabled;
+    bool repeating;
+    uint8_t rampShape;
+    uint16_t rampSeconds;
+    uint32_t oneTimeDate;
+    char label[ALARM_LABEL_MAX + 1];        // Longer labels are cut
+    char sound[PATTERN_NAME_MAX + 1];
+};
+
+struct AlarmTable {
+    uint8_t count;
+    AlarmSummary alarms[MAX_ALARMS];
 };
 
 enum AlarmState {
@@ -37,6 +69,18 @@ enum AlarmState {
     ALARM_WAITING_FOR_PILL_BOX
 };
 
+// Events published on the EventBus
+struct AlarmStateEvent {
+    AlarmState state;
+    AlarmState previous;
+    uint8_t alarmId;        // Active alarm, 0 when none
+};
+
+struct BuzzerEvent {
+    bool active;            // True: start the alarm sound, false: silence it
+    uint8_t alarmId;        // Alarm whose sound to play
+};
+
 class AlarmManager {
 private:
     std::vector<Alarm> alarms;
@@ -51,16 +95,22 @@ private:
     unsigned long snoozeStartTime;
     bool buzzerActive;
     
-    // Hardware interaction callbacks
-    std::function<void(bool)> buzzerCallback;
+    // Pill box state query (a single answer, so not an event)
     std::function<bool()> pillBoxCallback;
     
+    // Republished after every change; read without locking from the AsyncTCP task
+    SeqLockSnapshot<AlarmTable> table;
+    
     void saveAlarmsToFlash();
+    void publishTable();
+    uint8_t nextAlarmId() const;
     void loadAlarmsFromFlash();
     bool isAlarmTimeMatched(const Alarm& alarm, struct tm& timeinfo);
     bool isDayMatched(uint8_t dayMask, int weekday);
     void triggerAlarm(uint8_t alarmId);
     void stopAlarm();
+    void setState(AlarmState state);
+    void setBuzzer(bool active);
 
 public:
     AlarmManager(Logger* log, ESP32Time* rtcInstance);
@@ -70,11 +120,15 @@ public:
     void update(); // Call this frequently in main loop
     
     // Alarm management
-    bool addAlarm(uint8_t hour, uint8_t minute, uint8_t dayMask, const String& label = "");
+    bool addAlarm(uint8_t hour, uint8_t minute, uint8_t dayMask, const String& label = "", const String& sound = "",
+                  uint16_t rampSeconds = 0, uint8_t rampShape = RAMP_PERCEPTUAL);
     bool addOneTimeAlarm(uint8_t hour, uint8_t minute, time_t date, const String& label = "");
     bool removeAlarm(uint8_t alarmId);
     bool enableAlarm(uint8_t alarmId, bool enabled);
     bool modifyAlarm(uint8_t alarmId, uint8_t hour, uint8_t minute, uint8_t dayMask);
+    bool setAlarmSound(uint8_t alarmId, const String& sound);
+    bool setAlarmRamp(uint8_t alarmId, uint16_t rampSeconds, uint8_t rampShape);
+    bool updateAlarm(uint8_t alarmId, const Alarm& values);     // Everything but id and one-time date
     void clearAllAlarms();
     
     // State management
@@ -87,11 +141,12 @@ public:
     // Getters
     std::vector<Alarm> getAlarms() const { return alarms; }
     Alarm* getAlarm(uint8_t alarmId);
+    uint32_t readAlarmTable(AlarmTable* out) const { return table.read(out); }    // Safe from any task
+    uint32_t getAlarmTableVersion() const { return table.getVersion(); }        // Changes with every edit
     String getAlarmsStatus();
     unsigned long getAlarmDuration() const;
     
-    // Hardware callbacks
-    void setBuzzerCallback(std::function<void(bool)> callback) { buzzerCallback = callback; }
+    // Hardware query
     void setPillBoxCallback(std::function<bool()> callback) { pillBoxCallback = callback; }
     
     // Utility
@@ -0,0 +1,92 @@
+/**
+ * @file AudioEngine.h
+ * @brief Sampled-audio alarm playback over I2S DMA for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Optional (build with -DENABLE_AUDIO_ENGINE=1). Streams clips from LittleFS
+ * through the I2S DMA engine to the built-in DAC or as PDM (sigma-delta).
+ * A task refills one DMA buffer at a time and otherwise sleeps in i2s_write,
+ * so the CPU only decodes and mixes. The buzzer and its BuzzerPattern API are
+ * untouched; alarms whose sound names a clip play it here instead.
+ */
+
+#ifndef AUDIO_ENGINE_H
+#define AUDIO_ENGINE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <driver/i2s.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "Logger.h"
+#include "ClipDecoder.h"
+#include "AudioMixer.h"
+#include "FadePlanner.h"
+
+class AudioEngine {
+private:
+    enum CommandType {
+        AUDIO_COMMAND_PLAY,
+        AUDIO_COMMAND_STOP
+    };
+
+    // Callers only queue commands; the audio task owns files and decoders
+    struct Command {
+        uint8_t type;               // CommandType
+        char name[PATTERN_NAME_MAX + 1];
+        bool loop;
+        RampProfile ramp;
+    };
+
+    struct Track {
+        ClipDecoder decoder;
+        File file;
+        bool loop;
+        RampProfile ramp;
+        uint32_t playedFrames;      // Since play(), across loops; drives the ramp
+        int8_t slot;                // Mixer voice, -1 when idle
+    };
+
+    Logger* logger;
+    AudioOutput output;
+    AudioMixer mixer;
+    Track tracks[AUDIO_MAX_VOICES];
+    uint16_t frames[AUDIO_DMA_FRAMES * 2];
+
+    QueueHandle_t commands;
+    TaskHandle_t task;
+    bool streaming;                 // I2S clocks running
+
+    volatile bool playing;
+    volatile uint16_t loadPermille; // Decode and mix time per buffer period, smoothed
+
+    static void taskEntry(void* arg);
+    static size_t readFile(void* context, uint8_t* buffer, size_t length);
+    void run();
+    void handleCommand(const Command& command);
+    bool startTrack(Track& track, const Command& command);
+    bool rewind(Track& track);
+    void stopTrack(Track& track);
+    void fillBuffer();
+
+public:
+    AudioEngine(Logger* log);
+    ~AudioEngine();
+
+    bool begin(AudioOutput mode = AUDIO_OUTPUT_MODE);
+
+    // Queued for the audio task; false if the clip is missing or the queue is full
+    bool play(const String& name, bool loop, const RampProfile* ramp = nullptr);
+    void stop();
+
+    bool hasClip(const String& name);
+    bool isPlaying() const { return playing; }
+    uint16_t getLoadPermille() const { return loadPermille; }
+
+    static String path(const String& name);
+};
+
+#endif // AUDIO_ENGINE_H
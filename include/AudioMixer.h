@@ -0,0 +1,59 @@
+/**
+ * @file AudioMixer.h
+ * @brief Clip mixing and I2S frame rendering for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Mixes up to AUDIO_MAX_VOICES ClipDecoder streams into one block of output
+ * frames. Each voice has a level (0-255) that glides across a block when it
+ * changes, so wake-up ramps do not click. Blocks are rendered straight into
+ * the I2S DMA layout: two 16-bit slots per frame, both channels the same.
+ * Plain C++ (no Arduino dependencies) so it can be benchmarked on the host
+ * (see tools/audio_bench.cpp).
+ */
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "ClipDecoder.h"
+
+enum AudioOutput {
+    AUDIO_OUTPUT_DAC,       // Built-in 8-bit DAC on GPIO25 (unsigned, top byte of each slot)
+    AUDIO_OUTPUT_PDM        // I2S PDM (sigma-delta) on AUDIO_PDM_PIN (signed 16-bit)
+};
+
+class AudioMixer {
+private:
+    struct Voice {
+        ClipDecoder* decoder;   // nullptr = free slot
+        uint8_t level;          // Level at the start of the next block
+        uint8_t target;         // Level reached by the end of the next block
+    };
+
+    Voice voices[AUDIO_MAX_VOICES];
+    int32_t mixBuffer[AUDIO_DMA_FRAMES];
+    int16_t voiceBuffer[AUDIO_DMA_FRAMES];
+
+    void addVoice(Voice& voice, uint16_t frames);
+
+public:
+    AudioMixer();
+
+    // Returns the slot, or -1 when every voice is busy
+    int8_t attach(ClipDecoder* decoder, uint8_t level);
+    void detach(uint8_t slot);
+    void setLevel(uint8_t slot, uint8_t level);
+
+    // A voice whose clip ran out stays attached until detached or restarted
+    bool isAttached(uint8_t slot) const { return slot < AUDIO_MAX_VOICES && voices[slot].decoder; }
+    bool isFinished(uint8_t slot) const;
+    uint8_t activeCount() const;
+
+    // Mixes frames (up to AUDIO_DMA_FRAMES) and renders them for the output;
+    // frames holds two uint16_t slots per frame
+    void render(uint16_t* frames, uint16_t count, AudioOutput output);
+};
+
+#endif // AUDIO_MIXER_H
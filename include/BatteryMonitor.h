@@ -0,0 +1,39 @@
+/**
+ * @file BatteryMonitor.h
+ * @brief Calibrated battery voltage measurement for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <Arduino.h>
+#include <esp_adc_cal.h>
+#include "config.h"
+
+// Raw-to-millivolt lookup table: one entry every 64 ADC counts (0..4096)
+#define BATTERY_LUT_SIZE 65
+
+class BatteryMonitor {
+private:
+    adc1_channel_t channel;
+    esp_adc_cal_value_t calibrationSource;
+    uint16_t millivoltLut[BATTERY_LUT_SIZE];
+    uint32_t filteredMillivolts;    // Pin voltage x16 after EWMA
+    bool hasReading;
+    
+    uint16_t rawToMillivolts(uint32_t raw) const;
+
+public:
+    BatteryMonitor();
+    
+    bool begin();
+    uint16_t sample();              // Oversample, filter and return battery millivolts
+    
+    uint16_t getMillivolts() const;
+    float getVoltage() const { return getMillivolts() / 1000.0f; }
+    const char* getCalibrationSource() const;
+};
+
+#endif // BATTERY_MONITOR_H
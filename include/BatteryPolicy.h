@@ -0,0 +1,64 @@
+/**
+ * @file BatteryPolicy.h
+ * @brief Battery level classification and power-saving profiles for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Plain C++ (no Arduino dependencies) so the policy can be exercised on the host.
+ */
+
+#ifndef BATTERY_POLICY_H
+#define BATTERY_POLICY_H
+
+#include <stdint.h>
+
+enum BatteryLevel {
+    BATTERY_EXTERNAL,   // No battery detected, running from USB/mains
+    BATTERY_NORMAL,
+    BATTERY_LOW,
+    BATTERY_CRITICAL
+};
+
+// What the rest of the system should do at a given battery level
+struct PowerProfile {
+    BatteryLevel level;
+    uint8_t samplingSlowdown;   // Multiplier applied to sensor sampling intervals
+    bool radioEnabled;          // False: keep WiFi off entirely
+    bool radioPowerSave;        // True: use modem sleep while connected
+    uint8_t minLogLevel;        // Lowest LogLevel still recorded
+};
+
+class BatteryPolicy {
+private:
+    uint16_t lowMillivolts;
+    uint16_t criticalMillivolts;
+    uint16_t hysteresisMillivolts;
+    uint16_t presentMillivolts;
+    uint16_t maxMillivolts;
+    uint16_t maxStepMillivolts;
+    uint8_t confirmSamples;
+    BatteryLevel level;
+    BatteryLevel pending;           // Least severe change the recent readings agree on
+    uint8_t pendingCount;
+    uint16_t lastMillivolts;        // 0 until the first reading
+
+    BatteryLevel classify(uint16_t millivolts) const;
+
+public:
+    // A reading outside presentMv..maxMv, or one that moved more than maxStepMv since the last, is not
+    // a cell (nothing fitted, or a floating sense pin) and switches to external power at once. Leaving
+    // external power, or falling to a lower level, takes confirmSamples such readings in a row.
+    BatteryPolicy(uint16_t lowMv, uint16_t criticalMv, uint16_t hysteresisMv, uint16_t presentMv,
+                  uint16_t maxMv, uint16_t maxStepMv, uint8_t confirm);
+
+    // Feed a filtered battery voltage; returns true when the level changed
+    bool update(uint16_t millivolts);
+
+    BatteryLevel getLevel() const { return level; }
+    PowerProfile getProfile() const { return profileFor(level); }
+
+    static PowerProfile profileFor(BatteryLevel level);
+    static const char* levelName(BatteryLevel level);
+};
+
+#endif // BATTERY_POLICY_H
@@ -9,8 +9,15 @@
 #define BUZZER_CONTROLLER_H
 
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <driver/ledc.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "config.h"
 #include "Logger.h"
+#include "PatternSequencer.h"
+#include "ToneQueue.h"
+#include "PatternLibrary.h"
 
 enum BuzzerPattern {
     PATTERN_OFF,
@@ -21,13 +28,9 @@ enum BuzzerPattern {
     PATTERN_ALARM,
     PATTERN_SUCCESS,
     PATTERN_ERROR,
-    PATTERN_NOTIFICATION
-};
-
-struct BuzzerTone {
-    int frequency;
-    int duration;
-    int pause;
+    PATTERN_NOTIFICATION,
+    PATTERN_TONES,              // Ad-hoc beeps and jingles
+    PATTERN_CUSTOM              // Uploaded pattern from the PatternLibrary
 };
 
 class BuzzerController {
@@ -38,40 +41,71 @@ private:
     int buzzerPin;
     int pwmChannel;
     int currentFrequency;
+    uint32_t outputFrequency;   // Frequency the LEDC timer is currently set to
+    bool hardwareFade;          // LEDC fade service installed; otherwise volume changes in steps
+    
+    // Pattern control (written under sequencerLock, also from the timer task)
+    volatile BuzzerPattern currentPattern;
+    volatile bool isActive;
+    volatile bool patternFinished;  // Set by the step timer when the queue runs dry
+    volatile bool timerFault;       // esp_timer_start_once() failed; logged by update()
     
-    // Pattern control
-    BuzzerPattern currentPattern;
-    bool isActive;
-    unsigned long patternStartTime;
-    unsigned long lastToggleTime;
-    int patternStep;
-    bool toneOn;
+    // Step timing runs from an esp_timer at absolute deadlines, independent of update().
+    // Requests wait in toneQueue; the next one starts at the previous one's last deadline.
+    ToneQueue toneQueue;
+    PatternSequencer sequencer;
+    esp_timer_handle_t stepTimer;
+    SemaphoreHandle_t sequencerLock;        // Never waited for on the esp_timer task
     
-    // Pattern definitions
-    static const BuzzerTone alarmPattern[];
-    static const BuzzerTone successPattern[];
-    static const BuzzerTone errorPattern[];
-    static const BuzzerTone notificationPattern[];
+    // Uploaded patterns, loaded by name
+    PatternLibrary* patternLibrary;
+    
+    static void onStepTimer(void* arg);
+    void handleStepTimer();
+    void armStepTimer();
+    void applyOutput(const ToneOutput& output);
+    void startCurrent(uint64_t startUs);
+    ToneDecision submit(ToneRequest& request);
+    ToneDecision playCode(const uint8_t* code, uint16_t length, bool loop, TonePriority priority, BuzzerPattern tag,
+                          const RampProfile* ramp = nullptr);
+    ledc_mode_t fadeMode() const { return (ledc_mode_t)(pwmChannel / 8); }
+    ledc_channel_t fadeChannel() const { return (ledc_channel_t)(pwmChannel % 8); }
+    void playBeeps(int frequency, int duration, uint8_t count);
+    static TonePriority defaultPriority(BuzzerPattern pattern);
     
 public:
     BuzzerController(Logger* log);
     ~BuzzerController();
     
     bool begin(int pin = BUZZER_PIN, int channel = BUZZER_CHANNEL);
-    void update(); // Call frequently in main loop
+    void update(); // Call from the main loop; only reports finished patterns
     
-    // Basic control
+    // Basic control. Nothing here blocks: requests are queued and played by the step timer.
+    // A higher priority preempts the sound playing; lower priorities wait behind it.
     void setBuzzer(bool enabled);
     void playPattern(BuzzerPattern pattern);
-    void stopPattern();
+    void playPattern(BuzzerPattern pattern, TonePriority priority);
+    void stopPattern();                         // Stops playback and clears the queue
+    void stopPriority(TonePriority priority);   // Stops one priority, then resumes the queue
+    
+    // Plays a built-in pattern by name ("alarm", "pulse", ...) or an uploaded one;
+    // loop repeats one-shot patterns, e.g. when used as an alarm sound, and
+    // ramp fades the volume in from quiet (wake-up crescendo)
+    bool playSound(const String& name, TonePriority priority, bool loop, const RampProfile* ramp = nullptr);
+    void setPatternLibrary(PatternLibrary* library);
+    
+    // Built-in names, indexed by BuzzerPattern
+    static const char* const builtinNames[];
+    static BuzzerPattern patternFromName(const String& name);   // PATTERN_OFF if not built in
     
-    // Custom tones
+    // Custom tones (feedback priority)
     void playBeep(int frequency = BUZZER_FREQUENCY, int duration = 200);
     void playDoubleBeep();
     void playTripleBeep();
     
     // Status
     bool isPlaying() const { return isActive; }
+    uint8_t getQueuedCount() const { return toneQueue.size(); }
     BuzzerPattern getCurrentPattern() const { return currentPattern; }
     
     // Configuration
@@ -82,11 +116,9 @@ public:
     void performBuzzerTest();
     void playStartupTone();
 
-    // Added missing method declarations    
+    // Direct tone control (bypasses the sequencer)
     void playTone(int frequency, int duration = 0);
     void stopTone();
-    void updatePattern();
-    void executePatternStep(const BuzzerTone* pattern, int patternLength);
 
 };
 
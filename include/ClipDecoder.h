@@ -0,0 +1,84 @@
+/**
+ * @file ClipDecoder.h
+ * @brief Streaming decoder for sampled audio clips for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Clips are "<AUDIO_DIRECTORY>/<name>.nba" files made with tools/make_clip.py:
+ *
+ *   'N' 'B' 'A' version     magic and format version
+ *   format                  CLIP_PCM_U8 or CLIP_IMA_ADPCM
+ *   reserved
+ *   sampleRate  uint16 LE   Hz, must match AUDIO_SAMPLE_RATE
+ *   sampleCount uint32 LE   mono samples in the clip
+ *   data
+ *
+ * PCM data is unsigned 8-bit. IMA ADPCM data is in CLIP_BLOCK_BYTES blocks
+ * (the last may be shorter), each starting with the predictor (int16 LE) and
+ * step index, followed by 4-bit codes, low nibble first. Blocks decode
+ * independently, so a damaged block cannot garble the rest of the clip.
+ *
+ * The decoder pulls bytes through a read function and produces signed
+ * 16-bit samples a block at a time. Plain C++ (no Arduino dependencies) so it
+ * can be benchmarked on the host (see tools/audio_bench.cpp).
+ */
+
+#ifndef CLIP_DECODER_H
+#define CLIP_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CLIP_HEADER_BYTES 12
+#define CLIP_BLOCK_BYTES 256
+#define CLIP_ADPCM_HEADER_BYTES 4
+#define CLIP_ADPCM_BLOCK_SAMPLES ((CLIP_BLOCK_BYTES - CLIP_ADPCM_HEADER_BYTES) * 2)
+#define CLIP_FORMAT_VERSION 1
+
+enum ClipFormat {
+    CLIP_PCM_U8 = 0,
+    CLIP_IMA_ADPCM = 1
+};
+
+struct ClipHeader {
+    uint8_t format;         // ClipFormat
+    uint16_t sampleRate;
+    uint32_t sampleCount;
+};
+
+class ClipDecoder {
+public:
+    typedef size_t (*ReadFunction)(void* context, uint8_t* buffer, size_t length);
+
+private:
+    ReadFunction reader;
+    void* readContext;
+    ClipHeader header;
+    uint32_t remaining;         // Samples not yet returned
+
+    uint8_t encoded[CLIP_BLOCK_BYTES];
+    int16_t decoded[CLIP_ADPCM_BLOCK_SAMPLES];
+    uint16_t decodedCount;
+    uint16_t decodedPos;
+
+    bool refill();
+
+public:
+    ClipDecoder();
+
+    // Reads and checks the header; the read function then supplies the data
+    bool begin(ReadFunction read, void* context);
+
+    // Fills out with up to count samples; fewer only at the end of the clip
+    uint16_t read(int16_t* out, uint16_t count);
+
+    bool finished() const { return remaining == 0; }
+    const ClipHeader& getHeader() const { return header; }
+
+    static bool parseHeader(const uint8_t* data, size_t length, ClipHeader* header);
+
+    // Decodes one ADPCM block; returns the samples produced (2 per data byte)
+    static uint16_t decodeAdpcmBlock(const uint8_t* block, uint16_t length, int16_t* out);
+};
+
+#endif // CLIP_DECODER_H
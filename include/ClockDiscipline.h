@@ -0,0 +1,71 @@
+/**
+ * @file ClockDiscipline.h
+ * @brief Drift estimation and slewing decisions for the system clock
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Turns SNTP samples into clock corrections without ever stepping the time
+ * once it is set: the measured offset is slewed away (adjtime() on the
+ * device), and the offset left over after a sync interval tells how far the
+ * crystal drifts. The drift estimate is a scalar Kalman filter whose
+ * measurement noise is the sample's round-trip delay over the interval, so
+ * noisy short intervals barely move it. driftCorrection() hands out the
+ * correction the estimate implies, a few microseconds at a time, so the
+ * clock keeps time between syncs. The poll interval doubles while the
+ * predicted error at the next sync stays under SNTP_TARGET_ERROR_MS and
+ * halves when a sync finds more than twice that.
+ *
+ * Only the first sample, or one beyond SNTP_STEP_THRESHOLD_MS, steps the
+ * clock. Plain C++ (no Arduino dependencies) so it can be exercised on the
+ * host.
+ */
+
+#ifndef CLOCK_DISCIPLINE_H
+#define CLOCK_DISCIPLINE_H
+
+#include <stdint.h>
+#include "config.h"
+
+enum ClockAction {
+    CLOCK_IGNORE,       // Sample not trusted
+    CLOCK_STEP,         // Set the clock forward/back by amountUs at once
+    CLOCK_SLEW          // Add amountUs to the gradual adjustment
+};
+
+struct ClockCorrection {
+    uint8_t action;     // ClockAction
+    int64_t amountUs;
+};
+
+class ClockDiscipline {
+private:
+    bool synchronized;
+    double driftPpm;            // Correction applied: positive when the crystal runs slow
+    double driftVariance;       // Uncertainty of driftPpm, ppm^2
+    uint64_t lastSampleUs;      // Monotonic time of the last accepted sample
+    uint64_t lastCorrectionUs;  // Monotonic time driftCorrection() was last settled to
+    double correctionCarryUs;   // Sub-microsecond remainder of the drift correction
+    uint32_t pollIntervalS;
+    int64_t lastOffsetUs;
+    uint32_t sampleCount;
+    uint32_t stepCount;
+
+public:
+    ClockDiscipline();
+
+    // pendingUs: adjustment already handed to the clock but not applied yet
+    ClockCorrection addSample(int64_t offsetUs, uint32_t delayUs, uint64_t monotonicUs, int64_t pendingUs = 0);
+
+    // Drift correction owed since the previous call, in whole microseconds
+    int64_t driftCorrection(uint64_t monotonicUs);
+
+    bool isSynchronized() const { return synchronized; }
+    uint32_t getPollInterval() const { return pollIntervalS; }
+    double getDriftPpm() const { return driftPpm; }
+    double getDriftUncertaintyPpm() const;
+    int64_t getLastOffsetUs() const { return lastOffsetUs; }
+    uint32_t getSampleCount() const { return sampleCount; }
+    uint32_t getStepCount() const { return stepCount; }
+};
+
+#endif // CLOCK_DISCIPLINE_H
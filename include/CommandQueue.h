@@ -0,0 +1,156 @@
+/**
+ * @file CommandQueue.h
+ * @brief Typed commands handed from any task or core to the main loop
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * A Command is a short list of typed operations (add an alarm, set the
+ * quiet window, ...) that the main loop executes in order, stopping at the
+ * first one that fails. Nothing is encoded as text or parsed again: the
+ * web handlers validate their arguments into the structs below and the
+ * main loop uses the fields as they are.
+ *
+ * The queue is a bounded ring with one sequence number per cell (Vyukov's
+ * MPMC design, used here with a single consumer). push() claims a cell
+ * with one compare-and-swap and never waits or allocates, so the AsyncTCP
+ * task, the other core or an ISR-deferred task can all submit; a full
+ * queue is reported instead. Only the main loop calls pop() and
+ * complete().
+ *
+ * Every accepted command gets a ticket. Its outcome is kept in one of
+ * COMMAND_COMPLETION_SLOTS completion slots, where getResult() finds it
+ * until COMMAND_COMPLETION_SLOTS later commands have reused the slot.
+ */
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include "config.h"
+
+enum CommandType : uint8_t {
+    CMD_ADD_ALARM,
+    CMD_UPDATE_ALARM,
+    CMD_DELETE_ALARM,
+    CMD_SET_WIFI,
+    CMD_CLEAR_LOGS,
+    CMD_SET_LOG_LEVEL,
+    CMD_SET_QUIET_WINDOW,
+    CMD_OTA_RESTART,
+    CMD_STORE_PATTERN,
+    CMD_DELETE_PATTERN
+};
+
+struct AlarmOperation {
+    uint8_t id;                 // Update and delete
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t dayMask;
+    bool enabled;               // Update only; added alarms start enabled
+    uint8_t rampShape;
+    uint16_t rampSeconds;
+    char label[ALARM_LABEL_MAX + 1];
+    char sound[PATTERN_NAME_MAX + 1];
+};
+
+struct WiFiOperation {
+    char ssid[33];
+    char password[64];
+};
+
+struct PatternOperation {
+    char name[PATTERN_NAME_MAX + 1];
+    uint16_t length;            // Store only
+    const uint8_t* code;        // Store only; the sender's buffer, left alone until the command completes
+};
+
+struct QuietWindowOperation {
+    uint16_t startMinute;       // Equal: no quiet window
+    uint16_t endMinute;
+};
+
+struct CommandOp {
+    CommandType type;
+    union {
+        AlarmOperation alarm;
+        WiFiOperation wifi;
+        QuietWindowOperation quiet;
+        PatternOperation pattern;
+        uint8_t logLevel;
+    };
+};
+
+struct Command {
+    uint8_t count;
+    CommandOp ops[COMMAND_MAX_OPS];
+
+    Command() : count(0) {}
+
+    // Zeroed operation of the given type, or nullptr once the command is full
+    CommandOp* add(CommandType type) {
+        if (count >= COMMAND_MAX_OPS) {
+            return nullptr;
+        }
+        CommandOp* op = &ops[count++];
+        memset(op, 0, sizeof(*op));
+        op->type = type;
+        return op;
+    }
+};
+
+enum CommandStatus : uint8_t {
+    COMMAND_UNKNOWN,            // Never issued, or its slot has been reused
+    COMMAND_PENDING,
+    COMMAND_DONE,
+    COMMAND_FAILED              // ops[completed] failed; the ones after it were not run
+};
+
+struct CommandResult {
+    CommandStatus status;
+    uint8_t completed;                  // Operations that succeeded
+    int32_t values[COMMAND_MAX_OPS];    // Per operation, e.g. the id of an added alarm; -1 if none
+    const char* error;                  // Static string, nullptr unless failed
+};
+
+class CommandQueue {
+private:
+    struct Cell {
+        std::atomic<uint32_t> sequence;     // Position it is free for, or position + 1 once filled
+        Command command;
+    };
+
+    // Results are copied in and out as relaxed atomic words: a reader that overlaps a write gets torn
+    // words it then discards, rather than racing on plain memory
+    static const size_t RESULT_WORDS = (sizeof(CommandResult) + 3) / 4;
+
+    struct Completion {
+        std::atomic<uint32_t> ticket;       // 0 while being written
+        std::atomic<uint32_t> words[RESULT_WORDS];
+    };
+
+    Cell cells[COMMAND_QUEUE_SIZE];
+    std::atomic<uint32_t> enqueuePosition;
+    uint32_t dequeuePosition;               // Main loop only
+    std::atomic<uint32_t> lastCompleted;
+    Completion completions[COMMAND_COMPLETION_SLOTS];
+    std::atomic<uint32_t> rejected;
+
+public:
+    CommandQueue();
+
+    // Any task or core. Returns the ticket, or 0 if the queue is full or the command empty.
+    uint32_t push(const Command& command);
+
+    // Main loop only: oldest command first
+    bool pop(Command* command, uint32_t* ticket);
+    void complete(uint32_t ticket, const CommandResult& result);
+
+    // Any task or core
+    CommandStatus getResult(uint32_t ticket, CommandResult* result) const;
+    uint32_t getRejectedCount() const { return rejected.load(std::memory_order_relaxed); }
+};
+
+#endif // COMMAND_QUEUE_H
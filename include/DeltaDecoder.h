@@ -0,0 +1,131 @@
+/**
+ * @file DeltaDecoder.h
+ * @brief Streaming decoder for NBD1 binary delta patches
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * An NBD1 patch rebuilds a new firmware image from the one that runs now,
+ * bsdiff style: the new image is a series of blocks, each a stretch of the
+ * old image with small byte differences added (code that moved keeps its
+ * instructions but not its addresses) followed by bytes that are simply
+ * new. Patches are made on the host by tools/make_delta.py.
+ *
+ *   header   "NBD1"
+ *            u32 source size, 32-byte SHA-256 of the source image
+ *            u32 target size, 32-byte SHA-256 of the target image
+ *   blocks   until the target is complete; integers are LEB128 varints:
+ *            diff length, extra length, zigzag source seek
+ *            diff:  tokens until diff length bytes are out; a token n with
+ *                   the low bit clear copies n >> 1 source bytes unchanged,
+ *                   with it set n >> 1 bytes follow that are added to the
+ *                   source bytes (mod 256)
+ *            extra: extra length bytes, copied as they are
+ *            The diff reads the source from the current position onwards;
+ *            after the block the position moves on by the seek.
+ *
+ * feed() takes the patch in pieces of any size, as they come off the
+ * network. Source bytes are read through a DELTA_SOURCE_WINDOW cache and
+ * output goes to the write function in pieces of at most
+ * DELTA_OUTPUT_BUFFER bytes, so memory use does not depend on the image.
+ * feed() stops right after the header so the caller can check the source
+ * and get ready for the target before any output arrives.
+ *
+ * Plain C++ (no Arduino dependencies); tools/delta_check.cpp runs it on
+ * the host.
+ */
+
+#ifndef DELTA_DECODER_H
+#define DELTA_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#define DELTA_SHA256_BYTES 32
+#define DELTA_HEADER_BYTES (4 + 4 + DELTA_SHA256_BYTES + 4 + DELTA_SHA256_BYTES)
+
+enum DeltaStatus {
+    DELTA_MORE,         // All input used, more expected
+    DELTA_HEADER,       // Header complete; feed() stopped right after it
+    DELTA_DONE,         // Target complete
+    DELTA_ERROR         // See getError(); nothing more is accepted
+};
+
+struct DeltaHeader {
+    uint32_t sourceSize;
+    uint8_t sourceSha256[DELTA_SHA256_BYTES];
+    uint32_t targetSize;
+    uint8_t targetSha256[DELTA_SHA256_BYTES];
+};
+
+class DeltaDecoder {
+public:
+    typedef bool (*ReadFunction)(void* context, uint32_t offset, uint8_t* buffer, size_t length);
+    typedef bool (*WriteFunction)(void* context, const uint8_t* data, size_t length);
+
+private:
+    enum Stage {
+        STAGE_HEADER,
+        STAGE_CONTROL,      // Three varints
+        STAGE_TOKEN,        // Next diff token
+        STAGE_ADD,          // Inside a diff token's added bytes
+        STAGE_EXTRA,
+        STAGE_DONE,
+        STAGE_FAILED
+    };
+
+    ReadFunction readSource;
+    WriteFunction writeTarget;
+    void* context;
+
+    Stage stage;
+    uint8_t headerBytes[DELTA_HEADER_BYTES];
+    DeltaHeader header;
+    uint32_t varint;                // Varint being read and the bits it has so far
+    uint8_t varintShift;
+    uint8_t controlField;           // Which of the three control varints comes next
+    uint32_t diffLeft;
+    uint32_t extraLeft;
+    int32_t seek;
+    uint32_t tokenLeft;             // Added bytes left in the current token
+    uint32_t sourcePos;
+    uint32_t produced;
+    uint32_t consumed;
+    const char* error;
+
+    uint8_t window[DELTA_SOURCE_WINDOW];
+    uint32_t windowStart;
+    uint32_t windowLength;
+    uint8_t output[DELTA_OUTPUT_BUFFER];
+
+    bool parseHeader();
+    bool readVarint(uint8_t byte, bool* complete);
+    bool startBlock();
+    bool nextPart();
+    bool endBlock();
+    bool copySource(uint32_t length);
+    bool loadWindow(uint32_t position);
+    bool emit(const uint8_t* data, size_t length);
+    bool fail(const char* reason);
+
+public:
+    DeltaDecoder();
+
+    void begin(ReadFunction read, WriteFunction write, void* context);
+    void reset();       // Ready for a new patch
+
+    // used: how much of data was taken; all of it unless DELTA_HEADER or DELTA_ERROR
+    DeltaStatus feed(const uint8_t* data, size_t length, size_t* used);
+
+    bool hasHeader() const { return consumed >= DELTA_HEADER_BYTES; }
+    const DeltaHeader& getHeader() const { return header; }
+    bool isComplete() const { return stage == STAGE_DONE; }
+    uint32_t getProduced() const { return produced; }
+    uint32_t getConsumed() const { return consumed; }
+    const char* getError() const { return error; }
+
+    // Whether an upload starting with these bytes is a patch rather than an image (which starts 0xE9)
+    static bool isPatch(const uint8_t* data, size_t length);
+};
+
+#endif // DELTA_DECODER_H
@@ -0,0 +1,136 @@
+/**
+ * @file EventBus.h
+ * @brief Allocation-free typed publish/subscribe bus for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Events are small POD structs declared next to the component that produces
+ * them. Every event type gets its own fixed table of EVENT_MAX_SUBSCRIBERS
+ * plain function pointers, so dispatch needs neither heap allocation nor
+ * virtual calls. publish() calls subscribers immediately; post() copies the
+ * event into a fixed ring that dispatchPending() drains from the main loop.
+ *
+ * Subscribing and deferred posting are meant for the main loop task only.
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "config.h"
+
+// Per-type subscriber table, one instance per event type
+template <typename E>
+struct EventSubscribers {
+    typedef void (*Handler)(void* context, const E& event);
+
+    struct Entry {
+        Handler handler;
+        void* context;
+    };
+
+    static Entry entries[EVENT_MAX_SUBSCRIBERS];
+    static uint8_t count;
+};
+
+template <typename E>
+typename EventSubscribers<E>::Entry EventSubscribers<E>::entries[EVENT_MAX_SUBSCRIBERS];
+
+template <typename E>
+uint8_t EventSubscribers<E>::count = 0;
+
+class EventBus {
+private:
+    typedef void (*Dispatcher)(const void* payload);
+
+    // Deferred events, copied by value
+    struct PendingEvent {
+        Dispatcher dispatch;
+        alignas(8) uint8_t payload[EVENT_MAX_PAYLOAD];
+    };
+
+    static PendingEvent queue[EVENT_QUEUE_SIZE];
+    static uint8_t queueHead;
+    static uint8_t queueCount;
+    static uint32_t droppedEvents;
+
+    template <typename E>
+    static void dispatchStored(const void* payload) {
+        E event;
+        memcpy(&event, payload, sizeof(E));
+        publish(event);
+    }
+
+    // Adapters so plain functions and member functions share one table layout
+    template <typename E>
+    static void callFunction(void* context, const E& event) {
+        void (*function)(const E&);
+        memcpy(&function, &context, sizeof(function));
+        function(event);
+    }
+
+    template <typename E, typename T, void (T::*Method)(const E&)>
+    static void callMember(void* context, const E& event) {
+        (static_cast<T*>(context)->*Method)(event);
+    }
+
+    static bool enqueue(Dispatcher dispatch, const void* event, size_t size);
+
+public:
+    // Handler with an explicit context pointer
+    template <typename E>
+    static bool subscribe(void (*handler)(void*, const E&), void* context) {
+        typedef EventSubscribers<E> Table;
+        if (Table::count >= EVENT_MAX_SUBSCRIBERS) {
+            return false;
+        }
+        Table::entries[Table::count].handler = handler;
+        Table::entries[Table::count].context = context;
+        Table::count++;
+        return true;
+    }
+
+    // Free function: EventBus::subscribe(onPillBox)
+    template <typename E>
+    static bool subscribe(void (*handler)(const E&)) {
+        static_assert(sizeof(handler) <= sizeof(void*), "function pointer does not fit the context slot");
+        void* context = nullptr;
+        memcpy(&context, &handler, sizeof(handler));
+        return subscribe<E>(&callFunction<E>, context);
+    }
+
+    // Member function: EventBus::subscribe<E, T, &T::method>(object)
+    template <typename E, typename T, void (T::*Method)(const E&)>
+    static bool subscribe(T* object) {
+        return subscribe<E>(&callMember<E, T, Method>, object);
+    }
+
+    // Synchronous dispatch to every subscriber in registration order
+    template <typename E>
+    static void publish(const E& event) {
+        typedef EventSubscribers<E> Table;
+        for (uint8_t i = 0; i < Table::count; i++) {
+            Table::entries[i].handler(Table::entries[i].context, event);
+        }
+    }
+
+    // Deferred dispatch; returns false (and counts a drop) when the ring is full
+    template <typename E>
+    static bool post(const E& event) {
+        static_assert(std::is_trivially_copyable<E>::value, "events must be POD");
+        static_assert(sizeof(E) <= EVENT_MAX_PAYLOAD, "event larger than EVENT_MAX_PAYLOAD");
+        return enqueue(&dispatchStored<E>, &event, sizeof(E));
+    }
+
+    // Delivers events posted before the call; returns how many were delivered
+    static uint8_t dispatchPending();
+
+    template <typename E>
+    static uint8_t subscriberCount() { return EventSubscribers<E>::count; }
+    static uint8_t pendingCount() { return queueCount; }
+    static uint32_t getDroppedCount() { return droppedEvents; }
+};
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,61 @@
+/**
+ * @file FadePlanner.h
+ * @brief Volume ramps and LEDC hardware fade planning for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * The LEDC fade engine moves the duty by one step every 1..LEDC_FADE_MAX_CYCLES
+ * PWM periods, so how slow a single fade can be depends on the tone frequency
+ * and the duty distance. FadePlanner splits a fade into segments the hardware
+ * can execute, each programmed once and none longer than FADE_SEGMENT_MAX_MS
+ * (on IDF 4.4 a duty write waits for a running fade), and computes wake-up
+ * ramp levels.
+ * Plain C++ (no Arduino dependencies) so it can be checked on the host
+ * (see tools/fade_planner_check.cpp).
+ */
+
+#ifndef FADE_PLANNER_H
+#define FADE_PLANNER_H
+
+#include <stdint.h>
+#include "config.h"
+
+#define LEDC_FADE_MAX_CYCLES 1023   // 10-bit cycle counter per duty step
+
+enum RampShape {
+    RAMP_NONE,          // Full volume from the start
+    RAMP_LINEAR,
+    RAMP_PERCEPTUAL     // Quadratic: slow start, loudness rises evenly to the ear
+};
+
+// Wake-up crescendo from startLevel to full volume
+struct RampProfile {
+    uint16_t durationS;
+    uint8_t startLevel;     // 0-255 share of the pattern's volume at the start
+    uint8_t shape;          // RampShape
+};
+
+// Fade to duty over fadeMs, then hold until durationMs
+struct FadeSegment {
+    uint8_t duty;
+    uint32_t fadeMs;
+    uint32_t durationMs;
+};
+
+class FadePlanner {
+public:
+    // Longest single hardware fade across dutyDelta steps at pwmFrequency
+    static uint32_t maxFadeMs(uint32_t dutyDelta, uint32_t pwmFrequency);
+
+    // Splits a fade into at most maxSegments hardware fades; returns the count
+    static uint8_t plan(uint8_t fromDuty, uint8_t toDuty, uint32_t durationMs, uint32_t pwmFrequency,
+                        FadeSegment* segments, uint8_t maxSegments);
+
+    // Ramp level (0-255) elapsedMs into the ramp
+    static uint8_t rampLevel(const RampProfile& profile, uint32_t elapsedMs);
+
+    // duty scaled by level, never rounding an audible duty down to silence
+    static uint8_t scaleDuty(uint8_t duty, uint8_t level);
+};
+
+#endif // FADE_PLANNER_H
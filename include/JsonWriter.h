@@ -0,0 +1,81 @@
+/**
+ * @file JsonWriter.h
+ * @brief Allocation-free JSON serializer into a fixed buffer
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Writes JSON straight into a caller-owned buffer: no String, no heap, no
+ * document tree. Commas and nesting are tracked so callers only say what
+ * comes next. Room for closing every open object/array is always kept back,
+ * so a writer that runs out of space still ends in valid JSON once the
+ * containers are closed; overflowed() reports that something was dropped.
+ *
+ * mark()/rollback() let a list stop cleanly at the last element that fit,
+ * which is how the web API pages long responses.
+ *
+ * Plain C++ (no Arduino dependencies) so it can be exercised on the host.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define JSON_WRITER_MAX_DEPTH 16
+
+class JsonWriter {
+public:
+    struct Mark {
+        size_t length;
+        uint8_t depth;
+        uint8_t skipped;
+        uint16_t hasItems;
+        const char* pendingKey;
+        bool overflow;
+    };
+
+private:
+    char* buffer;
+    size_t capacity;
+    size_t length;
+    uint8_t depth;
+    uint8_t skipped;        // Containers that did not fit; their end*() calls are ignored
+    uint16_t hasItems;      // Bit per nesting level: the next item needs a comma
+    const char* pendingKey; // Written together with its value, so a value that does not fit takes it along
+    bool overflow;
+
+    bool put(const char* text, size_t count);
+    bool put(char c) { return put(&c, 1); }
+    bool separate();
+    bool open(char bracket);
+    void close(char bracket);
+    bool putEscaped(const char* text);
+
+public:
+    JsonWriter(char* buf, size_t size);
+
+    void beginObject() { open('{'); }
+    void endObject() { close('}'); }
+    void beginArray() { open('['); }
+    void endArray() { close(']'); }
+    void key(const char* name);         // Must stay valid until the value is written
+
+    void string(const char* text);      // nullptr writes null
+    void number(int32_t value);
+    void unsignedNumber(uint32_t value);
+    void decimal(float value, uint8_t digits);
+    void boolean(bool value);
+    void null();
+
+    Mark mark() const;
+    void rollback(const Mark& position);
+
+    const char* data() const { return buffer; }
+    size_t size() const { return length; }
+    size_t remaining() const { return capacity - length - depth; }   // After closing what is open
+    bool overflowed() const { return overflow; }
+    bool isComplete() const { return depth == 0 && skipped == 0 && length > 0; }
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,66 @@
+/**
+ * @file LightTrendDetector.h
+ * @brief Streaming lights-out / lights-on detection for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * One-sided CUSUM change-point detection on the filtered light level,
+ * measured against learned day and night baselines. Integer arithmetic and
+ * O(1) work per sample. Plain C++ (no Arduino dependencies) so recorded
+ * traces can be replayed on the host (see tools/light_replay.cpp).
+ */
+
+#ifndef LIGHT_TREND_DETECTOR_H
+#define LIGHT_TREND_DETECTOR_H
+
+#include <stdint.h>
+
+enum LightRegime {
+    LIGHT_REGIME_UNKNOWN,
+    LIGHT_REGIME_LIT,
+    LIGHT_REGIME_DARK
+};
+
+enum LightTrendChange {
+    LIGHT_TREND_NONE,
+    LIGHT_TREND_LIGHTS_OUT,
+    LIGHT_TREND_LIGHTS_ON
+};
+
+struct LightTrendResult {
+    LightTrendChange change;
+    uint8_t confidence;         // 0-100
+    uint32_t changeTime;        // Timestamp the shift started (not when it was confirmed)
+    int32_t level;              // Level the signal shifted to
+};
+
+class LightTrendDetector {
+private:
+    // Baselines and statistics are kept scaled by 16
+    int32_t litBaseline;
+    int32_t darkBaseline;
+    int32_t threshold;          // Initial split between lit and dark
+    uint32_t minDwellSeconds;   // Shifts shorter than this are treated as shadows
+
+    LightRegime regime;
+    int32_t cusum;
+    uint32_t runStart;
+    int32_t runLevel;           // Fast EWMA of the level since runStart (-1 = no run)
+
+    void resetRun();
+    void learn(int32_t scaledLevel);
+    int32_t contrast() const;
+
+public:
+    LightTrendDetector(int32_t darkThreshold, uint32_t dwellSeconds);
+
+    // Feed one filtered light sample (0-4095); returns a confirmed change, if any
+    LightTrendResult update(uint32_t timestamp, int32_t level);
+
+    LightRegime getRegime() const { return regime; }
+    int32_t getLitBaseline() const { return litBaseline / 16; }
+    int32_t getDarkBaseline() const { return darkBaseline / 16; }
+    int32_t getCusum() const { return cusum / 16; }
+};
+
+#endif // LIGHT_TREND_DETECTOR_H
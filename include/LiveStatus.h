@@ -0,0 +1,75 @@
+/**
+ * @file LiveStatus.h
+ * @brief Coalesced, delta-encoded live status for WebSocket subscribers
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Holds the latest value of each pushed field. set() may be called any
+ * number of times per tick; commit() closes the tick and gives the changes
+ * one revision number. flush() sends each client a JSON object with only the
+ * fields changed since the last message that client accepted, e.g.
+ * {"r":42,"alarm":1,"id":3}. A client that is busy is skipped and later gets
+ * one message covering everything it missed, so intermediate states are
+ * dropped instead of queued. A new client first gets every known field.
+ * Plain C++ (no Arduino dependencies) so it can be exercised on the host.
+ */
+
+#ifndef LIVE_STATUS_H
+#define LIVE_STATUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+enum LiveField {
+    LIVE_ALARM_STATE,       // AlarmState
+    LIVE_ALARM_ID,          // Active alarm, 0 when none
+    LIVE_PILL_BOX,          // 1 = open
+    LIVE_USB,               // 1 = connected
+    LIVE_LIGHT,             // 0-4095 ADC, within LIVE_LIGHT_DEADBAND
+    LIVE_NETWORK,           // NetworkState
+    LIVE_FIELD_COUNT
+};
+
+class LiveStatus {
+public:
+    // Returns false when the client cannot take a message now; it is retried on a later flush
+    typedef bool (*SendFunction)(void* context, uint32_t clientId, const char* message, size_t length);
+
+private:
+    struct Client {
+        uint32_t id;
+        uint32_t sentRevision;      // 0 until the first full message went out
+        bool used;
+    };
+
+    int32_t values[LIVE_FIELD_COUNT];
+    uint32_t changedAt[LIVE_FIELD_COUNT];   // Revision of the last change, 0 = never set
+    uint32_t revision;                      // Last committed tick
+    bool pending;                           // Changes waiting for commit()
+    Client clients[WS_MAX_CLIENTS];
+
+public:
+    LiveStatus();
+
+    // Deadband: changes smaller than this (in either direction) are ignored
+    void set(LiveField field, int32_t value, int32_t deadband = 0);
+    bool commit();      // True if the tick had changes
+
+    bool addClient(uint32_t id);        // False when WS_MAX_CLIENTS are connected
+    void removeClient(uint32_t id);
+    uint8_t clientCount() const;
+
+    // Sends what each client is missing; returns the number of messages accepted
+    uint8_t flush(SendFunction send, void* context);
+
+    // JSON with the fields changed after revision since (0 = all known fields)
+    size_t writeDelta(uint32_t since, char* out, size_t capacity) const;
+
+    uint32_t getRevision() const { return revision; }
+    int32_t getValue(LiveField field) const { return field < LIVE_FIELD_COUNT ? values[field] : 0; }
+
+    static const char* fieldName(LiveField field);
+};
+
+#endif // LIVE_STATUS_H
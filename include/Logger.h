@@ -11,6 +11,8 @@
 #include <Arduino.h>
 #include <vector>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "config.h"
 
 // Log levels
@@ -50,12 +52,17 @@ struct LogEntry {
     String data;
 };
 
+// Called for each entry by visitRecentLogs(); return false to stop
+typedef bool (*LogVisitor)(void* context, const LogEntry& entry);
+
 class Logger {
 private:
     std::vector<LogEntry> logBuffer;
     Preferences preferences;
     bool flashLoggingEnabled;
     bool serialLoggingEnabled;
+    LogLevel minLevel;
+    SemaphoreHandle_t bufferLock;   // logBuffer is read by the web API from the AsyncTCP task
     
     String levelToString(LogLevel level);
     String eventTypeToString(LogEventType eventType);
@@ -74,11 +81,18 @@ public:
     void logError(LogEventType eventType, const String& message, const String& data = "");
     
     std::vector<LogEntry> getRecentLogs(int count = 10);
+    // Newest first, at most count entries at or above level; safe from any task, no copies
+    size_t visitRecentLogs(size_t count, LogLevel level, LogVisitor visitor, void* context);
     void clearLogs();
     void enableFlashLogging(bool enable);
     void enableSerialLogging(bool enable);
+    void setMinLevel(LogLevel level) { minLevel = level; }
+    LogLevel getMinLevel() const { return minLevel; }
     String getLogsSummary();
     void exportLogsToString(String& output);
+    
+    static const char* levelName(LogLevel level);
+    static const char* eventName(LogEventType eventType);
 };
 
 #endif // LOGGER_H
@@ -0,0 +1,121 @@
+/**
+ * @file MqttClient.h
+ * @brief Non-blocking MQTT 3.1.1 publisher
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Just enough MQTT to publish at QoS 1: CONNECT, PUBLISH, PUBACK and the
+ * keepalive ping. The owner opens the TCP connection and hands over send
+ * and receive functions that never wait; update() moves whatever bytes the
+ * socket takes or has, parses complete packets and reports what happened.
+ * One PUBLISH is in flight at a time, so its PUBACK confirms everything up
+ * to it. Sessions are clean: anything not acknowledged when the connection
+ * drops is simply published again on the next one, which is what the
+ * spool behind it is for.
+ *
+ * All buffers are members of fixed size; nothing is allocated.
+ *
+ * Plain C++ (no Arduino dependencies) so it can be exercised on the host,
+ * against a real broker too.
+ */
+
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#define MQTT_CLIENT_ID_MAX 23       // Longest id every 3.1.1 broker has to accept
+
+enum MqttState {
+    MQTT_DISCONNECTED,
+    MQTT_WAIT_CONNACK,
+    MQTT_CONNECTED
+};
+
+enum MqttEvent {
+    MQTT_NONE,
+    MQTT_SESSION_UP,        // CONNACK accepted
+    MQTT_PUBLISHED,         // The message in flight was acknowledged
+    MQTT_LOST               // Refused, timed out or closed; see getLastError(). Close the transport.
+};
+
+enum MqttError {
+    MQTT_OK,
+    MQTT_ERROR_REFUSED,     // CONNACK return code in getRefusalCode()
+    MQTT_ERROR_TIMEOUT,     // No CONNACK, PUBACK or PINGRESP in time
+    MQTT_ERROR_TRANSPORT,   // Send or receive failed, or the broker closed the connection
+    MQTT_ERROR_PROTOCOL     // Something we did not ask for or cannot parse
+};
+
+class MqttClient {
+public:
+    // Both return bytes moved, 0 when the socket would block, -1 on error or close
+    typedef int (*SendFunction)(void* context, const uint8_t* data, size_t length);
+    typedef int (*ReceiveFunction)(void* context, uint8_t* data, size_t capacity);
+
+private:
+    SendFunction sendBytes;
+    ReceiveFunction receiveBytes;
+    void* context;
+
+    char clientId[MQTT_CLIENT_ID_MAX + 1];
+    uint16_t keepAliveS;
+
+    MqttState state;
+    MqttError lastError;
+    uint8_t refusalCode;
+
+    // Bytes waiting for the socket
+    uint8_t txBuffer[MQTT_PACKET_MAX];
+    size_t txLength;
+    size_t txSent;
+
+    // Partial packet from the broker; we only expect short ones
+    uint8_t rxBuffer[MQTT_RX_BUFFER];
+    size_t rxLength;
+
+    uint16_t nextPacketId;
+    uint16_t inFlightId;        // 0 when nothing awaits a PUBACK
+    uint32_t waitStarted;       // CONNACK or PUBACK outstanding since
+    bool pingOutstanding;
+    uint32_t pingSent;
+    uint32_t lastSent;          // Last packet queued; the keepalive counts from here
+
+    uint32_t published;
+    uint32_t acknowledged;
+
+    bool queue(const uint8_t* data, size_t length);
+    bool flush();
+    MqttEvent parse(uint32_t now);
+    MqttEvent fail(MqttError error);
+    static size_t encodeLength(uint8_t* out, size_t length);
+    static size_t putString(uint8_t* out, const char* text, size_t length);
+
+public:
+    MqttClient();
+
+    void begin(SendFunction send, ReceiveFunction receive, void* context);
+    void setClientId(const char* id);
+    void setKeepAlive(uint16_t seconds) { keepAliveS = seconds; }
+
+    // Call once the transport is connected; sends CONNECT
+    void startSession(uint32_t now);
+    void reset();               // Transport closed by the owner
+
+    // Never blocks; call often
+    MqttEvent update(uint32_t now);
+
+    // QoS 1; false while another message is in flight or the session is not up
+    bool canPublish() const { return state == MQTT_CONNECTED && inFlightId == 0 && txLength == 0; }
+    bool publish(const char* topic, const uint8_t* payload, size_t length, uint32_t now);
+
+    MqttState getState() const { return state; }
+    MqttError getLastError() const { return lastError; }
+    uint8_t getRefusalCode() const { return refusalCode; }
+    uint32_t getPublishedCount() const { return published; }
+    uint32_t getAcknowledgedCount() const { return acknowledged; }
+};
+
+#endif // MQTT_CLIENT_H
@@ -3,6 +3,44 @@
  * @brief WiFi and BLE connectivity for ESP32 Smart Alarm
  * @author Nighty Byte Team
  * @date 2025-08-25
+ *
+ * The web interface runs on ESPAsyncWebServer, so requests are served from
+ * the AsyncTCP task and never from loop(). Handlers only parse and answer;
+ * anything that changes alarm or WiFi state is queued and carried out by
+ * update() on the main loop.
+ *
+ * JSON responses (/status, /history and the /api routes) are written by
+ * JsonWriter into one of API_BUFFER_COUNT static buffers and sent from
+ * there, so a request never builds its body on the heap; when all buffers
+ * are in flight the request is answered 503. The heap the remaining
+ * response bookkeeping takes is measured and reported in /status.
+ *
+ * /status is kept rendered in a StatusCache and only rendered again once
+ * the second, the connection or the alarm table changed; polls in between
+ * are copied from it, whole or as the ?fields= they ask for, and answered
+ * 304 when their ETag still matches.
+ *
+ * Live status goes out over a WebSocket on WEBSOCKET_PORT (WS_PATH): alarm,
+ * sensor and network changes are gathered from the EventBus, coalesced every
+ * WS_PUSH_INTERVAL_MS and sent as deltas by LiveStatus. Polling /status is
+ * only the fallback when the socket is down.
+ *
+ * Reconnects go straight to the last access point's BSSID and channel,
+ * reusing its IP lease while it is fresh, so no scan or DHCP exchange is
+ * needed; only when that fails is a full scan made. Failures back off
+ * exponentially with jitter, and after WIFI_AP_FALLBACK_ATTEMPTS the setup
+ * access point opens while the station keeps retrying.
+ *
+ * RadioPowerPolicy sets the radio's duty cycle: full power while an alarm
+ * is active or the web interface is in use, modem sleep with a
+ * RADIO_LISTEN_INTERVAL listen interval otherwise, and off during the quiet
+ * window except for short wakes to sync time or send what is queued
+ * (setOutboundPending(), setNextTelemetryFlush()). Radio-on time per hour
+ * is reported by /api/radio.
+ *
+ * Time comes from SntpClient without blocking the loop; ClockDiscipline
+ * slews the system clock with adjtime() and corrects the crystal's drift
+ * between syncs, so alarm minutes are never skipped or repeated.
  */
 
 #ifndef NETWORK_MANAGER_H
@@ -10,14 +48,39 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
+#include <AsyncTCP.h>
+#include <ESPAsyncWebServer.h>
 #include <ArduinoOTA.h>
-#include <NTPClient.h>
 #include <WiFiUdp.h>
+#include <lwip/dns.h>
 #include <ESP32Time.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 #include "config.h"
 #include "Logger.h"
+#include "SensorHistory.h"
+#include "PatternLibrary.h"
+#include "BatteryPolicy.h"
+#include "EventBus.h"
+#include "LiveStatus.h"
+#include "SntpClient.h"
+#include "ClockDiscipline.h"
+#include "RadioPowerPolicy.h"
+#include "SeqLockSnapshot.h"
+#include "OtaUpdater.h"
+#include "CommandQueue.h"
+#include "StatusCache.h"
+
+struct WebAsset;
+struct AlarmSummary;
+class AlarmManager;
+class SensorManager;
+class JsonWriter;
+struct AlarmStateEvent;
+struct PillBoxEvent;
+struct UsbStateEvent;
+struct SensorSampleEvent;
 
 enum NetworkState {
     NETWORK_IDLE,
@@ -27,6 +90,11 @@ enum NetworkState {
     NETWORK_ERROR
 };
 
+// Published on the EventBus when the station connection comes up or drops
+struct NetworkStateEvent {
+    bool connected;
+};
+
 class NetworkManager {
 private:
     Logger* logger;
@@ -38,34 +106,180 @@ private:
     String password;
     bool apModeEnabled;
     unsigned long lastConnectionAttempt;
-    int connectionRetries;
+    unsigned long nextConnectAttempt;
+    uint8_t failedAttempts;     // Full scans that failed in a row
+    bool radioSuspended;    // WiFi switched off by the power profile or the quiet window
+    bool radioPowerSave;
+    
+    // Radio duty cycle
+    RadioPowerPolicy radioPolicy;
+    SeqLockSnapshot<RadioReport> radioReport;   // For /api/radio on the AsyncTCP task
+    RadioMode radioMode;
+    bool radioAllowed;          // From the power profile
+    bool alarmActive;
+    bool outboundPending;
+    unsigned long telemetryFlushAt;     // millis(), 0 when none is scheduled
+    volatile uint32_t lastWebRequest;   // Set by the handlers, 0 before the first
+    unsigned long lastRadioPolicy;
+    
+    // Last good association, persisted; a reconnect with it skips the scan, and DHCP until associated
+    struct WiFiCache {
+        bool valid;
+        uint8_t bssid[6];
+        uint8_t channel;
+        uint32_t ip;
+        uint32_t gateway;
+        uint32_t subnet;
+        uint32_t dns;
+        uint32_t leaseTime;     // Clock time the lease was obtained, 0 if unknown
+        uint32_t leaseSeconds;  // As granted by the DHCP server, 0 if unknown
+    };
+    WiFiCache wifiCache;
+    bool fastConnect;           // The attempt in progress uses wifiCache
+    bool fastConnectFailed;     // wifiCache did not work; scan on the next attempt
+    bool cachedLease;           // The attempt in progress starts on the cached address
+    bool leaseConfirming;       // DHCP restarted after a cached-lease connect, not yet bound
+    unsigned long connectedAt;
+    
+    // Time-to-connected metric
+    uint32_t lastConnectMs;
+    bool lastConnectFast;
+    uint32_t fastConnects;
+    uint32_t scanConnects;
+    
+    // Socket connects and disconnects, handed from the AsyncTCP task to update()
+    struct SocketEvent {
+        uint32_t clientId;
+        bool connected;
+    };
     
     // WiFi components
-    WebServer* webServer;
+    AsyncWebServer* webServer;
+    bool webServerRunning;
+    
+    // Live status push. statusSocket and its client list belong to the AsyncTCP task; update() reaches
+    // clients only through liveClients under liveClientsLock, which a disconnect takes before the
+    // library frees the client
+    AsyncWebServer* socketServer;
+    AsyncWebSocket* statusSocket;
+    QueueHandle_t socketEvents;
+    SemaphoreHandle_t liveClientsLock;
+    AsyncWebSocketClient* liveClients[WS_MAX_CLIENTS];  // Admitted clients, changed only on the AsyncTCP task
+    LiveStatus liveStatus;
+    unsigned long lastLivePush;
+    
+    // Time synchronization
     WiFiUDP ntpUDP;
-    NTPClient* timeClient;
+    SntpClient sntpClient;
+    ClockDiscipline clockDiscipline;
+    volatile uint32_t ntpServerAddress;     // Set by the lwIP DNS callback, 0 until resolved
+    volatile bool ntpResolving;
+    unsigned long lastResolveAttempt;
+    unsigned long lastDriftTick;
     
     // Preferences for storing credentials
     Preferences preferences;
     
-    // Callbacks
-    std::function<void(bool)> connectionCallback;
-    std::function<void(String, String)> commandCallback;
+    // Data sources for the web API
+    PatternLibrary* patternLibrary;
+    const AlarmManager* alarmManager;       // Only readAlarmTable(); changes are queued
+    const SensorManager* sensorManager;     // Only getCurrentReadings(), the battery level and queryHistory()
+    OtaUpdater* otaUpdater;                 // Uploads on the AsyncTCP task; the restart is queued
+    CommandQueue* commands;                 // Changes requested over the web, run by the main loop
+    AsyncWebServerRequest* volatile otaRequest;     // The request whose body is being flashed
+    uint8_t patternCode[PATTERN_MAX_BYTES];         // Compiled upload, until its store command completes
+    uint32_t patternTicket;                         // That command, 0 if none
+    
+    // JSON response accounting (AsyncTCP task)
+    uint32_t apiHeapPeak;                   // Most heap one response held besides its static body
+    uint32_t apiBusyRejects;                // Requests turned away with every buffer in flight
+    
+    // /status is rendered again only when one of these changed (AsyncTCP task)
+    struct StatusInputs {
+        uint32_t uptime;                    // Seconds; the clock field moves with it
+        uint32_t connectedAt;               // New connection, so possibly a new address
+        uint32_t alarmsVersion;
+        uint32_t connectMs;
+        uint32_t apiHeapPeak;
+        uint32_t apiBusyRejects;
+        uint8_t state;
+    };
+    StatusInputs statusInputs;
+    StatusCache statusCache;
+    
+    // Web server handlers (AsyncTCP task)
+    void handleAsset(AsyncWebServerRequest* request, const WebAsset& asset);
+    void handleSetAlarm(AsyncWebServerRequest* request);
+    void handleGetStatus(AsyncWebServerRequest* request);
+    void handleSetWiFi(AsyncWebServerRequest* request);
+    void handleGetHistory(AsyncWebServerRequest* request);
+    void handleGetTimeSeries(AsyncWebServerRequest* request);
+    void handleGetPatterns(AsyncWebServerRequest* request);
+    void handleUploadPattern(AsyncWebServerRequest* request);
+    void handlePatternBody(AsyncWebServerRequest* request, uint8_t* data, size_t length,
+                           size_t index, size_t total);
+    void handleDeletePattern(AsyncWebServerRequest* request);
+    void handleNotFound(AsyncWebServerRequest* request);
     
-    // Web server handlers
-    void handleRoot();
-    void handleSetAlarm();
-    void handleGetStatus();
-    void handleSetWiFi();
-    void handleOTA();
-    void handleNotFound();
+    // REST API (AsyncTCP task)
+    void handleApiGetAlarms(AsyncWebServerRequest* request);
+    void handleApiAddAlarm(AsyncWebServerRequest* request);
+    void handleApiUpdateAlarm(AsyncWebServerRequest* request);
+    void handleApiDeleteAlarm(AsyncWebServerRequest* request);
+    void handleApiGetSensors(AsyncWebServerRequest* request);
+    void handleApiGetLogs(AsyncWebServerRequest* request);
+    void handleApiClearLogs(AsyncWebServerRequest* request);
+    void handleApiGetConfig(AsyncWebServerRequest* request);
+    void handleApiSetConfig(AsyncWebServerRequest* request);
+    void handleApiGetRadio(AsyncWebServerRequest* request);
+    void handleApiGetCommand(AsyncWebServerRequest* request);
+    void handleApiGetOta(AsyncWebServerRequest* request);
+    void handleApiOtaUpload(AsyncWebServerRequest* request);
+    void handleOtaBody(AsyncWebServerRequest* request, uint8_t* data, size_t length, size_t index, size_t total);
+    const char* readAlarmFields(AsyncWebServerRequest* request, const AlarmSummary* current, AlarmOperation* alarm);
+    bool findAlarm(AsyncWebServerRequest* request, AlarmSummary* alarm);
+    int8_t claimJsonBuffer(AsyncWebServerRequest* request);
+    void sendJson(AsyncWebServerRequest* request, int8_t slot, const JsonWriter& json);
+    void sendBuffer(AsyncWebServerRequest* request, int8_t slot, size_t length, const char* etag);
+    void renderStatus();
+    
+    // Command hand-off from the handlers to the main loop
+    uint32_t queueCommand(const Command& command);     // Ticket, 0 if the queue is full
+    void sendQueued(AsyncWebServerRequest* request, uint32_t ticket);
+    
+    // Live status
+    void handleSocketEvent(AsyncWebSocketClient* client, AwsEventType type);
+    void pushLiveStatus(unsigned long currentTime);
+    static bool sendLiveStatus(void* context, uint32_t clientId, const char* message, size_t length);
+    AsyncWebSocketClient* findLiveClient(uint32_t clientId) const;    // Caller holds liveClientsLock
+    void onAlarmStateChanged(const AlarmStateEvent& event);
+    void onPillBoxChanged(const PillBoxEvent& event);
+    void onUsbStateChanged(const UsbStateEvent& event);
+    void onSensorSample(const SensorSampleEvent& event);
     
     // Helper methods
     void startWebServer();
     void stopWebServer();
     void startAccessPoint();
     void connectToWiFi();
-    void updateTimeFromNTP();
+    void onStationConnected();
+    void updateRadioPolicy(unsigned long currentTime, bool force);
+    void setRadioMode(RadioMode mode);
+    void applySleepMode();
+    void scheduleReconnect();
+    bool isLeaseReusable() const;
+    static bool readDhcpLease(uint32_t* seconds);
+    void loadWiFiCache();
+    void saveWiFiCache();
+    void updateTimeSync();
+    void updateClockDrift(unsigned long currentTime);
+    void resolveNtpServer();
+    void applyClockCorrection(const ClockCorrection& correction);
+    static void slewClock(int64_t amountUs);
+    static int64_t pendingClockAdjustment();
+    static bool sendNtpPacket(void* context, const uint8_t* packet, size_t length);
+    static size_t receiveNtpPacket(void* context, uint8_t* packet, size_t capacity);
+    static void onNtpServerResolved(const char* name, const ip_addr_t* address, void* context);
     bool loadWiFiCredentials();
     void saveWiFiCredentials(const String& ssid, const String& password);
 
@@ -87,22 +301,41 @@ public:
     bool isConnected() const { return currentState == NETWORK_CONNECTED; }
     String getLocalIP() const;
     int getSignalStrength() const;
+    uint32_t getLastConnectTime() const { return lastConnectMs; }     // ms from WiFi.begin() to connected
+    bool wasLastConnectFast() const { return lastConnectFast; }
     String getNetworkInfo();
     
     // Time synchronization
-    void syncTime();
+    void syncTime();        // Poll the NTP server on the next update(); does not wait
     bool isTimeValid() const;
+    const ClockDiscipline& getClockDiscipline() const { return clockDiscipline; }
     
     // OTA updates
     void initializeOTA();
     
+    // Power management
+    void applyPowerProfile(const PowerProfile& profile);
+    bool isRadioSuspended() const { return radioSuspended; }
+    RadioMode getRadioMode() const { return radioMode; }
+    const RadioPowerPolicy& getRadioPolicy() const { return radioPolicy; }
+    void setQuietWindow(uint16_t startMinute, uint16_t endMinute);     // Equal: no quiet window; persisted
+    
+    // Outbound traffic; inside the quiet window the radio wakes for it
+    void setOutboundPending(bool pending) { outboundPending = pending; }
+    void setNextTelemetryFlush(unsigned long atMillis) { telemetryFlushAt = atMillis; }    // 0: none
+    
     // Web interface
     void enableWebInterface(bool enable);
-    bool isWebInterfaceEnabled() const { return webServer != nullptr; }
+    bool isWebInterfaceEnabled() const { return webServerRunning; }
+    uint8_t getLiveClientCount() const { return liveStatus.clientCount(); }
+    void updateLiveStatus(LiveField field, int32_t value) { liveStatus.set(field, value); }   // Seeds values no event has reported yet
     
-    // Callbacks
-    void setConnectionCallback(std::function<void(bool)> callback) { connectionCallback = callback; }
-    void setCommandCallback(std::function<void(String, String)> callback) { commandCallback = callback; }
+    // Data sources
+    void setPatternLibrary(PatternLibrary* library) { patternLibrary = library; }
+    void setAlarmManager(const AlarmManager* alarms) { alarmManager = alarms; }
+    void setSensorManager(const SensorManager* sensors) { sensorManager = sensors; }
+    void setOtaUpdater(OtaUpdater* updater) { otaUpdater = updater; }
+    void setCommandQueue(CommandQueue* queue) { commands = queue; }
     
     // BLE functionality (stub for future implementation)
     void initializeBLE();
@@ -0,0 +1,149 @@
+/**
+ * @file OtaUpdater.h
+ * @brief Streaming firmware update into the inactive A/B partition
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * An upload is written straight into the OTA partition that is not
+ * running, OTA_WRITE_CHUNK bytes (one flash sector) at a time, so it never
+ * needs more RAM than that one buffer. Each chunk is hashed with SHA-256
+ * on the way. finish() activates the image only if it is complete, matches
+ * the SHA-256 the uploader gave (when it gave one) and passes ESP-IDF's own
+ * image check; anything else leaves the running firmware selected.
+ *
+ * After the restart the new image is on trial. It is confirmed once it has
+ * run OTA_HEALTH_MIN_UPTIME_MS with the network reachable and enough free
+ * heap. If it is not healthy within OTA_HEALTH_TIMEOUT_MS, or it restarts
+ * more than OTA_TRIAL_MAX_BOOTS times before that, the previous partition
+ * is selected again and the device restarts into it. The bootloader's
+ * rollback (pending-verify images) is used where the build has it; the
+ * boot count in NVS covers builds whose bootloader does not.
+ *
+ * The upload can also be an NBD1 delta patch against the running image
+ * (see DeltaDecoder.h), told apart by its first bytes. The patch is applied
+ * as it arrives, reading the running partition and writing the rebuilt
+ * image through the same chunk buffer, and the result is checked against
+ * the SHA-256 of the new image that the patch carries. A patch made for a
+ * different image is refused before anything is written.
+ *
+ * start(), write() and finish() run on the AsyncTCP task with the upload;
+ * begin() and update() on the main loop, which also logs what the upload
+ * did.
+ */
+
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+#include "config.h"
+#include "Logger.h"
+#include "DeltaDecoder.h"
+
+#define OTA_SHA256_BYTES 32
+
+enum OtaState {
+    OTA_IDLE,
+    OTA_RECEIVING,
+    OTA_READY,          // Verified and selected for the next boot
+    OTA_FAILED          // See getError(); the running image stays selected
+};
+
+struct OtaUploadStats {
+    uint32_t bytes;             // Received; the patch size for a delta update
+    uint32_t imageBytes;        // Written to flash
+    uint32_t durationMs;
+    uint32_t bytesPerSecond;
+    uint32_t heapUsed;          // Largest drop in free heap during the upload, on top of the chunk buffer
+};
+
+class OtaUpdater {
+private:
+    Logger* logger;
+    Preferences preferences;
+    const esp_partition_t* running;
+
+    // Upload (AsyncTCP task)
+    volatile OtaState state;
+    const esp_partition_t* target;
+    esp_ota_handle_t handle;
+    bool handleOpen;
+    mbedtls_sha256_context sha;
+    uint8_t expectedDigest[OTA_SHA256_BYTES];
+    bool hasExpectedDigest;
+    uint8_t digest[OTA_SHA256_BYTES];
+    bool digestReady;
+    size_t transferSize;        // Upload as announced
+    size_t transferred;
+    bool patching;
+    DeltaDecoder delta;
+    size_t expectedSize;        // Image
+    size_t received;
+    size_t buffered;
+    uint32_t startedAt;
+    uint32_t finishedAt;
+    uint32_t heapAtStart;
+    uint32_t heapLowest;
+    const char* error;
+    static uint8_t chunk[OTA_WRITE_CHUNK];
+
+    // Trial of a new image and restarts (main loop)
+    volatile bool trial;
+    uint8_t trialBoots;
+    OtaState loggedState;
+    volatile unsigned long restartAt;   // 0: none scheduled
+    char lastRollback[48];
+
+    void beginUpload(size_t size);
+    bool openTarget(size_t size, const uint8_t* sha256);
+    bool openPatchTarget();
+    bool writeImage(const uint8_t* data, size_t length);
+    bool writePatch(const uint8_t* data, size_t length);
+    bool flushChunk();
+    static bool readRunningImage(void* context, uint32_t offset, uint8_t* buffer, size_t length);
+    static bool writeNewImage(void* context, const uint8_t* data, size_t length);
+    bool fail(const char* reason);
+    void confirm(unsigned long currentTime);
+    void rollBack(const char* reason);
+
+public:
+    OtaUpdater(Logger* log);
+    ~OtaUpdater();
+
+    // At boot, before anything else that could crash; may roll back and restart
+    bool begin();
+
+    // Health check, logging and the restart after an upload; call from the main loop
+    void update(unsigned long currentTime, bool networkHealthy);
+
+    // Upload, in order, from one request
+    bool start(size_t size, const char* sha256Hex);      // sha256Hex nullptr or empty: not checked
+    bool startPatch(size_t size);                       // The patch carries the SHA-256 of its result
+    bool write(const uint8_t* data, size_t length);
+    bool finish();
+    void abort(const char* reason);
+
+    // When the restart cannot be scheduled: selects the running image again and fails the upload
+    void cancelInstall(const char* reason);
+
+    // Main loop, once the uploader has its answer
+    void restartIntoUpdate(unsigned long currentTime);
+
+    OtaState getState() const { return state; }
+    const char* getError() const { return error; }
+    bool isBusy() const { return state == OTA_RECEIVING || state == OTA_READY; }
+    size_t getMaxImageSize() const;
+    OtaUploadStats getUploadStats() const;
+    void getDigestHex(char* out) const;         // 65 bytes; empty until a whole upload was hashed
+    bool isOnTrial() const { return trial; }
+    const char* getRunningPartition() const { return running ? running->label : "?"; }
+    const char* getLastRollback() const { return lastRollback; }
+
+    bool isPatching() const { return patching; }
+
+    static bool parseHex(const char* hex, uint8_t* out, size_t bytes);
+};
+
+#endif // OTA_UPDATER_H
@@ -0,0 +1,131 @@
+/**
+ * @file PatternCode.h
+ * @brief Compact buzzer pattern bytecode for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Patterns are byte programs that PatternSequencer plays directly. The top
+ * two bits of each opcode select its class; durations are in 10 ms ticks.
+ *
+ *   00 000000          END
+ *   00 000001 n        LOOP      repeat the body up to ENDLOOP n times (1-255)
+ *   00 000010          ENDLOOP
+ *   00 000011 d        VOLUME    PWM duty for following tones (1-255)
+ *   00 000100 g        GAP       silence g ticks at the end of each tone
+ *   00 000101 d t      FADE      glide the volume to duty d (1-255) over t ticks,
+ *                                sounding the most recent tone's frequency
+ *   01 nnnnnn t        NOTE      semitone n above C4 (C4..D#9) for t ticks
+ *   10 hhhhhh l t      TONE      14-bit frequency h:l in Hz for t ticks
+ *   11 hhhhhh l        REST      silence for 14-bit h:l ticks
+ *
+ * Built-in patterns are written with the PC_* macros, which range-check
+ * their arguments at compile time: an out-of-range constant in a constexpr
+ * table fails to compile.
+ */
+
+#ifndef PATTERN_CODE_H
+#define PATTERN_CODE_H
+
+#include <stdint.h>
+#include "config.h"
+
+#define PC_OP_END       0x00
+#define PC_OP_LOOP      0x01
+#define PC_OP_ENDLOOP   0x02
+#define PC_OP_VOLUME    0x03
+#define PC_OP_GAP       0x04
+#define PC_OP_FADE      0x05
+#define PC_CLASS_CONTROL 0x00
+#define PC_CLASS_NOTE   0x40
+#define PC_CLASS_TONE   0x80
+#define PC_CLASS_REST   0xC0
+
+#define PC_TICK_MS      10
+#define PC_MAX_NOTE     63
+#define PC_MAX_TONE_TICKS 255
+#define PC_MAX_REST_TICKS 0x3FFF
+#define PC_MAX_FREQUENCY 0x3FFF
+#define PC_DEFAULT_DUTY 128         // Volume until the first VOLUME or FADE
+
+namespace PatternCode {
+    // Deliberately not constexpr and never defined: calling it in a constant
+    // expression is a compile error, which is how the PC_* macros reject values.
+    uint8_t valueOutOfRange();
+
+    constexpr uint32_t ticks(uint32_t ms) {
+        return (ms + PC_TICK_MS / 2) / PC_TICK_MS;
+    }
+
+    constexpr uint8_t checked(uint32_t value, uint32_t minimum, uint32_t maximum) {
+        return value >= minimum && value <= maximum ? (uint8_t)(value & 0xFF) : valueOutOfRange();
+    }
+
+    constexpr uint8_t high6(uint32_t value, uint32_t maximum) {
+        return value <= maximum ? (uint8_t)(value >> 8) : valueOutOfRange();
+    }
+
+    // Equal temperament, octave 8 (C8..B8); lower octaves shift right
+    inline uint32_t noteFrequency(uint8_t note) {
+        static const uint16_t octave8[12] = {
+            4186, 4435, 4699, 4978, 5274, 5588, 5920, 6272, 6645, 7040, 7459, 7902
+        };
+        uint8_t octave = note / 12;     // 0 = octave 4
+        uint32_t base = octave8[note % 12];
+        if (octave < 4) {
+            return (base + (1u << (3 - octave))) >> (4 - octave);
+        }
+        return base << (octave - 4);
+    }
+
+    // Checks operands, loop nesting and that every loop body makes sound or
+    // silence; optionally reports the played length of one pass in ms
+    bool validate(const uint8_t* code, uint16_t length, uint32_t* durationMs = nullptr);
+}
+
+#define PC_END              PC_OP_END
+#define PC_LOOP(n)          PC_OP_LOOP, PatternCode::checked((n), 1, 255)
+#define PC_ENDLOOP          PC_OP_ENDLOOP
+#define PC_VOLUME(duty)     PC_OP_VOLUME, PatternCode::checked((duty), 1, 255)
+#define PC_GAP(ms)          PC_OP_GAP, PatternCode::checked(PatternCode::ticks(ms), 0, 255)
+#define PC_FADE(duty, ms)   PC_OP_FADE, PatternCode::checked((duty), 1, 255), \
+                            PatternCode::checked(PatternCode::ticks(ms), 1, PC_MAX_TONE_TICKS)
+#define PC_NOTE(n, ms)      (uint8_t)(PC_CLASS_NOTE | PatternCode::checked((n), 0, PC_MAX_NOTE)), \
+                            PatternCode::checked(PatternCode::ticks(ms), 1, PC_MAX_TONE_TICKS)
+#define PC_TONE(hz, ms)     (uint8_t)(PC_CLASS_TONE | PatternCode::high6((hz), PC_MAX_FREQUENCY)), \
+                            (uint8_t)((hz) & 0xFF), \
+                            PatternCode::checked(PatternCode::ticks(ms), 1, PC_MAX_TONE_TICKS)
+#define PC_REST(ms)         (uint8_t)(PC_CLASS_REST | PatternCode::high6(PatternCode::ticks(ms), PC_MAX_REST_TICKS)), \
+                            (uint8_t)(PatternCode::ticks(ms) & 0xFF)
+
+// Appends instructions at runtime (compiler, ad-hoc beeps). Long tones, rests
+// and fades are split so any duration fits; overflow is sticky and reported.
+class PatternWriter {
+private:
+    uint8_t* buffer;
+    uint16_t capacity;
+    uint16_t length;
+    uint8_t gapTicks;
+    uint8_t duty;           // Volume after the last VOLUME or FADE, for splitting fades
+    bool overflowed;
+
+    void put(uint8_t value);
+    void toneTicks(uint8_t opcode, uint8_t operand, bool isNote, uint32_t ticks);
+
+public:
+    PatternWriter(uint8_t* out, uint16_t outCapacity);
+
+    void tone(uint32_t frequency, uint32_t ms);
+    void note(uint8_t note, uint32_t ms);
+    void rest(uint32_t ms);
+    void volume(uint8_t duty);
+    void gap(uint32_t ms);
+    void fade(uint8_t duty, uint32_t ms);
+    void loop(uint8_t count);
+    void endLoop();
+    void end();
+
+    uint16_t size() const { return length; }
+    bool overflow() const { return overflowed; }
+};
+
+#endif // PATTERN_CODE_H
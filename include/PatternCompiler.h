@@ -0,0 +1,63 @@
+/**
+ * @file PatternCompiler.h
+ * @brief RTTTL and pattern DSL compiler for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Turns uploaded text into PatternCode bytecode once, so playback never
+ * parses text. Two source formats are accepted:
+ *
+ * RTTTL (Nokia ring tones), e.g. "wake:d=8,o=6,b=140:c,e,g,2c7,p,4g"
+ *
+ * Pattern DSL, tokens separated by spaces, commas or semicolons:
+ *   2000:500          tone in Hz for ms
+ *   a5:250  c#6:125   note name and octave (C4..D#9) for ms
+ *   rest:200  r:200   silence for ms
+ *   vol:200           PWM duty for following tones (1-255)
+ *   gap:20            silence at the end of each tone, ms
+ *   fade:255:700      glide the previous tone's volume to a duty (1-255) over ms
+ *   repeat 3 { ... }  repeat a block (nests up to PATTERN_MAX_LOOP_DEPTH)
+ *   # comment         to end of line
+ *
+ * Plain C++ (no Arduino dependencies) so it can be run on the host.
+ */
+
+#ifndef PATTERN_COMPILER_H
+#define PATTERN_COMPILER_H
+
+#include <stdint.h>
+#include "PatternCode.h"
+
+enum PatternFormat {
+    PATTERN_FORMAT_AUTO,
+    PATTERN_FORMAT_RTTTL,
+    PATTERN_FORMAT_DSL
+};
+
+struct PatternCompileResult {
+    uint16_t length;        // Bytecode bytes written, END included
+    uint32_t durationMs;    // One pass through the pattern
+    const char* error;      // nullptr on success
+    uint16_t errorOffset;   // Source offset the error refers to
+};
+
+class PatternCompiler {
+private:
+    static bool compileRtttl(const char* source, PatternWriter& writer, PatternCompileResult* result);
+    static bool compileDsl(const char* source, PatternWriter& writer, PatternCompileResult* result);
+    static bool fail(PatternCompileResult* result, const char* error, const char* source, const char* at);
+
+public:
+    static bool compile(const char* source, PatternFormat format, uint8_t* out, uint16_t capacity,
+                        PatternCompileResult* result);
+
+    // RTTTL when the second colon-separated section holds "key=value" defaults
+    static PatternFormat detectFormat(const char* source);
+
+    // "a5", "C#6" -> semitones above C4, or -1
+    static int parseNoteName(const char* text, uint8_t length);
+
+    static const uint16_t RTTTL_GAP_MS = 10;    // Separates repeated notes
+};
+
+#endif // PATTERN_COMPILER_H
@@ -0,0 +1,53 @@
+/**
+ * @file PatternLibrary.h
+ * @brief Uploaded buzzer patterns stored on LittleFS
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Each pattern is "<PATTERN_DIRECTORY>/<name>.pat": a 4-byte header ("NBP"
+ * and a format version) followed by compiled PatternCode bytecode. Patterns
+ * are validated when stored and again when loaded, so a corrupt file is never
+ * handed to the sequencer.
+ */
+
+#ifndef PATTERN_LIBRARY_H
+#define PATTERN_LIBRARY_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "Logger.h"
+#include "PatternCode.h"
+
+class PatternLibrary {
+private:
+    Logger* logger;
+    bool mounted;
+
+    // Built-in pattern names, which uploads may not shadow
+    const char* const* reservedNames;
+    uint8_t reservedCount;
+
+public:
+    PatternLibrary(Logger* log);
+
+    bool begin();
+
+    bool store(const String& name, const uint8_t* code, uint16_t length);
+    uint16_t load(const String& name, uint8_t* out, uint16_t capacity);    // 0 if missing or invalid
+    bool remove(const String& name);
+    bool exists(const String& name);
+    uint8_t count();
+    String list();      // JSON array: built-ins {"name","builtin":true}, uploads {"name","bytes"}
+
+    void setReservedNames(const char* const* names, uint8_t count);
+    bool isReservedName(const String& name) const;
+
+    // Lower-case letters, digits, '-' and '_', up to PATTERN_NAME_MAX characters
+    static bool isValidName(const String& name);
+    static String path(const String& name);
+
+    static const uint8_t FORMAT_VERSION = 1;
+};
+
+#endif // PATTERN_LIBRARY_H
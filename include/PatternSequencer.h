@@ -0,0 +1,93 @@
+/**
+ * @file PatternSequencer.h
+ * @brief Deadline-based buzzer pattern sequencing for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Executes PatternCode bytecode and reports what the buzzer should output
+ * until which absolute deadline. Each deadline is derived from the previous
+ * one, not from the time the caller got around to advancing, so callback
+ * latency never accumulates. Volume changes within a step (FADE instructions,
+ * the optional wake-up ramp) are reported as one hardware fade per output
+ * rather than as a stream of duty writes. Plain C++ (no Arduino dependencies) so it can be
+ * driven by a virtual timer on the host (see tools/sequencer_sim.cpp).
+ */
+
+#ifndef PATTERN_SEQUENCER_H
+#define PATTERN_SEQUENCER_H
+
+#include <stdint.h>
+#include "PatternCode.h"
+#include "FadePlanner.h"
+
+// What the buzzer should do until the next deadline: start at duty, then
+// (if fadeMs > 0) let the LEDC fade engine move to fadeDuty within fadeMs
+struct ToneOutput {
+    uint32_t frequency;     // 0 = silent
+    uint8_t duty;
+    uint8_t fadeDuty;
+    uint32_t fadeMs;
+};
+
+class PatternSequencer {
+private:
+    struct LoopFrame {
+        uint16_t start;     // First instruction of the body
+        uint8_t remaining;  // Further passes after the current one
+    };
+
+    const uint8_t* code;
+    uint16_t length;
+    bool looping;
+    bool running;
+
+    uint16_t pc;
+    LoopFrame loops[PATTERN_MAX_LOOP_DEPTH];
+    uint8_t depth;
+    uint8_t duty;
+    uint8_t gapTicks;
+    uint8_t pendingGap;     // Ticks of silence owed after the current tone
+    bool timedSinceWrap;    // Guards against programs that never take time
+    uint64_t deadline;      // Microseconds, same clock as start()
+
+    // FADE in progress: planned hardware fades still to output
+    uint32_t toneFrequency;     // Most recent tone, which FADE keeps sounding
+    FadeSegment fadeSegments[FADE_MAX_SEGMENTS];
+    uint8_t fadeCount;
+    uint8_t fadeIndex;
+    uint8_t fadeFrom;
+
+    // Wake-up envelope over the whole request, across loop passes
+    RampProfile ramp;
+    uint64_t startUs;
+
+    void resetProgramState();
+    bool execute(ToneOutput* out);
+    bool emit(uint32_t frequency, uint32_t ticks, ToneOutput* out);
+    bool emitFade(ToneOutput* out);
+    bool shape(uint32_t frequency, uint8_t fromDuty, uint8_t toDuty, uint32_t fadeMs, uint32_t durationMs,
+               ToneOutput* out);
+    bool finish(ToneOutput* out);
+    uint32_t elapsedMs(uint64_t atUs) const;
+
+public:
+    PatternSequencer();
+
+    // Starts at nowUs and fills the first output; false for an empty pattern.
+    // A ramp scales every output's volume from its start level up to full.
+    bool start(const uint8_t* pattern, uint16_t patternLength, bool loop, uint64_t nowUs, ToneOutput* out,
+               const RampProfile* rampProfile = nullptr);
+
+    // Call once getDeadline() has passed; fills the next output, false when finished
+    bool advance(ToneOutput* out);
+
+    void stop() { running = false; }
+
+    bool isRunning() const { return running; }
+    uint64_t getDeadline() const { return deadline; }
+    uint16_t getPosition() const { return pc; }
+
+    static const uint8_t DEFAULT_DUTY = PC_DEFAULT_DUTY;
+};
+
+#endif // PATTERN_SEQUENCER_H
@@ -0,0 +1,109 @@
+/**
+ * @file RadioPowerPolicy.h
+ * @brief WiFi radio duty cycle for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Decides how much radio the device needs right now:
+ *   RADIO_FULL  no power save: an alarm is active, someone is using the web
+ *               interface, or a quiet-window wake is getting its work done
+ *   RADIO_DOZE  associated in modem sleep, listening every
+ *               RADIO_LISTEN_INTERVAL beacons
+ *   RADIO_OFF   WiFi switched off: inside the quiet window with nothing to
+ *               do, or the power profile forbids the radio
+ *
+ * Inside the quiet window the radio only comes on for a due time sync, a
+ * telemetry flush or data waiting to go out. It goes off again
+ * RADIO_WAKE_LINGER_MS after the last of them is done, and a wake that does
+ * not finish within RADIO_WAKE_MAX_MS (no access point, say) is cut off
+ * and not retried for RADIO_WAKE_RETRY_MS.
+ *
+ * Time the radio was on is counted per uptime hour for the last
+ * RADIO_HISTORY_HOURS hours.
+ *
+ * Plain C++ (no Arduino dependencies) so the policy can be built and
+ * exercised on the host.
+ */
+
+#ifndef RADIO_POWER_POLICY_H
+#define RADIO_POWER_POLICY_H
+
+#include <stdint.h>
+#include "config.h"
+
+#define RADIO_HISTORY_HOURS 24
+
+enum RadioMode {
+    RADIO_OFF,
+    RADIO_DOZE,
+    RADIO_FULL
+};
+
+// What the rest of the firmware wants from the radio, gathered each tick
+struct RadioDemand {
+    bool allowed;           // Power profile permits the radio at all
+    bool alarmActive;       // Ringing, snoozed or waiting for the pill box
+    bool uiActive;          // Live status client, setup AP or a recent web request
+    bool syncDue;           // Time sync due within RADIO_WAKE_LEAD_MS or in progress
+    bool flushDue;          // Telemetry flush scheduled
+    bool outboundPending;   // Data queued to go out
+};
+
+// Copy of the policy's state for readers on other tasks
+struct RadioReport {
+    uint8_t mode;
+    bool quiet;                             // Inside the quiet window now
+    uint16_t quietStart;                    // Minutes after midnight
+    uint16_t quietEnd;
+    uint32_t wakes;                         // Quiet-window wakes since boot
+    uint32_t cutOff;                        // Wakes that ran out of time
+    uint32_t onMs[RADIO_HISTORY_HOURS];     // Radio-on time, [0] = current hour
+};
+
+class RadioPowerPolicy {
+private:
+    uint16_t quietStart;
+    uint16_t quietEnd;      // Equal to quietStart: no quiet window
+
+    RadioMode mode;
+    bool quiet;
+    bool waking;            // On inside the quiet window for a wake reason
+    uint32_t wakeStarted;
+    uint32_t lastWanted;    // Last tick a wake reason was present
+    bool holdingOff;        // The last wake was cut off
+    uint32_t holdOffUntil;
+    uint32_t wakes;
+    uint32_t cutOff;
+
+    // Radio-on milliseconds in each of the last RADIO_HISTORY_HOURS uptime hours
+    uint32_t hourlyOnMs[RADIO_HISTORY_HOURS];
+    uint32_t currentHour;
+    uint32_t lastUpdate;
+    bool started;
+
+    void advanceHour(uint32_t hour);
+
+public:
+    RadioPowerPolicy();
+
+    // Configuration
+    void setQuietWindow(uint16_t startMinute, uint16_t endMinute);
+    uint16_t getQuietStart() const { return quietStart; }
+    uint16_t getQuietEnd() const { return quietEnd; }
+    bool hasQuietWindow() const { return quietStart != quietEnd; }
+    bool isQuietTime(int16_t minuteOfDay) const;    // -1 (clock not set) is never quiet
+
+    // Call every RADIO_POLICY_TICK_MS or on a change of demand; minuteOfDay is local time or -1
+    RadioMode update(uint32_t now, int16_t minuteOfDay, const RadioDemand& demand);
+    RadioMode getMode() const { return mode; }
+    bool isWaking() const { return waking; }
+
+    // Statistics
+    uint32_t getOnTimeLastHour(uint32_t now) const { return getOnTimeInHour(now, 0); }
+    uint32_t getOnTimeInHour(uint32_t now, uint8_t hoursAgo) const;
+    uint32_t getWakeCount() const { return wakes; }
+    uint32_t getCutOffCount() const { return cutOff; }
+    void fillReport(uint32_t now, RadioReport* report) const;
+};
+
+#endif // RADIO_POWER_POLICY_H
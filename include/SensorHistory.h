@@ -0,0 +1,90 @@
+/**
+ * @file SensorHistory.h
+ * @brief Fixed-memory multi-resolution sensor history for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Keeps per-minute, per-hour and per-day min/max/avg/count buckets for each
+ * sensor channel in statically sized ring buffers. Every sample updates the
+ * open bucket of all three tiers in O(1); a bucket is frozen into its ring
+ * when its period ends. Plain C++ so it can be exercised on the host.
+ */
+
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Ring sizes per tier
+#define HISTORY_MINUTE_BUCKETS 180   // 3 hours of per-minute buckets
+#define HISTORY_HOUR_BUCKETS 168     // 7 days of per-hour buckets
+#define HISTORY_DAY_BUCKETS 62       // ~2 months of per-day buckets
+
+enum HistoryChannel {
+    HISTORY_LIGHT,
+    HISTORY_USB,
+    HISTORY_PILL_BOX,
+    HISTORY_CHANNEL_COUNT
+};
+
+enum HistoryResolution {
+    HISTORY_MINUTE,
+    HISTORY_HOUR,
+    HISTORY_DAY,
+    HISTORY_RESOLUTION_COUNT
+};
+
+// Values are stored on a 0-255 scale: light is ADC >> 4, binary channels are 0/255
+struct HistoryBucket {
+    uint16_t count;         // Samples in bucket (saturates at 65535), 0 = no data
+    uint8_t minValue;
+    uint8_t maxValue;
+    uint8_t avgValue;
+    uint8_t reserved;
+};
+
+class SensorHistory {
+private:
+    // Open (not yet frozen) bucket of one tier
+    struct Accumulator {
+        uint32_t sum;
+        uint32_t count;
+        uint8_t minValue;
+        uint8_t maxValue;
+    };
+
+    HistoryBucket minuteBuckets[HISTORY_CHANNEL_COUNT][HISTORY_MINUTE_BUCKETS];
+    HistoryBucket hourBuckets[HISTORY_CHANNEL_COUNT][HISTORY_HOUR_BUCKETS];
+    HistoryBucket dayBuckets[HISTORY_CHANNEL_COUNT][HISTORY_DAY_BUCKETS];
+
+    Accumulator open[HISTORY_CHANNEL_COUNT][HISTORY_RESOLUTION_COUNT];
+    uint32_t head[HISTORY_CHANNEL_COUNT][HISTORY_RESOLUTION_COUNT]; // Absolute index of open bucket
+    uint32_t tail[HISTORY_CHANNEL_COUNT][HISTORY_RESOLUTION_COUNT]; // Absolute index of first recorded bucket
+    bool started[HISTORY_CHANNEL_COUNT][HISTORY_RESOLUTION_COUNT];
+
+    HistoryBucket* ring(HistoryChannel channel, HistoryResolution resolution);
+    const HistoryBucket* ring(HistoryChannel channel, HistoryResolution resolution) const;
+    void addToTier(HistoryChannel channel, HistoryResolution resolution, uint32_t timestamp, uint8_t value);
+    void clearTier(HistoryChannel channel, HistoryResolution resolution);
+    static HistoryBucket toBucket(const Accumulator& acc);
+
+public:
+    SensorHistory();
+
+    void clear();
+    void record(HistoryChannel channel, uint32_t timestamp, uint8_t value);
+
+    // Fills out[] with consecutive buckets covering [from, to] (epoch seconds),
+    // oldest first. Returns the number of buckets written and sets firstBucketTime
+    // to the start of out[0]. Buckets without samples have count == 0.
+    size_t query(HistoryChannel channel, HistoryResolution resolution,
+                 uint32_t from, uint32_t to,
+                 HistoryBucket* out, size_t maxOut, uint32_t* firstBucketTime) const;
+
+    static uint32_t periodSeconds(HistoryResolution resolution);
+    static uint16_t capacity(HistoryResolution resolution);
+    static const char* channelName(HistoryChannel channel);
+};
+
+#endif // SENSOR_HISTORY_H
@@ -11,6 +11,15 @@
 #include <Arduino.h>
 #include "config.h"
 #include "Logger.h"
+#include "AlarmManager.h"
+#include "AdaptiveSampler.h"
+#include "SensorHistory.h"
+#include "BatteryMonitor.h"
+#include "BatteryPolicy.h"
+#include "EventBus.h"
+#include "SeqLockSnapshot.h"
+#include "LightTrendDetector.h"
+#include "SleepTracker.h"
 
 struct SensorReadings {
     int lightLevel;          // 0-4095 ADC reading
@@ -18,6 +27,81 @@ struct SensorReadings {
     bool pillBoxOpen;        // Pill box contact switch state
     float batteryVoltage;    // Battery voltage (if available)
     unsigned long timestamp; // When readings were taken
+    uint32_t version;        // Increases every time any field changes
+};
+
+// One sensor's adaptive sampling, as reported by /api/sensors
+struct SamplerStats {
+    uint32_t intervalMs;     // Current interval, including boost and power slowdown
+    uint32_t samplesThisHour;
+    uint32_t samplesLastHour;
+    bool boosted;
+};
+
+struct SamplingStats {
+    SamplerStats light;
+    SamplerStats usb;
+    SamplerStats pillBox;
+    bool bedtimeWindow;
+};
+
+// Light sensor calibration progress (advanced one step per update())
+enum CalibrationState {
+    CALIBRATION_IDLE,
+    CALIBRATION_SAMPLING
+};
+
+// Sensor self-test progress (advanced one step per update())
+enum DiagnosticState {
+    DIAGNOSTIC_IDLE,
+    DIAGNOSTIC_LIGHT,
+    DIAGNOSTIC_USB,
+    DIAGNOSTIC_PILL_BOX
+};
+
+struct SensorTestResult {
+    int lightMin;            // Lowest light reading during the test
+    int lightMax;            // Highest light reading during the test
+    int usbReading;          // Raw USB detection ADC value
+    bool usbConnected;       // USB state derived from usbReading
+    bool pillBoxOpen;        // Raw pill box switch state
+};
+
+// Events published on the EventBus
+// Lights out (dark = true) or lights on, confirmed by the light trend detector
+struct BedtimeEvent {
+    bool dark;
+    int lightLevel;          // Mean level since the change started
+    uint8_t confidence;      // 0-100
+    uint32_t changeTime;     // Epoch seconds when the change started
+};
+
+struct UsbStateEvent {
+    bool connected;
+};
+
+struct PillBoxEvent {
+    bool open;
+};
+
+struct LightCalibratedEvent {
+    int baseline;            // New averaged light level
+};
+
+struct SensorTestEvent {
+    SensorTestResult result;
+};
+
+// Every raw sample (light ADC 0-4095, USB/pill box 0/1) with its epoch timestamp
+struct SensorSampleEvent {
+    HistoryChannel channel;
+    uint32_t timestamp;
+    uint16_t value;
+};
+
+// Posted (deferred) when the battery level changes and a different profile applies
+struct PowerProfileEvent {
+    PowerProfile profile;
 };
 
 class SensorManager {
@@ -30,10 +114,32 @@ private:
     bool currentPillBoxState;
     bool previousPillBoxState;
     
-    // Timing for non-blocking sensor reads
-    unsigned long lastLightRead;
-    unsigned long lastUsbRead;
-    unsigned long lastPillBoxRead;
+    // Adaptive scheduling for non-blocking sensor reads
+    AdaptiveSampler lightSampler;
+    AdaptiveSampler usbSampler;
+    AdaptiveSampler pillBoxSampler;
+    AlarmState alarmState;
+    bool inBedtimeWindow;
+    unsigned long lastClockCheck;
+    SeqLockSnapshot<SamplingStats> samplingSnapshot;   // The samplers' counters are only touched by update()
+    unsigned long lastSamplingPublish;
+    
+    // Min/max/avg rollups of every sample; written by the main loop, queried by web handlers
+    SensorHistory history;
+    mutable portMUX_TYPE historyLock;
+    
+    // Consistent copy of the readings for readers on other cores/tasks
+    SeqLockSnapshot<SensorReadings> snapshot;
+    float snapshotBatteryVoltage;   // Last published voltage, filters ADC noise
+    
+    // Battery sensing and power policy
+    BatteryMonitor battery;
+    BatteryPolicy batteryPolicy;
+    unsigned long lastBatteryRead;
+    
+    // Lights-out / lights-on detection and the sleep statistics built on it
+    LightTrendDetector lightTrend;
+    SleepTracker sleepTracker;
     
     // Debouncing for pill box switch
     unsigned long pillBoxDebounceTime;
@@ -45,16 +151,31 @@ private:
     int lightTotal;
     bool lightSamplesInitialized;
     
-    // Callbacks for events
-    std::function<void(bool)> bedtimeCallback;
-    std::function<void(bool)> usbStateCallback;
-    std::function<void(bool)> pillBoxCallback;
+    // Non-blocking calibration
+    CalibrationState calibrationState;
+    int calibrationStep;
+    unsigned long lastCalibrationStep;
     
+    // Non-blocking diagnostics
+    DiagnosticState diagnosticState;
+    int diagnosticStep;
+    unsigned long lastDiagnosticStep;
+    SensorTestResult testResult;
+    
+    void recordSample(HistoryChannel channel, uint16_t value);
     void readLightSensor();
+    void updateLightTrend(int level);
     void readUsbState();
     void readPillBoxState();
+    void readBattery();
+    void publishSnapshot();
     int getAverageLightLevel();
-    void initializeLightSamples();
+    void seedLightSamples();
+    void updateCalibration(unsigned long currentTime);
+    void updateDiagnostics(unsigned long currentTime);
+    void updateSamplingPolicy(unsigned long currentTime);
+    void publishSamplingStats(unsigned long currentTime);
+    void onAlarmStateChanged(const AlarmStateEvent& event);
 
 public:
     SensorManager(Logger* log);
@@ -63,26 +184,42 @@ public:
     bool begin();
     void update(); // Call frequently in main loop
     
-    // Getters
-    SensorReadings getCurrentReadings();
-    int getLightLevel() const { return currentLightLevel; }
-    bool isUsbConnected() const { return currentUsbState; }
-    bool isPillBoxOpen() const { return currentPillBoxState; }
-    bool isDarkEnvironment() const { return currentLightLevel < BEDTIME_LIGHT_THRESHOLD; }
+    // Getters (lock-free and safe from any core)
+    SensorReadings getCurrentReadings() const;
+    uint32_t getReadingsVersion() const { return snapshot.getVersion(); }
+    bool readingsChangedSince(uint32_t version) const { return snapshot.changedSince(version); }
+    int getLightLevel() const { return getCurrentReadings().lightLevel; }
+    bool isUsbConnected() const { return getCurrentReadings().usbConnected; }
+    bool isPillBoxOpen() const { return getCurrentReadings().pillBoxOpen; }
+    bool isDarkEnvironment() const { return getLightLevel() < BEDTIME_LIGHT_THRESHOLD; }
+    float getBatteryVoltage() const { return getCurrentReadings().batteryVoltage; }
+    BatteryLevel getBatteryLevel() const { return batteryPolicy.getLevel(); }
+    PowerProfile getPowerProfile() const { return batteryPolicy.getProfile(); }
     
-    // Calibration and configuration
+    // Calibration and configuration (calibration completes asynchronously)
     void calibrateLightSensor();
+    bool isCalibrating() const { return calibrationState != CALIBRATION_IDLE; }
     void setLightThreshold(int threshold);
     int getLightThreshold() const { return BEDTIME_LIGHT_THRESHOLD; }
     
-    // Event callbacks
-    void setBedtimeCallback(std::function<void(bool)> callback) { bedtimeCallback = callback; }
-    void setUsbStateCallback(std::function<void(bool)> callback) { usbStateCallback = callback; }
-    void setPillBoxCallback(std::function<void(bool)> callback) { pillBoxCallback = callback; }
+    // Adaptive sampling (follows AlarmStateEvent automatically after begin())
+    void setAlarmState(AlarmState state);
+    String getSamplingStats();
+    SamplingStats getSamplingSnapshot() const;     // Safe from any task; refreshed every SAMPLING_STATS_PUBLISH_MS
+    
+    // History, safe from any task: copied out under a short critical section
+    size_t queryHistory(HistoryChannel channel, HistoryResolution resolution, uint32_t from, uint32_t to,
+                        HistoryBucket* out, size_t maxOut, uint32_t* firstBucketTime) const;
+    
+    // Light trend and sleep
+    LightRegime getLightRegime() const { return lightTrend.getRegime(); }
+    const SleepTracker* getSleepTracker() const { return &sleepTracker; }
+    String getSleepStats();
     
-    // Diagnostic functions
+    // Diagnostic functions (self-test completes asynchronously)
     String getSensorStatus();
     void performSensorTest();
+    bool isTestRunning() const { return diagnosticState != DIAGNOSTIC_IDLE; }
 };
 
 #endif // SENSOR_MANAGER_H
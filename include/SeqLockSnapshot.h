@@ -0,0 +1,113 @@
+/**
+ * @file SeqLockSnapshot.h
+ * @brief Lock-free single-writer snapshot for sharing state across cores
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * The writer alternates between two slots, each guarded by its own sequence
+ * counter (twice the version it holds, odd while being written), then
+ * publishes the slot through a monotonically increasing version. Readers
+ * copy the latest slot and retry only if the writer lapped them onto that
+ * same slot, so the writer never waits, readers never take a lock, and the
+ * version read() returns is always the one of the value it copied.
+ *
+ * Exactly one task may call publish(); read() is safe from any core or task.
+ * T must be trivially copyable; it is stored as 32-bit atomic words, so the
+ * copies never race on plain memory. Check with tools/seqlock_check.cpp.
+ */
+
+#ifndef SEQLOCK_SNAPSHOT_H
+#define SEQLOCK_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+class SeqLockSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot type must be trivially copyable");
+
+private:
+    // The value is copied in and out as relaxed atomic words: a reader that overlaps a write gets torn
+    // words it then discards, rather than racing on plain memory
+    static const size_t WORDS = (sizeof(T) + 3) / 4;
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        std::atomic<uint32_t> words[WORDS];
+    };
+
+    Slot slots[2];
+    std::atomic<uint32_t> version;
+
+    static void storeWords(Slot& slot, const T& value) {
+        const uint8_t* from = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t word = 0;
+            size_t offset = i * 4;
+            memcpy(&word, from + offset, sizeof(T) - offset < 4 ? sizeof(T) - offset : 4);
+            slot.words[i].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    static void loadWords(const Slot& slot, T* out) {
+        uint8_t* to = reinterpret_cast<uint8_t*>(out);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t word = slot.words[i].load(std::memory_order_relaxed);
+            size_t offset = i * 4;
+            memcpy(to + offset, &word, sizeof(T) - offset < 4 ? sizeof(T) - offset : 4);
+        }
+    }
+
+public:
+    SeqLockSnapshot() : version(0) {
+        for (int i = 0; i < 2; i++) {
+            slots[i].sequence.store(0, std::memory_order_relaxed);
+            storeWords(slots[i], T());
+        }
+    }
+
+    // Writer side; returns the new version
+    uint32_t publish(const T& value) {
+        uint32_t next = version.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots[next & 1];
+
+        // The sequence is twice the version the slot holds, odd while it is being written
+        slot.sequence.store(next * 2 - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        storeWords(slot, value);
+
+        slot.sequence.store(next * 2, std::memory_order_release);
+        version.store(next, std::memory_order_release);
+        return next;
+    }
+
+    // Copies the latest consistent value; returns its version
+    uint32_t read(T* out) const {
+        for (;;) {
+            uint32_t current = version.load(std::memory_order_acquire);
+            const Slot& slot = slots[current & 1];
+
+            // Odd: being written; another version: the writer lapped onto this slot since
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before != current * 2) {
+                continue;
+            }
+
+            loadWords(slot, out);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                return current;
+            }
+        }
+    }
+
+    uint32_t getVersion() const { return version.load(std::memory_order_acquire); }
+    bool changedSince(uint32_t seen) const { return getVersion() != seen; }
+};
+
+#endif // SEQLOCK_SNAPSHOT_H
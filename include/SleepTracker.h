@@ -0,0 +1,47 @@
+/**
+ * @file SleepTracker.h
+ * @brief Sleep duration statistics from lights-out / lights-on events
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Plain C++ (no Arduino dependencies) so it can be replayed on the host.
+ */
+
+#ifndef SLEEP_TRACKER_H
+#define SLEEP_TRACKER_H
+
+#include <stdint.h>
+
+#define SLEEP_HISTORY_NIGHTS 7
+
+class SleepTracker {
+private:
+    uint32_t minSleepSeconds;
+    uint32_t maxSleepSeconds;
+    uint32_t mergeGapSeconds;   // Lights on for less than this (e.g. a bathroom trip) continues the night
+
+    bool asleep;
+    uint32_t sleepStart;
+    uint32_t lastWake;
+    bool canMerge;              // The last wake may still turn out to be an interruption
+    bool recorded;              // The current night already has a history entry
+
+    uint16_t nightMinutes[SLEEP_HISTORY_NIGHTS];
+    uint8_t head;
+    uint8_t count;
+
+public:
+    SleepTracker(uint32_t minSeconds, uint32_t maxSeconds, uint32_t mergeSeconds);
+
+    void onLightsOut(uint32_t timestamp);
+    // Returns true when a night was recorded or extended
+    bool onLightsOn(uint32_t timestamp);
+
+    bool isAsleep() const { return asleep; }
+    uint32_t getSleepStart() const { return sleepStart; }
+    uint8_t getNightCount() const { return count; }
+    uint16_t getLastNightMinutes() const;
+    uint16_t getAverageMinutes() const;
+};
+
+#endif // SLEEP_TRACKER_H
@@ -0,0 +1,91 @@
+/**
+ * @file SntpClient.h
+ * @brief Non-blocking SNTP (RFC 4330) client state machine
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * update() is called from the main loop with the local monotonic time and
+ * the current system time. When a poll is due it sends one request and
+ * returns; later calls pick up the reply, or give up after SNTP_TIMEOUT_MS
+ * and retry with a doubling back-off. A reply yields one SntpSample (clock
+ * offset and round-trip delay), which ClockDiscipline turns into
+ * corrections. Replies whose originate timestamp does not echo our request,
+ * and kiss-o'-death or unsynchronized servers, are rejected.
+ *
+ * Packets go through caller-supplied send/receive functions, so the same
+ * code runs over WiFiUDP on the device and over a POSIX socket on the host
+ * (tools/sntp_check.cpp). Plain C++ (no Arduino dependencies).
+ */
+
+#ifndef SNTP_CLIENT_H
+#define SNTP_CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#define SNTP_PACKET_BYTES 48
+
+enum SntpStatus {
+    SNTP_IDLE,          // Nothing due
+    SNTP_WAITING,       // Request out, no reply yet
+    SNTP_SAMPLE,        // Reply accepted; see getSample()
+    SNTP_TIMEOUT,       // No reply, or the request could not be sent
+    SNTP_REJECTED       // Server unsynchronized or asked us to back off
+};
+
+struct SntpSample {
+    int64_t offsetUs;           // Server time minus our clock
+    uint32_t delayUs;           // Round trip minus server processing
+    uint64_t monotonicUs;       // When the reply was taken
+    uint8_t stratum;
+};
+
+class SntpClient {
+public:
+    typedef bool (*SendFunction)(void* context, const uint8_t* packet, size_t length);
+    typedef size_t (*ReceiveFunction)(void* context, uint8_t* packet, size_t capacity);    // 0 = nothing waiting
+
+private:
+    SendFunction sendPacket;
+    ReceiveFunction receivePacket;
+    void* context;
+
+    bool waiting;
+    uint64_t sentMonotonicUs;
+    int64_t sentClockUs;
+    uint64_t sentTimestamp;     // Our transmit timestamp, echoed as the reply's originate
+    uint64_t nextPollUs;
+    uint32_t pollIntervalS;
+    uint32_t retryS;
+    SntpSample sample;
+
+    uint32_t requests;
+    uint32_t replies;
+
+    void backOff(uint64_t monotonicUs);
+
+public:
+    SntpClient();
+
+    void begin(SendFunction send, ReceiveFunction receive, void* context);
+
+    // Never blocks. clockUs is the system time in microseconds since the Unix epoch (UTC).
+    SntpStatus update(uint64_t monotonicUs, int64_t clockUs);
+
+    void requestNow();                      // Poll on the next update()
+    void setPollInterval(uint32_t seconds); // Applies from the next successful reply
+    uint32_t getPollInterval() const { return pollIntervalS; }
+    uint64_t getNextPoll() const { return nextPollUs; }     // Monotonic time the next request goes out
+    bool isWaiting() const { return waiting; }
+    const SntpSample& getSample() const { return sample; }
+    uint32_t getRequestCount() const { return requests; }
+    uint32_t getReplyCount() const { return replies; }
+
+    // NTP timestamps: seconds since 1900 in the high word, binary fraction in the low word
+    static uint64_t toNtpTime(int64_t unixUs);
+    static int64_t fromNtpTime(uint64_t ntpTime);
+    static void writeRequest(uint64_t transmitTime, uint8_t* packet);
+};
+
+#endif // SNTP_CLIENT_H
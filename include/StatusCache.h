@@ -0,0 +1,70 @@
+/**
+ * @file StatusCache.h
+ * @brief Rendered /status document, reused until the state behind it changes
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * The status object is rendered once into a static buffer, together with
+ * where each of its fields ends. Requests in between are answered from that
+ * buffer: the whole document, or with ?fields= only the chosen fields,
+ * copied out in the order they were rendered. Nothing is formatted again.
+ *
+ * The ETag is a hash of exactly the bytes a selection sends, so a poller
+ * that asks only for fields that did not change keeps getting 304 even
+ * while the clock and uptime fields move on.
+ *
+ * Rendering:
+ *   JsonWriter json(cache.getBuffer(), cache.getCapacity());
+ *   cache.beginRender(json);
+ *   cache.field(json, "uptime");
+ *   json.unsignedNumber(...);
+ *   ...
+ *   cache.finish(json);
+ *
+ * Plain C++ (no Arduino dependencies) so it can be exercised on the host.
+ * Not thread-safe: render and read from one task.
+ */
+
+#ifndef STATUS_CACHE_H
+#define STATUS_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "JsonWriter.h"
+
+#define STATUS_ALL_FIELDS 0xFFFFFFFFu
+
+class StatusCache {
+private:
+    char document[STATUS_CACHE_SIZE];
+    const char* fieldNames[STATUS_FIELD_MAX];   // Static strings, as passed to field()
+    uint16_t fieldEnds[STATUS_FIELD_MAX];       // Offset just past each field's value
+    uint8_t fieldCount;
+    uint16_t length;                            // 0 until a render succeeded
+    uint32_t renders;
+
+    // Writes the selection to out (when not nullptr) and returns its length; *hash gets its FNV-1a hash
+    size_t emit(uint32_t mask, char* out, size_t size, uint32_t* hash) const;
+
+public:
+    StatusCache();
+
+    // Rendering; a failed render leaves the cache empty
+    char* getBuffer() { return document; }
+    size_t getCapacity() const { return sizeof(document); }
+    void beginRender(JsonWriter& json);
+    void field(JsonWriter& json, const char* name);     // Ends the previous field, writes this one's key
+    bool finish(JsonWriter& json);
+    void invalidate() { length = 0; }
+
+    // Reading
+    bool isValid() const { return length > 0; }
+    uint32_t parseFields(const char* list) const;       // Bit per field; 0 if a name is unknown or none given
+    void formatETag(uint32_t mask, char* out) const;    // 12 bytes, quotes included
+    size_t copy(uint32_t mask, char* out, size_t size) const;   // 0 if it does not fit
+
+    uint32_t getRenderCount() const { return renders; }
+};
+
+#endif // STATUS_CACHE_H
@@ -0,0 +1,114 @@
+/**
+ * @file TelemetryPublisher.h
+ * @brief MQTT telemetry for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Alarm, pill box, USB and bedtime events from the EventBus, plus a metrics
+ * sample every TELEMETRY_METRICS_INTERVAL_MS, go into a TelemetrySpool and
+ * from there to MQTT_BROKER in batches of up to TELEMETRY_BATCH_RECORDS,
+ * published at QoS 1 on <MQTT_TOPIC_PREFIX>/<device>/telemetry. Records
+ * leave the spool only once the broker has acknowledged their batch.
+ *
+ * Everything runs from update() on the main loop and nothing in it waits:
+ * the broker name is resolved through the lwIP DNS callback, the socket is
+ * non-blocking and MqttClient only moves what the socket takes. Reconnects
+ * back off exponentially with jitter.
+ *
+ * The radio policy is told when events are queued (a quiet-window wake for
+ * them) and when queued metrics are next due to go out.
+ */
+
+#ifndef TELEMETRY_PUBLISHER_H
+#define TELEMETRY_PUBLISHER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <lwip/dns.h>
+#include "config.h"
+#include "Logger.h"
+#include "MqttClient.h"
+#include "TelemetrySpool.h"
+
+class NetworkManager;
+class SensorManager;
+struct AlarmStateEvent;
+struct PillBoxEvent;
+struct UsbStateEvent;
+struct BedtimeEvent;
+struct NetworkStateEvent;
+
+enum TelemetryLinkState {
+    TELEMETRY_OFFLINE,      // No WiFi, no broker configured, or waiting to retry
+    TELEMETRY_RESOLVING,
+    TELEMETRY_CONNECTING,   // TCP connect in progress
+    TELEMETRY_SESSION       // MQTT session (or CONNECT) on an open socket
+};
+
+class TelemetryPublisher {
+private:
+    Logger* logger;
+    NetworkManager* network;
+    const SensorManager* sensors;
+    Preferences preferences;
+
+    TelemetrySpool spool;
+    MqttClient mqtt;
+    char deviceId[13];
+    char topic[64];
+
+    // Link to the broker
+    TelemetryLinkState linkState;
+    bool wifiUp;
+    int socketFd;
+    unsigned long stateSince;
+    unsigned long nextAttempt;
+    uint8_t failures;
+    volatile uint32_t brokerAddress;    // Set by the lwIP DNS callback
+    volatile bool resolving;
+
+    // Batch awaiting its PUBACK
+    bool batchInFlight;
+    uint32_t batchLastSequence;
+    size_t batchCount;
+
+    unsigned long lastMetrics;
+    unsigned long lastFlush;
+    uint32_t sequenceReserved;      // Sequence numbers below this are reserved in NVS
+    uint32_t batchesSent;
+    uint32_t recordsSent;
+
+    // Link management
+    void updateLink(unsigned long currentTime);
+    void startConnect(unsigned long currentTime);
+    void closeLink(const char* reason);
+    void publishNext(unsigned long currentTime);
+    void reserveSequences();
+    void record(TelemetryKind kind, const int32_t* values, uint8_t count);
+    void sampleMetrics();
+
+    static int sendBytes(void* context, const uint8_t* data, size_t length);
+    static int receiveBytes(void* context, uint8_t* data, size_t capacity);
+    static void onBrokerResolved(const char* name, const ip_addr_t* address, void* context);
+
+    // EventBus subscribers
+    void onAlarmStateChanged(const AlarmStateEvent& event);
+    void onPillBoxChanged(const PillBoxEvent& event);
+    void onUsbStateChanged(const UsbStateEvent& event);
+    void onBedtime(const BedtimeEvent& event);
+    void onNetworkStateChanged(const NetworkStateEvent& event);
+
+public:
+    TelemetryPublisher(Logger* log, NetworkManager* networkManager, const SensorManager* sensorManager);
+    ~TelemetryPublisher();
+
+    bool begin();
+    void update();  // Call frequently in main loop
+
+    bool isEnabled() const { return MQTT_BROKER[0] != '\0'; }
+    TelemetryLinkState getLinkState() const { return linkState; }
+    size_t getQueuedCount() const { return spool.size(); }
+    String getStats() const;
+};
+
+#endif // TELEMETRY_PUBLISHER_H
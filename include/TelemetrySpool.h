@@ -0,0 +1,123 @@
+/**
+ * @file TelemetrySpool.h
+ * @brief Bounded RAM and flash queue for outgoing telemetry
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Records wait here until the broker has acknowledged them. New records go
+ * into a ring of TELEMETRY_RAM_RECORDS in RAM. When the ring is full:
+ *   1. with at least half a segment of events (everything but metrics) in
+ *      RAM, they move to flash, oldest first, one segment file of up to
+ *      TELEMETRY_SEGMENT_RECORDS at a time. Metrics never go to flash: they
+ *      are superseded by the next sample and would only wear it.
+ *   2. with TELEMETRY_FLASH_SEGMENTS segments already written, the oldest
+ *      segment is deleted first and its events are counted as dropped.
+ *   3. with fewer events than that (or no flash), the oldest metric is
+ *      dropped, or the oldest event if there is no metric.
+ * So a long outage keeps the newest metrics and as many events as flash
+ * holds, and the newest records always get in.
+ *
+ * peek() hands out the oldest records for one batch - flash first, then
+ * RAM - and acknowledge() removes them by sequence number once the broker
+ * has them, so records dropped meanwhile cannot shift the batch. Flash
+ * segments are written once and deleted when sent. After a restart the
+ * flash records are sent again from the start of their segment; the
+ * sequence numbers let the backend discard the repeats.
+ *
+ * encodeBatch() is the wire format, compact JSON with positional fields:
+ *   {"dev":"<device>","r":[[<sequence>,<time>,"<kind>",<value>...],...]}
+ *
+ * Plain C++ on stdio files (LittleFS is mounted into the VFS on the ESP32),
+ * so the spool can be exercised on the host.
+ */
+
+#ifndef TELEMETRY_SPOOL_H
+#define TELEMETRY_SPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+
+#define TELEMETRY_MAX_VALUES 4
+#define TELEMETRY_PATH_MAX 48
+
+enum TelemetryKind {
+    TELEMETRY_METRICS,      // Light level, battery mV, free heap, RSSI
+    TELEMETRY_ALARM,        // State, previous state, alarm id
+    TELEMETRY_PILL_BOX,     // Open
+    TELEMETRY_USB,          // Connected
+    TELEMETRY_BEDTIME       // Dark, light level, confidence
+};
+
+// Fixed size, written to flash as is
+struct TelemetryRecord {
+    uint32_t sequence;
+    uint32_t timestamp;     // Epoch seconds (UTC), 0 while the clock is not set
+    uint8_t kind;
+    uint8_t valueCount;
+    uint16_t reserved;
+    int32_t values[TELEMETRY_MAX_VALUES];
+};
+
+class TelemetrySpool {
+private:
+    // RAM ring, oldest at ramHead
+    TelemetryRecord ram[TELEMETRY_RAM_RECORDS];
+    uint16_t ramHead;
+    uint16_t ramCount;
+    uint16_t ramEvents;
+
+    // Flash segments firstSegment..nextSegment-1 in "<directory>/<number>.tlm"
+    char directory[TELEMETRY_PATH_MAX - 14];     // Room for "/<8 hex digits>.tlm" after it
+    bool flashEnabled;
+    uint32_t firstSegment;
+    uint32_t nextSegment;
+    uint32_t firstSegmentRead;      // Records of the first segment already acknowledged
+    uint32_t firstSegmentSize;      // Records in the first segment
+    uint32_t flashRecords;          // Not yet acknowledged
+    bool peekedFlash;               // The last peek() came from flash
+
+    uint32_t nextSequence;
+    uint32_t droppedEvents;
+    uint32_t droppedMetrics;
+    uint32_t flashErrors;
+
+    const TelemetryRecord& ramAt(uint16_t index) const { return ram[(ramHead + index) % TELEMETRY_RAM_RECORDS]; }
+    void makeRoom();
+    bool spillEvents();
+    void dropOldestSegment();
+    void removeFromRam(uint16_t index);
+    void openFirstSegment();
+    void segmentPath(uint32_t segment, char* path) const;
+    static uint32_t recordsInFile(const char* path);
+
+public:
+    TelemetrySpool();
+
+    // directory nullptr: RAM only. Sequence numbers continue from firstSequence or past what flash holds.
+    bool begin(const char* directory, uint32_t firstSequence);
+
+    uint32_t push(TelemetryKind kind, uint32_t timestamp, const int32_t* values, uint8_t count);
+
+    // Oldest records, all from flash or all from RAM; returns how many were copied
+    size_t peek(TelemetryRecord* records, size_t max);
+    void acknowledge(uint32_t lastSequence);
+
+    size_t size() const { return ramCount + flashRecords; }
+    bool isEmpty() const { return size() == 0; }
+    size_t ramSize() const { return ramCount; }
+    size_t flashSize() const { return flashRecords; }
+    size_t eventCount() const { return ramEvents + flashRecords; }     // Records other than metrics
+    uint32_t getNextSequence() const { return nextSequence; }
+    uint32_t getDroppedEvents() const { return droppedEvents; }
+    uint32_t getDroppedMetrics() const { return droppedMetrics; }
+    uint32_t getFlashErrors() const { return flashErrors; }
+    
+    // As many of records as fit in size bytes; returns how many, the JSON length in *length
+    static size_t encodeBatch(const char* device, const TelemetryRecord* records, size_t count, char* out,
+                              size_t size, size_t* length);
+    static const char* kindName(uint8_t kind);
+};
+
+#endif // TELEMETRY_SPOOL_H
@@ -0,0 +1,97 @@
+/**
+ * @file TimeSeriesCodec.h
+ * @brief Gorilla-style block codec for sensor time series
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * A block is TS_BLOCK_SIZE bytes: an 8-byte little-endian header
+ * (sample count, first value, first timestamp) followed by a bit stream.
+ * Each further sample stores its timestamp as a delta-of-delta and its value
+ * as a zigzag delta, both with variable-length prefixes:
+ *
+ *   timestamp dod   '0' = 0 | '10'+7 bits | '110'+9 bits | '1110'+12 bits | '1111'+32 bits
+ *   value delta     '0' = 0 | '10'+6 bits | '110'+9 bits | '111'+16 bits (absolute value)
+ *
+ * Plain C++ so blocks can be decoded on the host (see tools/ts_decode.py).
+ */
+
+#ifndef TIME_SERIES_CODEC_H
+#define TIME_SERIES_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TS_BLOCK_SIZE 256
+#define TS_BLOCK_HEADER_SIZE 8
+#define TS_MAX_SAMPLE_BITS (4 + 32 + 3 + 16)
+
+class BitWriter {
+private:
+    uint8_t* buffer;
+    size_t capacityBits;
+    size_t position;
+
+public:
+    BitWriter() : buffer(nullptr), capacityBits(0), position(0) {}
+    void reset(uint8_t* data, size_t sizeBytes);
+    void write(uint32_t value, uint8_t bits);
+    size_t bitsUsed() const { return position; }
+    size_t bitsFree() const { return capacityBits - position; }
+};
+
+class BitReader {
+private:
+    const uint8_t* buffer;
+    size_t capacityBits;
+    size_t position;
+
+public:
+    BitReader(const uint8_t* data, size_t sizeBytes)
+        : buffer(data), capacityBits(sizeBytes * 8), position(0) {}
+    bool read(uint8_t bits, uint32_t* value);
+};
+
+class TimeSeriesBlockEncoder {
+private:
+    uint8_t block[TS_BLOCK_SIZE];
+    BitWriter writer;
+    uint16_t sampleCount;
+    uint32_t firstTimestamp;
+    uint16_t firstValue;
+    uint32_t lastTimestamp;
+    int32_t lastDelta;
+    uint16_t lastValue;
+
+    void writeHeader();
+
+public:
+    TimeSeriesBlockEncoder();
+
+    void reset();
+    bool append(uint32_t timestamp, uint16_t value); // false when the block is full
+    bool isEmpty() const { return sampleCount == 0; }
+
+    const uint8_t* data();
+    uint16_t getSampleCount() const { return sampleCount; }
+    uint32_t getFirstTimestamp() const { return firstTimestamp; }
+    uint32_t getLastTimestamp() const { return lastTimestamp; }
+    size_t getEncodedBytes() const { return TS_BLOCK_HEADER_SIZE + (writer.bitsUsed() + 7) / 8; }
+};
+
+class TimeSeriesBlockDecoder {
+private:
+    BitReader reader;
+    uint16_t sampleCount;
+    uint16_t decoded;
+    uint32_t lastTimestamp;
+    int32_t lastDelta;
+    uint16_t lastValue;
+
+public:
+    TimeSeriesBlockDecoder(const uint8_t* data, size_t sizeBytes);
+
+    uint16_t getSampleCount() const { return sampleCount; }
+    bool next(uint32_t* timestamp, uint16_t* value);
+};
+
+#endif // TIME_SERIES_CODEC_H
@@ -0,0 +1,70 @@
+/**
+ * @file TimeSeriesStore.h
+ * @brief Append-only compressed sensor time series on LittleFS
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Each channel has a data file of fixed TS_BLOCK_SIZE blocks and an index
+ * file with one TimeSeriesIndexEntry per block. Blocks are only written once
+ * they are full, so existing flash data is never rewritten. When a data file
+ * reaches TS_MAX_BLOCKS_PER_FILE it is rotated to "<name>.old.*".
+ */
+
+#ifndef TIME_SERIES_STORE_H
+#define TIME_SERIES_STORE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "Logger.h"
+#include "SensorHistory.h"
+#include "TimeSeriesCodec.h"
+
+// Little-endian, 16 bytes, one per block in "<name>.idx"
+struct TimeSeriesIndexEntry {
+    uint32_t firstTimestamp;
+    uint32_t lastTimestamp;
+    uint32_t offset;        // Byte offset of the block in "<name>.dat"
+    uint16_t sampleCount;
+    uint16_t reserved;
+};
+
+class TimeSeriesStore {
+private:
+    Logger* logger;
+    bool mounted;
+
+    // Open block per channel, flushed to flash when full
+    TimeSeriesBlockEncoder encoders[HISTORY_CHANNEL_COUNT];
+    uint32_t blockCount[HISTORY_CHANNEL_COUNT];
+    uint16_t lastValue[HISTORY_CHANNEL_COUNT];
+    uint32_t lastTimestamp[HISTORY_CHANNEL_COUNT];
+    uint32_t samplesWritten[HISTORY_CHANNEL_COUNT];
+
+    bool writeBlock(HistoryChannel channel);
+    void rotate(HistoryChannel channel);
+    size_t readFile(HistoryChannel channel, bool rotated, uint32_t from, uint32_t to,
+                    std::function<bool(uint32_t, uint16_t)> visitor, bool* stop);
+
+public:
+    TimeSeriesStore(Logger* log);
+    ~TimeSeriesStore();
+
+    bool begin();
+
+    // Unchanged values are only stored every TS_UNCHANGED_KEEPALIVE_S
+    void append(HistoryChannel channel, uint32_t timestamp, uint16_t value);
+
+    // Writes partially filled blocks, e.g. before a restart
+    void flush();
+
+    // Visits samples in [from, to] oldest first; return false from the visitor to stop
+    size_t readRange(HistoryChannel channel, uint32_t from, uint32_t to,
+                     std::function<bool(uint32_t, uint16_t)> visitor);
+
+    static String dataPath(HistoryChannel channel, bool rotated = false);
+    static String indexPath(HistoryChannel channel, bool rotated = false);
+    String getStats();
+};
+
+#endif // TIME_SERIES_STORE_H
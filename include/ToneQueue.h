@@ -0,0 +1,77 @@
+/**
+ * @file ToneQueue.h
+ * @brief Bounded priority queue of buzzer sequences for ESP32 Smart Alarm
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Decides what the buzzer plays next. A request with a higher priority
+ * preempts the one playing; lower or equal priorities wait their turn, so a
+ * notification never interrupts an alarm. Plain C++ (no Arduino
+ * dependencies) so the arbitration can be exercised on the host
+ * (see tools/tone_queue_check.cpp).
+ */
+
+#ifndef TONE_QUEUE_H
+#define TONE_QUEUE_H
+
+#include <stdint.h>
+#include "config.h"
+#include "PatternCode.h"
+#include "FadePlanner.h"
+
+enum TonePriority {
+    TONE_PRIORITY_FEEDBACK,         // Beeps, startup and test tones
+    TONE_PRIORITY_NOTIFICATION,     // Reminders, success/error jingles
+    TONE_PRIORITY_ALARM             // Alarm sound; preempts everything
+};
+
+struct ToneRequest {
+    const uint8_t* pattern;         // Static bytecode, or nullptr to play code[]
+    uint8_t code[PATTERN_MAX_BYTES];
+    uint16_t length;
+    bool loop;
+    uint8_t priority;               // TonePriority
+    uint8_t tag;                    // Caller's identifier (BuzzerPattern)
+    uint32_t enqueuedAt;            // Milliseconds
+    RampProfile ramp;               // Wake-up crescendo; shape RAMP_NONE for full volume
+
+    const uint8_t* program() const { return pattern ? pattern : code; }
+};
+
+enum ToneDecision {
+    TONE_START_NOW,                 // Request became current; (re)start playback
+    TONE_QUEUED,
+    TONE_REJECTED                   // Queue full of equal or higher priorities
+};
+
+class ToneQueue {
+private:
+    // Waiting requests, highest priority first, FIFO within a priority
+    ToneRequest entries[TONE_QUEUE_SIZE];
+    uint8_t count;
+
+    ToneRequest current;
+    bool playing;
+    uint32_t dropped;
+
+    void removeAt(uint8_t index);
+
+public:
+    ToneQueue();
+
+    ToneDecision submit(const ToneRequest& request);
+
+    // Current request finished: promote the next one not older than maxAgeMs
+    bool next(uint32_t now, uint32_t maxAgeMs);
+
+    // Stops and discards everything of one priority; true if the current request was stopped
+    bool removePriority(uint8_t priority);
+    void clear();
+
+    bool isPlaying() const { return playing; }
+    const ToneRequest& getCurrent() const { return current; }
+    uint8_t size() const { return count; }
+    uint32_t getDroppedCount() const { return dropped; }
+};
+
+#endif // TONE_QUEUE_H
@@ -0,0 +1,283 @@
+/**
+ * @file WebAssets.h
+ * @brief Gzipped web interface, generated by tools/embed_web.py from web/
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Do not edit; change the files in web/ and rebuild.
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+struct WebAsset {
+    const char* path;
+    const char* contentType;
+    const char* cacheControl;
+    const char* etag;           // Quoted SHA-256 prefix of the gzipped body
+    const uint8_t* data;        // gzip, served from flash
+    uint32_t length;
+};
+
+// app.js, 2022 bytes gzipped
+static const uint8_t WEB_APP_JS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0xb5, 0x58, 0xdf, 0x6f, 0xdb, 0x36,
+    0x10, 0x7e, 0xcf, 0x5f, 0xc1, 0xe4, 0xa1, 0x94, 0x36, 0x5b, 0x4e, 0xbb, 0x75, 0x18, 0x1c, 0x64,
+    0x41, 0xb2, 0x76, 0x58, 0xd7, 0xa4, 0x09, 0x62, 0x77, 0x7d, 0x28, 0x8a, 0x82, 0x96, 0xe8, 0x98,
+    0x8b, 0x2c, 0x0a, 0x24, 0x15, 0xd7, 0x4d, 0xf3, 0xbf, 0xef, 0x8e, 0xa4, 0x24, 0x4a, 0xb6, 0x93,
+    0x3e, 0x6c, 0x42, 0x80, 0x48, 0x14, 0x75, 0xbf, 0xf8, 0xdd, 0x77, 0x77, 0x1e, 0x8d, 0xc8, 0xb9,
+    0xb8, 0xe3, 0xa4, 0x2a, 0x33, 0x66, 0xb8, 0x26, 0xa9, 0x5c, 0x72, 0x22, 0xef, 0xb8, 0x22, 0x66,
+    0xc1, 0x89, 0x36, 0xcc, 0x54, 0x9a, 0x7c, 0xe0, 0xb3, 0x89, 0x4c, 0x6f, 0xb9, 0x39, 0x22, 0x23,
+    0xbf, 0x24, 0x34, 0x29, 0x65, 0x9e, 0xf3, 0x8c, 0xc8, 0x22, 0x5f, 0x93, 0xd5, 0x42, 0xe4, 0x9c,
+    0x08, 0x83, 0xeb, 0x99, 0x5c, 0x15, 0x7b, 0x77, 0x4c, 0x91, 0xab, 0xcb, 0xf3, 0xf3, 0xcf, 0x17,
+    0x13, 0x72, 0x4c, 0x5e, 0x1e, 0x1e, 0x1e, 0x1e, 0xd9, 0xb5, 0xd3, 0xf3, 0xd3, 0xeb, 0x8b, 0xcf,
+    0x93, 0xe9, 0xe9, 0xf4, 0x35, 0xbe, 0xf8, 0x48, 0xdf, 0x64, 0x39, 0xa7, 0x03, 0x42, 0xaf, 0x45,
+    0x71, 0x03, 0x7f, 0x78, 0x3b, 0x29, 0xa4, 0xfc, 0xca, 0x33, 0xbc, 0xfd, 0xc0, 0x84, 0x81, 0x55,
+    0x32, 0x97, 0x8a, 0x94, 0x22, 0xcf, 0xc9, 0x4c, 0x7e, 0xa1, 0x9f, 0x9c, 0xa8, 0x77, 0xaf, 0xa7,
+    0x1f, 0x2e, 0xaf, 0xdf, 0x6e, 0x13, 0xf6, 0xbb, 0x2c, 0x0a, 0x9e, 0x1a, 0x2f, 0xcf, 0x3f, 0x39,
+    0x89, 0xa7, 0x57, 0xe4, 0x42, 0x66, 0x76, 0xd7, 0x6b, 0xa5, 0xa4, 0x42, 0x69, 0x56, 0x9c, 0xb6,
+    0x1e, 0x82, 0x98, 0xa2, 0xca, 0xf3, 0xa3, 0x60, 0xe9, 0x4a, 0xaa, 0xee, 0xb2, 0xe2, 0xa9, 0x93,
+    0xf8, 0x8a, 0xe7, 0x6c, 0x0d, 0xaf, 0x9e, 0x37, 0xee, 0x61, 0x4c, 0xa6, 0x62, 0x09, 0xe1, 0x0b,
+    0x3f, 0x48, 0x73, 0x10, 0x74, 0xc6, 0x34, 0xaf, 0x57, 0x09, 0x5e, 0xa3, 0x11, 0x79, 0xc5, 0xef,
+    0x44, 0xca, 0x89, 0x81, 0x2f, 0x08, 0x2b, 0x32, 0x1b, 0xf3, 0x25, 0x9c, 0x40, 0x61, 0x30, 0x96,
+    0x2b, 0xa6, 0x41, 0x17, 0xcb, 0x06, 0xd6, 0x7d, 0x7c, 0x07, 0x72, 0x58, 0xee, 0xc4, 0xed, 0xed,
+    0xcd, 0xab, 0x02, 0x5c, 0x94, 0x05, 0xd1, 0xdc, 0x4c, 0xf9, 0x17, 0x13, 0x09, 0xd8, 0x79, 0xc7,
+    0xf2, 0x8a, 0xc7, 0xe4, 0x7e, 0x0f, 0x35, 0xa0, 0x6e, 0x9e, 0x73, 0x2b, 0xef, 0x18, 0xce, 0x25,
+    0xad, 0xf0, 0x36, 0xb9, 0xe1, 0xe6, 0xb5, 0x5b, 0x3d, 0x5b, 0xbf, 0xc9, 0xe0, 0xb3, 0xf8, 0xc8,
+    0x6e, 0x17, 0x73, 0x12, 0xd5, 0xdb, 0x9f, 0x3d, 0x73, 0xa2, 0xc8, 0xfe, 0xf1, 0x31, 0xa9, 0x8a,
+    0x8c, 0xcf, 0x45, 0xc1, 0xb3, 0x5a, 0x30, 0x5e, 0x7e, 0x67, 0x62, 0x40, 0x35, 0x44, 0xd8, 0x38,
+    0x25, 0xf6, 0x23, 0x27, 0xee, 0x61, 0xef, 0x21, 0x30, 0xd2, 0x01, 0x6c, 0x62, 0xd1, 0x13, 0xd5,
+    0x72, 0xe6, 0xdc, 0xa4, 0x8b, 0x88, 0x7a, 0x50, 0x9d, 0xcc, 0x05, 0xcf, 0x33, 0x7d, 0xbc, 0x12,
+    0x73, 0x31, 0xc0, 0x98, 0x0c, 0x58, 0xce, 0xd4, 0x52, 0x0f, 0xa4, 0x61, 0x78, 0x08, 0x83, 0x95,
+    0xc6, 0x7f, 0x34, 0x6e, 0x6c, 0x48, 0x20, 0x28, 0x45, 0xa4, 0xb8, 0x2e, 0x65, 0x81, 0xd1, 0xfd,
+    0x8d, 0xd4, 0xf7, 0xc9, 0x3f, 0x5a, 0x16, 0x51, 0xdc, 0xdf, 0x0a, 0x36, 0x30, 0xdc, 0xd6, 0xba,
+    0x81, 0x57, 0x1d, 0x40, 0x8a, 0x9a, 0x87, 0xce, 0x18, 0x00, 0x08, 0x6e, 0x4e, 0x70, 0xc9, 0xc7,
+    0x67, 0x63, 0x7b, 0x5a, 0x29, 0x05, 0x6e, 0x0f, 0xd1, 0xd6, 0x7a, 0x3f, 0xde, 0xef, 0xda, 0x6f,
+    0xdd, 0x19, 0xa6, 0xb2, 0x2a, 0x4c, 0xbd, 0xdd, 0x79, 0xb8, 0xeb, 0x83, 0xcc, 0xe2, 0x63, 0x28,
+    0x4a, 0xd8, 0x8e, 0x67, 0x8f, 0x91, 0x4c, 0x16, 0x52, 0x9b, 0x82, 0xed, 0xd6, 0x02, 0xd1, 0x1a,
+    0x96, 0x18, 0x27, 0xaf, 0xc2, 0x47, 0xaf, 0xb7, 0x3d, 0xc4, 0xe4, 0x3d, 0x1a, 0x3d, 0x26, 0xaf,
+    0xe0, 0x80, 0x92, 0x92, 0x29, 0xcd, 0xa3, 0xc6, 0x95, 0x44, 0xf1, 0x32, 0x67, 0x29, 0x8f, 0x28,
+    0xc1, 0x94, 0x99, 0xd2, 0x38, 0x1e, 0x10, 0x66, 0xfc, 0xe6, 0x42, 0xae, 0xa2, 0xf8, 0xa1, 0x2b,
+    0x18, 0x51, 0xe4, 0x22, 0x67, 0x4f, 0x0b, 0x91, 0x14, 0xe6, 0xd1, 0xb1, 0x4b, 0x81, 0xb8, 0x77,
+    0x04, 0xd6, 0x83, 0x30, 0xdd, 0x02, 0x11, 0x47, 0x1b, 0x3b, 0x7d, 0xfe, 0x39, 0x52, 0x8a, 0x7a,
+    0x9e, 0x3d, 0x34, 0x4f, 0x0f, 0xc1, 0xf1, 0x43, 0xf0, 0x00, 0x6a, 0x1c, 0x53, 0x1e, 0x01, 0x00,
+    0x12, 0xb4, 0xcc, 0x79, 0x62, 0x17, 0x22, 0x47, 0x05, 0x63, 0xf0, 0xd0, 0x3e, 0xc7, 0x20, 0x31,
+    0xc4, 0x2e, 0x20, 0x42, 0x81, 0x5d, 0x79, 0x0e, 0x84, 0xd2, 0x60, 0x17, 0xfd, 0x0c, 0xd2, 0x7d,
+    0x8b, 0x5f, 0x21, 0x19, 0xc0, 0xe9, 0xbc, 0x81, 0x1c, 0x51, 0x90, 0x1f, 0x51, 0x98, 0x0a, 0x83,
+    0x9a, 0x25, 0xe3, 0x3a, 0x69, 0x3a, 0x67, 0x99, 0x03, 0x37, 0x0f, 0x97, 0x9e, 0xaf, 0x4a, 0x67,
+    0x01, 0xdd, 0xb0, 0x4e, 0x96, 0x8f, 0x1b, 0xb7, 0xbf, 0xc5, 0xb8, 0x34, 0xe7, 0x4c, 0x35, 0x26,
+    0x35, 0x7b, 0x83, 0x58, 0x6e, 0x72, 0xd9, 0x53, 0x06, 0xe2, 0x83, 0xb7, 0x0e, 0xc8, 0xed, 0x82,
+    0x6b, 0xcd, 0x6e, 0xb0, 0xa6, 0x30, 0xa5, 0xd6, 0xae, 0x4e, 0x20, 0x89, 0xb9, 0x2c, 0x87, 0x5b,
+    0x66, 0x48, 0xba, 0x60, 0xc5, 0x0d, 0x07, 0xde, 0xe2, 0xc9, 0x4d, 0x42, 0xee, 0x0f, 0xd4, 0xc1,
+    0xf8, 0xe7, 0x17, 0x83, 0x03, 0x9b, 0x15, 0x07, 0xe3, 0xe7, 0x83, 0x03, 0x91, 0x1d, 0x8c, 0x7f,
+    0x7a, 0x68, 0x9d, 0x65, 0x65, 0x99, 0xaf, 0xb1, 0x62, 0x59, 0x8c, 0x85, 0xee, 0xb6, 0xe9, 0xb4,
+    0x9b, 0xb3, 0x7a, 0x99, 0x88, 0x99, 0x8e, 0x86, 0x87, 0x45, 0xe9, 0x63, 0x2b, 0xe7, 0x13, 0xf9,
+    0xf6, 0x2d, 0xc8, 0xd2, 0xce, 0x09, 0x35, 0x1a, 0x6d, 0x55, 0x7a, 0x5a, 0x21, 0x6e, 0x1b, 0x62,
+    0xf1, 0xf2, 0x49, 0x69, 0x3f, 0x3b, 0x21, 0xf4, 0xb2, 0xe4, 0x05, 0x25, 0x63, 0x28, 0x52, 0xb9,
+    0xd4, 0x50, 0xa1, 0xb6, 0x2b, 0xa9, 0xf4, 0xec, 0x3b, 0x74, 0xc0, 0xae, 0x5a, 0x3c, 0x7e, 0x70,
+    0x12, 0x56, 0x3e, 0x54, 0xf1, 0x4a, 0xe8, 0xb4, 0x59, 0xd8, 0xae, 0x28, 0x17, 0x37, 0x0b, 0xf3,
+    0x1d, 0xaa, 0xec, 0xbe, 0x5a, 0x99, 0x7d, 0xd8, 0x2e, 0xaf, 0xe0, 0xdf, 0x23, 0xad, 0x4b, 0xbb,
+    0xdd, 0xba, 0xfe, 0xb1, 0x96, 0xd3, 0x9e, 0x06, 0x3c, 0xc4, 0xdb, 0x4a, 0x4c, 0x8f, 0x15, 0x02,
+    0x6c, 0xec, 0x47, 0xb4, 0xe9, 0x61, 0x28, 0x11, 0x05, 0x59, 0x89, 0x02, 0xda, 0x94, 0x38, 0xb4,
+    0x46, 0x71, 0x53, 0xa9, 0xa2, 0x03, 0xf2, 0xa6, 0x23, 0xe0, 0xab, 0xb6, 0x07, 0x02, 0x73, 0xf5,
+    0x78, 0x34, 0xa2, 0xe4, 0xc7, 0x4d, 0x4a, 0x86, 0x35, 0x3a, 0xc6, 0x37, 0x01, 0x95, 0xc1, 0xd2,
+    0x68, 0xa5, 0xeb, 0x78, 0xbb, 0x17, 0x89, 0x2c, 0x24, 0x1c, 0x3c, 0x88, 0xae, 0x8d, 0x8f, 0xba,
+    0xa6, 0x6c, 0x6d, 0x30, 0x9a, 0xb8, 0x85, 0x09, 0xdf, 0x2e, 0x77, 0x2b, 0xac, 0x77, 0xa4, 0xa7,
+    0x75, 0xe9, 0x72, 0x32, 0x54, 0xcc, 0xef, 0xa0, 0x84, 0x85, 0xda, 0xdb, 0x14, 0xfb, 0x6b, 0x72,
+    0xf9, 0xce, 0x17, 0x04, 0xbb, 0x2b, 0xb1, 0x39, 0xb7, 0x43, 0x74, 0x8a, 0x00, 0xde, 0xe5, 0x51,
+    0xaf, 0xb9, 0x6a, 0x3d, 0x09, 0x89, 0xf5, 0xa8, 0x83, 0x0c, 0x60, 0x1e, 0x59, 0x99, 0xa8, 0x73,
+    0xa8, 0x83, 0x5e, 0x68, 0x82, 0x4f, 0x36, 0x62, 0x76, 0xc1, 0xcc, 0x22, 0x59, 0x0a, 0x6c, 0x0f,
+    0x3a, 0x6f, 0x7e, 0x20, 0x2f, 0x06, 0xe4, 0x27, 0x08, 0xe8, 0x61, 0xeb, 0x88, 0x23, 0xac, 0x29,
+    0x90, 0x93, 0x2d, 0x8b, 0x44, 0x55, 0x85, 0x76, 0xcd, 0x16, 0x70, 0xd6, 0x5c, 0xc9, 0xa5, 0xeb,
+    0xbe, 0x98, 0x36, 0x4d, 0x03, 0x8c, 0x8d, 0x19, 0x58, 0xbd, 0x17, 0x12, 0xfb, 0x86, 0xeb, 0x88,
+    0xbd, 0xb6, 0xd0, 0x42, 0x25, 0xdc, 0x17, 0xfa, 0x1d, 0x7b, 0xd7, 0xae, 0xb9, 0x76, 0x21, 0x8c,
+    0x14, 0xf6, 0x6c, 0x50, 0x56, 0x3d, 0xea, 0xb0, 0xca, 0xf6, 0x76, 0x03, 0xa0, 0xda, 0xda, 0x4b,
+    0x86, 0x6d, 0x21, 0x4f, 0x98, 0xe9, 0x85, 0x70, 0x5b, 0x93, 0x02, 0x9f, 0x25, 0x46, 0x9e, 0xa3,
+    0x6f, 0x80, 0x15, 0x85, 0x81, 0xa7, 0xfa, 0x8e, 0xc6, 0x6d, 0xa1, 0x9f, 0x22, 0x95, 0x13, 0x1a,
+    0xb7, 0x39, 0x36, 0xb0, 0x00, 0x84, 0x67, 0x8c, 0xd2, 0x1f, 0x42, 0x2d, 0x57, 0x4c, 0xe1, 0xc8,
+    0x90, 0x4b, 0x96, 0x91, 0x08, 0xfa, 0x8b, 0x64, 0x61, 0x96, 0x79, 0xdc, 0x6f, 0xf6, 0x2e, 0x0d,
+    0x7b, 0x53, 0xcc, 0xe5, 0x46, 0xb7, 0xc7, 0x4a, 0x31, 0x82, 0x8f, 0xfe, 0xc7, 0x3e, 0xce, 0xb6,
+    0x40, 0x00, 0x2d, 0x81, 0xd6, 0x34, 0x94, 0x5b, 0x2f, 0x40, 0x04, 0x7d, 0x83, 0xa3, 0x04, 0xb3,
+    0x2c, 0x0c, 0x4e, 0x14, 0xc4, 0x3e, 0xc5, 0x96, 0x29, 0x1b, 0xe7, 0xb7, 0x4a, 0x86, 0xe9, 0x48,
+    0x07, 0x72, 0xfd, 0x23, 0x26, 0xfa, 0x80, 0xcc, 0x2a, 0x91, 0x1b, 0x82, 0x14, 0x60, 0xdf, 0xd9,
+    0xc7, 0xc7, 0x64, 0x29, 0x00, 0xff, 0x8c, 0xa5, 0xb7, 0x0d, 0x97, 0x02, 0xc6, 0xae, 0xfd, 0x1a,
+    0x12, 0x1e, 0x2d, 0x64, 0xc1, 0x69, 0x20, 0xe1, 0xbf, 0xea, 0x69, 0x8c, 0xfc, 0x93, 0x7f, 0x89,
+    0x66, 0xd5, 0x7c, 0x0e, 0x45, 0xdf, 0xc7, 0xd1, 0x51, 0x20, 0x39, 0x55, 0x8a, 0xad, 0x13, 0x84,
+    0x7d, 0x84, 0x18, 0x7c, 0x2f, 0x0a, 0xf3, 0xab, 0x5d, 0xab, 0xb7, 0x83, 0x9b, 0xa8, 0x6f, 0x06,
+    0x40, 0xf2, 0x10, 0x7a, 0xfe, 0x4b, 0x0c, 0xf1, 0xcd, 0x26, 0x98, 0xcf, 0x11, 0xe4, 0x17, 0x3d,
+    0x84, 0x10, 0x26, 0xff, 0x48, 0x48, 0x3f, 0xda, 0xef, 0x57, 0x1c, 0x6e, 0x6a, 0x18, 0x45, 0xe1,
+    0xb0, 0x32, 0xc7, 0x29, 0x72, 0xf7, 0xa4, 0x62, 0x23, 0x86, 0x7b, 0x00, 0xae, 0xf8, 0x4f, 0x7f,
+    0x3c, 0xfc, 0xd4, 0x8e, 0x2e, 0xfb, 0xb8, 0xb4, 0xb5, 0xbe, 0xd8, 0x40, 0x73, 0x5d, 0xe5, 0xc6,
+    0x8e, 0x83, 0x0b, 0x89, 0x4c, 0xc5, 0x40, 0x9b, 0x47, 0x72, 0x32, 0x83, 0x92, 0x00, 0x4f, 0xda,
+    0xd0, 0x0e, 0xa3, 0xf4, 0x0b, 0x02, 0x9a, 0xc8, 0x2a, 0xb3, 0x00, 0x13, 0x29, 0x64, 0x9c, 0x48,
+    0xed, 0x41, 0xcf, 0x8c, 0x64, 0xd1, 0xa3, 0x26, 0x57, 0x9a, 0x2b, 0x30, 0xd9, 0x0d, 0x54, 0xbe,
+    0x44, 0x6c, 0xf4, 0xb4, 0xbd, 0xeb, 0x51, 0x81, 0x25, 0xd3, 0x7a, 0x25, 0x55, 0x56, 0x0b, 0xf5,
+    0x56, 0xa3, 0x7d, 0xb3, 0xca, 0x18, 0x59, 0x3c, 0x15, 0x44, 0x77, 0x06, 0xb5, 0xb7, 0xee, 0x9b,
+    0x24, 0x13, 0x9a, 0xcd, 0x70, 0xa4, 0x3f, 0x86, 0x5c, 0xa8, 0xa7, 0xb8, 0x3d, 0x3f, 0xaa, 0xa6,
+    0x6a, 0x5d, 0x1a, 0x99, 0xe8, 0x6a, 0x66, 0xe0, 0x8c, 0x6c, 0x33, 0xc7, 0xbf, 0x08, 0x6d, 0x34,
+    0xdc, 0x93, 0x85, 0x31, 0xa5, 0x26, 0x25, 0x76, 0x7b, 0x47, 0x50, 0x5b, 0xcd, 0x02, 0x98, 0x1b,
+    0x27, 0x58, 0x64, 0x4d, 0x37, 0xc3, 0x00, 0xd5, 0x63, 0xc7, 0x93, 0x2e, 0x78, 0x7a, 0xab, 0xed,
+    0xba, 0x58, 0x62, 0x21, 0x12, 0x46, 0xf3, 0x7c, 0xde, 0x58, 0x9f, 0x09, 0x10, 0x81, 0x75, 0xc2,
+    0x15, 0xe8, 0xc4, 0x69, 0x45, 0xe6, 0xec, 0xea, 0x3f, 0x69, 0xc2, 0x87, 0x87, 0x9e, 0x30, 0x44,
+    0xe7, 0x99, 0x05, 0x67, 0x14, 0x77, 0x19, 0xa2, 0xf3, 0x5d, 0xe2, 0xe4, 0x47, 0x74, 0xf2, 0xe7,
+    0xe9, 0xf0, 0xc5, 0xcb, 0x5f, 0x7c, 0xd6, 0xc5, 0xfe, 0x1b, 0x9b, 0x13, 0x31, 0x19, 0x37, 0xc2,
+    0xaf, 0x20, 0x07, 0x84, 0xc6, 0x21, 0x08, 0x12, 0x0b, 0x0a, 0x22, 0xa5, 0x41, 0xa4, 0x6d, 0xf1,
+    0xb2, 0xd1, 0x6a, 0xf9, 0xd8, 0xbd, 0x75, 0x5a, 0x7a, 0x94, 0xa5, 0x17, 0x4f, 0x31, 0x56, 0x0b,
+    0xd1, 0xf7, 0xf6, 0x78, 0xf0, 0x87, 0x0f, 0x04, 0x98, 0x75, 0x51, 0x8b, 0xaf, 0x16, 0x3b, 0x64,
+    0xb6, 0x36, 0x5c, 0x27, 0x49, 0x42, 0x7b, 0xb4, 0xe2, 0x93, 0xb7, 0x4f, 0xb2, 0x48, 0x76, 0xa8,
+    0x1a, 0x58, 0xee, 0x04, 0xfe, 0x83, 0xd3, 0xc7, 0xb6, 0x41, 0x81, 0x25, 0x4b, 0x74, 0x83, 0x2d,
+    0x83, 0xd8, 0x92, 0xc3, 0x09, 0x66, 0xf0, 0xfa, 0xea, 0x72, 0x02, 0xd5, 0x60, 0xe3, 0xfd, 0x02,
+    0x6a, 0x1f, 0x90, 0xde, 0x98, 0xdc, 0xd3, 0x53, 0x48, 0x07, 0xa9, 0xc4, 0x57, 0xdb, 0x07, 0xd1,
+    0xb1, 0x4d, 0x0f, 0xf7, 0x93, 0x0b, 0xfe, 0x20, 0x30, 0x9c, 0xae, 0x4b, 0x0e, 0xab, 0x14, 0x7b,
+    0x0a, 0xe1, 0x9a, 0xa5, 0x91, 0x84, 0xfe, 0xd3, 0x40, 0xbb, 0x07, 0x15, 0x74, 0x49, 0x1f, 0x36,
+    0xa5, 0xcf, 0x64, 0xb6, 0x1e, 0x5b, 0xa7, 0xbb, 0x63, 0xdd, 0x0e, 0x12, 0xdc, 0x5d, 0x3a, 0xbc,
+    0x99, 0x98, 0x00, 0x51, 0xd7, 0xa2, 0xd8, 0xce, 0x6b, 0x1d, 0xab, 0xb0, 0xce, 0xd0, 0x00, 0x57,
+    0x9b, 0x57, 0xaf, 0x24, 0x41, 0xf8, 0x9a, 0x15, 0xfc, 0x0d, 0xa4, 0x06, 0x1e, 0xde, 0xa3, 0x19,
+    0xd1, 0xbd, 0xbc, 0x05, 0x37, 0x58, 0xae, 0xb9, 0xa7, 0xe0, 0x31, 0xc1, 0x77, 0x0f, 0xf1, 0x77,
+    0x56, 0x33, 0xcb, 0x69, 0x6e, 0x82, 0xbf, 0xdd, 0x3a, 0x2e, 0xef, 0xc2, 0x0e, 0xd6, 0x5e, 0x50,
+    0x0c, 0x01, 0xc4, 0x33, 0xac, 0x4b, 0x91, 0xab, 0x02, 0x9b, 0xb3, 0x74, 0x48, 0x73, 0x9b, 0x23,
+    0xf4, 0x23, 0x8a, 0xfe, 0xe6, 0x0a, 0xfa, 0x76, 0x48, 0x80, 0x46, 0x85, 0x4d, 0xe9, 0x33, 0xc4,
+    0x67, 0x8b, 0xd4, 0x5d, 0x54, 0xe7, 0x2a, 0x70, 0xc6, 0x73, 0x63, 0xb1, 0xe9, 0xba, 0x2c, 0x16,
+    0x54, 0xce, 0x8e, 0x18, 0xe0, 0x16, 0x80, 0xb5, 0xaf, 0xcd, 0x76, 0x15, 0x18, 0xdb, 0x62, 0xbb,
+    0xd3, 0x0b, 0xf9, 0x94, 0x74, 0x3b, 0x96, 0x9a, 0x44, 0xbb, 0xb4, 0xdb, 0xe6, 0x50, 0x49, 0x18,
+    0x4b, 0xa2, 0x56, 0xdb, 0x15, 0x57, 0x13, 0xec, 0x15, 0x33, 0x32, 0x82, 0x86, 0xe7, 0xc5, 0xcf,
+    0x4e, 0xcc, 0xdb, 0xb3, 0x91, 0xe5, 0xb8, 0x96, 0xcb, 0x06, 0xad, 0x95, 0x00, 0xb1, 0xf2, 0x3d,
+    0xcc, 0x6d, 0x3b, 0xd4, 0xf8, 0x18, 0x60, 0xc2, 0x94, 0x71, 0x42, 0xae, 0xb9, 0x35, 0x10, 0xf2,
+    0x7a, 0x4b, 0xfe, 0x06, 0x3d, 0x6f, 0xa7, 0x7d, 0x82, 0xe6, 0xeb, 0x65, 0xdb, 0xac, 0x3e, 0xd1,
+    0x02, 0x3c, 0xca, 0x27, 0x1d, 0x4c, 0xf8, 0xa6, 0xa0, 0x87, 0x44, 0x88, 0x22, 0xe2, 0x70, 0x4b,
+    0x45, 0xb0, 0x40, 0x3e, 0xb2, 0x59, 0x08, 0xc5, 0xdc, 0x0e, 0x78, 0x8f, 0x57, 0xa8, 0xba, 0xfb,
+    0x6a, 0xba, 0xdb, 0x5e, 0x53, 0x68, 0xe5, 0xf4, 0x67, 0x96, 0xfe, 0x40, 0xf0, 0x2f, 0x58, 0x2d,
+    0x02, 0x1f, 0x9f, 0x16, 0x00, 0x00,
+};
+
+// style.css, 289 bytes gzipped
+static const uint8_t WEB_STYLE_CSS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x5d, 0x91, 0x4b, 0x6e, 0xc3, 0x30,
+    0x0c, 0x44, 0xf7, 0x3d, 0x05, 0x81, 0xa0, 0xbb, 0x3a, 0x50, 0x0a, 0xa4, 0x4e, 0xe5, 0x55, 0x8e,
+    0x42, 0x7d, 0x9c, 0x10, 0x91, 0x45, 0x43, 0x92, 0xf3, 0x69, 0xd1, 0xbb, 0x97, 0x56, 0x5d, 0x24,
+    0x08, 0xb4, 0x12, 0x34, 0x8f, 0x33, 0x1a, 0x1a, 0x76, 0x37, 0xf8, 0x86, 0x9e, 0x63, 0x69, 0x7a,
+    0x1c, 0x28, 0xdc, 0x34, 0xec, 0x13, 0x61, 0x78, 0x83, 0x8c, 0x31, 0x37, 0xd9, 0x27, 0xea, 0x3b,
+    0x18, 0x30, 0x1d, 0x28, 0x6a, 0x78, 0x57, 0xe3, 0xb5, 0x83, 0x9f, 0x97, 0xb5, 0x15, 0x00, 0x29,
+    0xfa, 0x24, 0xf0, 0x80, 0xd7, 0xe6, 0x42, 0xae, 0x1c, 0x35, 0x7c, 0xa8, 0x2a, 0xf8, 0x97, 0x2b,
+    0xc0, 0xa9, 0x70, 0x05, 0x7a, 0x4e, 0x43, 0x73, 0x48, 0x3c, 0x8d, 0x95, 0x98, 0xdf, 0x1b, 0xc3,
+    0xa5, 0xf0, 0xa0, 0x61, 0xb3, 0xfd, 0x9b, 0x1a, 0xd0, 0xf8, 0x20, 0xcf, 0x8e, 0xf2, 0x18, 0x50,
+    0x92, 0x98, 0xc0, 0xf6, 0xd4, 0x3d, 0xcb, 0x17, 0x35, 0xc5, 0x71, 0x2a, 0x12, 0xd3, 0x07, 0x6f,
+    0x8b, 0x50, 0x4b, 0x84, 0x8d, 0x52, 0xaf, 0x1d, 0x8c, 0xe8, 0x1c, 0xc5, 0x83, 0x86, 0xdd, 0x3d,
+    0xcf, 0xdd, 0x6f, 0xf9, 0x85, 0x99, 0xe4, 0x1e, 0x05, 0x35, 0x68, 0x4f, 0x73, 0xb6, 0xe8, 0x34,
+    0xac, 0x94, 0x6a, 0xad, 0xc1, 0x0e, 0x2c, 0x07, 0x4e, 0x1a, 0x2e, 0x47, 0x2a, 0xfe, 0x61, 0xe0,
+    0x0c, 0x2f, 0x3d, 0x18, 0x4e, 0xce, 0x8b, 0x24, 0x72, 0x14, 0x85, 0x9d, 0x52, 0x9e, 0x81, 0x91,
+    0x29, 0x16, 0x9f, 0xee, 0x06, 0xfa, 0xc8, 0xe7, 0x5a, 0xd4, 0x93, 0xcd, 0x16, 0x77, 0x6d, 0xed,
+    0x26, 0x17, 0x2c, 0x53, 0x7e, 0x16, 0xf4, 0x6a, 0x3e, 0x8f, 0xce, 0xdb, 0xc7, 0x6e, 0x6b, 0x0e,
+    0x55, 0xf9, 0x40, 0x67, 0x2f, 0xf4, 0x12, 0x78, 0xd5, 0xb6, 0x32, 0xb6, 0x6e, 0x34, 0xd3, 0x97,
+    0x97, 0x2d, 0xac, 0x3f, 0xfd, 0x30, 0x0b, 0x7f, 0x01, 0xee, 0x0a, 0x27, 0xf1, 0xed, 0x01, 0x00,
+    0x00,
+};
+
+// index.html, 855 bytes gzipped
+static const uint8_t WEB_INDEX_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0xb5, 0x56, 0x4d, 0x6f, 0xe3, 0x36,
+    0x10, 0xbd, 0xef, 0xaf, 0x60, 0x75, 0x28, 0x5a, 0x20, 0xb2, 0xe2, 0x66, 0xbb, 0x68, 0xb6, 0xb2,
+    0x81, 0xed, 0xa6, 0x2d, 0x0a, 0x04, 0x48, 0x00, 0xef, 0x22, 0xe8, 0xa9, 0xa0, 0xc9, 0x91, 0xc5,
+    0x86, 0x12, 0x59, 0x72, 0xe8, 0xac, 0xff, 0x7d, 0x87, 0xa4, 0xd2, 0x28, 0x8e, 0x37, 0xb1, 0x03,
+    0xd7, 0x07, 0x4b, 0x24, 0xdf, 0x3c, 0x3d, 0xce, 0x07, 0x87, 0xf5, 0x37, 0x17, 0x57, 0x1f, 0x3f,
+    0xfd, 0x79, 0xfd, 0x2b, 0x6b, 0xb1, 0xd3, 0xf3, 0x37, 0xf5, 0xfd, 0x03, 0xb8, 0x9c, 0xbf, 0x61,
+    0xf4, 0xab, 0x51, 0xa1, 0x86, 0xf9, 0xa2, 0xe3, 0x0e, 0xd9, 0x07, 0xcd, 0x5d, 0xc7, 0x3e, 0x9a,
+    0xbe, 0x51, 0xab, 0xe0, 0x38, 0x2a, 0xd3, 0xd7, 0x55, 0x06, 0x64, 0x70, 0x07, 0xc8, 0x59, 0xcf,
+    0x3b, 0x98, 0x15, 0x6b, 0x05, 0x77, 0xd6, 0x38, 0x2c, 0x98, 0x30, 0x3d, 0x42, 0x8f, 0xb3, 0xe2,
+    0x4e, 0x49, 0x6c, 0x67, 0x12, 0xd6, 0x4a, 0x40, 0x99, 0x06, 0x27, 0x4c, 0xf5, 0x0a, 0x15, 0xd7,
+    0xa5, 0x17, 0x5c, 0xc3, 0x6c, 0x5a, 0x0c, 0x44, 0x5a, 0xf5, 0xb7, 0xcc, 0x81, 0x9e, 0x15, 0x1e,
+    0x37, 0x1a, 0x7c, 0x0b, 0x40, 0x4c, 0xad, 0x83, 0x66, 0x56, 0x54, 0x69, 0x6a, 0xc2, 0xcf, 0xe1,
+    0xfc, 0x2d, 0x08, 0x3e, 0x11, 0xde, 0x93, 0x59, 0x5d, 0x65, 0xd1, 0xf5, 0xd2, 0xc8, 0xcd, 0xc0,
+    0x22, 0xd5, 0x9a, 0x09, 0xcd, 0xbd, 0x9f, 0x15, 0x51, 0x04, 0x57, 0x3d, 0xb8, 0xe1, 0x0b, 0x69,
+    0xbd, 0x9d, 0x3e, 0xda, 0xd8, 0x62, 0xe3, 0x11, 0x3a, 0x22, 0x9a, 0x3e, 0x60, 0x1e, 0xc0, 0x23,
+    0x32, 0x8f, 0x1c, 0x83, 0x1f, 0x31, 0x65, 0xb6, 0xb3, 0x79, 0x66, 0x60, 0x8b, 0xb4, 0x4e, 0x44,
+    0x67, 0x5b, 0x10, 0x3b, 0xbf, 0x51, 0xbf, 0xa9, 0xf7, 0xac, 0xf6, 0x96, 0xf7, 0x4c, 0xc9, 0xe8,
+    0x93, 0x46, 0x95, 0xf7, 0x7c, 0x97, 0x86, 0x4b, 0xd5, 0xaf, 0x26, 0x93, 0x49, 0x5d, 0x45, 0xc4,
+    0xbc, 0xae, 0xec, 0x13, 0x86, 0x4f, 0xaa, 0x83, 0x31, 0x83, 0x08, 0xce, 0x91, 0x7b, 0x4b, 0xa4,
+    0xf9, 0x3d, 0x29, 0xd2, 0x76, 0xfd, 0x98, 0x84, 0xc7, 0x99, 0x52, 0x98, 0xd0, 0xe3, 0x21, 0x1c,
+    0x4f, 0x29, 0xe2, 0x56, 0x48, 0x46, 0xf9, 0x8c, 0xe5, 0xb5, 0xd2, 0x9a, 0x2d, 0xcd, 0x97, 0xb1,
+    0xb1, 0xa5, 0xb9, 0x92, 0xe6, 0x1e, 0x2c, 0xd9, 0xb7, 0x9d, 0x92, 0xd2, 0xe0, 0xcf, 0xec, 0xf3,
+    0xe2, 0x97, 0x31, 0x34, 0xf8, 0xe5, 0x2e, 0xd4, 0xa5, 0x5a, 0xb5, 0x38, 0xc6, 0xe9, 0x38, 0xf1,
+    0xac, 0x92, 0xfb, 0x70, 0x6a, 0xb5, 0x26, 0xc9, 0x9f, 0xad, 0x24, 0xe9, 0xfe, 0x31, 0xc5, 0x1a,
+    0xca, 0xce, 0x48, 0x5a, 0xb5, 0x46, 0x53, 0x4e, 0xae, 0x76, 0x91, 0xd5, 0x15, 0xa5, 0xc6, 0xae,
+    0x8c, 0x69, 0x7f, 0x48, 0xe1, 0xde, 0x2e, 0x18, 0x9a, 0x7e, 0xc0, 0x34, 0x86, 0x12, 0x8f, 0x8b,
+    0xb8, 0x12, 0x33, 0x1b, 0x30, 0x26, 0x44, 0xc1, 0xa8, 0x90, 0x5a, 0x13, 0xfd, 0x62, 0x3c, 0x6e,
+    0xe7, 0xd9, 0x28, 0x11, 0xa3, 0x75, 0xb9, 0x72, 0x26, 0xd8, 0x2d, 0x50, 0x2e, 0x22, 0xbe, 0x04,
+    0x3d, 0x5f, 0x2c, 0xfe, 0xb8, 0x78, 0x5f, 0x57, 0x79, 0xf0, 0x14, 0xa4, 0x7a, 0x1b, 0x90, 0xe1,
+    0xc6, 0x52, 0xcd, 0x22, 0x7c, 0xa1, 0x2a, 0xcb, 0xf5, 0xeb, 0xbd, 0x92, 0x05, 0x95, 0xe0, 0x3f,
+    0x41, 0x39, 0x90, 0x5b, 0x12, 0x1e, 0xef, 0xf8, 0x35, 0xaa, 0xae, 0x09, 0x79, 0x67, 0x9c, 0xdc,
+    0x53, 0x99, 0x1d, 0xe0, 0xf7, 0xea, 0xfe, 0x1b, 0xbf, 0x2c, 0x6c, 0x19, 0x10, 0x4d, 0x3f, 0xf0,
+    0xf8, 0xb0, 0xec, 0x14, 0x79, 0x94, 0x42, 0xd2, 0x83, 0x40, 0x16, 0xe3, 0x53, 0x57, 0x19, 0x32,
+    0x8e, 0x68, 0xdc, 0xc2, 0x57, 0x42, 0xfa, 0x41, 0xca, 0x7c, 0x5e, 0xbc, 0x14, 0xc9, 0x54, 0x10,
+    0x47, 0x0d, 0x65, 0x2a, 0xfd, 0x3d, 0x43, 0x19, 0x4f, 0x83, 0xc1, 0x59, 0xf9, 0xfd, 0x7f, 0x0b,
+    0xe5, 0x05, 0xdf, 0xf8, 0x67, 0x54, 0x79, 0xd0, 0xd1, 0xd3, 0x59, 0x8a, 0x24, 0xec, 0x0e, 0xa6,
+    0x04, 0x34, 0x36, 0xfa, 0x8e, 0xad, 0xb9, 0x0e, 0x09, 0xa9, 0xf4, 0xa6, 0x20, 0x72, 0x7a, 0xd4,
+    0x55, 0x5e, 0xdb, 0xcb, 0xf0, 0x0e, 0xe0, 0x36, 0x7f, 0xe6, 0x66, 0x78, 0x3b, 0xd8, 0x1c, 0x7a,
+    0x39, 0x98, 0xc7, 0xb7, 0xaf, 0x9b, 0xd3, 0x69, 0x90, 0x36, 0x77, 0x74, 0x97, 0x5e, 0xc6, 0xff,
+    0x57, 0x14, 0x6d, 0xc2, 0x17, 0xcc, 0x6a, 0x2e, 0xa0, 0x35, 0x5a, 0x82, 0x9b, 0x15, 0x57, 0x49,
+    0x3c, 0xd7, 0x2c, 0xe5, 0x23, 0xcb, 0x90, 0xa3, 0x2b, 0x5e, 0x50, 0xeb, 0x90, 0xaf, 0x39, 0x66,
+    0xa2, 0xdd, 0x96, 0xe2, 0x24, 0xf4, 0x84, 0xd9, 0xa0, 0x3d, 0x9c, 0xb0, 0x25, 0x80, 0xfd, 0xab,
+    0xe1, 0x1e, 0x99, 0x71, 0x8c, 0x0e, 0xe6, 0x60, 0x35, 0xf5, 0x27, 0x90, 0xcc, 0x72, 0x44, 0x70,
+    0xfd, 0xf1, 0xf7, 0x72, 0xc3, 0x6f, 0xa1, 0x0c, 0x96, 0x39, 0xde, 0xd9, 0x7d, 0x13, 0x3b, 0x62,
+    0xf7, 0x4b, 0xec, 0xd3, 0x62, 0x7e, 0xd5, 0x34, 0xec, 0xbb, 0x26, 0x50, 0x1b, 0x5c, 0x1b, 0x1d,
+    0x3a, 0xf8, 0xfe, 0xa0, 0x0c, 0x7d, 0x47, 0x0c, 0x53, 0xd6, 0xa9, 0x3e, 0x20, 0x1c, 0x64, 0x38,
+    0xfd, 0x89, 0x2c, 0xcf, 0x06, 0xcb, 0xc3, 0xaa, 0xe2, 0xec, 0x94, 0x4c, 0x7f, 0x7c, 0x95, 0xe9,
+    0xbb, 0x68, 0x3a, 0x3d, 0x7d, 0xd9, 0x76, 0x77, 0x35, 0x3d, 0x75, 0xb5, 0x6f, 0xb9, 0x85, 0xfd,
+    0x7c, 0x6d, 0xc1, 0x09, 0xb0, 0x18, 0x38, 0x65, 0xfc, 0xef, 0x74, 0x49, 0xd2, 0xc0, 0xe8, 0x82,
+    0xe2, 0xf0, 0xa0, 0x0d, 0x50, 0xdf, 0x07, 0x4e, 0xf7, 0xc6, 0xcb, 0xf4, 0x3c, 0xc6, 0x69, 0xb0,
+    0xb3, 0x25, 0x8d, 0xfa, 0xca, 0x73, 0xfd, 0x68, 0xc4, 0x97, 0xc7, 0x5e, 0x38, 0x65, 0x91, 0x79,
+    0x27, 0xa8, 0xed, 0x70, 0x6b, 0x27, 0xe2, 0xed, 0xb4, 0x11, 0xe7, 0x02, 0x26, 0x7f, 0xd3, 0x21,
+    0x46, 0xa2, 0xd2, 0x7a, 0xbc, 0x20, 0xe7, 0x9b, 0x31, 0xb5, 0xad, 0x74, 0xc9, 0xff, 0x17, 0x4b,
+    0xd0, 0x9c, 0x37, 0xfc, 0x0b, 0x00, 0x00,
+};
+
+// ota.html, 530 bytes gzipped
+static const uint8_t WEB_OTA_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x85, 0x54, 0x4b, 0x6f, 0xdb, 0x30,
+    0x0c, 0xbe, 0xf7, 0x57, 0x68, 0x3a, 0x6d, 0x40, 0x63, 0x23, 0x45, 0x2f, 0x29, 0x64, 0x03, 0xc5,
+    0xd2, 0x01, 0x01, 0x0a, 0xc4, 0x18, 0xda, 0xc3, 0x30, 0xec, 0x40, 0x4b, 0x4c, 0xad, 0x45, 0x91,
+    0x04, 0x89, 0x4e, 0x96, 0x7f, 0x3f, 0xf9, 0x91, 0xe6, 0x55, 0x6c, 0xbe, 0xd8, 0x7c, 0x93, 0x1f,
+    0xf9, 0x59, 0x7c, 0x9a, 0x2f, 0xbf, 0xbe, 0xfc, 0xa8, 0x9e, 0x58, 0x43, 0x1b, 0x53, 0xde, 0x88,
+    0xc3, 0x0b, 0x41, 0x95, 0x37, 0x2c, 0x3d, 0x82, 0x34, 0x19, 0x2c, 0x97, 0x2f, 0x8f, 0xec, 0xd5,
+    0x2b, 0x20, 0x14, 0xf9, 0xa0, 0x19, 0xac, 0x1b, 0x24, 0x60, 0x16, 0x36, 0x58, 0xf0, 0xad, 0xc6,
+    0x9d, 0x77, 0x81, 0x38, 0x93, 0xce, 0x12, 0x5a, 0x2a, 0xf8, 0x4e, 0x2b, 0x6a, 0x0a, 0x85, 0x5b,
+    0x2d, 0x71, 0xd2, 0x0b, 0xb7, 0x4c, 0x5b, 0x4d, 0x1a, 0xcc, 0x24, 0x4a, 0x30, 0x58, 0x4c, 0xf9,
+    0x98, 0xc8, 0x68, 0xbb, 0x66, 0x01, 0x4d, 0xc1, 0x23, 0xed, 0x0d, 0xc6, 0x06, 0x31, 0x65, 0x6a,
+    0x02, 0xae, 0x0a, 0x9e, 0xf7, 0xaa, 0x0c, 0x66, 0x38, 0xbb, 0x47, 0x09, 0x99, 0x8c, 0x31, 0x85,
+    0x89, 0x7c, 0xe8, 0x52, 0xd4, 0x4e, 0xed, 0xc7, 0x2c, 0x4a, 0x6f, 0x99, 0x34, 0x10, 0x63, 0xc1,
+    0xbb, 0x26, 0x40, 0x5b, 0x0c, 0x63, 0x85, 0xde, 0xde, 0x4c, 0xcf, 0x26, 0x49, 0xe2, 0xd1, 0xe6,
+    0xcb, 0xef, 0xad, 0xb5, 0xda, 0xbe, 0x3d, 0x30, 0x11, 0x3d, 0x58, 0xa6, 0x55, 0xc1, 0x1d, 0xc1,
+    0xc4, 0x43, 0x48, 0x23, 0x6b, 0x67, 0x79, 0xf9, 0xec, 0x40, 0x25, 0x8f, 0x2c, 0xcb, 0x44, 0xde,
+    0xf9, 0x94, 0x17, 0xae, 0x5b, 0x0c, 0xb1, 0x77, 0x1c, 0xcd, 0x22, 0xf7, 0x67, 0x15, 0x9e, 0x21,
+    0x12, 0x0b, 0xce, 0x98, 0x1a, 0xe4, 0xfa, 0xb2, 0xce, 0x41, 0xcf, 0x4b, 0xeb, 0x2c, 0x7e, 0x94,
+    0xe1, 0x64, 0x90, 0xbb, 0xf2, 0xd5, 0x9b, 0xd4, 0x0d, 0x5b, 0xe9, 0xb0, 0xd9, 0x41, 0x40, 0xe6,
+    0x02, 0x03, 0xa6, 0xd0, 0xa4, 0x85, 0x78, 0x20, 0xd9, 0xa4, 0xf1, 0xee, 0xce, 0x8a, 0x0b, 0x6d,
+    0x7d, 0x4b, 0x8c, 0xf6, 0x3e, 0x6d, 0x6b, 0xa5, 0x0d, 0xf2, 0xf7, 0xd2, 0x83, 0x04, 0x52, 0xa2,
+    0x4f, 0x6b, 0xcb, 0x6a, 0x6d, 0x6f, 0x33, 0x5b, 0x2b, 0x7e, 0x35, 0xc0, 0x59, 0x0e, 0xc2, 0x3f,
+    0x74, 0xcc, 0xd1, 0xc6, 0x84, 0x35, 0xdb, 0x82, 0x69, 0x93, 0xc9, 0xea, 0xb7, 0x86, 0xf6, 0xf5,
+    0x9e, 0x90, 0x27, 0x8c, 0x4e, 0x83, 0x7c, 0xda, 0xce, 0xce, 0x05, 0xc5, 0x4f, 0xf0, 0x3d, 0x68,
+    0xbc, 0x01, 0x89, 0x8d, 0x33, 0x0a, 0x43, 0xc1, 0xbb, 0x45, 0xbd, 0x9b, 0xae, 0x1b, 0xa9, 0x5b,
+    0x22, 0x77, 0x04, 0xaf, 0xed, 0xd1, 0xe0, 0xcc, 0x59, 0x69, 0xb4, 0x5c, 0x17, 0x7c, 0x50, 0x7c,
+    0x1b, 0xd1, 0xf9, 0xfc, 0x85, 0x8f, 0x80, 0x89, 0x7c, 0x88, 0xbc, 0xcc, 0x78, 0x5c, 0x03, 0xc6,
+    0xd6, 0x10, 0xff, 0x07, 0xf2, 0x8f, 0x41, 0xb5, 0xda, 0x3a, 0xb6, 0x98, 0x3f, 0xb1, 0x9c, 0x55,
+    0x06, 0x68, 0xe5, 0xc2, 0x66, 0xb1, 0xbc, 0x42, 0x7c, 0xde, 0x5f, 0x3e, 0x5b, 0x54, 0xa7, 0xab,
+    0x1e, 0xe9, 0xa0, 0xfd, 0x07, 0xe7, 0x74, 0x39, 0x65, 0x87, 0x41, 0x95, 0x38, 0x75, 0x75, 0x92,
+    0x1d, 0xcf, 0xfe, 0x1f, 0x5e, 0x8d, 0xf0, 0x3d, 0xb0, 0x9f, 0x55, 0x70, 0x84, 0x92, 0x50, 0xfd,
+    0x7a, 0x77, 0x12, 0x79, 0xa2, 0xcb, 0xf0, 0x39, 0xc8, 0x51, 0x06, 0xed, 0x89, 0xc5, 0x20, 0x13,
+    0xe7, 0xc0, 0xfb, 0x4c, 0xde, 0x4f, 0x57, 0x72, 0x26, 0x31, 0xfb, 0x1d, 0xfb, 0x93, 0xee, 0xed,
+    0x1d, 0xf3, 0x06, 0xca, 0xa5, 0x79, 0xfb, 0xdf, 0xc5, 0x5f, 0xbe, 0xab, 0x03, 0x08, 0x46, 0x04,
+    0x00, 0x00,
+};
+
+static const WebAsset WEB_ASSETS[] = {
+    {"/app.c41fc9ce.js", "application/javascript", "public, max-age=31536000, immutable", "\"c41fc9cee70387f2\"", WEB_APP_JS_GZ, 2022},
+    {"/style.a9e94eca.css", "text/css", "public, max-age=31536000, immutable", "\"a9e94ecac5bcc31c\"", WEB_STYLE_CSS_GZ, 289},
+    {"/", "text/html", "no-cache", "\"10d70333f6628497\"", WEB_INDEX_HTML_GZ, 855},
+    {"/ota", "text/html", "no-cache", "\"b64f685748ef56ce\"", WEB_OTA_HTML_GZ, 530},
+};
+
+static const uint8_t WEB_ASSET_COUNT = 4;
+
+#endif // WEB_ASSETS_H
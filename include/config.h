@@ -19,6 +19,30 @@
 #define BUZZER_PIN 2              // GPIO2 - Built-in LED pin, good for buzzer
 #define BUZZER_FREQUENCY 2000     // 2kHz frequency for buzzer
 #define BUZZER_CHANNEL 0          // PWM channel for buzzer
+#define TONE_QUEUE_SIZE 8         // Buzzer requests waiting behind the one playing
+#define PATTERN_MAX_BYTES 256     // Largest compiled pattern (bytecode), also per queued request
+#define PATTERN_MAX_LOOP_DEPTH 4  // Nested repeat blocks in a pattern
+#define PATTERN_MAX_SOURCE 2048   // Largest RTTTL/DSL upload in bytes
+#define PATTERN_LIBRARY_MAX 16    // Uploaded patterns kept in flash
+#define PATTERN_NAME_MAX 16       // Characters in an uploaded pattern name
+#define PATTERN_DIRECTORY "/patterns"
+#define TONE_QUEUE_MAX_AGE_MS 10000 // Queued tones older than this are skipped
+#define FADE_SEGMENT_MAX_MS 250   // Longest single LEDC hardware fade (a stop waits for it)
+#define BUZZER_LOCK_RETRY_US 1000 // Step timer retry while another task holds the sequencer lock
+#define FADE_MAX_SEGMENTS 12      // Hardware fades one FADE instruction may be split into
+
+// Sampled audio (optional): clips streamed by I2S DMA to the DAC or as PDM
+#ifndef ENABLE_AUDIO_ENGINE
+#define ENABLE_AUDIO_ENGINE 0     // Build flag: -DENABLE_AUDIO_ENGINE=1 to include AudioEngine
+#endif
+#define AUDIO_OUTPUT_MODE AUDIO_OUTPUT_DAC // AUDIO_OUTPUT_DAC (GPIO25) or AUDIO_OUTPUT_PDM
+#define AUDIO_PDM_PIN 26          // GPIO26 - PDM output, needs an RC low-pass before the amplifier
+#define AUDIO_SAMPLE_RATE 16000   // Clips must be recorded at this rate
+#define AUDIO_DMA_BUFFERS 4       // DMA descriptors; the CPU refills one while the others play
+#define AUDIO_DMA_FRAMES 256      // Frames per DMA buffer (16 ms at 16 kHz)
+#define AUDIO_MAX_VOICES 2        // Clips mixed at once
+#define AUDIO_TASK_PRIORITY 5     // Above the Arduino loop, so playback never starves
+#define AUDIO_DIRECTORY "/audio"
 
 // Pill Box Contact Switch
 #define PILL_BOX_SWITCH_PIN 4     // GPIO4 - Digital input with internal pullup
@@ -27,13 +51,23 @@
 // Light Sensor (LDR with voltage divider)
 #define LIGHT_SENSOR_PIN 36       // GPIO36 (ADC1_CH0) - Analog input only
 #define LIGHT_SAMPLES 10          // Number of samples to average
-#define LIGHT_SAMPLE_DELAY_MS 10  // Delay between samples
+#define LIGHT_SAMPLE_DELAY_MS 10  // Minimum spacing between calibration samples
 #define BEDTIME_LIGHT_THRESHOLD 500 // ADC value below which it's considered dark (0-4095)
 
 // USB Charging Detection
 #define USB_DETECT_PIN 39         // GPIO39 (ADC1_CH3) - Analog input only
 #define USB_VOLTAGE_THRESHOLD 2048 // ADC threshold for 5V detection (assuming voltage divider)
 
+// Battery Sensing (battery+ -> 100k -> GPIO35 -> 100k -> GND)
+#ifndef BATTERY_SENSE_ENABLED
+#define BATTERY_SENSE_ENABLED 0   // Build flag: -DBATTERY_SENSE_ENABLED=1 once the divider is fitted; off, runs as on mains
+#endif
+#define BATTERY_SENSE_PIN 35      // GPIO35 (ADC1_CH7) - Analog input only
+#define BATTERY_ADC_CHANNEL ADC1_CHANNEL_7 // ADC1 channel of BATTERY_SENSE_PIN
+#define BATTERY_DIVIDER_RATIO 2   // Voltage divider ratio on the sense pin
+#define BATTERY_OVERSAMPLE 16     // Raw ADC reads averaged per battery sample
+#define BATTERY_SAMPLE_INTERVAL_MS 10000 // Battery sampling interval (scaled by power profile)
+
 // Status LED (optional - using built-in LED)
 #define STATUS_LED_PIN 2          // GPIO2 - Same as buzzer, will blink when not buzzing
 
@@ -44,16 +78,63 @@
 #define WIFI_SSID_MAX_LENGTH 32
 #define WIFI_PASSWORD_MAX_LENGTH 64
 #define WIFI_CONNECT_TIMEOUT_MS 10000
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 2000   // Reconnect to the cached BSSID/channel before scanning instead
+#define WIFI_BACKOFF_MIN_MS 2000            // First retry after a failed scan-and-connect
+#define WIFI_BACKOFF_MAX_MS 300000          // Retry interval cap; each failure doubles, +-25% jitter
+#define WIFI_AP_FALLBACK_ATTEMPTS 3         // Failures before the setup AP is opened alongside the retries
+
+// Radio Power Policy
+#define RADIO_POLICY_TICK_MS 1000           // How often the radio mode is re-evaluated
+#define RADIO_LISTEN_INTERVAL 3             // Beacon intervals between wake-ups in modem sleep (about 300 ms)
+#define RADIO_QUIET_START_MIN 0             // Quiet window start, minutes after local midnight
+#define RADIO_QUIET_END_MIN 0               // Quiet window end; equal to the start means no quiet window
+#define RADIO_WAKE_LEAD_MS 2000             // Come on this long before a scheduled time sync
+#define RADIO_WAKE_LINGER_MS 5000           // Stay on after the last wake reason is done
+#define RADIO_WAKE_MAX_MS 60000             // A quiet-window wake still busy after this is cut off
+#define RADIO_WAKE_RETRY_MS 900000          // No further wake for this long after a cut-off
+#define RADIO_UI_LINGER_MS 60000            // Full power this long after the last web request
+
+// MQTT Telemetry
+#define MQTT_BROKER ""                      // Host name or address; empty disables telemetry
+#define MQTT_PORT 1883
+#define MQTT_TOPIC_PREFIX "nightybyte"      // Batches go to <prefix>/<device>/telemetry
+#define MQTT_KEEPALIVE_S 60
+#define MQTT_ACK_TIMEOUT_MS 10000           // CONNACK, PUBACK or PINGRESP later than this drops the connection
+#define MQTT_CONNECT_TIMEOUT_MS 5000        // TCP connect to the broker
+#define MQTT_RETRY_MIN_MS 5000              // First reconnect after a failure, then doubling
+#define MQTT_RETRY_MAX_MS 600000
+#define MQTT_PACKET_MAX 896                 // Largest PUBLISH, header and topic included
+#define MQTT_RX_BUFFER 32                   // Only CONNACK, PUBACK and PINGRESP come back
+#define TELEMETRY_PAYLOAD_MAX 768           // One batch of records as JSON
+#define TELEMETRY_BATCH_RECORDS 16          // Records per batch at most
+#define TELEMETRY_RAM_RECORDS 64            // Records queued in RAM (28 bytes each)
+#define TELEMETRY_SEGMENT_RECORDS 32        // Events moved to flash at a time, one file each
+#define TELEMETRY_FLASH_SEGMENTS 16         // Flash segments kept before the oldest is dropped
+#define TELEMETRY_METRICS_INTERVAL_MS 300000    // Light, battery, heap and RSSI sample
+#define TELEMETRY_FLUSH_INTERVAL_MS 3600000     // Quiet-window wake to send queued metrics
+#define TELEMETRY_SEQUENCE_BLOCK 256        // Sequence numbers reserved in NVS at a time
 
 // Time Configuration
 #define NTP_SERVER "pool.ntp.org"
+#define NTP_PORT 123
 #define TIMEZONE_OFFSET_HOURS 0   // UTC offset for your timezone
-#define NTP_UPDATE_INTERVAL_MS 3600000 // Update time every hour
+#define SNTP_TIMEOUT_MS 2000            // Wait this long for a reply
+#define SNTP_RETRY_MIN_S 16             // First retry after a lost or rejected reply, then doubling
+#define SNTP_MIN_POLL_S 64              // Sync interval while the drift estimate settles
+#define SNTP_MAX_POLL_S 32768           // Longest sync interval once drift is known (about 9 h)
+#define SNTP_MAX_DELAY_MS 500           // Replies with a longer round trip are not trusted
+#define SNTP_STEP_THRESHOLD_MS 60000    // Larger offsets are stepped, smaller ones slewed
+#define SNTP_TARGET_ERROR_MS 50         // Clock error allowed to build up between syncs
+#define SNTP_MAX_DRIFT_PPM 500          // Clamp on the oscillator drift estimate
+#define CLOCK_DRIFT_TICK_MS 10000       // How often the drift correction is slewed in
 
 // Alarm Configuration
 #define MAX_ALARMS 5              // Maximum number of alarms
 #define ALARM_BUZZER_DURATION_MS 300000 // 5 minutes maximum buzzer time
 #define ALARM_SNOOZE_DURATION_MS 540000 // 9 minutes snooze time
+#define ALARM_RAMP_MAX_S 600      // Longest wake-up crescendo per alarm
+#define ALARM_RAMP_START_LEVEL 16 // Crescendo starting volume (of 255)
+#define ALARM_LABEL_MAX 32        // Label characters accepted from the web API
 
 // Logging Configuration
 #define LOG_BUFFER_SIZE 1024      // Size of log buffer
@@ -69,18 +150,81 @@
 // Power Management
 #define DEEP_SLEEP_DURATION_US 60000000 // 1 minute deep sleep when idle
 #define LOW_BATTERY_THRESHOLD 3.3       // Voltage threshold for low battery warning
+#define CRITICAL_BATTERY_THRESHOLD 3.15 // Voltage below which the radio is switched off
+#define BATTERY_HYSTERESIS 0.05         // Voltage margin before recovering to a better level
+#define BATTERY_PRESENT_THRESHOLD 2.5   // Below this no battery is considered fitted
+#define BATTERY_MAX_PLAUSIBLE 4.35      // Above this the reading is not a single Li-ion cell
+#define BATTERY_MAX_STEP 0.1            // A larger move between filtered samples is a floating pin, not a cell
+#define BATTERY_CONFIRM_SAMPLES 5       // Steady readings in a row before a battery or a lower level applies
+
+// On-flash Time Series
+#define TS_DIRECTORY "/ts"
+#define TS_MAX_BLOCKS_PER_FILE 512        // 128 KB per channel before rotating
+#define TS_UNCHANGED_KEEPALIVE_S 300      // Store repeated values at most every 5 minutes
 
 // OTA Configuration
 #define OTA_PORT 3232
 #define OTA_PASSWORD "nightybyte2025"
+#define OTA_HTTP_USER "nightybyte"          // Basic auth user for POST /api/ota; password OTA_PASSWORD
+#define OTA_WRITE_CHUNK 4096                // Upload written to flash a sector at a time
+#define OTA_RESTART_DELAY_MS 1000           // After a verified upload, so the response gets out
+#define OTA_HEALTH_MIN_UPTIME_MS 60000      // A new image has to run this long, healthy,
+#define OTA_HEALTH_TIMEOUT_MS 300000        // within this, or the previous image is restored
+#define OTA_HEALTH_MIN_HEAP 40000           // Free heap the health check asks for
+#define OTA_TRIAL_MAX_BOOTS 3               // Restarts of an unconfirmed image before it is rolled back
+#define DELTA_SOURCE_WINDOW 256             // Running image bytes cached while applying a patch
+#define DELTA_OUTPUT_BUFFER 256             // Patched bytes handed on at a time
 
 // Network Settings
 #define WEBSOCKET_PORT 81
 #define HTTP_PORT 80
-
-// Sensor Reading Intervals
+#define COMMAND_QUEUE_SIZE 8              // Commands waiting for the main loop (power of two)
+#define COMMAND_MAX_OPS 4                 // Operations one command can carry
+#define COMMAND_COMPLETION_SLOTS 16       // Recent command outcomes kept for GET /api/commands
+#define API_BUFFER_COUNT 2                // JSON responses being sent at once; more get 503
+#define API_BUFFER_SIZE 4096              // Static buffer per JSON response (fits 180 history buckets)
+#define API_PAGE_RESERVE 48               // Kept free in a paged list for the closing fields
+#define API_LOG_PAGE_MAX 50               // Log entries per /api/logs request
+#define STATUS_CACHE_SIZE 512             // Rendered /status document, reused until its inputs change
+#define STATUS_FIELD_MAX 16               // Fields /status can report (and ?fields= select)
+#define WS_PATH "/ws"                     // Live status WebSocket on WEBSOCKET_PORT
+#define WS_MAX_CLIENTS 4                  // Live status subscribers at once
+#define WS_PUSH_INTERVAL_MS 100           // Changes within one interval go out as one message
+#define LIVE_LIGHT_DEADBAND 32            // Light changes (ADC counts) too small to push
+#define LIVE_MESSAGE_MAX 128              // Longest live status message in bytes
+
+// Sensor Reading Intervals (initial values, adapted at runtime)
 #define LIGHT_SENSOR_INTERVAL_MS 30000    // Read light sensor every 30 seconds
 #define USB_DETECT_INTERVAL_MS 5000       // Check USB charging every 5 seconds
 #define PILL_BOX_CHECK_INTERVAL_MS 100    // Check pill box very frequently when alarm is active
+#define PILL_BOX_ACTIVITY_THRESHOLD 50    // Sampler change (samples are 0 closed / 100 open) treated as lid activity
+
+// Adaptive Sampling Bounds
+#define LIGHT_SENSOR_MIN_INTERVAL_MS 2000     // Fastest light sampling (changing signal, near bedtime)
+#define LIGHT_SENSOR_MAX_INTERVAL_MS 300000   // Slowest light sampling when stable
+#define USB_DETECT_MIN_INTERVAL_MS 1000       // Fastest USB sampling
+#define USB_DETECT_MAX_INTERVAL_MS 60000      // Slowest USB sampling when stable
+#define PILL_BOX_MAX_INTERVAL_MS 1000         // Slowest pill box sampling when no alarm is active
+#define LIGHT_ACTIVITY_THRESHOLD 30           // ADC change treated as real light activity
+#define USB_ACTIVITY_THRESHOLD 200            // ADC change treated as real USB activity
+#define BEDTIME_WINDOW_HOURS 1                // Sample fast this many hours around bedtime
+#define SAMPLING_CLOCK_CHECK_MS 60000         // How often the time-of-day policy is re-evaluated
+#define SAMPLING_STATS_PUBLISH_MS 1000        // How often sampling stats are copied out for /api/sensors
+
+// Sensor Diagnostics
+#define SENSOR_TEST_SAMPLES 10            // Light samples taken during self-test
+#define SENSOR_TEST_SAMPLE_INTERVAL_MS 100 // Spacing between self-test light samples
+
+// Light Trend Detection
+#define LIGHT_TREND_DWELL_S 90            // A shift must last this long to count (shadows are shorter)
+#define LIGHT_TREND_MIN_CONFIDENCE 60     // Confidence (0-100) needed for bedtime and sleep tracking
+#define SLEEP_MIN_DURATION_S 7200         // Shorter dark periods are not counted as a night
+#define SLEEP_MAX_DURATION_S 57600        // Longer dark periods mean nobody was home
+#define SLEEP_MERGE_GAP_S 1800            // Lights on for less than this continues the same night
+
+// Event Bus
+#define EVENT_MAX_SUBSCRIBERS 4           // Listeners per event type
+#define EVENT_QUEUE_SIZE 16               // Deferred events waiting for dispatchPending()
+#define EVENT_MAX_PAYLOAD 24              // Largest event struct in bytes
 
 #endif // CONFIG_H
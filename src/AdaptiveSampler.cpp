@@ -0,0 +1,93 @@
+/**
+ * @file AdaptiveSampler.cpp
+ * @brief Per-channel adaptive sampling interval scheduler implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "AdaptiveSampler.h"
+
+#define MS_PER_HOUR 3600000UL
+
+AdaptiveSampler::AdaptiveSampler(uint32_t minMs, uint32_t maxMs, uint32_t initialMs, int32_t threshold) {
+    minIntervalMs = minMs;
+    maxIntervalMs = maxMs;
+    currentIntervalMs = initialMs < minMs ? minMs : (initialMs > maxMs ? maxMs : initialMs);
+
+    activityThreshold = threshold;
+    activity = 0;
+    lastValue = 0;
+    hasValue = false;
+
+    lastSampleTime = 0;
+    boosted = false;
+    slowdown = 1;
+
+    for (int i = 0; i < SAMPLER_HISTORY_HOURS; i++) {
+        hourlyCounts[i] = 0;
+    }
+    currentHour = 0;
+    totalSamples = 0;
+}
+
+bool AdaptiveSampler::isDue(uint32_t now) const {
+    return !hasValue || now - lastSampleTime >= getInterval();
+}
+
+void AdaptiveSampler::recordSample(uint32_t now, int32_t value) {
+    advanceHour(now / MS_PER_HOUR);
+    if (hourlyCounts[currentHour % SAMPLER_HISTORY_HOURS] < UINT16_MAX) {
+        hourlyCounts[currentHour % SAMPLER_HISTORY_HOURS]++;
+    }
+    totalSamples++;
+    lastSampleTime = now;
+
+    if (!hasValue) {
+        lastValue = value;
+        hasValue = true;
+        return;
+    }
+
+    int32_t delta = value - lastValue;
+    if (delta < 0) delta = -delta;
+    lastValue = value;
+
+    // Smooth the absolute change so a single noisy sample doesn't reset the backoff
+    activity = (activity * 3 + delta * 16) / 4;
+
+    if (delta > activityThreshold) {
+        // Signal is moving: sample as fast as allowed
+        currentIntervalMs = minIntervalMs;
+    } else if (activity <= activityThreshold * 16) {
+        // Signal is stable: back off exponentially
+        currentIntervalMs = currentIntervalMs * 2 > maxIntervalMs ? maxIntervalMs : currentIntervalMs * 2;
+    }
+}
+
+uint32_t AdaptiveSampler::getSamplesLastHour(uint32_t now) {
+    return getSamplesInHour(now, 0);
+}
+
+uint32_t AdaptiveSampler::getSamplesInHour(uint32_t now, uint8_t hoursAgo) {
+    advanceHour(now / MS_PER_HOUR);
+    if (hoursAgo >= SAMPLER_HISTORY_HOURS || hoursAgo > currentHour) {
+        return 0;
+    }
+    return hourlyCounts[(currentHour - hoursAgo) % SAMPLER_HISTORY_HOURS];
+}
+
+void AdaptiveSampler::advanceHour(uint32_t hour) {
+    if (hour == currentHour) {
+        return;
+    }
+
+    // Clear the slots of every hour that passed without samples
+    uint32_t elapsed = hour - currentHour;
+    if (elapsed > SAMPLER_HISTORY_HOURS) {
+        elapsed = SAMPLER_HISTORY_HOURS;
+    }
+    for (uint32_t i = 1; i <= elapsed; i++) {
+        hourlyCounts[(hour - elapsed + i) % SAMPLER_HISTORY_HOURS] = 0;
+    }
+    currentHour = hour;
+}
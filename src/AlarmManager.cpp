@@ -76,9 +76,8 @@ void AlarmManager::update() {
             }
             
             // Keep buzzer active
-            if (buzzerCallback && !buzzerActive) {
-                buzzerCallback(true);
-                buzzerActive = true;
+            if (!buzzerActive) {
+                setBuzzer(true);
             }
             break;
             
@@ -86,7 +85,7 @@ void AlarmManager::update() {
             // Check if snooze period is over
             if (currentTime - snoozeStartTime >= ALARM_SNOOZE_DURATION_MS) {
                 // Re-trigger the alarm
-                currentState = ALARM_TRIGGERED;
+                setState(ALARM_TRIGGERED);
                 alarmStartTime = currentTime;
                 if (logger) {
                     logger->logInfo(EVENT_ALARM_TRIGGERED, 
@@ -101,8 +100,8 @@ void AlarmManager::update() {
             // for it to be closed again before going back to idle
             if (pillBoxCallback && !pillBoxCallback()) {
                 // Pill box is closed, go back to idle
-                currentState = ALARM_IDLE;
                 activeAlarmId = 0;
+                setState(ALARM_IDLE);
                 if (logger) {
                     logger->logInfo(EVENT_PILL_BOX_CLOSED, "Pill box closed, alarm cycle complete");
                 }
@@ -111,7 +110,8 @@ void AlarmManager::update() {
     }
 }
 
-bool AlarmManager::addAlarm(uint8_t hour, uint8_t minute, uint8_t dayMask, const String& label) {
+bool AlarmManager::addAlarm(uint8_t hour, uint8_t minute, uint8_t dayMask, const String& label, const String& sound,
+                            uint16_t rampSeconds, uint8_t rampShape) {
     if (alarms.size() >= MAX_ALARMS) {
         if (logger) logger->logError(EVENT_ALARM_SET, "Cannot add alarm: maximum limit reached");
         return false;
@@ -124,13 +124,16 @@ bool AlarmManager::addAlarm(uint8_t hour, uint8_t minute, uint8_t dayMask, const
     }
     
     Alarm newAlarm;
-    newAlarm.id = alarms.size() + 1; // Simple ID assignment
+    newAlarm.id = nextAlarmId();
     newAlarm.hour = hour;
     newAlarm.minute = minute;
     newAlarm.dayMask = dayMask;
     newAlarm.enabled = true;
     newAlarm.label = label;
     newAlarm.repeating = true;
+    newAlarm.sound = sound;
+    newAlarm.rampSeconds = rampSeconds > ALARM_RAMP_MAX_S ? ALARM_RAMP_MAX_S : rampSeconds;
+    newAlarm.rampShape = rampShape <= RAMP_PERCEPTUAL ? rampShape : RAMP_PERCEPTUAL;
     
     alarms.push_back(newAlarm);
     saveAlarmsToFlash();
@@ -156,7 +159,7 @@ bool AlarmManager::addOneTimeAlarm(uint8_t hour, uint8_t minute, time_t date, co
     }
     
     Alarm newAlarm;
-    newAlarm.id = alarms.size() + 1;
+    newAlarm.id = nextAlarmId();
     newAlarm.hour = hour;
     newAlarm.minute = minute;
     newAlarm.dayMask = 0; // Not used for one-time alarms
@@ -227,9 +230,72 @@ bool AlarmManager::modifyAlarm(uint8_t alarmId, uint8_t hour, uint8_t minute, ui
     return false;
 }
 
+bool AlarmManager::setAlarmSound(uint8_t alarmId, const String& sound) {
+    for (auto& alarm : alarms) {
+        if (alarm.id == alarmId) {
+            alarm.sound = sound;
+            saveAlarmsToFlash();
+            if (logger) {
+                logger->logInfo(EVENT_ALARM_SET, "Alarm sound set",
+                               "ID: " + String(alarmId) + ", Sound: " + (sound.isEmpty() ? "alarm" : sound));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AlarmManager::setAlarmRamp(uint8_t alarmId, uint16_t rampSeconds, uint8_t rampShape) {
+    if (rampShape > RAMP_PERCEPTUAL) {
+        return false;
+    }
+    for (auto& alarm : alarms) {
+        if (alarm.id == alarmId) {
+            alarm.rampSeconds = rampSeconds > ALARM_RAMP_MAX_S ? ALARM_RAMP_MAX_S : rampSeconds;
+            alarm.rampShape = rampShape;
+            saveAlarmsToFlash();
+            if (logger) {
+                logger->logInfo(EVENT_ALARM_SET, "Alarm ramp set",
+                               "ID: " + String(alarmId) + ", Ramp: " + String(alarm.rampSeconds) + "s");
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AlarmManager::updateAlarm(uint8_t alarmId, const Alarm& values) {
+    if (values.hour > 23 || values.minute > 59 || values.rampShape > RAMP_PERCEPTUAL) {
+        return false;
+    }
+    
+    Alarm* alarm = getAlarm(alarmId);
+    if (!alarm) {
+        return false;
+    }
+    
+    alarm->hour = values.hour;
+    alarm->minute = values.minute;
+    alarm->dayMask = values.dayMask;
+    alarm->enabled = values.enabled;
+    alarm->label = values.label;
+    alarm->sound = values.sound;
+    alarm->rampSeconds = values.rampSeconds > ALARM_RAMP_MAX_S ? ALARM_RAMP_MAX_S : values.rampSeconds;
+    alarm->rampShape = values.rampShape;
+    saveAlarmsToFlash();
+    
+    if (logger) {
+        logger->logInfo(EVENT_ALARM_SET, "Alarm updated",
+                       "ID: " + String(alarmId) + ", Time: " + formatTime(alarm->hour, alarm->minute) +
+                       (alarm->enabled ? "" : " (disabled)"));
+    }
+    return true;
+}
+
 void AlarmManager::clearAllAlarms() {
     alarms.clear();
     preferences.clear();
+    publishTable();
     if (logger) {
         logger->logInfo(EVENT_ALARM_SET, "All alarms cleared");
     }
@@ -240,14 +306,11 @@ bool AlarmManager::snoozeCurrentAlarm() {
         return false;
     }
     
-    currentState = ALARM_SNOOZED;
+    setState(ALARM_SNOOZED);
     snoozeStartTime = millis();
     
     // Turn off buzzer
-    if (buzzerCallback) {
-        buzzerCallback(false);
-        buzzerActive = false;
-    }
+    setBuzzer(false);
     
     if (logger) {
         logger->logInfo(EVENT_ALARM_SNOOZED, "Alarm snoozed", 
@@ -271,7 +334,7 @@ void AlarmManager::onPillBoxOpened() {
         }
         
         // Transition to waiting state to detect when pill box is closed
-        currentState = ALARM_WAITING_FOR_PILL_BOX;
+        setState(ALARM_WAITING_FOR_PILL_BOX);
     }
 }
 
@@ -295,6 +358,12 @@ String AlarmManager::getAlarmsStatus() {
         if (!alarm.label.isEmpty()) {
             status += " '" + alarm.label + "'";
         }
+        if (!alarm.sound.isEmpty()) {
+            status += " sound:" + alarm.sound;
+        }
+        if (alarm.rampSeconds > 0) {
+            status += " ramp:" + String(alarm.rampSeconds) + "s";
+        }
         status += "\n";
     }
     
@@ -309,15 +378,12 @@ unsigned long AlarmManager::getAlarmDuration() const {
 }
 
 void AlarmManager::triggerAlarm(uint8_t alarmId) {
-    currentState = ALARM_TRIGGERED;
     activeAlarmId = alarmId;
     alarmStartTime = millis();
+    setState(ALARM_TRIGGERED);
     
     // Turn on buzzer
-    if (buzzerCallback) {
-        buzzerCallback(true);
-        buzzerActive = true;
-    }
+    setBuzzer(true);
     
     if (logger) {
         Alarm* alarm = getAlarm(alarmId);
@@ -328,13 +394,10 @@ void AlarmManager::triggerAlarm(uint8_t alarmId) {
 }
 
 void AlarmManager::stopAlarm() {
-    currentState = ALARM_IDLE;
+    setState(ALARM_IDLE);
     
     // Turn off buzzer
-    if (buzzerCallback) {
-        buzzerCallback(false);
-        buzzerActive = false;
-    }
+    setBuzzer(false);
     
     if (logger && activeAlarmId != 0) {
         logger->logInfo(EVENT_ALARM_STOPPED, "Alarm stopped", 
@@ -345,6 +408,22 @@ void AlarmManager::stopAlarm() {
     alarmStartTime = 0;
 }
 
+void AlarmManager::setState(AlarmState state) {
+    if (state == currentState) {
+        return;
+    }
+    
+    AlarmStateEvent event = {state, currentState, activeAlarmId};
+    currentState = state;
+    EventBus::publish(event);
+}
+
+void AlarmManager::setBuzzer(bool active) {
+    buzzerActive = active;
+    BuzzerEvent event = {active, activeAlarmId};
+    EventBus::publish(event);
+}
+
 void AlarmManager::saveAlarmsToFlash() {
     preferences.putUInt("count", alarms.size());
     
@@ -357,7 +436,61 @@ void AlarmManager::saveAlarmsToFlash() {
         preferences.putString((prefix + "label").c_str(), alarms[i].label);
         preferences.putBool((prefix + "repeat").c_str(), alarms[i].repeating);
         preferences.putULong64((prefix + "date").c_str(), alarms[i].oneTimeDate);
+        preferences.putString((prefix + "sound").c_str(), alarms[i].sound);
+        preferences.putUShort((prefix + "ramp").c_str(), alarms[i].rampSeconds);
+        preferences.putUChar((prefix + "shape").c_str(), alarms[i].rampShape);
+        preferences.putUChar((prefix + "id").c_str(), alarms[i].id);
+    }
+    
+    publishTable();
+}
+
+void AlarmManager::publishTable() {
+    AlarmTable snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    
+    snapshot.count = alarms.size();
+    for (size_t i = 0; i < alarms.size(); i++) {
+        AlarmSummary& summary = snapshot.alarms[i];
+        summary.id = alarms[i].id;
+        summary.hour = alarms[i].hour;
+        summary.minute = alarms[i].minute;
+        summary.dayMask = alarms[i].dayMask;
+        summary.enabled = alarms[i].enabled;
+        summary.repeating = alarms[i].repeating;
+        summary.rampShape = alarms[i].rampShape;
+        summary.rampSeconds = alarms[i].rampSeconds;
+        summary.oneTimeDate = (uint32_t)alarms[i].oneTimeDate;
+        strncpy(summary.label, alarms[i].label.c_str(), ALARM_LABEL_MAX);
+        strncpy(summary.sound, alarms[i].sound.c_str(), PATTERN_NAME_MAX);
     }
+    
+    table.publish(snapshot);
+}
+
+uint8_t AlarmManager::nextAlarmId() const {
+    // Ids stay with their alarm, so a deleted id is never handed to the next one added
+    uint8_t highest = 0;
+    for (const auto& alarm : alarms) {
+        if (alarm.id > highest) {
+            highest = alarm.id;
+        }
+    }
+    if (highest < 255) {
+        return highest + 1;
+    }
+    
+    // Wrapped: fall back to the lowest free id
+    for (uint8_t id = 1; id < 255; id++) {
+        bool used = false;
+        for (const auto& alarm : alarms) {
+            used = used || alarm.id == id;
+        }
+        if (!used) {
+            return id;
+        }
+    }
+    return 255;
 }
 
 void AlarmManager::loadAlarmsFromFlash() {
@@ -369,7 +502,7 @@ void AlarmManager::loadAlarmsFromFlash() {
         String prefix = "alarm_" + String(i) + "_";
         
         Alarm alarm;
-        alarm.id = i + 1;
+        alarm.id = preferences.getUChar((prefix + "id").c_str(), i + 1);
         alarm.hour = preferences.getUChar((prefix + "hour").c_str(), 0);
         alarm.minute = preferences.getUChar((prefix + "minute").c_str(), 0);
         alarm.dayMask = preferences.getUChar((prefix + "days").c_str(), 0);
@@ -377,9 +510,14 @@ void AlarmManager::loadAlarmsFromFlash() {
         alarm.label = preferences.getString((prefix + "label").c_str(), "");
         alarm.repeating = preferences.getBool((prefix + "repeat").c_str(), true);
         alarm.oneTimeDate = preferences.getULong64((prefix + "date").c_str(), 0);
+        alarm.sound = preferences.getString((prefix + "sound").c_str(), "");
+        alarm.rampSeconds = preferences.getUShort((prefix + "ramp").c_str(), 0);
+        alarm.rampShape = preferences.getUChar((prefix + "shape").c_str(), RAMP_PERCEPTUAL);
         
         alarms.push_back(alarm);
     }
+    
+    publishTable();
 }
 
 bool AlarmManager::isAlarmTimeMatched(const Alarm& alarm, struct tm& timeinfo) {
@@ -432,6 +570,9 @@ uint8_t AlarmManager::stringToDayMask(const String& days) {
     if (days.equalsIgnoreCase("weekdays")) return 0x3E;
     if (days.equalsIgnoreCase("weekends")) return 0x41;
     
+    // Numeric bit mask, as the web API reports it
+    if (days.length() > 0 && isDigit(days[0])) return days.toInt() & 0x7F;
+    
     uint8_t mask = 0;
     if (days.indexOf("sun") != -1) mask |= 0x01;
     if (days.indexOf("mon") != -1) mask |= 0x02;
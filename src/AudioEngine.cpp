@@ -0,0 +1,256 @@
+/**
+ * @file AudioEngine.cpp
+ * @brief Sampled-audio alarm playback over I2S DMA implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "AudioEngine.h"
+
+#if ENABLE_AUDIO_ENGINE
+
+#include "PatternLibrary.h"
+
+static const uint32_t BUFFER_PERIOD_US = (uint32_t)AUDIO_DMA_FRAMES * 1000000 / AUDIO_SAMPLE_RATE;
+
+AudioEngine::AudioEngine(Logger* log) {
+    logger = log;
+    output = AUDIO_OUTPUT_MODE;
+    commands = nullptr;
+    task = nullptr;
+    streaming = false;
+    playing = false;
+    loadPermille = 0;
+    for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+        tracks[i].slot = -1;
+        tracks[i].loop = false;
+        tracks[i].playedFrames = 0;
+    }
+}
+
+AudioEngine::~AudioEngine() {
+    if (task) {
+        vTaskDelete(task);
+    }
+    if (commands) {
+        vQueueDelete(commands);
+    }
+    i2s_driver_uninstall(I2S_NUM_0);
+}
+
+bool AudioEngine::begin(AudioOutput mode) {
+    output = mode;
+
+    // The driver cycles through the DMA buffers on its own; underruns play silence
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX |
+                               (output == AUDIO_OUTPUT_DAC ? I2S_MODE_DAC_BUILT_IN : I2S_MODE_PDM));
+    config.sample_rate = AUDIO_SAMPLE_RATE;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+    config.communication_format = output == AUDIO_OUTPUT_DAC ? I2S_COMM_FORMAT_STAND_MSB
+                                                             : I2S_COMM_FORMAT_STAND_I2S;
+    config.intr_alloc_flags = 0;
+    config.dma_buf_count = AUDIO_DMA_BUFFERS;
+    config.dma_buf_len = AUDIO_DMA_FRAMES;
+    config.use_apll = false;
+    config.tx_desc_auto_clear = true;
+
+    if (i2s_driver_install(I2S_NUM_0, &config, 0, nullptr) != ESP_OK) {
+        if (logger) logger->logError(EVENT_SYSTEM_START, "I2S driver install failed");
+        return false;
+    }
+
+    if (output == AUDIO_OUTPUT_DAC) {
+        i2s_set_pin(I2S_NUM_0, nullptr);
+        i2s_set_dac_mode(I2S_DAC_CHANNEL_RIGHT_EN);     // GPIO25
+    } else {
+        i2s_pin_config_t pins = {};
+        pins.bck_io_num = I2S_PIN_NO_CHANGE;
+        pins.ws_io_num = I2S_PIN_NO_CHANGE;
+        pins.data_out_num = AUDIO_PDM_PIN;
+        pins.data_in_num = I2S_PIN_NO_CHANGE;
+        i2s_set_pin(I2S_NUM_0, &pins);
+    }
+    i2s_stop(I2S_NUM_0);    // Clocks only run while something plays
+
+    if (!LittleFS.begin(true)) {
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Failed to mount LittleFS for audio");
+        return false;
+    }
+
+    commands = xQueueCreate(4, sizeof(Command));
+    if (!commands || xTaskCreate(&AudioEngine::taskEntry, "audio", 4096, this,
+                                 AUDIO_TASK_PRIORITY, &task) != pdPASS) {
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Audio task creation failed");
+        return false;
+    }
+
+    if (logger) {
+        logger->logInfo(EVENT_SYSTEM_START, "AudioEngine initialized",
+                        String(output == AUDIO_OUTPUT_DAC ? "DAC GPIO25" : "PDM GPIO" + String(AUDIO_PDM_PIN)) +
+                        ", " + String(AUDIO_SAMPLE_RATE) + " Hz");
+    }
+    return true;
+}
+
+bool AudioEngine::play(const String& name, bool loop, const RampProfile* ramp) {
+    if (!commands || !hasClip(name)) {
+        return false;
+    }
+
+    Command command = {};
+    command.type = AUDIO_COMMAND_PLAY;
+    strncpy(command.name, name.c_str(), PATTERN_NAME_MAX);
+    command.loop = loop;
+    command.ramp = ramp ? *ramp : RampProfile{0, 255, RAMP_NONE};
+
+    // Marked now so callers see the state before the task gets to it
+    if (xQueueSend(commands, &command, 0) != pdTRUE) {
+        return false;
+    }
+    playing = true;
+    return true;
+}
+
+void AudioEngine::stop() {
+    if (!commands) {
+        return;
+    }
+    Command command = {};
+    command.type = AUDIO_COMMAND_STOP;
+    xQueueSend(commands, &command, portMAX_DELAY);
+}
+
+bool AudioEngine::hasClip(const String& name) {
+    return PatternLibrary::isValidName(name) && LittleFS.exists(path(name));
+}
+
+String AudioEngine::path(const String& name) {
+    return String(AUDIO_DIRECTORY) + "/" + name + ".nba";
+}
+
+void AudioEngine::taskEntry(void* arg) {
+    static_cast<AudioEngine*>(arg)->run();
+}
+
+size_t AudioEngine::readFile(void* context, uint8_t* buffer, size_t length) {
+    return static_cast<File*>(context)->read(buffer, length);
+}
+
+void AudioEngine::run() {
+    for (;;) {
+        // Idle: sleep until a command arrives. Playing: pick up commands between buffers.
+        Command command;
+        TickType_t wait = mixer.activeCount() > 0 ? 0 : portMAX_DELAY;
+        while (xQueueReceive(commands, &command, wait) == pdTRUE) {
+            handleCommand(command);
+            wait = 0;
+        }
+
+        if (mixer.activeCount() == 0) {
+            if (streaming) {
+                i2s_zero_dma_buffer(I2S_NUM_0);
+                i2s_stop(I2S_NUM_0);
+                streaming = false;
+            }
+            playing = uxQueueMessagesWaiting(commands) > 0;
+            loadPermille = 0;
+            continue;
+        }
+
+        if (!streaming) {
+            i2s_start(I2S_NUM_0);
+            streaming = true;
+        }
+        fillBuffer();
+    }
+}
+
+void AudioEngine::fillBuffer() {
+    int64_t started = esp_timer_get_time();
+
+    // Ramp levels are set for the end of this buffer; the mixer glides to them
+    for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+        Track& track = tracks[i];
+        if (track.slot < 0) continue;
+        track.playedFrames += AUDIO_DMA_FRAMES;
+        uint32_t elapsedMs = (uint32_t)((uint64_t)track.playedFrames * 1000 / AUDIO_SAMPLE_RATE);
+        mixer.setLevel(track.slot, FadePlanner::rampLevel(track.ramp, elapsedMs));
+    }
+
+    mixer.render(frames, AUDIO_DMA_FRAMES, output);
+
+    for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+        Track& track = tracks[i];
+        if (track.slot >= 0 && mixer.isFinished(track.slot) && !(track.loop && rewind(track))) {
+            stopTrack(track);
+        }
+    }
+
+    // Smoothed share of the buffer period spent decoding and mixing
+    uint32_t busyUs = (uint32_t)(esp_timer_get_time() - started);
+    uint32_t permille = busyUs * 1000 / BUFFER_PERIOD_US;
+    loadPermille = (uint16_t)((loadPermille * 7 + permille) / 8);
+
+    // Blocks until a DMA buffer is free, which is where the task spends its time
+    size_t written = 0;
+    i2s_write(I2S_NUM_0, frames, sizeof(frames), &written, portMAX_DELAY);
+}
+
+void AudioEngine::handleCommand(const Command& command) {
+    if (command.type == AUDIO_COMMAND_STOP) {
+        for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+            stopTrack(tracks[i]);
+        }
+        return;
+    }
+
+    for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+        if (tracks[i].slot < 0) {
+            startTrack(tracks[i], command);
+            return;
+        }
+    }
+    if (logger) logger->logWarning(EVENT_SYSTEM_START, "All audio voices busy, clip dropped", command.name);
+}
+
+bool AudioEngine::startTrack(Track& track, const Command& command) {
+    String name = command.name;
+    track.file = LittleFS.open(path(name), FILE_READ);
+    if (!track.file || !track.decoder.begin(&AudioEngine::readFile, &track.file) ||
+        track.decoder.getHeader().sampleRate != AUDIO_SAMPLE_RATE) {
+        if (track.file) track.file.close();
+        if (logger) logger->logWarning(EVENT_SYSTEM_START, "Audio clip invalid", name);
+        return false;
+    }
+
+    track.loop = command.loop;
+    track.ramp = command.ramp;
+    track.playedFrames = 0;
+    track.slot = mixer.attach(&track.decoder, FadePlanner::rampLevel(track.ramp, 0));
+    if (track.slot < 0) {
+        track.file.close();
+        return false;
+    }
+
+    playing = true;
+    if (logger) logger->logDebug(EVENT_SYSTEM_START, "Audio clip started", name);
+    return true;
+}
+
+bool AudioEngine::rewind(Track& track) {
+    return track.file.seek(0) && track.decoder.begin(&AudioEngine::readFile, &track.file);
+}
+
+void AudioEngine::stopTrack(Track& track) {
+    if (track.slot >= 0) {
+        mixer.detach(track.slot);
+        track.slot = -1;
+    }
+    if (track.file) {
+        track.file.close();
+    }
+}
+
+#endif // ENABLE_AUDIO_ENGINE
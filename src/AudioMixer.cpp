@@ -0,0 +1,93 @@
+/**
+ * @file AudioMixer.cpp
+ * @brief Clip mixing and I2S frame rendering implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "AudioMixer.h"
+
+AudioMixer::AudioMixer() {
+    for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+        voices[i].decoder = nullptr;
+        voices[i].level = 0;
+        voices[i].target = 0;
+    }
+}
+
+int8_t AudioMixer::attach(ClipDecoder* decoder, uint8_t level) {
+    for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+        if (!voices[i].decoder) {
+            voices[i].decoder = decoder;
+            voices[i].level = level;
+            voices[i].target = level;
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+void AudioMixer::detach(uint8_t slot) {
+    if (slot < AUDIO_MAX_VOICES) {
+        voices[slot].decoder = nullptr;
+    }
+}
+
+void AudioMixer::setLevel(uint8_t slot, uint8_t level) {
+    if (slot < AUDIO_MAX_VOICES) {
+        voices[slot].target = level;
+    }
+}
+
+bool AudioMixer::isFinished(uint8_t slot) const {
+    return isAttached(slot) && voices[slot].decoder->finished();
+}
+
+uint8_t AudioMixer::activeCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < AUDIO_MAX_VOICES; i++) {
+        if (voices[i].decoder && !voices[i].decoder->finished()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void AudioMixer::addVoice(Voice& voice, uint16_t frames) {
+    uint16_t samples = voice.decoder->read(voiceBuffer, frames);
+
+    // Gain in Q16 (255 = unity), moving linearly to the target across the block
+    int32_t gain = (int32_t)voice.level * 257;
+    int32_t step = frames > 0 ? (((int32_t)voice.target - voice.level) * 257) / frames : 0;
+    for (uint16_t i = 0; i < samples; i++) {
+        mixBuffer[i] += ((int32_t)voiceBuffer[i] * gain) >> 16;
+        gain += step;
+    }
+    voice.level = voice.target;
+}
+
+void AudioMixer::render(uint16_t* frames, uint16_t count, AudioOutput output) {
+    if (count > AUDIO_DMA_FRAMES) {
+        count = AUDIO_DMA_FRAMES;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        mixBuffer[i] = 0;
+    }
+    for (uint8_t v = 0; v < AUDIO_MAX_VOICES; v++) {
+        if (voices[v].decoder && !voices[v].decoder->finished()) {
+            addVoice(voices[v], count);
+        }
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        int32_t sample = mixBuffer[i];
+        if (sample > 32767) sample = 32767;
+        if (sample < -32768) sample = -32768;
+
+        // The DAC takes offset binary in the top byte; PDM takes two's complement
+        uint16_t slot = (output == AUDIO_OUTPUT_DAC) ? (uint16_t)((sample + 32768) & 0xFF00)
+                                                     : (uint16_t)(int16_t)sample;
+        frames[2 * i] = slot;
+        frames[2 * i + 1] = slot;
+    }
+}
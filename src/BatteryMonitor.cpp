@@ -0,0 +1,80 @@
+/**
+ * @file BatteryMonitor.cpp
+ * @brief Calibrated battery voltage measurement implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "BatteryMonitor.h"
+
+BatteryMonitor::BatteryMonitor() {
+    channel = BATTERY_ADC_CHANNEL;
+    calibrationSource = ESP_ADC_CAL_VAL_DEFAULT_VREF;
+    filteredMillivolts = 0;
+    hasReading = false;
+    
+    for (int i = 0; i < BATTERY_LUT_SIZE; i++) {
+        millivoltLut[i] = 0;
+    }
+}
+
+bool BatteryMonitor::begin() {
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    adc1_config_channel_atten(channel, ADC_ATTEN_DB_11);
+    
+    // Characterize from the eFuse Vref/Two Point values when burned, 1100mV otherwise
+    esp_adc_cal_characteristics_t characteristics;
+    calibrationSource = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                                 1100, &characteristics);
+    
+    // Precompute the linearization once so each sample is a table lookup
+    for (int i = 0; i < BATTERY_LUT_SIZE; i++) {
+        uint32_t raw = min(i * 64, 4095);
+        millivoltLut[i] = esp_adc_cal_raw_to_voltage(raw, &characteristics);
+    }
+    
+    return true;
+}
+
+uint16_t BatteryMonitor::sample() {
+    // Oversample to average out ADC noise
+    uint32_t rawTotal = 0;
+    for (int i = 0; i < BATTERY_OVERSAMPLE; i++) {
+        rawTotal += adc1_get_raw(channel);
+    }
+    uint32_t pinMillivolts = rawToMillivolts((rawTotal + BATTERY_OVERSAMPLE / 2) / BATTERY_OVERSAMPLE);
+    
+    // EWMA (alpha = 1/4) to ride out load transients such as WiFi bursts
+    if (!hasReading) {
+        filteredMillivolts = pinMillivolts * 16;
+        hasReading = true;
+    } else {
+        filteredMillivolts = (filteredMillivolts * 3 + pinMillivolts * 16) / 4;
+    }
+    
+    return getMillivolts();
+}
+
+uint16_t BatteryMonitor::getMillivolts() const {
+    return (uint16_t)((filteredMillivolts * BATTERY_DIVIDER_RATIO + 8) / 16);
+}
+
+uint16_t BatteryMonitor::rawToMillivolts(uint32_t raw) const {
+    uint32_t index = raw >> 6;
+    uint32_t fraction = raw & 63;
+    if (index >= BATTERY_LUT_SIZE - 1) {
+        return millivoltLut[BATTERY_LUT_SIZE - 1];
+    }
+    
+    int32_t low = millivoltLut[index];
+    int32_t high = millivoltLut[index + 1];
+    return (uint16_t)(low + ((high - low) * (int32_t)fraction) / 64);
+}
+
+const char* BatteryMonitor::getCalibrationSource() const {
+    switch (calibrationSource) {
+        case ESP_ADC_CAL_VAL_EFUSE_VREF: return "eFuse Vref";
+        case ESP_ADC_CAL_VAL_EFUSE_TP: return "eFuse Two Point";
+        default: return "Default Vref";
+    }
+}
@@ -0,0 +1,114 @@
+/**
+ * @file BatteryPolicy.cpp
+ * @brief Battery level classification and power-saving profiles implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "BatteryPolicy.h"
+#include <stdlib.h>
+
+BatteryPolicy::BatteryPolicy(uint16_t lowMv, uint16_t criticalMv, uint16_t hysteresisMv, uint16_t presentMv,
+                             uint16_t maxMv, uint16_t maxStepMv, uint8_t confirm) {
+    lowMillivolts = lowMv;
+    criticalMillivolts = criticalMv;
+    hysteresisMillivolts = hysteresisMv;
+    presentMillivolts = presentMv;
+    maxMillivolts = maxMv;
+    maxStepMillivolts = maxStepMv;
+    confirmSamples = confirm > 0 ? confirm : 1;
+    level = BATTERY_EXTERNAL;
+    pending = BATTERY_EXTERNAL;
+    pendingCount = 0;
+    lastMillivolts = 0;
+}
+
+bool BatteryPolicy::update(uint16_t millivolts) {
+    // A cell moves slowly; the first reading has nothing to compare with
+    bool steady = lastMillivolts != 0 && abs((int)millivolts - (int)lastMillivolts) <= maxStepMillivolts;
+    lastMillivolts = millivolts;
+
+    BatteryLevel next;
+    if (millivolts < presentMillivolts || millivolts > maxMillivolts || !steady) {
+        // Divider reads (near) zero, or a floating pin: no battery to act on
+        next = BATTERY_EXTERNAL;
+    } else {
+        next = classify(millivolts);
+    }
+
+    // Acting on a battery (and on a worse level, which cuts sampling and eventually the radio) needs
+    // confirmSamples readings in a row that call for it; any unsteady one starts the count again
+    if (next != BATTERY_EXTERNAL && (level == BATTERY_EXTERNAL || next > level)) {
+        pending = pendingCount == 0 || next < pending ? next : pending;
+        if (++pendingCount < confirmSamples) {
+            return false;
+        }
+        // A battery just found starts no worse than low, so the radio is only cut by a second confirmed fall
+        next = level == BATTERY_EXTERNAL && pending == BATTERY_CRITICAL ? BATTERY_LOW : pending;
+    }
+    pendingCount = 0;
+
+    bool changed = next != level;
+    level = next;
+    return changed;
+}
+
+BatteryLevel BatteryPolicy::classify(uint16_t millivolts) const {
+    // Falling thresholds need no margin, rising ones the hysteresis
+    switch (level) {
+        case BATTERY_LOW:
+            if (millivolts < criticalMillivolts) return BATTERY_CRITICAL;
+            if (millivolts >= lowMillivolts + hysteresisMillivolts) return BATTERY_NORMAL;
+            return BATTERY_LOW;
+
+        case BATTERY_CRITICAL:
+            if (millivolts >= lowMillivolts + hysteresisMillivolts) return BATTERY_NORMAL;
+            if (millivolts >= criticalMillivolts + hysteresisMillivolts) return BATTERY_LOW;
+            return BATTERY_CRITICAL;
+
+        default:
+            if (millivolts < criticalMillivolts) return BATTERY_CRITICAL;
+            if (millivolts < lowMillivolts) return BATTERY_LOW;
+            return BATTERY_NORMAL;
+    }
+}
+
+PowerProfile BatteryPolicy::profileFor(BatteryLevel level) {
+    PowerProfile profile;
+    profile.level = level;
+
+    switch (level) {
+        case BATTERY_LOW:
+            profile.samplingSlowdown = 2;
+            profile.radioEnabled = true;
+            profile.radioPowerSave = true;
+            profile.minLogLevel = 1; // LOG_INFO
+            break;
+
+        case BATTERY_CRITICAL:
+            profile.samplingSlowdown = 4;
+            profile.radioEnabled = false;
+            profile.radioPowerSave = true;
+            profile.minLogLevel = 2; // LOG_WARNING
+            break;
+
+        default:
+            profile.samplingSlowdown = 1;
+            profile.radioEnabled = true;
+            profile.radioPowerSave = false;
+            profile.minLogLevel = 0; // LOG_DEBUG
+            break;
+    }
+
+    return profile;
+}
+
+const char* BatteryPolicy::levelName(BatteryLevel level) {
+    switch (level) {
+        case BATTERY_EXTERNAL: return "External";
+        case BATTERY_NORMAL: return "Normal";
+        case BATTERY_LOW: return "Low";
+        case BATTERY_CRITICAL: return "Critical";
+        default: return "Unknown";
+    }
+}
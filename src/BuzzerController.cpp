@@ -6,53 +6,139 @@
  */
 
 #include "BuzzerController.h"
+#include <esp_idf_version.h>
 
-// Pattern definitions (frequency in Hz, duration in ms, pause in ms)
-const BuzzerTone BuzzerController::alarmPattern[] = {
-    {2000, 500, 200},
-    {2500, 500, 200},
-    {2000, 500, 200},
-    {2500, 500, 1000},
-    {0, 0, 0} // End marker
+// Built-in patterns, compiled to PatternCode bytecode at build time
+static constexpr uint8_t continuousCode[] = {
+    PC_TONE(BUZZER_FREQUENCY, 1000),    // Looped; same pitch, so the output never changes
+    PC_END
 };
 
-const BuzzerTone BuzzerController::successPattern[] = {
-    {1000, 100, 50},
-    {1500, 100, 50},
-    {2000, 200, 0},
-    {0, 0, 0} // End marker
+static constexpr uint8_t beepFastCode[] = {
+    PC_TONE(BUZZER_FREQUENCY, 250), PC_REST(250),
+    PC_END
 };
 
-const BuzzerTone BuzzerController::errorPattern[] = {
-    {500, 300, 100},
-    {400, 300, 100},
-    {300, 500, 0},
-    {0, 0, 0} // End marker
+static constexpr uint8_t beepSlowCode[] = {
+    PC_TONE(BUZZER_FREQUENCY, 1000), PC_REST(1000),
+    PC_END
 };
 
-const BuzzerTone BuzzerController::notificationPattern[] = {
-    {1500, 200, 200},
-    {1500, 200, 0},
-    {0, 0, 0} // End marker
+static constexpr uint8_t pulseCode[] = {
+    // Triangle volume swell, run by the LEDC fade engine rather than duty steps
+    PC_VOLUME(1), PC_TONE(BUZZER_FREQUENCY, 100),
+    PC_FADE(255, 700),
+    PC_FADE(1, 700),
+    PC_END
 };
 
+static constexpr uint8_t alarmCode[] = {
+    PC_LOOP(2),
+        PC_TONE(2000, 500), PC_REST(200),
+        PC_TONE(2500, 500), PC_REST(200),
+    PC_ENDLOOP,
+    PC_REST(800),
+    PC_END
+};
+
+static constexpr uint8_t successCode[] = {
+    PC_TONE(1000, 100), PC_REST(50),
+    PC_TONE(1500, 100), PC_REST(50),
+    PC_TONE(2000, 200),
+    PC_END
+};
+
+static constexpr uint8_t errorCode[] = {
+    PC_TONE(500, 300), PC_REST(100),
+    PC_TONE(400, 300), PC_REST(100),
+    PC_TONE(300, 500),
+    PC_END
+};
+
+static constexpr uint8_t notificationCode[] = {
+    PC_TONE(1500, 200), PC_REST(200),
+    PC_TONE(1500, 200),
+    PC_END
+};
+
+static constexpr uint8_t startupCode[] = {
+    // Ascending tones to indicate system ready
+    PC_TONE(1000, 150), PC_REST(50),
+    PC_TONE(1500, 150), PC_REST(50),
+    PC_TONE(2000, 200),
+    PC_END
+};
+
+static constexpr uint8_t testCode[] = {
+    // Frequency sweep, then the success and error jingles
+    PC_TONE(500, 300), PC_REST(200),
+    PC_TONE(1000, 300), PC_REST(200),
+    PC_TONE(1500, 300), PC_REST(200),
+    PC_TONE(2000, 300), PC_REST(200),
+    PC_TONE(2500, 300), PC_REST(200),
+    PC_TONE(1000, 100), PC_REST(50),
+    PC_TONE(1500, 100), PC_REST(50),
+    PC_TONE(2000, 200), PC_REST(500),
+    PC_TONE(500, 300), PC_REST(100),
+    PC_TONE(400, 300), PC_REST(100),
+    PC_TONE(300, 500),
+    PC_END
+};
+
+struct BuiltinPattern {
+    const uint8_t* code;
+    uint16_t length;
+    bool loop;
+};
+
+// Indexed by BuzzerPattern; names are what alarms refer to
+static const BuiltinPattern builtinPatterns[] = {
+    {nullptr, 0, false},                                    // PATTERN_OFF
+    {continuousCode, sizeof(continuousCode), true},
+    {beepFastCode, sizeof(beepFastCode), true},
+    {beepSlowCode, sizeof(beepSlowCode), true},
+    {pulseCode, sizeof(pulseCode), true},
+    {alarmCode, sizeof(alarmCode), true},
+    {successCode, sizeof(successCode), false},
+    {errorCode, sizeof(errorCode), false},
+    {notificationCode, sizeof(notificationCode), false}
+};
+
+const char* const BuzzerController::builtinNames[] = {
+    "off", "continuous", "beep_fast", "beep_slow", "pulse",
+    "alarm", "success", "error", "notification"
+};
+
+static_assert(sizeof(builtinPatterns) / sizeof(BuiltinPattern) == PATTERN_NOTIFICATION + 1,
+              "builtinPatterns must cover every BuzzerPattern");
+
 BuzzerController::BuzzerController(Logger* log) {
     logger = log;
     buzzerPin = BUZZER_PIN;
     pwmChannel = BUZZER_CHANNEL;
     currentFrequency = BUZZER_FREQUENCY;
     
+    outputFrequency = 0;
+    hardwareFade = false;
+    
     // Initialize state
     currentPattern = PATTERN_OFF;
     isActive = false;
-    patternStartTime = 0;
-    lastToggleTime = 0;
-    patternStep = 0;
-    toneOn = false;
+    patternFinished = false;
+    timerFault = false;
+    stepTimer = nullptr;
+    sequencerLock = nullptr;
+    patternLibrary = nullptr;
 }
 
 BuzzerController::~BuzzerController() {
     stopPattern();
+    if (stepTimer) {
+        esp_timer_delete(stepTimer);
+    }
+    if (sequencerLock) {
+        vSemaphoreDelete(sequencerLock);
+    }
 }
 
 bool BuzzerController::begin(int pin, int channel) {
@@ -66,6 +152,27 @@ bool BuzzerController::begin(int pin, int channel) {
     
     // Start with buzzer off
     ledcWrite(pwmChannel, 0);
+    outputFrequency = currentFrequency;
+    
+    // Volume ramps are handed to the LEDC fade engine, one programming per segment.
+    // Another driver may already have installed the service, which is fine.
+    esp_err_t fadeResult = ledc_fade_func_install(0);
+    hardwareFade = (fadeResult == ESP_OK || fadeResult == ESP_ERR_INVALID_STATE);
+    if (!hardwareFade && logger) {
+        logger->logWarning(EVENT_SYSTEM_START, "LEDC fade service unavailable, volume changes in steps");
+    }
+    
+    // Pattern steps are advanced from a one-shot esp_timer re-armed at each step boundary
+    sequencerLock = xSemaphoreCreateMutex();
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = &BuzzerController::onStepTimer;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "buzzer_step";
+    if (!sequencerLock || esp_timer_create(&timerArgs, &stepTimer) != ESP_OK) {
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Buzzer step timer creation failed");
+        return false;
+    }
     
     if (logger) {
         logger->logInfo(EVENT_SYSTEM_START, "BuzzerController initialized",
@@ -80,8 +187,20 @@ bool BuzzerController::begin(int pin, int channel) {
 }
 
 void BuzzerController::update() {
-    if (currentPattern != PATTERN_OFF && currentPattern != PATTERN_CONTINUOUS) {
-        updatePattern();
+    // One-shot patterns end in the timer callback; finish the bookkeeping here
+    if (patternFinished) {
+        patternFinished = false;
+        currentPattern = PATTERN_OFF;
+        isActive = false;
+        
+        if (logger) {
+            logger->logDebug(EVENT_SYSTEM_START, "Buzzer pattern finished");
+        }
+    }
+    
+    if (timerFault) {
+        timerFault = false;
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Buzzer step timer could not be armed");
     }
 }
 
@@ -94,71 +213,98 @@ void BuzzerController::setBuzzer(bool enabled) {
 }
 
 void BuzzerController::playPattern(BuzzerPattern pattern) {
-    currentPattern = pattern;
-    patternStartTime = millis();
-    lastToggleTime = millis();
-    patternStep = 0;
-    toneOn = false;
+    playPattern(pattern, defaultPriority(pattern));
+}
+
+void BuzzerController::playPattern(BuzzerPattern pattern, TonePriority priority) {
+    if (pattern == PATTERN_OFF) {
+        stopPattern();
+        return;
+    }
+    if (pattern > PATTERN_NOTIFICATION) {
+        return;
+    }
     
-    switch (pattern) {
-        case PATTERN_OFF:
-            stopTone();
-            isActive = false;
-            break;
-            
-        case PATTERN_CONTINUOUS:
-            playTone(currentFrequency, 0);
-            isActive = true;
-            break;
-            
-        case PATTERN_BEEP_FAST:
-        case PATTERN_BEEP_SLOW:
-        case PATTERN_PULSE:
-            isActive = true;
-            break;
-            
-        case PATTERN_ALARM:
-            isActive = true;
-            executePatternStep(alarmPattern, sizeof(alarmPattern) / sizeof(BuzzerTone));
-            break;
-            
-        case PATTERN_SUCCESS:
-            isActive = true;
-            executePatternStep(successPattern, sizeof(successPattern) / sizeof(BuzzerTone));
-            break;
-            
-        case PATTERN_ERROR:
-            isActive = true;
-            executePatternStep(errorPattern, sizeof(errorPattern) / sizeof(BuzzerTone));
-            break;
-            
-        case PATTERN_NOTIFICATION:
-            isActive = true;
-            executePatternStep(notificationPattern, sizeof(notificationPattern) / sizeof(BuzzerTone));
-            break;
+    const BuiltinPattern& builtin = builtinPatterns[pattern];
+    ToneDecision decision = playCode(builtin.code, builtin.length, builtin.loop, priority, pattern);
+    
+    if (logger && decision != TONE_REJECTED) {
+        logger->logDebug(EVENT_SYSTEM_START,
+                         decision == TONE_START_NOW ? "Buzzer pattern started" : "Buzzer pattern queued",
+                         builtinNames[pattern]);
+    }
+}
+
+bool BuzzerController::playSound(const String& name, TonePriority priority, bool loop, const RampProfile* ramp) {
+    BuzzerPattern pattern = name.isEmpty() ? PATTERN_ALARM : patternFromName(name);
+    if (pattern != PATTERN_OFF) {
+        const BuiltinPattern& builtin = builtinPatterns[pattern];
+        return playCode(builtin.code, builtin.length, builtin.loop || loop, priority, pattern, ramp) != TONE_REJECTED;
     }
     
-    if (logger && pattern != PATTERN_OFF) {
-        logger->logDebug(EVENT_SYSTEM_START, "Buzzer pattern started", String(pattern));
+    // Uploaded patterns are copied into the request, so the file is read only once
+    ToneRequest request;
+    request.length = patternLibrary ? patternLibrary->load(name, request.code, PATTERN_MAX_BYTES) : 0;
+    if (request.length == 0) {
+        if (logger) logger->logWarning(EVENT_SYSTEM_START, "Unknown buzzer sound", name);
+        return false;
     }
+    request.pattern = nullptr;
+    request.loop = loop;
+    request.priority = priority;
+    request.tag = PATTERN_CUSTOM;
+    request.ramp = ramp ? *ramp : RampProfile{0, 255, RAMP_NONE};
+    
+    if (submit(request) == TONE_REJECTED) {
+        if (logger) logger->logWarning(EVENT_SYSTEM_START, "Buzzer queue full, sound dropped", name);
+        return false;
+    }
+    return true;
 }
 
 void BuzzerController::stopPattern() {
-    currentPattern = PATTERN_OFF;
-    stopTone();
-    isActive = false;
+    if (stepTimer) {
+        xSemaphoreTake(sequencerLock, portMAX_DELAY);
+        esp_timer_stop(stepTimer);
+        sequencer.stop();
+        toneQueue.clear();
+        stopTone();
+        currentPattern = PATTERN_OFF;
+        isActive = false;
+        patternFinished = false;
+        xSemaphoreGive(sequencerLock);
+    } else {
+        stopTone();
+    }
     
     if (logger) {
         logger->logDebug(EVENT_SYSTEM_START, "Buzzer pattern stopped");
     }
 }
 
+void BuzzerController::stopPriority(TonePriority priority) {
+    if (!stepTimer) {
+        return;
+    }
+    
+    xSemaphoreTake(sequencerLock, portMAX_DELAY);
+    if (toneQueue.removePriority(priority)) {
+        // Whatever was waiting behind the stopped sound plays next
+        esp_timer_stop(stepTimer);
+        sequencer.stop();
+        toneQueue.next(millis(), TONE_QUEUE_MAX_AGE_MS);
+        startCurrent(esp_timer_get_time());
+    }
+    xSemaphoreGive(sequencerLock);
+}
+
 void BuzzerController::playTone(int frequency, int duration) {
     if (frequency > 0) {
         // Update PWM frequency and start tone
         ledcChangeFrequency(pwmChannel, frequency, 8);
         ledcWrite(pwmChannel, 128); // 50% duty cycle (volume control)
         currentFrequency = frequency;
+        outputFrequency = frequency;
         // If duration is specified, set up auto-stop (not implemented)
     } else {
         stopTone();
@@ -166,136 +312,209 @@ void BuzzerController::playTone(int frequency, int duration) {
 }
 
 void BuzzerController::stopTone() {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    if (hardwareFade) {
+        ledc_fade_stop(fadeMode(), fadeChannel());
+    }
+#endif
+    // On IDF 4.4 this waits for a running fade, at most FADE_SEGMENT_MAX_MS
     ledcWrite(pwmChannel, 0); // 0% duty cycle = silence
 }
 
-void BuzzerController::updatePattern() {
-    unsigned long currentTime = millis();
+void BuzzerController::onStepTimer(void* arg) {
+    static_cast<BuzzerController*>(arg)->handleStepTimer();
+}
+
+void BuzzerController::handleStepTimer() {
+    // This runs on the shared esp_timer task, so it must never wait: a holder of the lock may be
+    // stuck behind a duty write for up to FADE_SEGMENT_MAX_MS. Come back shortly instead; if the
+    // holder re-arms the timer for a new sequence meanwhile, that replaces the retry.
+    if (xSemaphoreTake(sequencerLock, 0) != pdTRUE) {
+        esp_timer_start_once(stepTimer, BUZZER_LOCK_RETRY_US);
+        return;
+    }
     
-    switch (currentPattern) {
+    // A callback that waited on the lock while the pattern was stopped or replaced belongs to the
+    // old sequence: the new one's deadline is still ahead and its own timer is already armed
+    int64_t now = esp_timer_get_time();
+    if (sequencer.isRunning() && (int64_t)sequencer.getDeadline() <= now) {
+        // Normally one step; catches up if the timer task was held off past a boundary
+        ToneOutput output;
+        do {
+            sequencer.advance(&output);
+        } while (sequencer.isRunning() && (int64_t)sequencer.getDeadline() <= now);
+        
+        if (sequencer.isRunning()) {
+            applyOutput(output);
+            armStepTimer();
+        } else {
+            // Next queued request starts exactly where this one ended
+            toneQueue.next(millis(), TONE_QUEUE_MAX_AGE_MS);
+            startCurrent(sequencer.getDeadline());
+        }
+    }
+    
+    xSemaphoreGive(sequencerLock);
+}
+
+void BuzzerController::armStepTimer() {
+    // Deadlines are absolute, so handler latency does not add up across steps
+    int64_t delay = (int64_t)sequencer.getDeadline() - esp_timer_get_time();
+    
+    // Starting a timer that is still armed fails, so whatever was pending is replaced
+    esp_timer_stop(stepTimer);
+    if (esp_timer_start_once(stepTimer, delay > 0 ? delay : 0) != ESP_OK) {
+        timerFault = true;      // Reported by update(); the pattern stalls on its current step
+    }
+}
+
+void BuzzerController::applyOutput(const ToneOutput& output) {
+    if (output.frequency == 0) {
+        ledcWrite(pwmChannel, 0);
+        return;
+    }
+    
+    // Reprogramming the LEDC timer is only needed when the pitch changes
+    if (output.frequency != outputFrequency) {
+        ledcChangeFrequency(pwmChannel, output.frequency, 8);
+        outputFrequency = output.frequency;
+    }
+    ledcWrite(pwmChannel, output.duty);
+    
+    // The sequencer keeps each fade within its step, so it has finished by the next write
+    if (output.fadeMs > 0 && hardwareFade) {
+        ledc_set_fade_with_time(fadeMode(), fadeChannel(), output.fadeDuty, (int)output.fadeMs);
+        ledc_fade_start(fadeMode(), fadeChannel(), LEDC_FADE_NO_WAIT);
+    }
+}
+
+void BuzzerController::startCurrent(uint64_t startUs) {
+    // Called with sequencerLock held; skips requests with nothing playable
+    while (toneQueue.isPlaying()) {
+        const ToneRequest& request = toneQueue.getCurrent();
+        ToneOutput output;
+        if (sequencer.start(request.program(), request.length, request.loop, startUs, &output, &request.ramp)) {
+            applyOutput(output);
+            currentPattern = (BuzzerPattern)request.tag;
+            isActive = true;
+            armStepTimer();
+            return;
+        }
+        toneQueue.next(millis(), TONE_QUEUE_MAX_AGE_MS);
+    }
+    
+    ledcWrite(pwmChannel, 0);
+    if (isActive) {
+        patternFinished = true;
+    }
+    currentPattern = PATTERN_OFF;
+    isActive = false;
+}
+
+ToneDecision BuzzerController::submit(ToneRequest& request) {
+    if (!stepTimer) {
+        return TONE_REJECTED;
+    }
+    
+    request.enqueuedAt = millis();
+    
+    // Only held briefly by the timer task, so this never waits on playback; the timer task only
+    // tries it, so a slow duty write in here delays a step, not every esp_timer callback
+    xSemaphoreTake(sequencerLock, portMAX_DELAY);
+    ToneDecision decision = toneQueue.submit(request);
+    if (decision == TONE_START_NOW) {
+        esp_timer_stop(stepTimer);
+        startCurrent(esp_timer_get_time());
+    }
+    xSemaphoreGive(sequencerLock);
+    
+    return decision;
+}
+
+ToneDecision BuzzerController::playCode(const uint8_t* code, uint16_t length, bool loop,
+                                        TonePriority priority, BuzzerPattern tag, const RampProfile* ramp) {
+    // Built-in code lives in flash; the request only points at it
+    ToneRequest request;
+    request.pattern = code;
+    request.length = length;
+    request.loop = loop;
+    request.priority = priority;
+    request.tag = tag;
+    request.ramp = ramp ? *ramp : RampProfile{0, 255, RAMP_NONE};
+    
+    ToneDecision decision = submit(request);
+    if (decision == TONE_REJECTED && logger) {
+        logger->logWarning(EVENT_SYSTEM_START, "Buzzer queue full, pattern dropped",
+                           tag <= PATTERN_NOTIFICATION ? builtinNames[tag] : "tones");
+    }
+    return decision;
+}
+
+void BuzzerController::playBeeps(int frequency, int duration, uint8_t count) {
+    ToneRequest request;
+    PatternWriter writer(request.code, PATTERN_MAX_BYTES);
+    for (uint8_t i = 0; i < count; i++) {
+        if (i > 0) writer.rest(100);
+        writer.tone(frequency, duration);
+    }
+    writer.end();
+    
+    request.pattern = nullptr;
+    request.length = writer.size();
+    request.loop = false;
+    request.priority = TONE_PRIORITY_FEEDBACK;
+    request.tag = PATTERN_TONES;
+    request.ramp = RampProfile{0, 255, RAMP_NONE};
+    
+    if (submit(request) == TONE_REJECTED && logger) {
+        logger->logWarning(EVENT_SYSTEM_START, "Buzzer queue full, tones dropped");
+    }
+}
+
+BuzzerPattern BuzzerController::patternFromName(const String& name) {
+    for (uint8_t i = PATTERN_CONTINUOUS; i <= PATTERN_NOTIFICATION; i++) {
+        if (name == builtinNames[i]) {
+            return (BuzzerPattern)i;
+        }
+    }
+    return PATTERN_OFF;
+}
+
+void BuzzerController::setPatternLibrary(PatternLibrary* library) {
+    patternLibrary = library;
+    if (patternLibrary) {
+        // "off" is not a sound, so that name stays free
+        patternLibrary->setReservedNames(builtinNames + PATTERN_CONTINUOUS, PATTERN_NOTIFICATION);
+    }
+}
+
+TonePriority BuzzerController::defaultPriority(BuzzerPattern pattern) {
+    switch (pattern) {
+        case PATTERN_CONTINUOUS:
         case PATTERN_BEEP_FAST:
-            if (currentTime - lastToggleTime >= 250) { // 250ms on/off
-                toneOn = !toneOn;
-                if (toneOn) {
-                    playTone(currentFrequency, 0);
-                } else {
-                    stopTone();
-                }
-                lastToggleTime = currentTime;
-            }
-            break;
-            
         case PATTERN_BEEP_SLOW:
-            if (currentTime - lastToggleTime >= 1000) { // 1000ms on/off
-                toneOn = !toneOn;
-                if (toneOn) {
-                    playTone(currentFrequency, 0);
-                } else {
-                    stopTone();
-                }
-                lastToggleTime = currentTime;
-            }
-            break;
-            
         case PATTERN_PULSE:
-            // Implement a pulsing pattern with varying intensity
-            if (currentTime - lastToggleTime >= 100) {
-                static int intensity = 0;
-                static int direction = 1;
-                
-                intensity += direction * 32;
-                if (intensity >= 255) {
-                    intensity = 255;
-                    direction = -1;
-                } else if (intensity <= 0) {
-                    intensity = 0;
-                    direction = 1;
-                }
-                
-                ledcWrite(pwmChannel, intensity);
-                lastToggleTime = currentTime;
-            }
-            break;
-            
         case PATTERN_ALARM:
-            executePatternStep(alarmPattern, sizeof(alarmPattern) / sizeof(BuzzerTone));
-            break;
-            
+            return TONE_PRIORITY_ALARM;
         case PATTERN_SUCCESS:
-            executePatternStep(successPattern, sizeof(successPattern) / sizeof(BuzzerTone));
-            break;
-            
         case PATTERN_ERROR:
-            executePatternStep(errorPattern, sizeof(errorPattern) / sizeof(BuzzerTone));
-            break;
-            
         case PATTERN_NOTIFICATION:
-            executePatternStep(notificationPattern, sizeof(notificationPattern) / sizeof(BuzzerTone));
-            break;
-            
+            return TONE_PRIORITY_NOTIFICATION;
         default:
-            break;
-    }
-}
-
-void BuzzerController::executePatternStep(const BuzzerTone* pattern, int patternLength) {
-    unsigned long currentTime = millis();
-    
-    // Check if current step is complete
-    if (!toneOn) {
-        // Start new tone
-        if (patternStep < patternLength - 1 && pattern[patternStep].frequency != 0) {
-            playTone(pattern[patternStep].frequency, 0);
-            toneOn = true;
-            lastToggleTime = currentTime;
-        } else {
-            // End of pattern, restart or stop
-            if (currentPattern == PATTERN_ALARM) {
-                // Restart alarm pattern
-                patternStep = 0;
-            } else {
-                // Stop pattern
-                stopPattern();
-                return;
-            }
-        }
-    } else {
-        // Check if tone duration is complete
-        if (currentTime - lastToggleTime >= pattern[patternStep].duration) {
-            stopTone();
-            toneOn = false;
-            lastToggleTime = currentTime;
-            
-            // Move to pause phase or next step
-            if (pattern[patternStep].pause > 0) {
-                // Wait for pause duration before next step
-                if (currentTime - lastToggleTime >= pattern[patternStep].pause) {
-                    patternStep++;
-                }
-            } else {
-                patternStep++;
-            }
-        }
+            return TONE_PRIORITY_FEEDBACK;
     }
 }
 
 void BuzzerController::playBeep(int frequency, int duration) {
-    playTone(frequency, 0);
-    delay(duration); // Simple blocking beep
-    stopTone();
+    playBeeps(frequency, duration, 1);
 }
 
 void BuzzerController::playDoubleBeep() {
-    playBeep(currentFrequency, 100);
-    delay(100);
-    playBeep(currentFrequency, 100);
+    playBeeps(currentFrequency, 100, 2);
 }
 
 void BuzzerController::playTripleBeep() {
-    for (int i = 0; i < 3; i++) {
-        playBeep(currentFrequency, 100);
-        if (i < 2) delay(100);
-    }
+    playBeeps(currentFrequency, 100, 3);
 }
 
 void BuzzerController::setDefaultFrequency(int frequency) {
@@ -310,39 +529,13 @@ void BuzzerController::performBuzzerTest() {
         logger->logInfo(EVENT_SYSTEM_START, "Starting buzzer test");
     }
     
-    // Test different frequencies
-    int testFrequencies[] = {500, 1000, 1500, 2000, 2500};
-    int numFreqs = sizeof(testFrequencies) / sizeof(int);
-    
-    for (int i = 0; i < numFreqs; i++) {
-        if (logger) {
-            logger->logDebug(EVENT_SYSTEM_START, "Testing frequency", String(testFrequencies[i]) + "Hz");
-        }
-        playBeep(testFrequencies[i], 300);
-        delay(200);
-    }
-    
-    // Test patterns
-    playPattern(PATTERN_SUCCESS);
-    delay(2000);
-    stopPattern();
-    
-    delay(500);
-    
-    playPattern(PATTERN_ERROR);
-    delay(2000);
-    stopPattern();
+    playCode(testCode, sizeof(testCode), false, TONE_PRIORITY_FEEDBACK, PATTERN_TONES);
     
     if (logger) {
-        logger->logInfo(EVENT_SYSTEM_START, "Buzzer test completed");
+        logger->logInfo(EVENT_SYSTEM_START, "Buzzer test queued");
     }
 }
 
 void BuzzerController::playStartupTone() {
-    // Simple ascending tone sequence to indicate system ready
-    playBeep(1000, 150);
-    delay(50);
-    playBeep(1500, 150);
-    delay(50);
-    playBeep(2000, 200);
+    playCode(startupCode, sizeof(startupCode), false, TONE_PRIORITY_FEEDBACK, PATTERN_TONES);
 }
@@ -0,0 +1,138 @@
+/**
+ * @file ClipDecoder.cpp
+ * @brief Streaming decoder for sampled audio clips implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "ClipDecoder.h"
+
+static const int16_t imaStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t imaIndexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+ClipDecoder::ClipDecoder() {
+    reader = nullptr;
+    readContext = nullptr;
+    header.format = CLIP_PCM_U8;
+    header.sampleRate = 0;
+    header.sampleCount = 0;
+    remaining = 0;
+    decodedCount = 0;
+    decodedPos = 0;
+}
+
+bool ClipDecoder::parseHeader(const uint8_t* data, size_t length, ClipHeader* out) {
+    if (length < CLIP_HEADER_BYTES || data[0] != 'N' || data[1] != 'B' || data[2] != 'A' ||
+        data[3] != CLIP_FORMAT_VERSION || data[4] > CLIP_IMA_ADPCM) {
+        return false;
+    }
+    out->format = data[4];
+    out->sampleRate = (uint16_t)(data[6] | (data[7] << 8));
+    out->sampleCount = (uint32_t)data[8] | ((uint32_t)data[9] << 8) |
+                       ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);
+    return out->sampleRate > 0;
+}
+
+bool ClipDecoder::begin(ReadFunction read, void* context) {
+    reader = read;
+    readContext = context;
+    remaining = 0;
+    decodedCount = 0;
+    decodedPos = 0;
+
+    uint8_t raw[CLIP_HEADER_BYTES];
+    if (!reader || reader(readContext, raw, sizeof(raw)) != sizeof(raw) ||
+        !parseHeader(raw, sizeof(raw), &header)) {
+        return false;
+    }
+    remaining = header.sampleCount;
+    return true;
+}
+
+uint16_t ClipDecoder::decodeAdpcmBlock(const uint8_t* block, uint16_t length, int16_t* out) {
+    if (length <= CLIP_ADPCM_HEADER_BYTES) {
+        return 0;
+    }
+
+    int32_t predictor = (int16_t)(block[0] | (block[1] << 8));
+    int32_t index = block[2] > 88 ? 88 : block[2];
+    uint16_t produced = 0;
+
+    for (uint16_t i = CLIP_ADPCM_HEADER_BYTES; i < length; i++) {
+        for (uint8_t shift = 0; shift <= 4; shift += 4) {
+            uint8_t code = (block[i] >> shift) & 0x0F;
+            int32_t step = imaStepTable[index];
+
+            // diff = (code + 0.5) * step / 4, without multiplies
+            int32_t diff = step >> 3;
+            if (code & 4) diff += step;
+            if (code & 2) diff += step >> 1;
+            if (code & 1) diff += step >> 2;
+            predictor += (code & 8) ? -diff : diff;
+            if (predictor > 32767) predictor = 32767;
+            if (predictor < -32768) predictor = -32768;
+
+            index += imaIndexTable[code];
+            if (index < 0) index = 0;
+            if (index > 88) index = 88;
+
+            out[produced++] = (int16_t)predictor;
+        }
+    }
+    return produced;
+}
+
+bool ClipDecoder::refill() {
+    decodedPos = 0;
+    decodedCount = 0;
+
+    size_t bytes = reader(readContext, encoded, CLIP_BLOCK_BYTES);
+    if (header.format == CLIP_IMA_ADPCM) {
+        decodedCount = decodeAdpcmBlock(encoded, (uint16_t)bytes, decoded);
+    } else {
+        for (size_t i = 0; i < bytes; i++) {
+            decoded[i] = (int16_t)(((int16_t)encoded[i] - 128) << 8);
+        }
+        decodedCount = (uint16_t)bytes;
+    }
+
+    // A truncated file ends the clip rather than playing garbage
+    if (decodedCount == 0) {
+        remaining = 0;
+    }
+    return decodedCount > 0;
+}
+
+uint16_t ClipDecoder::read(int16_t* out, uint16_t count) {
+    uint16_t produced = 0;
+    while (produced < count && remaining > 0) {
+        if (decodedPos >= decodedCount && !refill()) {
+            break;
+        }
+
+        uint32_t available = (uint32_t)(decodedCount - decodedPos);
+        uint32_t wanted = (uint32_t)(count - produced);
+        if (available > wanted) available = wanted;
+        if (available > remaining) available = remaining;
+
+        for (uint32_t i = 0; i < available; i++) {
+            out[produced + i] = decoded[decodedPos + i];
+        }
+        produced += (uint16_t)available;
+        decodedPos += (uint16_t)available;
+        remaining -= available;
+    }
+    return produced;
+}
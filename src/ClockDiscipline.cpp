@@ -0,0 +1,101 @@
+/**
+ * @file ClockDiscipline.cpp
+ * @brief Drift estimation and slewing decisions implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "ClockDiscipline.h"
+#include <math.h>
+#include <stdlib.h>
+
+static const double INITIAL_DRIFT_SIGMA_PPM = 100.0;   // Crystal tolerance before the first estimate
+static const double WANDER_PPM_PER_HOUR = 0.05;        // How fast the drift itself moves (temperature)
+static const double TIMESTAMP_NOISE_US = 1000.0;       // Main loop latency in taking the timestamps
+
+ClockDiscipline::ClockDiscipline() {
+    synchronized = false;
+    driftPpm = 0;
+    driftVariance = INITIAL_DRIFT_SIGMA_PPM * INITIAL_DRIFT_SIGMA_PPM;
+    lastSampleUs = 0;
+    lastCorrectionUs = 0;
+    correctionCarryUs = 0;
+    pollIntervalS = SNTP_MIN_POLL_S;
+    lastOffsetUs = 0;
+    sampleCount = 0;
+    stepCount = 0;
+}
+
+ClockCorrection ClockDiscipline::addSample(int64_t offsetUs, uint32_t delayUs, uint64_t monotonicUs,
+                                           int64_t pendingUs) {
+    ClockCorrection correction = {CLOCK_IGNORE, 0};
+    if (delayUs > (uint32_t)SNTP_MAX_DELAY_MS * 1000) {
+        return correction;
+    }
+
+    // Unset or far off: the only case where time jumps. A step also cancels pending slews.
+    int64_t remaining = offsetUs - pendingUs;
+    if (!synchronized || llabs(remaining) > (int64_t)SNTP_STEP_THRESHOLD_MS * 1000) {
+        synchronized = true;
+        lastSampleUs = monotonicUs;
+        lastCorrectionUs = monotonicUs;
+        correctionCarryUs = 0;
+        pollIntervalS = SNTP_MIN_POLL_S;
+        lastOffsetUs = offsetUs;
+        sampleCount++;
+        stepCount++;
+        correction.action = CLOCK_STEP;
+        correction.amountUs = offsetUs;
+        return correction;
+    }
+
+    // Whatever is left after the drift correction up to now is the estimate's error
+    int64_t owed = driftCorrection(monotonicUs);
+    int64_t residual = remaining - owed;
+    double elapsedUs = monotonicUs > lastSampleUs ? (double)(monotonicUs - lastSampleUs) : 1.0;
+    double residualPpm = (double)residual / elapsedUs * 1e6;
+
+    // Kalman update: the offset is known to about half the round trip, spread over the interval
+    double noisePpm = ((double)delayUs / 2.0 + TIMESTAMP_NOISE_US) / elapsedUs * 1e6;
+    double wanderPpm = WANDER_PPM_PER_HOUR * elapsedUs / 3.6e9;
+    driftVariance += wanderPpm * wanderPpm;
+    double gain = driftVariance / (driftVariance + noisePpm * noisePpm);
+    driftPpm += gain * residualPpm;
+    driftVariance *= 1.0 - gain;
+    if (driftPpm > SNTP_MAX_DRIFT_PPM) driftPpm = SNTP_MAX_DRIFT_PPM;
+    if (driftPpm < -SNTP_MAX_DRIFT_PPM) driftPpm = -SNTP_MAX_DRIFT_PPM;
+
+    // Stretch while two sigma over a doubled interval stays in budget; shrink on a surprise
+    double targetUs = (double)SNTP_TARGET_ERROR_MS * 1000;
+    double predictedUs = 2.0 * sqrt(driftVariance) * (2.0 * pollIntervalS);
+    if (llabs(residual) > 2 * (int64_t)targetUs && pollIntervalS > SNTP_MIN_POLL_S) {
+        pollIntervalS /= 2;
+    } else if (predictedUs < targetUs && pollIntervalS < SNTP_MAX_POLL_S) {
+        pollIntervalS *= 2;
+    }
+
+    lastSampleUs = monotonicUs;
+    lastOffsetUs = residual;
+    sampleCount++;
+
+    correction.action = CLOCK_SLEW;
+    correction.amountUs = residual + owed;
+    return correction;
+}
+
+int64_t ClockDiscipline::driftCorrection(uint64_t monotonicUs) {
+    if (!synchronized || monotonicUs <= lastCorrectionUs) {
+        lastCorrectionUs = monotonicUs > lastCorrectionUs ? monotonicUs : lastCorrectionUs;
+        return 0;
+    }
+
+    double amount = driftPpm * (double)(monotonicUs - lastCorrectionUs) / 1e6 + correctionCarryUs;
+    int64_t whole = (int64_t)amount;
+    correctionCarryUs = amount - (double)whole;
+    lastCorrectionUs = monotonicUs;
+    return whole;
+}
+
+double ClockDiscipline::getDriftUncertaintyPpm() const {
+    return sqrt(driftVariance);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file CommandQueue.cpp
+ * @brief Lock-free typed command queue implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "CommandQueue.h"
+
+static_assert((COMMAND_QUEUE_SIZE & (COMMAND_QUEUE_SIZE - 1)) == 0, "COMMAND_QUEUE_SIZE must be a power of two");
+
+CommandQueue::CommandQueue() : enqueuePosition(0), dequeuePosition(0), lastCompleted(0), rejected(0) {
+    for (uint32_t i = 0; i < COMMAND_QUEUE_SIZE; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < COMMAND_COMPLETION_SLOTS; i++) {
+        completions[i].ticket.store(0, std::memory_order_relaxed);
+        for (size_t j = 0; j < RESULT_WORDS; j++) {
+            completions[i].words[j].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint32_t CommandQueue::push(const Command& command) {
+    if (command.count == 0 || command.count > COMMAND_MAX_OPS) {
+        return 0;
+    }
+
+    // Claim the cell at the tail; losing the race to another producer just means trying the next position
+    uint32_t position = enqueuePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells[position & (COMMAND_QUEUE_SIZE - 1)];
+        uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int32_t difference = (int32_t)(sequence - position);
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            rejected.fetch_add(1, std::memory_order_relaxed);       // Still holds a command from a lap ago
+            return 0;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Only the operations in use are copied
+    cell->command.count = command.count;
+    memcpy(cell->command.ops, command.ops, command.count * sizeof(CommandOp));
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return position + 1;
+}
+
+bool CommandQueue::pop(Command* command, uint32_t* ticket) {
+    Cell& cell = cells[dequeuePosition & (COMMAND_QUEUE_SIZE - 1)];
+    uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if ((int32_t)(sequence - (dequeuePosition + 1)) < 0) {
+        return false;       // Empty, or the producer that claimed this cell is still copying
+    }
+
+    command->count = cell.command.count;
+    memcpy(command->ops, cell.command.ops, cell.command.count * sizeof(CommandOp));
+    *ticket = dequeuePosition + 1;
+
+    // Free for the producer one lap ahead
+    cell.sequence.store(dequeuePosition + COMMAND_QUEUE_SIZE, std::memory_order_release);
+    dequeuePosition++;
+    return true;
+}
+
+void CommandQueue::complete(uint32_t ticket, const CommandResult& result) {
+    uint32_t words[RESULT_WORDS] = {};
+    memcpy(words, &result, sizeof(CommandResult));
+
+    Completion& slot = completions[ticket % COMMAND_COMPLETION_SLOTS];
+    slot.ticket.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < RESULT_WORDS; i++) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    slot.ticket.store(ticket, std::memory_order_release);
+    lastCompleted.store(ticket, std::memory_order_release);
+}
+
+CommandStatus CommandQueue::getResult(uint32_t ticket, CommandResult* result) const {
+    if (ticket == 0) {
+        return COMMAND_UNKNOWN;
+    }
+
+    // Read before the slot: anything completed by then is in its slot unless the slot was reused since
+    uint32_t completed = lastCompleted.load(std::memory_order_acquire);
+
+    const Completion& slot = completions[ticket % COMMAND_COMPLETION_SLOTS];
+    while (slot.ticket.load(std::memory_order_acquire) == ticket) {
+        uint32_t words[RESULT_WORDS];
+        for (size_t i = 0; i < RESULT_WORDS; i++) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.ticket.load(std::memory_order_relaxed) == ticket) {
+            memcpy(result, words, sizeof(CommandResult));
+            return result->status;
+        }
+    }
+
+    uint32_t issued = enqueuePosition.load(std::memory_order_acquire);
+    if ((int32_t)(ticket - completed) > 0 && (int32_t)(ticket - issued) <= 0) {
+        return COMMAND_PENDING;
+    }
+    return COMMAND_UNKNOWN;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file DeltaDecoder.cpp
+ * @brief Streaming NBD1 delta patch decoder implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "DeltaDecoder.h"
+#include <string.h>
+
+static const uint8_t DELTA_MAGIC[4] = {'N', 'B', 'D', '1'};
+
+static uint32_t readLittleEndian(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+DeltaDecoder::DeltaDecoder() {
+    readSource = nullptr;
+    writeTarget = nullptr;
+    context = nullptr;
+    reset();
+}
+
+void DeltaDecoder::begin(ReadFunction read, WriteFunction write, void* ctx) {
+    readSource = read;
+    writeTarget = write;
+    context = ctx;
+}
+
+void DeltaDecoder::reset() {
+    stage = STAGE_HEADER;
+    memset(&header, 0, sizeof(header));
+    varint = 0;
+    varintShift = 0;
+    controlField = 0;
+    diffLeft = 0;
+    extraLeft = 0;
+    seek = 0;
+    tokenLeft = 0;
+    sourcePos = 0;
+    produced = 0;
+    consumed = 0;
+    error = "";
+    windowStart = 0;
+    windowLength = 0;
+}
+
+DeltaStatus DeltaDecoder::feed(const uint8_t* data, size_t length, size_t* used) {
+    *used = 0;
+    if (stage == STAGE_FAILED) {
+        return DELTA_ERROR;
+    }
+
+    size_t at = 0;
+    while (at < length) {
+        bool ok = true;
+        bool complete = false;
+        size_t take;
+
+        switch (stage) {
+            case STAGE_HEADER:
+                take = DELTA_HEADER_BYTES - consumed;
+                if (take > length - at) {
+                    take = length - at;
+                }
+                memcpy(headerBytes + consumed, data + at, take);
+                at += take;
+                consumed += take;
+                if (consumed == DELTA_HEADER_BYTES) {
+                    *used = at;
+                    return parseHeader() ? DELTA_HEADER : DELTA_ERROR;
+                }
+                break;
+
+            case STAGE_CONTROL:
+                consumed++;
+                ok = readVarint(data[at++], &complete);
+                if (!ok || !complete) {
+                    break;
+                }
+                if (controlField == 0) {
+                    diffLeft = varint;
+                } else if (controlField == 1) {
+                    extraLeft = varint;
+                } else {
+                    seek = (int32_t)(varint >> 1) ^ -(int32_t)(varint & 1);
+                }
+                varint = 0;
+                varintShift = 0;
+                if (++controlField == 3) {
+                    ok = startBlock();
+                }
+                break;
+
+            case STAGE_TOKEN: {
+                consumed++;
+                ok = readVarint(data[at++], &complete);
+                if (!ok || !complete) {
+                    break;
+                }
+                uint32_t count = varint >> 1;
+                bool added = varint & 1;
+                varint = 0;
+                varintShift = 0;
+                if (count == 0 || count > diffLeft) {
+                    ok = fail("Patch is malformed");
+                } else if (added) {
+                    tokenLeft = count;
+                    stage = STAGE_ADD;
+                } else {
+                    diffLeft -= count;
+                    ok = copySource(count) && nextPart();
+                }
+                break;
+            }
+
+            case STAGE_ADD:
+                take = tokenLeft < DELTA_OUTPUT_BUFFER ? tokenLeft : DELTA_OUTPUT_BUFFER;
+                if (take > length - at) {
+                    take = length - at;
+                }
+                for (size_t i = 0; i < take && ok; i++) {
+                    ok = loadWindow(sourcePos);
+                    if (ok) {
+                        output[i] = window[sourcePos - windowStart] + data[at + i];
+                        sourcePos++;
+                    }
+                }
+                at += take;
+                consumed += take;
+                tokenLeft -= take;
+                diffLeft -= take;
+                ok = ok && emit(output, take);
+                if (ok && tokenLeft == 0) {
+                    ok = nextPart();
+                }
+                break;
+
+            case STAGE_EXTRA:
+                take = extraLeft < length - at ? extraLeft : length - at;
+                ok = emit(data + at, take);
+                at += take;
+                consumed += take;
+                extraLeft -= take;
+                if (ok && extraLeft == 0) {
+                    ok = endBlock();
+                }
+                break;
+
+            case STAGE_DONE:
+                ok = fail("Data after the end of the patch");
+                break;
+
+            case STAGE_FAILED:
+                ok = false;
+                break;
+        }
+
+        if (!ok) {
+            *used = at;
+            return DELTA_ERROR;
+        }
+    }
+
+    *used = at;
+    return stage == STAGE_DONE ? DELTA_DONE : DELTA_MORE;
+}
+
+bool DeltaDecoder::parseHeader() {
+    if (memcmp(headerBytes, DELTA_MAGIC, sizeof(DELTA_MAGIC)) != 0) {
+        return fail("Not an NBD1 patch");
+    }
+    header.sourceSize = readLittleEndian(headerBytes + 4);
+    memcpy(header.sourceSha256, headerBytes + 8, DELTA_SHA256_BYTES);
+    header.targetSize = readLittleEndian(headerBytes + 8 + DELTA_SHA256_BYTES);
+    memcpy(header.targetSha256, headerBytes + 12 + DELTA_SHA256_BYTES, DELTA_SHA256_BYTES);
+    if (header.targetSize == 0) {
+        return fail("Patch is malformed");
+    }
+    stage = STAGE_CONTROL;
+    return true;
+}
+
+bool DeltaDecoder::readVarint(uint8_t byte, bool* complete) {
+    // 32 bits at most: four full groups and four bits of a fifth
+    if (varintShift > 28 || (varintShift == 28 && (byte & 0x70))) {
+        return fail("Patch is malformed");
+    }
+    varint |= (uint32_t)(byte & 0x7F) << varintShift;
+    varintShift += 7;
+    *complete = !(byte & 0x80);
+    return true;
+}
+
+bool DeltaDecoder::startBlock() {
+    controlField = 0;
+
+    // Checked once here, so the byte loops need no bounds checks of their own
+    if ((uint64_t)produced + diffLeft + extraLeft > header.targetSize ||
+        (uint64_t)sourcePos + diffLeft > header.sourceSize) {
+        return fail("Patch is malformed");
+    }
+    return nextPart();
+}
+
+bool DeltaDecoder::nextPart() {
+    if (diffLeft > 0) {
+        stage = STAGE_TOKEN;
+        return true;
+    }
+    if (extraLeft > 0) {
+        stage = STAGE_EXTRA;
+        return true;
+    }
+    return endBlock();
+}
+
+bool DeltaDecoder::endBlock() {
+    int64_t position = (int64_t)sourcePos + seek;
+    if (position < 0 || position > header.sourceSize) {
+        return fail("Patch is malformed");
+    }
+    sourcePos = (uint32_t)position;
+    stage = produced == header.targetSize ? STAGE_DONE : STAGE_CONTROL;
+    return true;
+}
+
+bool DeltaDecoder::copySource(uint32_t length) {
+    while (length > 0) {
+        if (!loadWindow(sourcePos)) {
+            return false;
+        }
+        uint32_t available = windowStart + windowLength - sourcePos;
+        uint32_t count = length < available ? length : available;
+        if (!emit(window + (sourcePos - windowStart), count)) {
+            return false;
+        }
+        sourcePos += count;
+        length -= count;
+    }
+    return true;
+}
+
+bool DeltaDecoder::loadWindow(uint32_t position) {
+    if (position >= windowStart && position < windowStart + windowLength) {
+        return true;
+    }
+    uint32_t length = header.sourceSize - position;
+    if (length > DELTA_SOURCE_WINDOW) {
+        length = DELTA_SOURCE_WINDOW;
+    }
+    if (!readSource || !readSource(context, position, window, length)) {
+        windowLength = 0;
+        return fail("Could not read the running firmware");
+    }
+    windowStart = position;
+    windowLength = length;
+    return true;
+}
+
+bool DeltaDecoder::emit(const uint8_t* data, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+    if (!writeTarget || !writeTarget(context, data, length)) {
+        return fail("Could not write the new firmware");
+    }
+    produced += length;
+    return true;
+}
+
+bool DeltaDecoder::fail(const char* reason) {
+    error = reason;
+    stage = STAGE_FAILED;
+    return false;
+}
+
+bool DeltaDecoder::isPatch(const uint8_t* data, size_t length) {
+    size_t count = length < sizeof(DELTA_MAGIC) ? length : sizeof(DELTA_MAGIC);
+    return count > 0 && memcmp(data, DELTA_MAGIC, count) == 0;
+}
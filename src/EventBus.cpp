@@ -0,0 +1,40 @@
+/**
+ * @file EventBus.cpp
+ * @brief Deferred event ring for the typed event bus
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "EventBus.h"
+
+EventBus::PendingEvent EventBus::queue[EVENT_QUEUE_SIZE];
+uint8_t EventBus::queueHead = 0;
+uint8_t EventBus::queueCount = 0;
+uint32_t EventBus::droppedEvents = 0;
+
+bool EventBus::enqueue(Dispatcher dispatch, const void* event, size_t size) {
+    if (queueCount >= EVENT_QUEUE_SIZE) {
+        droppedEvents++;
+        return false;
+    }
+
+    PendingEvent& slot = queue[(queueHead + queueCount) % EVENT_QUEUE_SIZE];
+    slot.dispatch = dispatch;
+    memcpy(slot.payload, event, size);
+    queueCount++;
+    return true;
+}
+
+uint8_t EventBus::dispatchPending() {
+    // Events posted by handlers wait for the next call, so one pass is bounded
+    uint8_t toDeliver = queueCount;
+
+    for (uint8_t i = 0; i < toDeliver; i++) {
+        PendingEvent& slot = queue[queueHead];
+        queueHead = (queueHead + 1) % EVENT_QUEUE_SIZE;
+        queueCount--;
+        slot.dispatch(slot.payload);
+    }
+
+    return toDeliver;
+}
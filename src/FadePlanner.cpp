@@ -0,0 +1,86 @@
+/**
+ * @file FadePlanner.cpp
+ * @brief Volume ramps and LEDC hardware fade planning implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "FadePlanner.h"
+
+uint32_t FadePlanner::maxFadeMs(uint32_t dutyDelta, uint32_t pwmFrequency) {
+    if (pwmFrequency == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)dutyDelta * LEDC_FADE_MAX_CYCLES * 1000 / pwmFrequency);
+}
+
+uint8_t FadePlanner::plan(uint8_t fromDuty, uint8_t toDuty, uint32_t durationMs, uint32_t pwmFrequency,
+                          FadeSegment* segments, uint8_t maxSegments) {
+    if (maxSegments == 0) {
+        return 0;
+    }
+
+    uint32_t delta = fromDuty > toDuty ? fromDuty - toDuty : toDuty - fromDuty;
+    if (delta == 0 || durationMs == 0 || pwmFrequency == 0) {
+        segments[0].duty = toDuty;
+        segments[0].fadeMs = 0;
+        segments[0].durationMs = durationMs;
+        return 1;
+    }
+
+    // Enough slices to keep each hardware fade short, and one per duty step
+    // when even the slowest fade would finish too early
+    uint32_t count = (durationMs + FADE_SEGMENT_MAX_MS - 1) / FADE_SEGMENT_MAX_MS;
+    if (maxFadeMs(delta, pwmFrequency) < durationMs && delta > count) {
+        count = delta;
+    }
+    if (count > delta) count = delta;
+    if (count > maxSegments) count = maxSegments;
+
+    // Each slice fades as slowly as allowed and holds for the rest of it
+    int32_t span = (int32_t)toDuty - (int32_t)fromDuty;
+    uint8_t previousDuty = fromDuty;
+    uint32_t previousEnd = 0;
+
+    for (uint32_t i = 1; i <= count; i++) {
+        uint8_t duty = (uint8_t)((int32_t)fromDuty + span * (int32_t)i / (int32_t)count);
+        uint32_t end = (uint32_t)((uint64_t)durationMs * i / count);
+        uint32_t sliceMs = end - previousEnd;
+        uint32_t stepDelta = duty > previousDuty ? duty - previousDuty : previousDuty - duty;
+        uint32_t fadeMs = maxFadeMs(stepDelta, pwmFrequency);
+        if (fadeMs > sliceMs) fadeMs = sliceMs;
+        if (fadeMs > FADE_SEGMENT_MAX_MS) fadeMs = FADE_SEGMENT_MAX_MS;
+
+        segments[i - 1].duty = duty;
+        segments[i - 1].fadeMs = fadeMs;
+        segments[i - 1].durationMs = sliceMs;
+
+        previousDuty = duty;
+        previousEnd = end;
+    }
+    return (uint8_t)count;
+}
+
+uint8_t FadePlanner::rampLevel(const RampProfile& profile, uint32_t elapsedMs) {
+    uint32_t totalMs = (uint32_t)profile.durationS * 1000;
+    if (profile.shape == RAMP_NONE || totalMs == 0 || elapsedMs >= totalMs) {
+        return 255;
+    }
+
+    // Progress in 1/65536ths, squared for the perceptual curve
+    uint32_t progress = (uint32_t)((uint64_t)elapsedMs * 65536 / totalMs);
+    if (profile.shape == RAMP_PERCEPTUAL) {
+        progress = (uint32_t)(((uint64_t)progress * progress) >> 16);
+    }
+
+    uint32_t range = 255 - profile.startLevel;
+    return (uint8_t)(profile.startLevel + ((range * progress + 32768) >> 16));
+}
+
+uint8_t FadePlanner::scaleDuty(uint8_t duty, uint8_t level) {
+    if (duty == 0 || level == 0) {
+        return 0;
+    }
+    uint32_t scaled = ((uint32_t)duty * level + 127) / 255;
+    return scaled > 0 ? (uint8_t)scaled : 1;
+}
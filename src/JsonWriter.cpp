@@ -0,0 +1,177 @@
+/**
+ * @file JsonWriter.cpp
+ * @brief Allocation-free JSON serializer implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "JsonWriter.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+JsonWriter::JsonWriter(char* buf, size_t size) {
+    buffer = buf;
+    capacity = size;
+    length = 0;
+    depth = 0;
+    skipped = 0;
+    hasItems = 0;
+    pendingKey = nullptr;
+    overflow = false;
+}
+
+bool JsonWriter::put(const char* text, size_t count) {
+    // One byte per open container stays free for its closing bracket
+    if (overflow || length + count + depth > capacity) {
+        overflow = true;
+        return false;
+    }
+    memcpy(buffer + length, text, count);
+    length += count;
+    return true;
+}
+
+bool JsonWriter::separate() {
+    uint16_t bit = (uint16_t)(1u << depth);
+    if ((hasItems & bit) && !put(',')) {
+        return false;
+    }
+    hasItems |= bit;
+    
+    if (pendingKey) {
+        const char* name = pendingKey;
+        pendingKey = nullptr;
+        return put('"') && putEscaped(name) && put("\":", 2);
+    }
+    return true;
+}
+
+bool JsonWriter::open(char bracket) {
+    Mark before = mark();
+    if (overflow || depth + 1 >= JSON_WRITER_MAX_DEPTH || !separate()) {
+        rollback(before);
+        overflow = true;
+        skipped++;
+        return false;
+    }
+    depth++;                        // Counted first so the closing bracket is reserved too
+    if (!put(bracket)) {
+        rollback(before);
+        overflow = true;
+        skipped++;
+        return false;
+    }
+    hasItems &= (uint16_t)~(1u << depth);
+    return true;
+}
+
+void JsonWriter::close(char bracket) {
+    if (skipped > 0) {
+        skipped--;
+        return;
+    }
+    if (depth == 0) {
+        return;
+    }
+    pendingKey = nullptr;      // A key without a value is dropped
+    depth--;
+    buffer[length++] = bracket;     // Reserved when the container was opened
+}
+
+bool JsonWriter::putEscaped(const char* text) {
+    static const char hex[] = "0123456789abcdef";
+    for (const char* p = text; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            char escaped[2] = {'\\', (char)c};
+            if (!put(escaped, 2)) return false;
+        } else if (c < 0x20) {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F]};
+            if (!put(escaped, 6)) return false;
+        } else if (!put((char)c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void JsonWriter::key(const char* name) {
+    pendingKey = name;
+}
+
+void JsonWriter::string(const char* text) {
+    if (!text) {
+        null();
+        return;
+    }
+    Mark before = mark();
+    if (!separate() || !put('"') || !putEscaped(text) || !put('"')) {
+        rollback(before);
+        overflow = true;
+    }
+}
+
+void JsonWriter::number(int32_t value) {
+    char digits[12];
+    int count = snprintf(digits, sizeof(digits), "%ld", (long)value);
+    Mark before = mark();
+    if (!separate() || !put(digits, (size_t)count)) {
+        rollback(before);
+        overflow = true;
+    }
+}
+
+void JsonWriter::unsignedNumber(uint32_t value) {
+    char digits[12];
+    int count = snprintf(digits, sizeof(digits), "%lu", (unsigned long)value);
+    Mark before = mark();
+    if (!separate() || !put(digits, (size_t)count)) {
+        rollback(before);
+        overflow = true;
+    }
+}
+
+void JsonWriter::decimal(float value, uint8_t digits) {
+    if (isnan(value) || isinf(value)) {
+        null();     // Not representable in JSON
+        return;
+    }
+    char text[24];
+    int count = snprintf(text, sizeof(text), "%.*f", (int)digits, (double)value);
+    Mark before = mark();
+    if (count <= 0 || count >= (int)sizeof(text) || !separate() || !put(text, (size_t)count)) {
+        rollback(before);
+        overflow = true;
+    }
+}
+
+void JsonWriter::boolean(bool value) {
+    Mark before = mark();
+    if (!separate() || !(value ? put("true", 4) : put("false", 5))) {
+        rollback(before);
+        overflow = true;
+    }
+}
+
+void JsonWriter::null() {
+    Mark before = mark();
+    if (!separate() || !put("null", 4)) {
+        rollback(before);
+        overflow = true;
+    }
+}
+
+JsonWriter::Mark JsonWriter::mark() const {
+    Mark position = {length, depth, skipped, hasItems, pendingKey, overflow};
+    return position;
+}
+
+void JsonWriter::rollback(const Mark& position) {
+    length = position.length;
+    depth = position.depth;
+    skipped = position.skipped;
+    hasItems = position.hasItems;
+    pendingKey = position.pendingKey;
+    overflow = position.overflow;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file LightTrendDetector.cpp
+ * @brief Streaming lights-out / lights-on detection implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "LightTrendDetector.h"
+
+// Smallest lit/dark separation assumed before the baselines are learned (ADC x16)
+static const int32_t MIN_CONTRAST = 100 * 16;
+
+// Baseline EWMA weight (1/32) while the signal sits in a regime
+static const int32_t LEARN_SHIFT = 5;
+
+// Keeps the CUSUM bounded during very long shifts
+static const int32_t CUSUM_LIMIT_FACTOR = 8;
+
+// Shifts that cover less than this share of the lit/dark gap (e.g. a lamp
+// dimmed, dusk) re-anchor the current baseline instead of switching regime
+static const int32_t MIN_SWITCH_CONFIDENCE = 50;
+
+// A partial shift held this many dwell periods is a new level, not a ramp
+static const uint32_t SETTLE_DWELL_FACTOR = 10;
+
+LightTrendDetector::LightTrendDetector(int32_t darkThreshold, uint32_t dwellSeconds) {
+    threshold = darkThreshold * 16;
+    minDwellSeconds = dwellSeconds;
+    litBaseline = threshold * 3;
+    darkBaseline = threshold / 3;
+    regime = LIGHT_REGIME_UNKNOWN;
+    cusum = 0;
+    resetRun();
+}
+
+void LightTrendDetector::resetRun() {
+    runStart = 0;
+    runLevel = -1;
+}
+
+int32_t LightTrendDetector::contrast() const {
+    int32_t separation = litBaseline - darkBaseline;
+    return separation > MIN_CONTRAST ? separation : MIN_CONTRAST;
+}
+
+void LightTrendDetector::learn(int32_t scaledLevel) {
+    if (regime == LIGHT_REGIME_LIT) {
+        litBaseline += (scaledLevel - litBaseline) >> LEARN_SHIFT;
+    } else if (regime == LIGHT_REGIME_DARK) {
+        darkBaseline += (scaledLevel - darkBaseline) >> LEARN_SHIFT;
+    }
+}
+
+LightTrendResult LightTrendDetector::update(uint32_t timestamp, int32_t level) {
+    LightTrendResult result = {LIGHT_TREND_NONE, 0, 0, level};
+    int32_t scaled = level * 16;
+
+    if (regime == LIGHT_REGIME_UNKNOWN) {
+        // First sample: a plain threshold decides where we start
+        regime = scaled < threshold ? LIGHT_REGIME_DARK : LIGHT_REGIME_LIT;
+        if (regime == LIGHT_REGIME_LIT) {
+            litBaseline = scaled;
+        } else {
+            darkBaseline = scaled;
+        }
+        return result;
+    }
+
+    bool lit = regime == LIGHT_REGIME_LIT;
+    int32_t reference = lit ? litBaseline : darkBaseline;
+    int32_t other = lit ? darkBaseline : litBaseline;
+    int32_t separation = contrast();
+
+    // Allowance k = d/4 ignores noise; threshold h = 2d needs a sustained full step
+    int32_t deviation = lit ? reference - scaled : scaled - reference;
+    cusum += deviation - separation / 4;
+    if (cusum <= 0) {
+        cusum = 0;
+        resetRun();
+        learn(scaled);
+        return result;
+    }
+    if (cusum > separation * CUSUM_LIMIT_FACTOR) {
+        cusum = separation * CUSUM_LIMIT_FACTOR;
+    }
+
+    // Track where the signal is heading
+    if (runLevel < 0) {
+        runStart = timestamp;
+        runLevel = scaled;
+    } else {
+        runLevel += (scaled - runLevel) / 4;
+    }
+
+    // Confirm only a large, sustained shift that is still in place now
+    int32_t travelled = lit ? reference - runLevel : runLevel - reference;
+    uint32_t runSeconds = timestamp - runStart;
+    if (cusum < separation * 2 || runSeconds < minDwellSeconds) {
+        return result;
+    }
+    if (travelled < separation / 2 && runSeconds < minDwellSeconds * SETTLE_DWELL_FACTOR) {
+        return result;
+    }
+
+    // Confidence is how far the level went towards the other baseline
+    int32_t span = lit ? reference - other : other - reference;
+    int32_t confidence = span > 0 ? (travelled * 100) / span : 100;
+    if (confidence > 100) confidence = 100;
+
+    if (confidence < MIN_SWITCH_CONFIDENCE) {
+        // Same regime at a new level
+        if (lit) {
+            litBaseline = runLevel;
+        } else {
+            darkBaseline = runLevel;
+        }
+        cusum = 0;
+        resetRun();
+        return result;
+    }
+
+    result.change = lit ? LIGHT_TREND_LIGHTS_OUT : LIGHT_TREND_LIGHTS_ON;
+    result.confidence = (uint8_t)confidence;
+    result.changeTime = runStart;
+    result.level = runLevel / 16;
+
+    // Switch regime; the new baseline keeps learning from here
+    regime = lit ? LIGHT_REGIME_DARK : LIGHT_REGIME_LIT;
+    if (lit) {
+        darkBaseline = runLevel;
+    } else {
+        litBaseline = runLevel;
+    }
+
+    cusum = 0;
+    resetRun();
+    return result;
+}
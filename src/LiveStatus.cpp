@@ -0,0 +1,137 @@
+/**
+ * @file LiveStatus.cpp
+ * @brief Coalesced, delta-encoded live status implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "LiveStatus.h"
+#include <stdio.h>
+
+static const char* const fieldNames[LIVE_FIELD_COUNT] = {
+    "alarm", "id", "pill", "usb", "light", "net"
+};
+
+LiveStatus::LiveStatus() {
+    revision = 0;
+    pending = false;
+    for (uint8_t i = 0; i < LIVE_FIELD_COUNT; i++) {
+        values[i] = 0;
+        changedAt[i] = 0;
+    }
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        clients[i].id = 0;
+        clients[i].sentRevision = 0;
+        clients[i].used = false;
+    }
+}
+
+void LiveStatus::set(LiveField field, int32_t value, int32_t deadband) {
+    if (field >= LIVE_FIELD_COUNT) {
+        return;
+    }
+    if (changedAt[field] != 0) {
+        int32_t difference = value > values[field] ? value - values[field] : values[field] - value;
+        if (difference == 0 || difference < deadband) {
+            return;
+        }
+    }
+
+    // Stamped with the open tick; only visible to clients after commit()
+    values[field] = value;
+    changedAt[field] = revision + 1;
+    pending = true;
+}
+
+bool LiveStatus::commit() {
+    if (!pending) {
+        return false;
+    }
+    revision++;
+    pending = false;
+    return true;
+}
+
+bool LiveStatus::addClient(uint32_t id) {
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (!clients[i].used) {
+            clients[i].id = id;
+            clients[i].sentRevision = 0;
+            clients[i].used = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void LiveStatus::removeClient(uint32_t id) {
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].used && clients[i].id == id) {
+            clients[i].used = false;
+        }
+    }
+}
+
+uint8_t LiveStatus::clientCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].used) count++;
+    }
+    return count;
+}
+
+uint8_t LiveStatus::flush(SendFunction send, void* context) {
+    // Clients that are up to date share one message, so it is built once per baseline
+    char message[LIVE_MESSAGE_MAX];
+    size_t length = 0;
+    uint32_t builtFor = 0;
+    bool built = false;
+    uint8_t accepted = 0;
+
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        Client& client = clients[i];
+        if (!client.used || client.sentRevision >= revision) {
+            continue;
+        }
+        if (!built || builtFor != client.sentRevision) {
+            length = writeDelta(client.sentRevision, message, sizeof(message));
+            builtFor = client.sentRevision;
+            built = true;
+        }
+        if (length > 0 && send(context, client.id, message, length)) {
+            client.sentRevision = revision;
+            accepted++;
+        }
+    }
+    return accepted;
+}
+
+size_t LiveStatus::writeDelta(uint32_t since, char* out, size_t capacity) const {
+    int written = snprintf(out, capacity, "{\"r\":%u", (unsigned)revision);
+    if (written < 0 || (size_t)written >= capacity) {
+        return 0;
+    }
+    size_t length = (size_t)written;
+
+    for (uint8_t i = 0; i < LIVE_FIELD_COUNT; i++) {
+        if (changedAt[i] == 0 || changedAt[i] <= since || changedAt[i] > revision) {
+            continue;
+        }
+        written = snprintf(out + length, capacity - length, ",\"%s\":%d", fieldNames[i], (int)values[i]);
+        if (written < 0 || (size_t)written >= capacity - length) {
+            return 0;
+        }
+        length += (size_t)written;
+    }
+
+    if (length + 2 > capacity) {
+        return 0;
+    }
+    out[length++] = '}';
+    out[length] = '\0';
+    return length;
+}
+
+const char* LiveStatus::fieldName(LiveField field) {
+    return field < LIVE_FIELD_COUNT ? fieldNames[field] : "";
+}
@@ -11,11 +11,16 @@
 Logger::Logger() {
     flashLoggingEnabled = LOG_TO_FLASH;
     serialLoggingEnabled = LOG_TO_SERIAL;
+    minLevel = LOG_DEBUG;
     logBuffer.reserve(MAX_LOG_ENTRIES);
+    bufferLock = xSemaphoreCreateMutex();
 }
 
 Logger::~Logger() {
     preferences.end();
+    if (bufferLock) {
+        vSemaphoreDelete(bufferLock);
+    }
 }
 
 bool Logger::begin() {
@@ -34,6 +39,10 @@ bool Logger::begin() {
 }
 
 void Logger::log(LogLevel level, LogEventType eventType, const String& message, const String& data) {
+    if (level < minLevel) {
+        return;
+    }
+    
     LogEntry entry;
     entry.timestamp = millis();
     entry.level = level;
@@ -42,10 +51,12 @@ void Logger::log(LogLevel level, LogEventType eventType, const String& message,
     entry.data = data;
     
     // Add to buffer
+    xSemaphoreTake(bufferLock, portMAX_DELAY);
     if (logBuffer.size() >= MAX_LOG_ENTRIES) {
         logBuffer.erase(logBuffer.begin()); // Remove oldest entry
     }
     logBuffer.push_back(entry);
+    xSemaphoreGive(bufferLock);
     
     // Write to serial if enabled
     if (serialLoggingEnabled) {
@@ -75,6 +86,14 @@ void Logger::logError(LogEventType eventType, const String& message, const Strin
 }
 
 String Logger::levelToString(LogLevel level) {
+    return levelName(level);
+}
+
+String Logger::eventTypeToString(LogEventType eventType) {
+    return eventName(eventType);
+}
+
+const char* Logger::levelName(LogLevel level) {
     switch (level) {
         case LOG_DEBUG: return "DEBUG";
         case LOG_INFO: return "INFO";
@@ -84,7 +103,7 @@ String Logger::levelToString(LogLevel level) {
     }
 }
 
-String Logger::eventTypeToString(LogEventType eventType) {
+const char* Logger::eventName(LogEventType eventType) {
     switch (eventType) {
         case EVENT_SYSTEM_START: return "SYSTEM_START";
         case EVENT_ALARM_SET: return "ALARM_SET";
@@ -148,8 +167,30 @@ std::vector<LogEntry> Logger::getRecentLogs(int count) {
     return std::vector<LogEntry>(logBuffer.begin() + startIndex, logBuffer.end());
 }
 
+size_t Logger::visitRecentLogs(size_t count, LogLevel level, LogVisitor visitor, void* context) {
+    size_t visited = 0;
+    
+    // Held only while the visitor formats into its own buffer; log() waits that long at most
+    xSemaphoreTake(bufferLock, portMAX_DELAY);
+    for (size_t i = logBuffer.size(); i > 0 && visited < count; i--) {
+        const LogEntry& entry = logBuffer[i - 1];
+        if (entry.level < level) {
+            continue;
+        }
+        visited++;
+        if (!visitor(context, entry)) {
+            break;
+        }
+    }
+    xSemaphoreGive(bufferLock);
+    
+    return visited;
+}
+
 void Logger::clearLogs() {
+    xSemaphoreTake(bufferLock, portMAX_DELAY);
     logBuffer.clear();
+    xSemaphoreGive(bufferLock);
     if (flashLoggingEnabled) {
         preferences.clear();
     }
@@ -0,0 +1,287 @@
+/**
+ * @file MqttClient.cpp
+ * @brief Non-blocking MQTT 3.1.1 publisher implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "MqttClient.h"
+#include <string.h>
+
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH_QOS1 0x32
+#define MQTT_PUBACK 0x40
+#define MQTT_PINGREQ 0xC0
+#define MQTT_PINGRESP 0xD0
+#define MQTT_CLEAN_SESSION 0x02
+
+MqttClient::MqttClient() {
+    sendBytes = nullptr;
+    receiveBytes = nullptr;
+    context = nullptr;
+    strcpy(clientId, "nightybyte");
+    keepAliveS = MQTT_KEEPALIVE_S;
+
+    state = MQTT_DISCONNECTED;
+    lastError = MQTT_OK;
+    refusalCode = 0;
+    txLength = 0;
+    txSent = 0;
+    rxLength = 0;
+    nextPacketId = 1;
+    inFlightId = 0;
+    waitStarted = 0;
+    pingOutstanding = false;
+    pingSent = 0;
+    lastSent = 0;
+    published = 0;
+    acknowledged = 0;
+}
+
+void MqttClient::begin(SendFunction send, ReceiveFunction receive, void* ctx) {
+    sendBytes = send;
+    receiveBytes = receive;
+    context = ctx;
+}
+
+void MqttClient::setClientId(const char* id) {
+    strncpy(clientId, id, MQTT_CLIENT_ID_MAX);
+    clientId[MQTT_CLIENT_ID_MAX] = '\0';
+}
+
+void MqttClient::startSession(uint32_t now) {
+    reset();
+
+    uint8_t packet[16 + MQTT_CLIENT_ID_MAX];
+    size_t idLength = strlen(clientId);
+    uint8_t* p = packet;
+    *p++ = MQTT_CONNECT;
+    p += encodeLength(p, 10 + 2 + idLength);
+    p += putString(p, "MQTT", 4);
+    *p++ = 4;                       // Protocol level 3.1.1
+    *p++ = MQTT_CLEAN_SESSION;
+    *p++ = (uint8_t)(keepAliveS >> 8);
+    *p++ = (uint8_t)keepAliveS;
+    p += putString(p, clientId, idLength);
+
+    queue(packet, p - packet);
+    state = MQTT_WAIT_CONNACK;
+    waitStarted = now;
+    lastSent = now;
+    flush();
+}
+
+void MqttClient::reset() {
+    state = MQTT_DISCONNECTED;
+    txLength = 0;
+    txSent = 0;
+    rxLength = 0;
+    inFlightId = 0;
+    pingOutstanding = false;
+}
+
+MqttEvent MqttClient::update(uint32_t now) {
+    if (state == MQTT_DISCONNECTED) {
+        return MQTT_NONE;
+    }
+    if (!flush()) {
+        return fail(MQTT_ERROR_TRANSPORT);
+    }
+
+    // One packet per call; the rest stays buffered for the next
+    MqttEvent event = parse(now);
+    if (event != MQTT_NONE || state == MQTT_DISCONNECTED) {
+        return event;
+    }
+    if (rxLength < sizeof(rxBuffer)) {
+        int received = receiveBytes(context, rxBuffer + rxLength, sizeof(rxBuffer) - rxLength);
+        if (received < 0) {
+            return fail(MQTT_ERROR_TRANSPORT);
+        }
+        if (received > 0) {
+            rxLength += (size_t)received;
+            event = parse(now);
+            if (event != MQTT_NONE) {
+                return event;
+            }
+        }
+    }
+
+    if ((state == MQTT_WAIT_CONNACK || inFlightId != 0) && now - waitStarted > MQTT_ACK_TIMEOUT_MS) {
+        return fail(MQTT_ERROR_TIMEOUT);
+    }
+    if (pingOutstanding && now - pingSent > MQTT_ACK_TIMEOUT_MS) {
+        return fail(MQTT_ERROR_TIMEOUT);
+    }
+
+    // Keepalive: ping at half the interval the broker was promised
+    if (state == MQTT_CONNECTED && keepAliveS > 0 && !pingOutstanding && txLength == 0 &&
+        now - lastSent >= keepAliveS * 500UL) {
+        uint8_t ping[2] = {MQTT_PINGREQ, 0};
+        queue(ping, sizeof(ping));
+        pingOutstanding = true;
+        pingSent = now;
+        lastSent = now;
+        flush();
+    }
+    return MQTT_NONE;
+}
+
+bool MqttClient::publish(const char* topic, const uint8_t* payload, size_t length, uint32_t now) {
+    if (!canPublish()) {
+        return false;
+    }
+
+    size_t topicLength = strlen(topic);
+    size_t remaining = 2 + topicLength + 2 + length;
+    uint8_t header[5];
+    size_t headerLength = 1 + encodeLength(header + 1, remaining);
+    if (headerLength + remaining > sizeof(txBuffer)) {
+        return false;
+    }
+
+    uint16_t id = nextPacketId;
+    nextPacketId = nextPacketId == 0xFFFF ? 1 : nextPacketId + 1;
+
+    // Written straight into the send buffer, which is empty (canPublish)
+    header[0] = MQTT_PUBLISH_QOS1;
+    uint8_t* p = txBuffer;
+    memcpy(p, header, headerLength);
+    p += headerLength;
+    p += putString(p, topic, topicLength);
+    *p++ = (uint8_t)(id >> 8);
+    *p++ = (uint8_t)id;
+    memcpy(p, payload, length);
+    txLength = headerLength + remaining;
+    txSent = 0;
+
+    inFlightId = id;
+    waitStarted = now;
+    lastSent = now;
+    published++;
+    flush();        // A failure shows up on the next update()
+    return true;
+}
+
+bool MqttClient::queue(const uint8_t* data, size_t length) {
+    if (txSent == txLength) {
+        txLength = 0;
+        txSent = 0;
+    }
+    if (txLength + length > sizeof(txBuffer)) {
+        return false;
+    }
+    memcpy(txBuffer + txLength, data, length);
+    txLength += length;
+    return true;
+}
+
+bool MqttClient::flush() {
+    while (txSent < txLength) {
+        int sent = sendBytes(context, txBuffer + txSent, txLength - txSent);
+        if (sent < 0) {
+            return false;
+        }
+        if (sent == 0) {
+            return true;        // Socket full; the rest goes on a later call
+        }
+        txSent += (size_t)sent;
+    }
+    txLength = 0;
+    txSent = 0;
+    return true;
+}
+
+MqttEvent MqttClient::parse(uint32_t now) {
+    if (rxLength < 2) {
+        return MQTT_NONE;
+    }
+
+    // Remaining length: 7 bits per byte, high bit set on all but the last
+    size_t remaining = 0;
+    size_t headerLength = 1;
+    for (int shift = 0;; shift += 7) {
+        if (headerLength >= rxLength) {
+            return MQTT_NONE;
+        }
+        if (shift > 21) {
+            return fail(MQTT_ERROR_PROTOCOL);
+        }
+        uint8_t byte = rxBuffer[headerLength++];
+        remaining |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+    size_t total = headerLength + remaining;
+    if (total > sizeof(rxBuffer)) {
+        return fail(MQTT_ERROR_PROTOCOL);     // Nothing we subscribe to, so nothing this long should come
+    }
+    if (rxLength < total) {
+        return MQTT_NONE;
+    }
+
+    const uint8_t* body = rxBuffer + headerLength;
+    MqttEvent event = MQTT_NONE;
+    switch (rxBuffer[0] & 0xF0) {
+        case MQTT_CONNACK:
+            if (state != MQTT_WAIT_CONNACK || remaining != 2) {
+                return fail(MQTT_ERROR_PROTOCOL);
+            }
+            if (body[1] != 0) {
+                refusalCode = body[1];
+                return fail(MQTT_ERROR_REFUSED);
+            }
+            state = MQTT_CONNECTED;
+            lastSent = now;
+            event = MQTT_SESSION_UP;
+            break;
+
+        case MQTT_PUBACK:
+            if (remaining != 2) {
+                return fail(MQTT_ERROR_PROTOCOL);
+            }
+            // An acknowledgement for an older, already given up message is ignored
+            if (inFlightId != 0 && (uint16_t)(body[0] << 8 | body[1]) == inFlightId) {
+                inFlightId = 0;
+                acknowledged++;
+                event = MQTT_PUBLISHED;
+            }
+            break;
+
+        case MQTT_PINGRESP:
+            pingOutstanding = false;
+            break;
+
+        default:
+            return fail(MQTT_ERROR_PROTOCOL);
+    }
+
+    rxLength -= total;
+    memmove(rxBuffer, rxBuffer + total, rxLength);
+    return event;
+}
+
+MqttEvent MqttClient::fail(MqttError error) {
+    lastError = error;
+    reset();
+    return MQTT_LOST;
+}
+
+size_t MqttClient::encodeLength(uint8_t* out, size_t length) {
+    size_t count = 0;
+    do {
+        uint8_t byte = length & 0x7F;
+        length >>= 7;
+        out[count++] = length > 0 ? (byte | 0x80) : byte;
+    } while (length > 0);
+    return count;
+}
+
+size_t MqttClient::putString(uint8_t* out, const char* text, size_t length) {
+    out[0] = (uint8_t)(length >> 8);
+    out[1] = (uint8_t)length;
+    memcpy(out + 2, text, length);
+    return length + 2;
+}
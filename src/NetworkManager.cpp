@@ -6,7 +6,34 @@
  */
 
 #include "NetworkManager.h"
-#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
+#include <sys/time.h>
+#include "TimeSeriesStore.h"
+#include "PatternCompiler.h"
+#include "FadePlanner.h"
+#include "WebAssets.h"
+#include "AlarmManager.h"
+#include "SensorManager.h"
+#include "JsonWriter.h"
+
+static const int64_t TIMEZONE_OFFSET_US = (int64_t)TIMEZONE_OFFSET_HOURS * 3600 * 1000000;
+
+// JSON bodies are written here and sent straight from here, never copied to the heap.
+// Claimed and released only on the AsyncTCP task, so no locking.
+static char jsonBuffers[API_BUFFER_COUNT][API_BUFFER_SIZE];
+static bool jsonBufferBusy[API_BUFFER_COUNT];
+static uint32_t jsonHeapBefore[API_BUFFER_COUNT];
+
+static int64_t systemClockUs() {
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+}
 
 NetworkManager::NetworkManager(Logger* log, ESP32Time* rtcInstance) {
     logger = log;
@@ -15,18 +42,67 @@ NetworkManager::NetworkManager(Logger* log, ESP32Time* rtcInstance) {
     currentState = NETWORK_IDLE;
     apModeEnabled = false;
     lastConnectionAttempt = 0;
-    connectionRetries = 0;
+    nextConnectAttempt = 0;
+    failedAttempts = 0;
+    radioSuspended = false;
+    radioPowerSave = false;
+    radioMode = RADIO_DOZE;
+    radioAllowed = true;
+    alarmActive = false;
+    outboundPending = false;
+    telemetryFlushAt = 0;
+    lastWebRequest = 0;
+    lastRadioPolicy = 0;
+    memset(&wifiCache, 0, sizeof(wifiCache));
+    fastConnect = false;
+    fastConnectFailed = false;
+    cachedLease = false;
+    leaseConfirming = false;
+    connectedAt = 0;
+    lastConnectMs = 0;
+    lastConnectFast = false;
+    fastConnects = 0;
+    scanConnects = 0;
     
     webServer = nullptr;
-    timeClient = nullptr;
+    webServerRunning = false;
+    socketServer = nullptr;
+    statusSocket = nullptr;
+    socketEvents = nullptr;
+    liveClientsLock = nullptr;
+    memset(liveClients, 0, sizeof(liveClients));
+    lastLivePush = 0;
+    ntpServerAddress = 0;
+    ntpResolving = false;
+    lastResolveAttempt = 0;
+    lastDriftTick = 0;
+    patternLibrary = nullptr;
+    alarmManager = nullptr;
+    sensorManager = nullptr;
+    otaUpdater = nullptr;
+    otaRequest = nullptr;
+    commands = nullptr;
+    patternTicket = 0;
+    apiHeapPeak = 0;
+    apiBusyRejects = 0;
+    memset(&statusInputs, 0, sizeof(statusInputs));
 }
 
 NetworkManager::~NetworkManager() {
     if (webServer) {
         delete webServer;
     }
-    if (timeClient) {
-        delete timeClient;
+    if (socketServer) {
+        delete socketServer;
+    }
+    if (statusSocket) {
+        delete statusSocket;
+    }
+    if (socketEvents) {
+        vQueueDelete(socketEvents);
+    }
+    if (liveClientsLock) {
+        vSemaphoreDelete(liveClientsLock);
     }
     preferences.end();
 }
@@ -38,8 +114,28 @@ bool NetworkManager::begin() {
         return false;
     }
     
+    socketEvents = xQueueCreate(WS_MAX_CLIENTS * 2, sizeof(SocketEvent));
+    liveClientsLock = xSemaphoreCreateMutex();
+    if (!socketEvents || !liveClientsLock) {
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Failed to create live status queue");
+        return false;
+    }
+    
+    // Sources for the live status push
+    EventBus::subscribe<AlarmStateEvent, NetworkManager, &NetworkManager::onAlarmStateChanged>(this);
+    EventBus::subscribe<PillBoxEvent, NetworkManager, &NetworkManager::onPillBoxChanged>(this);
+    EventBus::subscribe<UsbStateEvent, NetworkManager, &NetworkManager::onUsbStateChanged>(this);
+    EventBus::subscribe<SensorSampleEvent, NetworkManager, &NetworkManager::onSensorSample>(this);
+    
+    // The driver keeps no copy of its own; reconnects are handled by update()
+    WiFi.persistent(false);
+    WiFi.setAutoReconnect(false);
+    radioPolicy.setQuietWindow(preferences.getUShort("quietStart", RADIO_QUIET_START_MIN),
+                               preferences.getUShort("quietEnd", RADIO_QUIET_END_MIN));
+    
     // Load saved WiFi credentials
     if (loadWiFiCredentials()) {
+        loadWiFiCache();
         if (logger) {
             logger->logInfo(EVENT_SYSTEM_START, "Loaded WiFi credentials", "SSID: " + ssid);
         }
@@ -55,8 +151,8 @@ bool NetworkManager::begin() {
         startAccessPoint();
     }
     
-    // Initialize NTP client
-    timeClient = new NTPClient(ntpUDP, NTP_SERVER, TIMEZONE_OFFSET_HOURS * 3600, NTP_UPDATE_INTERVAL_MS);
+    // SNTP requests go out from update(); replies are picked up on later calls
+    sntpClient.begin(&NetworkManager::sendNtpPacket, &NetworkManager::receiveNtpPacket, this);
     
     // Initialize OTA
     initializeOTA();
@@ -71,42 +167,51 @@ bool NetworkManager::begin() {
 void NetworkManager::update() {
     unsigned long currentTime = millis();
     
+    // Web requests are served by the AsyncTCP task; their commands go to the main loop's CommandQueue
+    updateRadioPolicy(currentTime, false);
+    pushLiveStatus(currentTime);
+    updateClockDrift(currentTime);
+    
     switch (currentState) {
         case NETWORK_CONNECTING:
             if (WiFi.status() == WL_CONNECTED) {
                 currentState = NETWORK_CONNECTED;
-                if (logger) {
-                    logger->logInfo(EVENT_WIFI_CONNECTED, "WiFi connected", 
-                                   "IP: " + WiFi.localIP().toString() + 
-                                   ", RSSI: " + String(WiFi.RSSI()) + "dBm");
-                }
+                onStationConnected();
                 
                 // Start web server
                 startWebServer();
                 
-                // Sync time
-                syncTime();
-                
-                // Trigger callback
-                if (connectionCallback) {
-                    connectionCallback(true);
-                }
-            } else if (currentTime - lastConnectionAttempt > WIFI_CONNECT_TIMEOUT_MS) {
-                // Connection timeout
-                connectionRetries++;
-                if (connectionRetries < 3) {
+                NetworkStateEvent event = {true};
+                EventBus::publish(event);
+            } else if (currentTime - lastConnectionAttempt >
+                       (fastConnect ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS)) {
+                WiFi.disconnect();
+                if (fastConnect) {
+                    // Access point moved channel or was replaced: scan straight away
+                    fastConnectFailed = true;
                     if (logger) {
-                        logger->logWarning(EVENT_WIFI_DISCONNECTED, "WiFi connection timeout, retrying",
-                                         "Attempt: " + String(connectionRetries));
+                        logger->logWarning(EVENT_WIFI_DISCONNECTED, "Fast reconnect failed, scanning");
                     }
                     connectToWiFi();
-                } else {
-                    // Give up and start AP mode
+                    break;
+                }
+                
+                failedAttempts++;
+                scheduleReconnect();
+                if (logger) {
+                    logger->logWarning(EVENT_WIFI_DISCONNECTED, "WiFi connection timeout",
+                                       "Attempt " + String(failedAttempts) + ", retry in " +
+                                       String((nextConnectAttempt - currentTime) / 1000) + " s");
+                }
+                
+                // The setup AP opens once and stays up alongside the retries until they succeed
+                if (failedAttempts >= WIFI_AP_FALLBACK_ATTEMPTS && !apModeEnabled) {
                     if (logger) {
                         logger->logError(EVENT_WIFI_DISCONNECTED, "WiFi connection failed, starting AP mode");
                     }
                     startAccessPoint();
                 }
+                currentState = apModeEnabled ? NETWORK_AP_MODE : NETWORK_ERROR;
             }
             break;
             
@@ -120,45 +225,33 @@ void NetworkManager::update() {
                 // Stop web server
                 stopWebServer();
                 
-                // Try to reconnect
+                // Same access point, same lease: reconnect at once without scanning
+                failedAttempts = 0;
+                fastConnectFailed = false;
                 connectToWiFi();
                 
-                // Trigger callback
-                if (connectionCallback) {
-                    connectionCallback(false);
-                }
+                NetworkStateEvent event = {false};
+                EventBus::publish(event);
             } else {
-                // Handle web server
-                if (webServer) {
-                    webServer->handleClient();
+                // The cached address is only kept once the DHCP server has confirmed it
+                uint32_t leaseSeconds;
+                if (leaseConfirming && readDhcpLease(&leaseSeconds)) {
+                    leaseConfirming = false;
+                    saveWiFiCache();
                 }
                 
                 // Handle OTA
                 ArduinoOTA.handle();
                 
-                // Update NTP periodically
-                if (timeClient && currentTime % 60000 == 0) { // Every minute
-                    timeClient->update();
-                    if (rtc && timeClient->isTimeSet()) {
-                        rtc->setTime(timeClient->getEpochTime());
-                    }
-                }
-            }
-            break;
-            
-        case NETWORK_AP_MODE:
-            // Handle web server in AP mode
-            if (webServer) {
-                webServer->handleClient();
+                // Polls when due, otherwise just checks for a reply
+                updateTimeSync();
             }
             break;
             
         case NETWORK_ERROR:
-            // Try to recover after some time
-            if (currentTime - lastConnectionAttempt > 30000) { // Wait 30 seconds
-                if (logger) {
-                    logger->logInfo(EVENT_WIFI_CONNECTED, "Attempting to recover from network error");
-                }
+        case NETWORK_AP_MODE:
+            // Retry on the backoff schedule; in AP mode only with saved credentials
+            if ((long)(currentTime - nextConnectAttempt) >= 0 && !ssid.isEmpty()) {
                 connectToWiFi();
             }
             break;
@@ -169,8 +262,14 @@ void NetworkManager::update() {
 }
 
 bool NetworkManager::connectWiFi(const String& newSsid, const String& newPassword) {
+    if (newSsid != ssid) {
+        wifiCache.valid = false;    // Another network: its access point and lease are unknown
+        preferences.remove("wificache");
+    }
     ssid = newSsid;
     password = newPassword;
+    failedAttempts = 0;
+    fastConnectFailed = false;
     
     // Save credentials
     saveWiFiCredentials(ssid, password);
@@ -180,26 +279,151 @@ bool NetworkManager::connectWiFi(const String& newSsid, const String& newPasswor
 }
 
 void NetworkManager::connectToWiFi() {
-    if (ssid.isEmpty()) {
+    if (ssid.isEmpty() || radioSuspended) {
         return;
     }
     
-    // Stop AP mode if running
-    if (apModeEnabled) {
-        WiFi.softAPdisconnect();
-        apModeEnabled = false;
-        stopWebServer();
-    }
+    // A setup access point stays up until the station is connected
+    WiFi.mode(apModeEnabled ? WIFI_AP_STA : WIFI_STA);
     
     currentState = NETWORK_CONNECTING;
     lastConnectionAttempt = millis();
+    fastConnect = wifiCache.valid && !fastConnectFailed;
+    cachedLease = fastConnect && isLeaseReusable();
+    leaseConfirming = false;
+    
+    // A zero address switches DHCP back on
+    if (cachedLease) {
+        WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway), IPAddress(wifiCache.subnet),
+                    IPAddress(wifiCache.dns));
+    } else {
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    }
+    
+    if (fastConnect) {
+        // Known BSSID and channel: probe that one access point instead of scanning every channel
+        WiFi.begin(ssid.c_str(), password.c_str(), wifiCache.channel, wifiCache.bssid, false);
+    } else {
+        WiFi.begin(ssid.c_str(), password.c_str(), 0, nullptr, false);
+    }
+    
+    // The listen interval is only read at association, so it goes in before connecting
+    wifi_config_t station;
+    if (esp_wifi_get_config(WIFI_IF_STA, &station) == ESP_OK) {
+        station.sta.listen_interval = RADIO_LISTEN_INTERVAL;
+        esp_wifi_set_config(WIFI_IF_STA, &station);
+    }
+    esp_wifi_connect();
+    applySleepMode();
+    
+    if (logger) {
+        logger->logInfo(EVENT_WIFI_CONNECTED, "Connecting to WiFi",
+                        "SSID: " + ssid + (fastConnect ? ", channel " + String(wifiCache.channel) : ", scanning") +
+                        (cachedLease ? ", cached lease" : ""));
+    }
+}
+
+void NetworkManager::onStationConnected() {
+    connectedAt = millis();
+    lastConnectMs = connectedAt - lastConnectionAttempt;
+    lastConnectFast = fastConnect;
+    if (fastConnect) {
+        fastConnects++;
+    } else {
+        scanConnects++;
+    }
+    failedAttempts = 0;
+    fastConnectFailed = false;
+    
+    if (apModeEnabled) {
+        WiFi.softAPdisconnect(true);
+        WiFi.mode(WIFI_STA);
+        apModeEnabled = false;
+    }
     
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid.c_str(), password.c_str());
+    // The static address only got us on the network quickly; DHCP now asks to keep it (INIT-REBOOT),
+    // so the server confirms or replaces it and the lease is renewed on its schedule from here on
+    if (cachedLease) {
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+        leaseConfirming = true;
+    }
+    saveWiFiCache();
     
     if (logger) {
-        logger->logInfo(EVENT_WIFI_CONNECTED, "Connecting to WiFi", "SSID: " + ssid);
+        logger->logInfo(EVENT_WIFI_CONNECTED, "WiFi connected",
+                        "IP: " + WiFi.localIP().toString() + ", RSSI: " + String(WiFi.RSSI()) + "dBm, " +
+                        String(lastConnectMs) + " ms" + (fastConnect ? " (cached AP)" : " (scan)"));
+    }
+}
+
+void NetworkManager::scheduleReconnect() {
+    // Doubles per failure up to the cap; the jitter keeps devices behind one router from retrying in step
+    uint32_t backoff = WIFI_BACKOFF_MIN_MS;
+    for (uint8_t i = 1; i < failedAttempts && backoff < WIFI_BACKOFF_MAX_MS; i++) {
+        backoff *= 2;
+    }
+    if (backoff > WIFI_BACKOFF_MAX_MS) {
+        backoff = WIFI_BACKOFF_MAX_MS;
+    }
+    uint32_t jitter = backoff / 4;
+    nextConnectAttempt = millis() + backoff - jitter + esp_random() % (2 * jitter + 1);
+}
+
+bool NetworkManager::isLeaseReusable() const {
+    // Without a set clock the lease's age is unknown, so DHCP has to confirm it
+    if (wifiCache.leaseTime == 0 || wifiCache.leaseSeconds == 0 || wifiCache.ip == 0 ||
+        !clockDiscipline.isSynchronized()) {
+        return false;
+    }
+    
+    // Up to T1, half the lease, when a bound client would renew anyway
+    uint32_t now = (uint32_t)time(nullptr);
+    return now >= wifiCache.leaseTime && now - wifiCache.leaseTime < wifiCache.leaseSeconds / 2;
+}
+
+bool NetworkManager::readDhcpLease(uint32_t* seconds) {
+    // Read from lwIP's DHCP client: only true once it is bound, with the lease the server granted
+    esp_netif_t* station = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif* netif = station ? static_cast<struct netif*>(esp_netif_get_netif_impl(station)) : nullptr;
+    struct dhcp* dhcp = netif ? netif_dhcp_data(netif) : nullptr;
+    if (!dhcp || !dhcp_supplied_address(netif)) {
+        return false;
+    }
+    *seconds = dhcp->offered_t0_lease;
+    return true;
+}
+
+void NetworkManager::loadWiFiCache() {
+    if (preferences.getBytesLength("wificache") != sizeof(wifiCache) ||
+        preferences.getBytes("wificache", &wifiCache, sizeof(wifiCache)) != sizeof(wifiCache)) {
+        memset(&wifiCache, 0, sizeof(wifiCache));
+    }
+}
+
+void NetworkManager::saveWiFiCache() {
+    WiFiCache fresh;
+    memcpy(&fresh, &wifiCache, sizeof(fresh));
+    fresh.valid = true;
+    memcpy(fresh.bssid, WiFi.BSSID(), sizeof(fresh.bssid));
+    fresh.channel = WiFi.channel();
+    
+    // Only a lease DHCP has granted or confirmed is recorded; until then the cached one stands
+    uint32_t leaseSeconds;
+    if (readDhcpLease(&leaseSeconds)) {
+        fresh.ip = WiFi.localIP();
+        fresh.gateway = WiFi.gatewayIP();
+        fresh.subnet = WiFi.subnetMask();
+        fresh.dns = WiFi.dnsIP(0);
+        fresh.leaseTime = clockDiscipline.isSynchronized() ? (uint32_t)time(nullptr) : 0;
+        fresh.leaseSeconds = leaseSeconds;
+    }
+    
+    // Flash is only written when the access point or the lease changed
+    if (memcmp(&fresh, &wifiCache, sizeof(fresh)) == 0) {
+        return;
     }
+    wifiCache = fresh;
+    preferences.putBytes("wificache", &wifiCache, sizeof(wifiCache));
 }
 
 void NetworkManager::disconnectWiFi() {
@@ -214,6 +438,123 @@ void NetworkManager::disconnectWiFi() {
     }
 }
 
+void NetworkManager::applyPowerProfile(const PowerProfile& profile) {
+    radioAllowed = profile.radioEnabled;
+    radioPowerSave = profile.radioPowerSave;
+    updateRadioPolicy(millis(), true);
+    applySleepMode();
+}
+
+void NetworkManager::setQuietWindow(uint16_t startMinute, uint16_t endMinute) {
+    radioPolicy.setQuietWindow(startMinute, endMinute);
+    preferences.putUShort("quietStart", radioPolicy.getQuietStart());
+    preferences.putUShort("quietEnd", radioPolicy.getQuietEnd());
+    updateRadioPolicy(millis(), true);
+    
+    if (logger) {
+        char window[16];
+        snprintf(window, sizeof(window), "%02u:%02u-%02u:%02u", radioPolicy.getQuietStart() / 60,
+                 radioPolicy.getQuietStart() % 60, radioPolicy.getQuietEnd() / 60, radioPolicy.getQuietEnd() % 60);
+        logger->logInfo(EVENT_SYSTEM_START, "Radio quiet window set",
+                        radioPolicy.hasQuietWindow() ? String(window) : String("none"));
+    }
+}
+
+void NetworkManager::updateRadioPolicy(unsigned long currentTime, bool force) {
+    if (!force && currentTime - lastRadioPolicy < RADIO_POLICY_TICK_MS) {
+        return;
+    }
+    lastRadioPolicy = currentTime;
+    
+    // Without a synchronized clock the quiet window cannot be placed, and the radio is needed to set it
+    int16_t minuteOfDay = -1;
+    if (clockDiscipline.isSynchronized()) {
+        time_t now = time(nullptr);
+        struct tm local;
+        localtime_r(&now, &local);
+        minuteOfDay = local.tm_hour * 60 + local.tm_min;
+    }
+    
+    uint32_t webRequest = lastWebRequest;
+    int64_t untilSyncUs = (int64_t)(sntpClient.getNextPoll() - (uint64_t)esp_timer_get_time());
+    
+    RadioDemand demand;
+    demand.allowed = radioAllowed;
+    demand.alarmActive = alarmActive;
+    demand.uiActive = liveStatus.clientCount() > 0 || apModeEnabled ||
+                      (webRequest != 0 && currentTime - webRequest < RADIO_UI_LINGER_MS);
+    demand.syncDue = !clockDiscipline.isSynchronized() || sntpClient.isWaiting() || ntpResolving ||
+                     untilSyncUs < (int64_t)RADIO_WAKE_LEAD_MS * 1000;
+    demand.flushDue = telemetryFlushAt != 0 && (long)(currentTime - telemetryFlushAt) >= 0;
+    demand.outboundPending = outboundPending;
+    
+    RadioMode mode = radioPolicy.update(currentTime, minuteOfDay, demand);
+    if (mode != radioMode) {
+        setRadioMode(mode);
+    }
+    
+    RadioReport report;
+    radioPolicy.fillReport(currentTime, &report);
+    radioReport.publish(report);
+}
+
+void NetworkManager::setRadioMode(RadioMode mode) {
+    radioMode = mode;
+    
+    if (mode == RADIO_OFF) {
+        if (radioSuspended) {
+            return;
+        }
+        radioSuspended = true;
+        bool wasConnected = currentState == NETWORK_CONNECTED;
+        disconnectWiFi();
+        if (apModeEnabled) {
+            stopAPMode();
+        }
+        WiFi.mode(WIFI_OFF);
+        currentState = NETWORK_IDLE;
+        
+        if (wasConnected) {
+            NetworkStateEvent event = {false};
+            EventBus::publish(event);
+        }
+        if (logger) {
+            if (radioAllowed) {
+                logger->logDebug(EVENT_WIFI_DISCONNECTED, "WiFi off for the quiet window");
+            } else {
+                logger->logWarning(EVENT_WIFI_DISCONNECTED, "WiFi switched off to save battery");
+            }
+        }
+        return;
+    }
+    
+    if (radioSuspended) {
+        radioSuspended = false;
+        if (logger) {
+            logger->logDebug(EVENT_WIFI_CONNECTED, radioPolicy.isWaking() ? "WiFi on for a quiet-window wake"
+                                                                          : "WiFi back on");
+        }
+        failedAttempts = 0;
+        connectToWiFi();    // Cached access point and lease, so usually no scan
+        return;
+    }
+    
+    applySleepMode();
+}
+
+void NetworkManager::applySleepMode() {
+    if (currentState != NETWORK_CONNECTED && currentState != NETWORK_CONNECTING) {
+        return;
+    }
+    
+    // Maximum modem sleep honours the listen interval; minimum wakes for every DTIM beacon
+    if (radioMode == RADIO_FULL) {
+        WiFi.setSleep(radioPowerSave ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE);
+    } else {
+        WiFi.setSleep(WIFI_PS_MAX_MODEM);
+    }
+}
+
 void NetworkManager::startAccessPoint() {
     String apName = "SmartAlarm-" + String((uint32_t)ESP.getEfuseMac(), HEX);
     
@@ -246,32 +587,86 @@ void NetworkManager::stopAPMode() {
 }
 
 void NetworkManager::startWebServer() {
-    if (webServer) {
-        delete webServer;
+    if (webServerRunning) {
+        return;
     }
     
-    webServer = new WebServer(HTTP_PORT);
-    
-    // Set up routes
-    webServer->on("/", [this]() { handleRoot(); });
-    webServer->on("/setalarm", HTTP_POST, [this]() { handleSetAlarm(); });
-    webServer->on("/status", HTTP_GET, [this]() { handleGetStatus(); });
-    webServer->on("/setwifi", HTTP_POST, [this]() { handleSetWiFi(); });
-    webServer->on("/ota", HTTP_GET, [this]() { handleOTA(); });
-    webServer->onNotFound([this]() { handleNotFound(); });
+    // Created once: requests still in flight after end() keep using the handlers
+    if (!webServer) {
+        webServer = new AsyncWebServer(HTTP_PORT);
+        
+        // Set up routes
+        for (uint8_t i = 0; i < WEB_ASSET_COUNT; i++) {
+            const WebAsset* asset = &WEB_ASSETS[i];
+            webServer->on(asset->path, HTTP_GET, [this, asset](AsyncWebServerRequest* request) {
+                handleAsset(request, *asset);
+            });
+        }
+        webServer->on("/setalarm", HTTP_POST, [this](AsyncWebServerRequest* request) { handleSetAlarm(request); });
+        webServer->on("/status", HTTP_GET, [this](AsyncWebServerRequest* request) { handleGetStatus(request); });
+        webServer->on("/setwifi", HTTP_POST, [this](AsyncWebServerRequest* request) { handleSetWiFi(request); });
+        webServer->on("/history", HTTP_GET, [this](AsyncWebServerRequest* request) { handleGetHistory(request); });
+        webServer->on("/timeseries", HTTP_GET, [this](AsyncWebServerRequest* request) { handleGetTimeSeries(request); });
+        webServer->on("/patterns", HTTP_GET, [this](AsyncWebServerRequest* request) { handleGetPatterns(request); });
+        webServer->on("/patterns", HTTP_POST,
+                      [this](AsyncWebServerRequest* request) { handleUploadPattern(request); }, nullptr,
+                      [this](AsyncWebServerRequest* request, uint8_t* data, size_t length, size_t index, size_t total) {
+                          handlePatternBody(request, data, length, index, total);
+                      });
+        webServer->on("/patterns", HTTP_DELETE, [this](AsyncWebServerRequest* request) { handleDeletePattern(request); });
+        webServer->on("/api/alarms", HTTP_GET, [this](AsyncWebServerRequest* request) { handleApiGetAlarms(request); });
+        webServer->on("/api/alarms", HTTP_POST, [this](AsyncWebServerRequest* request) { handleApiAddAlarm(request); });
+        webServer->on("/api/alarms", HTTP_PUT, [this](AsyncWebServerRequest* request) { handleApiUpdateAlarm(request); });
+        webServer->on("/api/alarms", HTTP_DELETE, [this](AsyncWebServerRequest* request) { handleApiDeleteAlarm(request); });
+        webServer->on("/api/sensors", HTTP_GET, [this](AsyncWebServerRequest* request) { handleApiGetSensors(request); });
+        webServer->on("/api/history", HTTP_GET, [this](AsyncWebServerRequest* request) { handleGetHistory(request); });
+        webServer->on("/api/logs", HTTP_GET, [this](AsyncWebServerRequest* request) { handleApiGetLogs(request); });
+        webServer->on("/api/logs", HTTP_DELETE, [this](AsyncWebServerRequest* request) { handleApiClearLogs(request); });
+        webServer->on("/api/config", HTTP_GET, [this](AsyncWebServerRequest* request) { handleApiGetConfig(request); });
+        webServer->on("/api/config", HTTP_PUT, [this](AsyncWebServerRequest* request) { handleApiSetConfig(request); });
+        webServer->on("/api/commands", HTTP_GET, [this](AsyncWebServerRequest* request) { handleApiGetCommand(request); });
+        webServer->on("/api/radio", HTTP_GET, [this](AsyncWebServerRequest* request) { handleApiGetRadio(request); });
+        webServer->on("/api/ota", HTTP_GET, [this](AsyncWebServerRequest* request) { handleApiGetOta(request); });
+        webServer->on("/api/ota", HTTP_POST,
+                      [this](AsyncWebServerRequest* request) { handleApiOtaUpload(request); }, nullptr,
+                      [this](AsyncWebServerRequest* request, uint8_t* data, size_t length, size_t index, size_t total) {
+                          handleOtaBody(request, data, length, index, total);
+                      });
+        webServer->onNotFound([this](AsyncWebServerRequest* request) { handleNotFound(request); });
+    }
     
     webServer->begin();
     
+    if (!socketServer) {
+        socketServer = new AsyncWebServer(WEBSOCKET_PORT);
+        statusSocket = new AsyncWebSocket(WS_PATH);
+        statusSocket->onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type,
+                                     void* arg, uint8_t* data, size_t length) {
+            handleSocketEvent(client, type);
+        });
+        socketServer->addHandler(statusSocket);
+    }
+    socketServer->begin();
+    webServerRunning = true;
+    
     if (logger) {
         logger->logInfo(EVENT_SYSTEM_START, "Web server started", "Port: " + String(HTTP_PORT));
     }
 }
 
 void NetworkManager::stopWebServer() {
-    if (webServer) {
-        webServer->stop();
-        delete webServer;
-        webServer = nullptr;
+    if (webServerRunning) {
+        // Not closeAll(): the library's client list is only walked on the AsyncTCP task
+        xSemaphoreTake(liveClientsLock, portMAX_DELAY);
+        for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (liveClients[i]) {
+                liveClients[i]->close();
+            }
+        }
+        xSemaphoreGive(liveClientsLock);
+        socketServer->end();
+        webServer->end();
+        webServerRunning = false;
         
         if (logger) {
             logger->logInfo(EVENT_SYSTEM_START, "Web server stopped");
@@ -280,25 +675,137 @@ void NetworkManager::stopWebServer() {
 }
 
 void NetworkManager::syncTime() {
-    if (!timeClient) {
+    sntpClient.requestNow();
+}
+
+void NetworkManager::updateTimeSync() {
+    if (ntpServerAddress == 0) {
+        resolveNtpServer();
         return;
     }
     
-    timeClient->begin();
-    if (timeClient->update()) {
-        if (rtc) {
-            rtc->setTime(timeClient->getEpochTime());
+    SntpStatus status = sntpClient.update(esp_timer_get_time(), systemClockUs() - TIMEZONE_OFFSET_US);
+    if (status == SNTP_SAMPLE) {
+        const SntpSample& sample = sntpClient.getSample();
+        ClockCorrection correction = clockDiscipline.addSample(sample.offsetUs, sample.delayUs, sample.monotonicUs,
+                                                               pendingClockAdjustment());
+        applyClockCorrection(correction);
+        sntpClient.setPollInterval(clockDiscipline.getPollInterval());
+        
+        // A lease taken before the clock was set gets its age now, so later reconnects can reuse it
+        if (correction.action == CLOCK_STEP && wifiCache.valid && wifiCache.leaseTime == 0 && !leaseConfirming) {
+            wifiCache.leaseTime = (uint32_t)time(nullptr) - (millis() - connectedAt) / 1000;
+            preferences.putBytes("wificache", &wifiCache, sizeof(wifiCache));
         }
+    } else if (status == SNTP_REJECTED) {
+        // Kiss-o'-death or an unsynchronized server: let DNS pick another pool member
+        ntpServerAddress = 0;
+        if (logger) logger->logWarning(EVENT_SYSTEM_START, "NTP server rejected the request");
+    } else if (status == SNTP_TIMEOUT) {
+        if (logger) logger->logDebug(EVENT_SYSTEM_START, "NTP request timed out");
+    }
+}
+
+void NetworkManager::updateClockDrift(unsigned long currentTime) {
+    if (currentTime - lastDriftTick < CLOCK_DRIFT_TICK_MS) {
+        return;
+    }
+    lastDriftTick = currentTime;
+    
+    // Keeps time between syncs, with or without WiFi
+    slewClock(clockDiscipline.driftCorrection(esp_timer_get_time()));
+}
+
+void NetworkManager::resolveNtpServer() {
+    if (ntpResolving || (lastResolveAttempt != 0 && millis() - lastResolveAttempt < SNTP_RETRY_MIN_S * 1000UL)) {
+        return;
+    }
+    lastResolveAttempt = millis();
+    
+    // Answered from the DNS cache or later through the callback; never waits
+    ip_addr_t address;
+    err_t result = dns_gethostbyname(NTP_SERVER, &address, &NetworkManager::onNtpServerResolved, this);
+    if (result == ERR_OK) {
+        ntpServerAddress = ip_addr_get_ip4_u32(&address);
+    } else if (result == ERR_INPROGRESS) {
+        ntpResolving = true;
+    }
+}
+
+void NetworkManager::onNtpServerResolved(const char* name, const ip_addr_t* address, void* context) {
+    // lwIP task
+    NetworkManager* self = static_cast<NetworkManager*>(context);
+    self->ntpServerAddress = address ? ip_addr_get_ip4_u32(address) : 0;
+    self->ntpResolving = false;
+}
+
+void NetworkManager::applyClockCorrection(const ClockCorrection& correction) {
+    if (correction.action == CLOCK_STEP) {
+        // Only when the clock was never set or is off by more than SNTP_STEP_THRESHOLD_MS.
+        // settimeofday() also cancels any adjtime() still in progress.
+        int64_t target = systemClockUs() + correction.amountUs;
+        struct timeval now;
+        now.tv_sec = (time_t)(target / 1000000);
+        now.tv_usec = (suseconds_t)(target % 1000000);
+        settimeofday(&now, nullptr);
         
         if (logger) {
-            logger->logInfo(EVENT_SYSTEM_START, "Time synchronized", 
-                           "Epoch: " + String(timeClient->getEpochTime()));
+            logger->logInfo(EVENT_SYSTEM_START, "Time synchronized",
+                            "Epoch: " + String((uint32_t)now.tv_sec) +
+                            ", step " + String((int32_t)(correction.amountUs / 1000)) + " ms");
         }
-    } else {
+    } else if (correction.action == CLOCK_SLEW) {
+        slewClock(correction.amountUs);
+        
         if (logger) {
-            logger->logWarning(EVENT_SYSTEM_START, "Failed to sync time from NTP");
+            logger->logDebug(EVENT_SYSTEM_START, "Time slewed",
+                             String((int32_t)(clockDiscipline.getLastOffsetUs() / 1000)) + " ms, drift " +
+                             String(clockDiscipline.getDriftPpm(), 2) + " ppm, next sync in " +
+                             String(clockDiscipline.getPollInterval()) + " s");
         }
+    } else if (logger) {
+        logger->logDebug(EVENT_SYSTEM_START, "NTP reply ignored",
+                         "Delay " + String(sntpClient.getSample().delayUs / 1000) + " ms");
+    }
+}
+
+void NetworkManager::slewClock(int64_t amountUs) {
+    if (amountUs == 0) {
+        return;
+    }
+    
+    // adjtime() replaces the outstanding adjustment, so carry that over
+    int64_t total = pendingClockAdjustment() + amountUs;
+    struct timeval delta;
+    delta.tv_sec = (time_t)(total / 1000000);
+    delta.tv_usec = (suseconds_t)(total % 1000000);
+    adjtime(&delta, nullptr);
+}
+
+int64_t NetworkManager::pendingClockAdjustment() {
+    struct timeval remaining;
+    if (adjtime(nullptr, &remaining) != 0) {
+        return 0;
+    }
+    return (int64_t)remaining.tv_sec * 1000000 + remaining.tv_usec;
+}
+
+bool NetworkManager::sendNtpPacket(void* context, const uint8_t* packet, size_t length) {
+    NetworkManager* self = static_cast<NetworkManager*>(context);
+    if (!self->ntpUDP.beginPacket(IPAddress((uint32_t)self->ntpServerAddress), NTP_PORT)) {
+        return false;
+    }
+    self->ntpUDP.write(packet, length);
+    return self->ntpUDP.endPacket() == 1;
+}
+
+size_t NetworkManager::receiveNtpPacket(void* context, uint8_t* packet, size_t capacity) {
+    NetworkManager* self = static_cast<NetworkManager*>(context);
+    if (self->ntpUDP.parsePacket() <= 0) {
+        return 0;
     }
+    int length = self->ntpUDP.read(packet, capacity);
+    return length > 0 ? (size_t)length : 0;
 }
 
 void NetworkManager::initializeOTA() {
@@ -347,192 +854,1245 @@ void NetworkManager::initializeOTA() {
 }
 
 // Web server handlers
-void NetworkManager::handleRoot() {
-    String html = R"(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>Smart Alarm Configuration</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-        body { font-family: Arial, sans-serif; margin: 20px; }
-        .container { max-width: 600px; margin: 0 auto; }
-        .form-group { margin-bottom: 15px; }
-        label { display: block; margin-bottom: 5px; }
-        input, select { width: 100%; padding: 8px; margin-bottom: 10px; }
-        button { background: #007cba; color: white; padding: 10px 20px; border: none; cursor: pointer; }
-        button:hover { background: #005a87; }
-        .status { background: #f0f0f0; padding: 15px; margin: 10px 0; }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <h1>Smart Alarm System</h1>
-        
-        <div class="status">
-            <h3>System Status</h3>
-            <p>WiFi: <span id="wifi-status">Loading...</span></p>
-            <p>Time: <span id="current-time">Loading...</span></p>
-            <p>Alarms: <span id="alarm-count">Loading...</span></p>
-        </div>
-        
-        <h2>WiFi Configuration</h2>
-        <form action="/setwifi" method="post">
-            <div class="form-group">
-                <label>SSID:</label>
-                <input type="text" name="ssid" required>
-            </div>
-            <div class="form-group">
-                <label>Password:</label>
-                <input type="password" name="password">
-            </div>
-            <button type="submit">Connect WiFi</button>
-        </form>
-        
-        <h2>Add Alarm</h2>
-        <form action="/setalarm" method="post">
-            <div class="form-group">
-                <label>Time:</label>
-                <input type="time" name="time" required>
-            </div>
-            <div class="form-group">
-                <label>Days:</label>
-                <select name="days">
-                    <option value="daily">Daily</option>
-                    <option value="weekdays">Weekdays</option>
-                    <option value="weekends">Weekends</option>
-                </select>
-            </div>
-            <div class="form-group">
-                <label>Label:</label>
-                <input type="text" name="label" placeholder="Optional alarm label">
-            </div>
-            <button type="submit">Add Alarm</button>
-        </form>
-    </div>
-    
-    <script>
-        function updateStatus() {
-            fetch('/status')
-                .then(response => response.json())
-                .then(data => {
-                    document.getElementById('wifi-status').textContent = data.wifi;
-                    document.getElementById('current-time').textContent = data.time;
-                    document.getElementById('alarm-count').textContent = data.alarms;
-                })
-                .catch(error => console.error('Error:', error));
-        }
-        
-        // Update status every 5 seconds
-        updateStatus();
-        setInterval(updateStatus, 5000);
-    </script>
-</body>
-</html>
-    )";
-    
-    webServer->send(200, "text/html", html);
-}
-
-void NetworkManager::handleSetAlarm() {
-    String timeStr = webServer->arg("time");
-    String days = webServer->arg("days");
-    String label = webServer->arg("label");
-    
-    // Parse time (HH:MM format)
-    int colonIndex = timeStr.indexOf(':');
-    if (colonIndex > 0) {
-        int hour = timeStr.substring(0, colonIndex).toInt();
-        int minute = timeStr.substring(colonIndex + 1).toInt();
-        
-        if (commandCallback) {
-            String command = "SETALARM:" + String(hour) + ":" + String(minute) + ":" + days + ":" + label;
-            commandCallback("SETALARM", command);
-        }
-        
-        webServer->send(200, "text/plain", "Alarm set successfully");
+void NetworkManager::handleAsset(AsyncWebServerRequest* request, const WebAsset& asset) {
+    lastWebRequest = millis();      // Someone is using the interface: keep the radio at full power
+    
+    // The ETag is the content hash, so a match means the client's copy is current
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value().indexOf(asset.etag) >= 0) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", asset.etag);
+        response->addHeader("Cache-Control", asset.cacheControl);
+        request->send(response);
+        return;
+    }
+    
+    // Sent chunk by chunk straight from flash; the body is never copied to the heap
+    AsyncWebServerResponse* response = request->beginResponse_P(200, asset.contentType, asset.data, asset.length);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("Vary", "Accept-Encoding");
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", asset.cacheControl);
+    request->send(response);
+}
+
+void NetworkManager::handleSetAlarm(AsyncWebServerRequest* request) {
+    Command command;
+    const char* error = readAlarmFields(request, nullptr, &command.add(CMD_ADD_ALARM)->alarm);
+    if (error) {
+        request->send(400, "text/plain", error);
+    } else if (!queueCommand(command)) {
+        request->send(503, "text/plain", "Busy, try again");
     } else {
-        webServer->send(400, "text/plain", "Invalid time format");
+        request->send(200, "text/plain", "Alarm set successfully");
     }
 }
 
-void NetworkManager::handleGetStatus() {
-    DynamicJsonDocument doc(512);
+void NetworkManager::handleGetStatus(AsyncWebServerRequest* request) {
+    lastWebRequest = millis();
+    
+    // Rendered again only when what it shows changed; heap and radio time are sampled along with it
+    StatusInputs inputs;
+    memset(&inputs, 0, sizeof(inputs));
+    inputs.uptime = millis() / 1000;
+    inputs.connectedAt = connectedAt;
+    inputs.alarmsVersion = alarmManager ? alarmManager->getAlarmTableVersion() : 0;
+    inputs.connectMs = lastConnectMs;
+    inputs.apiHeapPeak = apiHeapPeak;
+    inputs.apiBusyRejects = apiBusyRejects;
+    inputs.state = currentState;
+    if (!statusCache.isValid() || memcmp(&inputs, &statusInputs, sizeof(inputs)) != 0) {
+        statusInputs = inputs;
+        renderStatus();
+    }
+    if (!statusCache.isValid()) {
+        request->send(500, "text/plain", "Response too large");
+        return;
+    }
     
-    doc["wifi"] = (currentState == NETWORK_CONNECTED) ? ("Connected (" + WiFi.localIP().toString() + ")") : 
-                  (currentState == NETWORK_AP_MODE) ? "AP Mode" : "Disconnected";
-    doc["time"] = rtc ? rtc->getTime("%Y-%m-%d %H:%M:%S") : "Not set";
-    doc["alarms"] = "0"; // TODO: Get actual alarm count
-    doc["uptime"] = millis() / 1000;
+    // ?fields=wifi,alarms sends only those, in document order
+    uint32_t fields = STATUS_ALL_FIELDS;
+    if (request->hasArg("fields")) {
+        fields = statusCache.parseFields(request->arg("fields").c_str());
+        if (fields == 0) {
+            request->send(400, "text/plain", "Unknown or empty fields");
+            return;
+        }
+    }
     
-    String jsonString;
-    serializeJson(doc, jsonString);
+    // The ETag hashes the bytes of this selection, so it holds while those fields stay the same
+    char etag[12];
+    statusCache.formatETag(fields, etag);
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value().indexOf(etag) >= 0) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+        return;
+    }
     
-    webServer->send(200, "application/json", jsonString);
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    size_t length = statusCache.copy(fields, jsonBuffers[slot], API_BUFFER_SIZE);
+    sendBuffer(request, slot, length, etag);
 }
 
-void NetworkManager::handleSetWiFi() {
-    String newSsid = webServer->arg("ssid");
-    String newPassword = webServer->arg("password");
+void NetworkManager::renderStatus() {
+    AlarmTable table;
+    table.count = 0;
+    if (alarmManager) {
+        alarmManager->readAlarmTable(&table);
+    }
+    RadioReport radio;
+    radioReport.read(&radio);
+    
+    JsonWriter json(statusCache.getBuffer(), statusCache.getCapacity());
+    char text[32];
     
-    if (!newSsid.isEmpty()) {
-        connectWiFi(newSsid, newPassword);
-        webServer->send(200, "text/plain", "WiFi credentials updated. Connecting...");
+    statusCache.beginRender(json);
+    statusCache.field(json, "wifi");
+    if (currentState == NETWORK_CONNECTED) {
+        IPAddress ip = WiFi.localIP();
+        snprintf(text, sizeof(text), "Connected (%u.%u.%u.%u)", ip[0], ip[1], ip[2], ip[3]);
+        json.string(text);
     } else {
-        webServer->send(400, "text/plain", "SSID cannot be empty");
+        json.string(currentState == NETWORK_AP_MODE ? "AP Mode" : "Disconnected");
+    }
+    
+    // The system clock holds local time, as rtc->getTime() would format it
+    statusCache.field(json, "time");
+    if (rtc) {
+        time_t now = time(nullptr);
+        struct tm local;
+        localtime_r(&now, &local);
+        strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+        json.string(text);
+    } else {
+        json.string("Not set");
     }
-}
-
-void NetworkManager::handleOTA() {
-    String html = R"(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>OTA Update</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-</head>
-<body>
-    <h1>OTA Update Ready</h1>
-    <p>Use Arduino IDE or PlatformIO to upload firmware via OTA.</p>
-    <p>Device IP: )" + getLocalIP() + R"(</p>
-    <p>OTA Port: )" + String(OTA_PORT) + R"(</p>
-    <p>Password: [Protected]</p>
-</body>
-</html>
-    )";
     
-    webServer->send(200, "text/html", html);
+    statusCache.field(json, "alarms");
+    json.unsignedNumber(table.count);
+    statusCache.field(json, "uptime");
+    json.unsignedNumber(statusInputs.uptime);
+    statusCache.field(json, "otaPort");
+    json.unsignedNumber(OTA_PORT);
+    statusCache.field(json, "wsPort");
+    json.unsignedNumber(WEBSOCKET_PORT);
+    statusCache.field(json, "connectMs");
+    json.unsignedNumber(lastConnectMs);
+    statusCache.field(json, "radioOnMs");
+    json.unsignedNumber(radio.onMs[0]);
+    statusCache.field(json, "heapFree");
+    json.unsignedNumber(ESP.getFreeHeap());
+    statusCache.field(json, "heapMin");
+    json.unsignedNumber(ESP.getMinFreeHeap());
+    statusCache.field(json, "apiHeapPeak");
+    json.unsignedNumber(apiHeapPeak);
+    statusCache.field(json, "apiBusy");
+    json.unsignedNumber(apiBusyRejects);
+    statusCache.field(json, "statusRenders");
+    json.unsignedNumber(statusCache.getRenderCount() + 1);
+    statusCache.finish(json);
 }
 
-void NetworkManager::handleNotFound() {
-    webServer->send(404, "text/plain", "Not Found");
+void NetworkManager::handleSetWiFi(AsyncWebServerRequest* request) {
+    String newSsid = request->arg("ssid");
+    String newPassword = request->arg("password");
+    
+    if (newSsid.isEmpty() || newSsid.length() > 32 || newPassword.length() > 63) {
+        request->send(400, "text/plain", "SSID must be 1-32 and password 0-63 characters");
+        return;
+    }
+    
+    // Reconnecting restarts the server, so it has to wait for the main loop
+    Command command;
+    CommandOp* op = command.add(CMD_SET_WIFI);
+    memcpy(op->wifi.ssid, newSsid.c_str(), newSsid.length() + 1);
+    memcpy(op->wifi.password, newPassword.c_str(), newPassword.length() + 1);
+    if (!queueCommand(command)) {
+        request->send(503, "text/plain", "Busy, try again");
+        return;
+    }
+    request->send(200, "text/plain", "WiFi credentials updated. Connecting...");
 }
 
-// Helper methods
-bool NetworkManager::loadWiFiCredentials() {
-    ssid = preferences.getString("ssid", "");
-    password = preferences.getString("password", "");
+void NetworkManager::handleGetHistory(AsyncWebServerRequest* request) {
+    if (!sensorManager) {
+        request->send(503, "text/plain", "History not available");
+        return;
+    }
     
-    return !ssid.isEmpty();
+    // ?ch=light|usb|pillbox&res=minute|hour|day&from=<epoch>&to=<epoch>
+    String channelArg = request->arg("ch");
+    String resolutionArg = request->arg("res");
+    
+    HistoryChannel channel = HISTORY_LIGHT;
+    if (channelArg == "usb") channel = HISTORY_USB;
+    else if (channelArg == "pillbox") channel = HISTORY_PILL_BOX;
+    else if (!channelArg.isEmpty() && channelArg != "light") {
+        request->send(400, "text/plain", "Unknown channel");
+        return;
+    }
+    
+    HistoryResolution resolution = HISTORY_MINUTE;
+    if (resolutionArg == "hour") resolution = HISTORY_HOUR;
+    else if (resolutionArg == "day") resolution = HISTORY_DAY;
+    else if (!resolutionArg.isEmpty() && resolutionArg != "minute") {
+        request->send(400, "text/plain", "Unknown resolution");
+        return;
+    }
+    
+    uint32_t to = request->hasArg("to") ? (uint32_t)request->arg("to").toInt() : (uint32_t)time(nullptr);
+    uint32_t from = request->hasArg("from") ? (uint32_t)request->arg("from").toInt() : 0;
+    
+    HistoryBucket buckets[HISTORY_MINUTE_BUCKETS];
+    uint32_t firstBucketTime = 0;
+    size_t count = sensorManager->queryHistory(channel, resolution, from, to, buckets,
+                                               HISTORY_MINUTE_BUCKETS, &firstBucketTime);
+    
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    
+    // Compact column arrays: {"ch":..,"res":<seconds>,"t0":..,"n":[..],"min":[..],"max":[..],"avg":[..]}
+    json.beginObject();
+    json.key("ch");
+    json.string(SensorHistory::channelName(channel));
+    json.key("res");
+    json.unsignedNumber(SensorHistory::periodSeconds(resolution));
+    json.key("t0");
+    json.unsignedNumber(firstBucketTime);
+    
+    const char* columns[] = {"n", "min", "max", "avg"};
+    for (int column = 0; column < 4; column++) {
+        json.key(columns[column]);
+        json.beginArray();
+        for (size_t i = 0; i < count; i++) {
+            switch (column) {
+                case 0: json.unsignedNumber(buckets[i].count); break;
+                case 1: json.unsignedNumber(buckets[i].minValue); break;
+                case 2: json.unsignedNumber(buckets[i].maxValue); break;
+                default: json.unsignedNumber(buckets[i].avgValue); break;
+            }
+        }
+        json.endArray();
+    }
+    json.endObject();
+    
+    sendJson(request, slot, json);
 }
 
-void NetworkManager::saveWiFiCredentials(const String& newSsid, const String& newPassword) {
-    preferences.putString("ssid", newSsid);
-    preferences.putString("password", newPassword);
+void NetworkManager::handleGetTimeSeries(AsyncWebServerRequest* request) {
+    // ?ch=light|usb|pillbox&file=dat|idx&old=1 - raw files for tools/ts_decode.py
+    String channelArg = request->arg("ch");
+    HistoryChannel channel = HISTORY_LIGHT;
+    if (channelArg == "usb") channel = HISTORY_USB;
+    else if (channelArg == "pillbox") channel = HISTORY_PILL_BOX;
+    
+    bool rotated = request->arg("old") == "1";
+    String path = request->arg("file") == "idx" ? TimeSeriesStore::indexPath(channel, rotated)
+                                                : TimeSeriesStore::dataPath(channel, rotated);
+    
+    if (!LittleFS.exists(path)) {
+        request->send(404, "text/plain", "No time series data");
+        return;
+    }
+    
+    // Streamed from the file in TCP-window sized chunks as the client acknowledges
+    request->send(LittleFS, path, "application/octet-stream");
 }
 
-String NetworkManager::getLocalIP() const {
-    if (currentState == NETWORK_CONNECTED) {
-        return WiFi.localIP().toString();
-    } else if (currentState == NETWORK_AP_MODE) {
-        return WiFi.softAPIP().toString();
+void NetworkManager::handleGetPatterns(AsyncWebServerRequest* request) {
+    if (!patternLibrary) {
+        request->send(503, "text/plain", "Patterns not available");
+        return;
     }
-    return "Not connected";
+    request->send(200, "application/json", patternLibrary->list());
 }
 
-int NetworkManager::getSignalStrength() const {
-    if (currentState == NETWORK_CONNECTED) {
-        return WiFi.RSSI();
+void NetworkManager::handleUploadPattern(AsyncWebServerRequest* request) {
+    // POST /patterns?name=<name>&format=rtttl|dsl with the source as the body
+    if (!patternLibrary) {
+        request->send(503, "text/plain", "Patterns not available");
+        return;
+    }
+    
+    String name = request->arg("name");
+    if (!PatternLibrary::isValidName(name) || patternLibrary->isReservedName(name)) {
+        request->send(400, "text/plain", "Invalid pattern name");
+        return;
+    }
+    
+    // Collected by handlePatternBody(); the server frees _tempObject with the request
+    const char* source = static_cast<const char*>(request->_tempObject);
+    if (!source || source[0] == '\0') {
+        request->send(413, "text/plain", "Pattern source empty or too large");
+        return;
+    }
+    
+    // One upload at a time: the main loop reads patternCode until the store has run
+    CommandResult pending;
+    if (patternTicket && commands && commands->getResult(patternTicket, &pending) == COMMAND_PENDING) {
+        request->send(503, "text/plain", "Busy, try again");
+        return;
+    }
+    
+    String formatArg = request->arg("format");
+    PatternFormat format = formatArg == "rtttl" ? PATTERN_FORMAT_RTTTL :
+                           formatArg == "dsl" ? PATTERN_FORMAT_DSL : PATTERN_FORMAT_AUTO;
+    
+    // Compiled once here; playback only ever sees bytecode
+    PatternCompileResult result;
+    if (!PatternCompiler::compile(source, format, patternCode, sizeof(patternCode), &result)) {
+        request->send(400, "application/json",
+                      "{\"error\":\"" + String(result.error) + "\",\"offset\":" + String(result.errorOffset) + "}");
+        return;
+    }
+    
+    // Writing flash stalls every connection, so the store runs on the main loop
+    Command command;
+    CommandOp* op = command.add(CMD_STORE_PATTERN);
+    memcpy(op->pattern.name, name.c_str(), name.length() + 1);
+    op->pattern.length = result.length;
+    op->pattern.code = patternCode;
+    uint32_t ticket = queueCommand(command);
+    if (ticket == 0) {
+        request->send(503, "text/plain", "Busy, try again");
+        return;
+    }
+    patternTicket = ticket;
+    
+    request->send(202, "application/json",
+                  "{\"queued\":true,\"command\":" + String(ticket) + ",\"name\":\"" + name +
+                  "\",\"bytes\":" + String(result.length) + ",\"ms\":" + String(result.durationMs) + "}");
+}
+
+void NetworkManager::handlePatternBody(AsyncWebServerRequest* request, uint8_t* data, size_t length,
+                                       size_t index, size_t total) {
+    if (total > PATTERN_MAX_SOURCE) {
+        return;     // No buffer, so handleUploadPattern() answers 413
+    }
+    if (index == 0) {
+        request->_tempObject = malloc(total + 1);
+    }
+    char* source = static_cast<char*>(request->_tempObject);
+    if (!source || index + length > total) {
+        return;
+    }
+    memcpy(source + index, data, length);
+    source[index + length] = '\0';
+}
+
+void NetworkManager::handleDeletePattern(AsyncWebServerRequest* request) {
+    if (!patternLibrary) {
+        request->send(503, "text/plain", "Patterns not available");
+        return;
+    }
+    
+    String name = request->arg("name");
+    if (!PatternLibrary::isValidName(name)) {
+        request->send(404, "text/plain", "Pattern not found");
+        return;
+    }
+    
+    // Removing the file erases flash, which is no job for the TCP task
+    Command command;
+    memcpy(command.add(CMD_DELETE_PATTERN)->pattern.name, name.c_str(), name.length() + 1);
+    sendQueued(request, queueCommand(command));
+}
+
+void NetworkManager::handleNotFound(AsyncWebServerRequest* request) {
+    request->send(404, "text/plain", "Not Found");
+}
+
+// REST API
+struct LogPage {
+    JsonWriter* json;
+    bool truncated;
+};
+
+static bool writeLogEntry(void* context, const LogEntry& entry) {
+    LogPage* page = static_cast<LogPage*>(context);
+    JsonWriter& json = *page->json;
+    JsonWriter::Mark before = json.mark();
+    
+    json.beginObject();
+    json.key("t");
+    json.unsignedNumber(entry.timestamp);
+    json.key("level");
+    json.string(Logger::levelName(entry.level));
+    json.key("event");
+    json.string(Logger::eventName(entry.eventType));
+    json.key("msg");
+    json.string(entry.message.c_str());
+    if (!entry.data.isEmpty()) {
+        json.key("data");
+        json.string(entry.data.c_str());
+    }
+    json.endObject();
+    
+    // Stop at the last whole entry that leaves room to close the page
+    if (json.overflowed() || json.remaining() < API_PAGE_RESERVE) {
+        json.rollback(before);
+        page->truncated = true;
+        return false;
+    }
+    return true;
+}
+
+// "HH:MM" <-> minutes after midnight, -1 when malformed
+static int parseMinuteOfDay(const String& text) {
+    int colonIndex = text.indexOf(':');
+    int hour = colonIndex > 0 ? text.substring(0, colonIndex).toInt() : -1;
+    int minute = colonIndex > 0 ? text.substring(colonIndex + 1).toInt() : -1;
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        return -1;
+    }
+    return hour * 60 + minute;
+}
+
+static void formatMinuteOfDay(uint16_t minuteOfDay, char* text) {
+    snprintf(text, 6, "%02u:%02u", (minuteOfDay / 60) % 24, minuteOfDay % 60);
+}
+
+static void writeAlarm(JsonWriter& json, const AlarmSummary& alarm) {
+    char time[6];
+    snprintf(time, sizeof(time), "%02u:%02u", alarm.hour, alarm.minute);
+    
+    json.beginObject();
+    json.key("id");
+    json.unsignedNumber(alarm.id);
+    json.key("time");
+    json.string(time);
+    json.key("days");
+    json.unsignedNumber(alarm.dayMask);
+    json.key("enabled");
+    json.boolean(alarm.enabled);
+    json.key("repeating");
+    json.boolean(alarm.repeating);
+    if (!alarm.repeating) {
+        json.key("date");
+        json.unsignedNumber(alarm.oneTimeDate);
+    }
+    json.key("label");
+    json.string(alarm.label);
+    json.key("sound");
+    json.string(alarm.sound[0] ? alarm.sound : "alarm");
+    json.key("ramp");
+    json.unsignedNumber(alarm.rampSeconds);
+    json.key("shape");
+    json.string(alarm.rampShape == RAMP_LINEAR ? "linear" : "perceptual");
+    json.endObject();
+}
+
+void NetworkManager::handleApiGetAlarms(AsyncWebServerRequest* request) {
+    // GET /api/alarms, or /api/alarms?id=<id> for one
+    if (!alarmManager) {
+        request->send(503, "text/plain", "Alarms not available");
+        return;
+    }
+    
+    AlarmSummary single;
+    bool one = request->hasArg("id");
+    if (one && !findAlarm(request, &single)) {
+        return;
+    }
+    AlarmTable table;
+    alarmManager->readAlarmTable(&table);
+    
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    
+    if (one) {
+        writeAlarm(json, single);
+    } else {
+        json.beginObject();
+        json.key("max");
+        json.unsignedNumber(MAX_ALARMS);
+        json.key("alarms");
+        json.beginArray();
+        for (uint8_t i = 0; i < table.count; i++) {
+            writeAlarm(json, table.alarms[i]);
+        }
+        json.endArray();
+        json.endObject();
+    }
+    
+    sendJson(request, slot, json);
+}
+
+void NetworkManager::handleApiAddAlarm(AsyncWebServerRequest* request) {
+    // Same fields as /setalarm; applied by the main loop, so the answer is 202
+    if (!alarmManager) {
+        request->send(503, "text/plain", "Alarms not available");
+        return;
+    }
+    
+    AlarmTable table;
+    alarmManager->readAlarmTable(&table);
+    if (table.count >= MAX_ALARMS) {
+        request->send(409, "text/plain", "Alarm limit reached");
+        return;
+    }
+    
+    Command command;
+    const char* error = readAlarmFields(request, nullptr, &command.add(CMD_ADD_ALARM)->alarm);
+    if (error) {
+        request->send(400, "text/plain", error);
+        return;
+    }
+    sendQueued(request, queueCommand(command));
+}
+
+void NetworkManager::handleApiUpdateAlarm(AsyncWebServerRequest* request) {
+    // PUT /api/alarms?id=<id> with any of time, days, enabled, label, sound, ramp, shape
+    AlarmSummary current;
+    if (!findAlarm(request, &current)) {
+        return;
+    }
+    
+    bool enabled = current.enabled;
+    if (request->hasArg("enabled")) {
+        const String& value = request->arg("enabled");
+        enabled = value == "1" || value == "true" || value == "on";
+    }
+    
+    Command command;
+    AlarmOperation* alarm = &command.add(CMD_UPDATE_ALARM)->alarm;
+    const char* error = readAlarmFields(request, &current, alarm);
+    if (error) {
+        request->send(400, "text/plain", error);
+        return;
+    }
+    alarm->id = current.id;
+    alarm->enabled = enabled;
+    sendQueued(request, queueCommand(command));
+}
+
+void NetworkManager::handleApiDeleteAlarm(AsyncWebServerRequest* request) {
+    AlarmSummary current;
+    if (!findAlarm(request, &current)) {
+        return;
+    }
+    
+    Command command;
+    command.add(CMD_DELETE_ALARM)->alarm.id = current.id;
+    sendQueued(request, queueCommand(command));
+}
+
+void NetworkManager::handleApiGetSensors(AsyncWebServerRequest* request) {
+    if (!sensorManager) {
+        request->send(503, "text/plain", "Sensors not available");
+        return;
+    }
+    
+    // Seqlock snapshots: consistent without blocking the sensor update
+    SensorReadings readings = sensorManager->getCurrentReadings();
+    SamplingStats sampling = sensorManager->getSamplingSnapshot();
+    
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    
+    json.beginObject();
+    json.key("light");
+    json.number(readings.lightLevel);
+    json.key("usb");
+    json.boolean(readings.usbConnected);
+    json.key("pillBox");
+    json.boolean(readings.pillBoxOpen);
+    json.key("battery");
+    json.decimal(readings.batteryVoltage, 2);
+    json.key("batteryLevel");
+    json.unsignedNumber(sensorManager->getBatteryLevel());
+    json.key("t");
+    json.unsignedNumber(readings.timestamp);
+    json.key("version");
+    json.unsignedNumber(readings.version);
+    
+    // Adaptive sampling: interval and samples taken this and the previous uptime hour per sensor
+    json.key("sampling");
+    json.beginObject();
+    const char* names[] = {"light", "usb", "pillBox"};
+    const SamplerStats* samplers[] = {&sampling.light, &sampling.usb, &sampling.pillBox};
+    for (int i = 0; i < 3; i++) {
+        json.key(names[i]);
+        json.beginObject();
+        json.key("intervalMs");
+        json.unsignedNumber(samplers[i]->intervalMs);
+        json.key("thisHour");
+        json.unsignedNumber(samplers[i]->samplesThisHour);
+        json.key("lastHour");
+        json.unsignedNumber(samplers[i]->samplesLastHour);
+        json.key("boosted");
+        json.boolean(samplers[i]->boosted);
+        json.endObject();
+    }
+    json.key("bedtimeWindow");
+    json.boolean(sampling.bedtimeWindow);
+    json.endObject();
+    json.endObject();
+    
+    sendJson(request, slot, json);
+}
+
+void NetworkManager::handleApiGetLogs(AsyncWebServerRequest* request) {
+    // ?count=<1-API_LOG_PAGE_MAX>&level=debug|info|warning|error, newest first
+    if (!logger) {
+        request->send(503, "text/plain", "Logs not available");
+        return;
+    }
+    
+    long count = request->hasArg("count") ? request->arg("count").toInt() : 20;
+    if (count < 1) count = 1;
+    if (count > API_LOG_PAGE_MAX) count = API_LOG_PAGE_MAX;
+    
+    LogLevel level = LOG_DEBUG;
+    const String& levelArg = request->arg("level");
+    if (levelArg == "info") level = LOG_INFO;
+    else if (levelArg == "warning") level = LOG_WARNING;
+    else if (levelArg == "error") level = LOG_ERROR;
+    else if (!levelArg.isEmpty() && levelArg != "debug") {
+        request->send(400, "text/plain", "Unknown level");
+        return;
+    }
+    
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    LogPage page = {&json, false};
+    
+    json.beginObject();
+    json.key("now");
+    json.unsignedNumber(millis());
+    json.key("logs");
+    json.beginArray();
+    logger->visitRecentLogs((size_t)count, level, writeLogEntry, &page);
+    json.endArray();
+    json.key("truncated");
+    json.boolean(page.truncated);
+    json.endObject();
+    
+    sendJson(request, slot, json);
+}
+
+void NetworkManager::handleApiClearLogs(AsyncWebServerRequest* request) {
+    // Clearing also erases the flash copy, which is no job for the TCP task
+    Command command;
+    command.add(CMD_CLEAR_LOGS);
+    sendQueued(request, queueCommand(command));
+}
+
+void NetworkManager::handleApiGetConfig(AsyncWebServerRequest* request) {
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    
+    // Read from the driver's own copy; the password is never reported
+    wifi_config_t station;
+    char stationSsid[sizeof(station.sta.ssid) + 1] = "";
+    if (esp_wifi_get_config(WIFI_IF_STA, &station) == ESP_OK) {
+        memcpy(stationSsid, station.sta.ssid, sizeof(station.sta.ssid));
+        stationSsid[sizeof(station.sta.ssid)] = '\0';
+    }
+    
+    RadioReport radio;
+    radioReport.read(&radio);
+    char quietStart[6];
+    char quietEnd[6];
+    formatMinuteOfDay(radio.quietStart, quietStart);
+    formatMinuteOfDay(radio.quietEnd, quietEnd);
+    
+    json.beginObject();
+    json.key("firmware");
+    json.string(FIRMWARE_VERSION);
+    json.key("hardware");
+    json.string(HARDWARE_VERSION);
+    json.key("ssid");
+    json.string(stationSsid);
+    json.key("timezone");
+    json.number(TIMEZONE_OFFSET_HOURS);
+    json.key("logLevel");
+    json.string(logger ? Logger::levelName(logger->getMinLevel()) : "UNKNOWN");
+    json.key("httpPort");
+    json.unsignedNumber(HTTP_PORT);
+    json.key("wsPort");
+    json.unsignedNumber(WEBSOCKET_PORT);
+    json.key("otaPort");
+    json.unsignedNumber(OTA_PORT);
+    json.key("maxAlarms");
+    json.unsignedNumber(MAX_ALARMS);
+    json.key("labelMax");
+    json.unsignedNumber(ALARM_LABEL_MAX);
+    json.key("rampMax");
+    json.unsignedNumber(ALARM_RAMP_MAX_S);
+    json.key("quietStart");
+    json.string(radio.quietStart != radio.quietEnd ? quietStart : nullptr);
+    json.key("quietEnd");
+    json.string(radio.quietStart != radio.quietEnd ? quietEnd : nullptr);
+    json.key("listenInterval");
+    json.unsignedNumber(RADIO_LISTEN_INTERVAL);
+    json.endObject();
+    
+    sendJson(request, slot, json);
+}
+
+void NetworkManager::handleApiSetConfig(AsyncWebServerRequest* request) {
+    // PUT /api/config with logLevel=debug|info|warning|error and/or quietStart=HH:MM&quietEnd=HH:MM
+    // (equal times: no quiet window); WiFi credentials go through /setwifi
+    bool hasLevel = request->hasArg("logLevel");
+    bool hasQuiet = request->hasArg("quietStart") || request->hasArg("quietEnd");
+    if (!hasLevel && !hasQuiet) {
+        request->send(400, "text/plain", "Nothing to change");
+        return;
+    }
+    
+    // One command, so the two changes are applied together and reported under one ticket
+    Command command;
+    if (hasLevel) {
+        const String& levelArg = request->arg("logLevel");
+        uint8_t level;
+        if (levelArg == "debug") level = LOG_DEBUG;
+        else if (levelArg == "info") level = LOG_INFO;
+        else if (levelArg == "warning") level = LOG_WARNING;
+        else if (levelArg == "error") level = LOG_ERROR;
+        else {
+            request->send(400, "text/plain", "Unknown logLevel");
+            return;
+        }
+        command.add(CMD_SET_LOG_LEVEL)->logLevel = level;
+    }
+    
+    if (hasQuiet) {
+        int quietStart = parseMinuteOfDay(request->arg("quietStart"));
+        int quietEnd = parseMinuteOfDay(request->arg("quietEnd"));
+        if (quietStart < 0 || quietEnd < 0) {
+            request->send(400, "text/plain", "quietStart and quietEnd must both be HH:MM");
+            return;
+        }
+        CommandOp* op = command.add(CMD_SET_QUIET_WINDOW);
+        op->quiet.startMinute = quietStart;
+        op->quiet.endMinute = quietEnd;
+    }
+    
+    sendQueued(request, queueCommand(command));
+}
+
+void NetworkManager::handleApiGetCommand(AsyncWebServerRequest* request) {
+    // GET /api/commands?id=<ticket from a 202 reply>
+    if (!commands) {
+        request->send(503, "text/plain", "Commands not available");
+        return;
+    }
+    CommandResult result;
+    uint32_t ticket = strtoul(request->arg("id").c_str(), nullptr, 10);
+    CommandStatus status = commands->getResult(ticket, &result);
+    if (status == COMMAND_UNKNOWN) {
+        request->send(404, "text/plain", "Unknown or expired command");
+        return;
+    }
+    
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    
+    json.beginObject();
+    json.key("id");
+    json.unsignedNumber(ticket);
+    json.key("status");
+    json.string(status == COMMAND_PENDING ? "pending" : status == COMMAND_DONE ? "done" : "failed");
+    if (status != COMMAND_PENDING) {
+        json.key("completed");
+        json.unsignedNumber(result.completed);
+        json.key("values");
+        json.beginArray();
+        for (uint8_t i = 0; i < result.completed; i++) {
+            json.number(result.values[i]);
+        }
+        json.endArray();
+        json.key("error");
+        json.string(result.error);
+    }
+    json.endObject();
+    
+    sendJson(request, slot, json);
+}
+
+void NetworkManager::handleApiGetRadio(AsyncWebServerRequest* request) {
+    RadioReport radio;
+    radioReport.read(&radio);
+    
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    static const char* const modes[] = {"off", "doze", "full"};
+    char quietStart[6];
+    char quietEnd[6];
+    formatMinuteOfDay(radio.quietStart, quietStart);
+    formatMinuteOfDay(radio.quietEnd, quietEnd);
+    
+    json.beginObject();
+    json.key("mode");
+    json.string(modes[radio.mode]);
+    json.key("quiet");
+    json.boolean(radio.quiet);
+    json.key("quietStart");
+    json.string(radio.quietStart != radio.quietEnd ? quietStart : nullptr);
+    json.key("quietEnd");
+    json.string(radio.quietStart != radio.quietEnd ? quietEnd : nullptr);
+    json.key("listenInterval");
+    json.unsignedNumber(RADIO_LISTEN_INTERVAL);
+    json.key("wakes");
+    json.unsignedNumber(radio.wakes);
+    json.key("cutOff");
+    json.unsignedNumber(radio.cutOff);
+    
+    // Radio-on milliseconds per uptime hour, the current hour first
+    json.key("onMs");
+    json.beginArray();
+    for (uint8_t i = 0; i < RADIO_HISTORY_HOURS; i++) {
+        json.unsignedNumber(radio.onMs[i]);
+    }
+    json.endArray();
+    json.endObject();
+    
+    sendJson(request, slot, json);
+}
+
+void NetworkManager::handleApiGetOta(AsyncWebServerRequest* request) {
+    if (!otaUpdater) {
+        request->send(503, "text/plain", "OTA not available");
+        return;
+    }
+    
+    int8_t slot = claimJsonBuffer(request);
+    if (slot < 0) {
+        return;
+    }
+    JsonWriter json(jsonBuffers[slot], API_BUFFER_SIZE);
+    static const char* const states[] = {"idle", "receiving", "ready", "failed"};
+    const esp_app_desc_t* app = esp_ota_get_app_description();
+    OtaUploadStats stats = otaUpdater->getUploadStats();
+    char digest[OTA_SHA256_BYTES * 2 + 1];
+    otaUpdater->getDigestHex(digest);
+    
+    json.beginObject();
+    json.key("partition");
+    json.string(otaUpdater->getRunningPartition());
+    json.key("version");
+    json.string(app->version);
+    json.key("built");
+    json.string((String(app->date) + " " + app->time).c_str());
+    json.key("trial");
+    json.boolean(otaUpdater->isOnTrial());
+    json.key("lastRollback");
+    json.string(otaUpdater->getLastRollback()[0] ? otaUpdater->getLastRollback() : nullptr);
+    json.key("maxImageSize");
+    json.unsignedNumber(otaUpdater->getMaxImageSize());
+    
+    // The last upload since boot
+    json.key("state");
+    json.string(states[otaUpdater->getState()]);
+    json.key("error");
+    json.string(otaUpdater->getState() == OTA_FAILED ? otaUpdater->getError() : nullptr);
+    json.key("delta");
+    json.boolean(otaUpdater->isPatching());
+    json.key("bytes");
+    json.unsignedNumber(stats.bytes);
+    json.key("imageBytes");
+    json.unsignedNumber(stats.imageBytes);
+    json.key("ms");
+    json.unsignedNumber(stats.durationMs);
+    json.key("bytesPerSecond");
+    json.unsignedNumber(stats.bytesPerSecond);
+    json.key("heapUsed");
+    json.unsignedNumber(stats.heapUsed);
+    json.key("bufferBytes");
+    json.unsignedNumber(OTA_WRITE_CHUNK);
+    json.key("sha256");
+    json.string(digest[0] ? digest : nullptr);
+    json.endObject();
+    
+    sendJson(request, slot, json);
+}
+
+void NetworkManager::handleApiOtaUpload(AsyncWebServerRequest* request) {
+    if (!otaUpdater) {
+        request->send(503, "text/plain", "OTA not available");
+        return;
+    }
+    if (!request->authenticate(OTA_HTTP_USER, OTA_PASSWORD)) {
+        request->requestAuthentication();
+        return;
+    }
+    
+    // handleOtaBody() never started this one; say why
+    if (request != otaRequest) {
+        if (alarmActive) {
+            request->send(409, "text/plain", "Alarm active, try again later");
+        } else if (otaUpdater->isBusy()) {
+            request->send(409, "text/plain", "Another update is in progress");
+        } else if (request->contentLength() == 0) {
+            request->send(400, "text/plain", "No firmware in the request body");
+        } else if (request->contentLength() > otaUpdater->getMaxImageSize()) {
+            request->send(413, "text/plain", "Image size does not fit the OTA partition");
+        } else {
+            request->send(400, "text/plain", otaUpdater->getState() == OTA_FAILED ? otaUpdater->getError() :
+                                             "Send the image as application/octet-stream");
+        }
+        return;
+    }
+    otaRequest = nullptr;
+    
+    OtaUploadStats stats = otaUpdater->getUploadStats();
+    char digest[OTA_SHA256_BYTES * 2 + 1];
+    otaUpdater->getDigestHex(digest);
+    bool ready = otaUpdater->getState() == OTA_READY;
+    
+    // The restart waits for the main loop, which gives this response time to leave
+    Command restart;
+    restart.add(CMD_OTA_RESTART);
+    if (ready && !queueCommand(restart)) {
+        otaUpdater->cancelInstall("Busy, upload again");
+        request->send(503, "text/plain", otaUpdater->getError());
+        return;
+    }
+    
+    String body = "{\"ok\":" + String(ready ? "true" : "false");
+    if (!ready) {
+        body += ",\"error\":\"" + String(otaUpdater->getError()) + "\"";
+    }
+    body += ",\"delta\":" + String(otaUpdater->isPatching() ? "true" : "false") +
+            ",\"bytes\":" + String(stats.bytes) + ",\"imageBytes\":" + String(stats.imageBytes) +
+            ",\"ms\":" + String(stats.durationMs) +
+            ",\"bytesPerSecond\":" + String(stats.bytesPerSecond) + ",\"heapUsed\":" + String(stats.heapUsed) +
+            ",\"bufferBytes\":" + String(OTA_WRITE_CHUNK) + ",\"sha256\":" +
+            (digest[0] ? "\"" + String(digest) + "\"" : String("null")) + "}";
+    request->send(ready ? 200 : 400, "application/json", body);
+}
+
+void NetworkManager::handleOtaBody(AsyncWebServerRequest* request, uint8_t* data, size_t length,
+                                   size_t index, size_t total) {
+    if (!otaUpdater) {
+        return;
+    }
+    lastWebRequest = millis();      // Keeps the radio fully on for the whole upload
+    
+    if (index == 0) {
+        // Nothing is written unless this request may and can update; handleApiOtaUpload() says why not.
+        // A delta patch or a whole image, told apart by the first bytes
+        if (!request->authenticate(OTA_HTTP_USER, OTA_PASSWORD) || alarmActive ||
+            !(DeltaDecoder::isPatch(data, length) ? otaUpdater->startPatch(total) :
+                                                    otaUpdater->start(total, request->arg("sha256").c_str()))) {
+            return;
+        }
+        otaRequest = request;
+        
+        // A client that goes away mid-upload leaves a partial image that must not be finished
+        request->onDisconnect([this, request]() {
+            if (otaRequest == request) {
+                otaRequest = nullptr;
+                otaUpdater->abort("Upload aborted");
+            }
+        });
+    }
+    if (request != otaRequest) {
+        return;
+    }
+    
+    if (otaUpdater->write(data, length) && index + length == total) {
+        otaUpdater->finish();
+    }
+}
+
+const char* NetworkManager::readAlarmFields(AsyncWebServerRequest* request, const AlarmSummary* current,
+                                            AlarmOperation* alarm) {
+    // Fields not given keep *current
+    int hour = current ? current->hour : -1;
+    int minute = current ? current->minute : -1;
+    if (request->hasArg("time")) {
+        const String& timeStr = request->arg("time");
+        int colonIndex = timeStr.indexOf(':');
+        hour = colonIndex > 0 ? timeStr.substring(0, colonIndex).toInt() : -1;
+        minute = colonIndex > 0 ? timeStr.substring(colonIndex + 1).toInt() : -1;
+    }
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        return "Invalid time format";
+    }
+    
+    // Days as in /setalarm ("weekdays", "mon,wed") or the numeric mask /api/alarms reports
+    uint8_t dayMask = current ? current->dayMask : 0;
+    if (request->hasArg("days")) {
+        dayMask = AlarmManager::stringToDayMask(request->arg("days"));
+    }
+    
+    const char* sound = request->hasArg("sound") ? request->arg("sound").c_str() : current ? current->sound : "";
+    const char* label = request->hasArg("label") ? request->arg("label").c_str() : current ? current->label : "";
+    
+    long rampSeconds = request->hasArg("ramp") ? request->arg("ramp").toInt() : current ? current->rampSeconds : 0;
+    int rampShape = current ? current->rampShape : RAMP_PERCEPTUAL;
+    if (request->hasArg("shape")) {
+        rampShape = request->arg("shape") == "linear" ? RAMP_LINEAR : RAMP_PERCEPTUAL;
+    }
+    if (rampSeconds < 0 || rampSeconds > ALARM_RAMP_MAX_S) {
+        return "Ramp out of range";
+    }
+    // Empty plays the default; anything else must be a name a pattern or clip could be stored under
+    if (sound[0] && !PatternLibrary::isValidName(String(sound))) {
+        return "Invalid days or sound";
+    }
+    if (strlen(label) > ALARM_LABEL_MAX) {
+        return "Alarm label too long";
+    }
+    
+    alarm->hour = hour;
+    alarm->minute = minute;
+    alarm->dayMask = dayMask;
+    alarm->rampShape = rampShape;
+    alarm->rampSeconds = rampSeconds;
+    strcpy(alarm->sound, sound);
+    strcpy(alarm->label, label);
+    return nullptr;
+}
+
+bool NetworkManager::findAlarm(AsyncWebServerRequest* request, AlarmSummary* alarm) {
+    if (!alarmManager) {
+        request->send(503, "text/plain", "Alarms not available");
+        return false;
+    }
+    
+    AlarmTable table;
+    alarmManager->readAlarmTable(&table);
+    long id = request->arg("id").toInt();
+    for (uint8_t i = 0; i < table.count; i++) {
+        if (table.alarms[i].id == id) {
+            *alarm = table.alarms[i];
+            return true;
+        }
+    }
+    request->send(404, "text/plain", "Alarm not found");
+    return false;
+}
+
+int8_t NetworkManager::claimJsonBuffer(AsyncWebServerRequest* request) {
+    lastWebRequest = millis();
+    uint32_t heap = ESP.getFreeHeap();
+    for (int8_t slot = 0; slot < API_BUFFER_COUNT; slot++) {
+        if (!jsonBufferBusy[slot]) {
+            jsonBufferBusy[slot] = true;
+            jsonHeapBefore[slot] = heap;
+            return slot;
+        }
+    }
+    
+    // Every buffer is still being sent; queueing here would only grow the heap
+    apiBusyRejects++;
+    request->send(503, "text/plain", "Busy, try again");
+    return -1;
+}
+
+void NetworkManager::sendJson(AsyncWebServerRequest* request, int8_t slot, const JsonWriter& json) {
+    if (json.overflowed() || !json.isComplete()) {
+        jsonBufferBusy[slot] = false;
+        request->send(500, "text/plain", "Response too large");
+        return;
+    }
+    sendBuffer(request, slot, json.size(), nullptr);
+}
+
+void NetworkManager::sendBuffer(AsyncWebServerRequest* request, int8_t slot, size_t length, const char* etag) {
+    if (length == 0) {
+        jsonBufferBusy[slot] = false;
+        request->send(500, "text/plain", "Response too large");
+        return;
+    }
+    
+    // Copied into the TCP window as it opens; the buffer is free again once the request is gone
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "application/json",
+                                                                (const uint8_t*)jsonBuffers[slot], length);
+    if (etag) {
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", "no-cache");       // May be kept, but asked for again with the ETag
+    } else {
+        response->addHeader("Cache-Control", "no-store");
+    }
+    request->onDisconnect([slot]() { jsonBufferBusy[slot] = false; });
+    request->send(response);
+    
+    // What the response holds on the heap besides its body: the object, headers and first segment
+    uint32_t heap = ESP.getFreeHeap();
+    if (jsonHeapBefore[slot] > heap && jsonHeapBefore[slot] - heap > apiHeapPeak) {
+        apiHeapPeak = jsonHeapBefore[slot] - heap;
+    }
+}
+
+// Command hand-off
+uint32_t NetworkManager::queueCommand(const Command& command) {
+    lastWebRequest = millis();
+    
+    // Never waits: a full queue is reported to the client instead of stalling the TCP task
+    return commands ? commands->push(command) : 0;
+}
+
+void NetworkManager::sendQueued(AsyncWebServerRequest* request, uint32_t ticket) {
+    if (ticket == 0) {
+        request->send(503, "text/plain", "Busy, try again");
+        return;
+    }
+    
+    // The main loop runs it shortly; GET /api/commands?id=<ticket> tells how it went
+    char body[40];
+    snprintf(body, sizeof(body), "{\"queued\":true,\"command\":%u}", ticket);
+    request->send(202, "application/json", body);
+}
+
+// Live status
+void NetworkManager::handleSocketEvent(AsyncWebSocketClient* client, AwsEventType type) {
+    if (type != WS_EVT_CONNECT && type != WS_EVT_DISCONNECT) {
+        return;     // Push only; anything the browser sends is ignored
+    }
+    
+    // A connect takes a free slot, a disconnect gives its own back before the library frees the client
+    AsyncWebSocketClient* match = type == WS_EVT_CONNECT ? nullptr : client;
+    uint8_t slot = WS_MAX_CLIENTS;
+    xSemaphoreTake(liveClientsLock, portMAX_DELAY);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS && slot == WS_MAX_CLIENTS; i++) {
+        if (liveClients[i] == match) {
+            slot = i;
+            liveClients[i] = type == WS_EVT_CONNECT ? client : nullptr;
+        }
+    }
+    xSemaphoreGive(liveClientsLock);
+    
+    if (slot == WS_MAX_CLIENTS) {
+        if (type == WS_EVT_CONNECT) {
+            client->close();    // Full; its disconnect then finds no slot either
+        }
+        return;
+    }
+    
+    SocketEvent event = {client->id(), type == WS_EVT_CONNECT};
+    xQueueSend(socketEvents, &event, 0);
+}
+
+void NetworkManager::pushLiveStatus(unsigned long currentTime) {
+    SocketEvent event;
+    while (socketEvents && xQueueReceive(socketEvents, &event, 0) == pdTRUE) {
+        if (!event.connected) {
+            liveStatus.removeClient(event.clientId);
+        } else if (!liveStatus.addClient(event.clientId)) {
+            xSemaphoreTake(liveClientsLock, portMAX_DELAY);
+            AsyncWebSocketClient* client = findLiveClient(event.clientId);
+            if (client) {
+                client->close();
+            }
+            xSemaphoreGive(liveClientsLock);
+        }
+    }
+    
+    if (!webServerRunning || currentTime - lastLivePush < WS_PUSH_INTERVAL_MS) {
+        return;
+    }
+    lastLivePush = currentTime;
+    
+    // Everything set since the last push goes out as one revision
+    liveStatus.set(LIVE_NETWORK, currentState);
+    liveStatus.commit();
+    if (liveStatus.clientCount() > 0) {
+        // Held across the sends, so no client goes away while it is written to
+        xSemaphoreTake(liveClientsLock, portMAX_DELAY);
+        liveStatus.flush(&NetworkManager::sendLiveStatus, this);
+        xSemaphoreGive(liveClientsLock);
+    }
+}
+
+bool NetworkManager::sendLiveStatus(void* context, uint32_t clientId, const char* message, size_t length) {
+    NetworkManager* self = static_cast<NetworkManager*>(context);
+    AsyncWebSocketClient* client = self->findLiveClient(clientId);
+    
+    // A client whose send queue is full is skipped; LiveStatus catches it up later
+    if (!client || client->status() != WS_CONNECTED || !client->canSend()) {
+        return false;
+    }
+    client->text(message, length);
+    return true;
+}
+
+AsyncWebSocketClient* NetworkManager::findLiveClient(uint32_t clientId) const {
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (liveClients[i] && liveClients[i]->id() == clientId) {
+            return liveClients[i];
+        }
+    }
+    return nullptr;
+}
+
+void NetworkManager::onAlarmStateChanged(const AlarmStateEvent& event) {
+    liveStatus.set(LIVE_ALARM_STATE, event.state);
+    liveStatus.set(LIVE_ALARM_ID, event.alarmId);
+    
+    // Full power for as long as the alarm needs attention, without waiting for the next tick
+    alarmActive = event.state != ALARM_IDLE;
+    updateRadioPolicy(millis(), true);
+}
+
+void NetworkManager::onPillBoxChanged(const PillBoxEvent& event) {
+    liveStatus.set(LIVE_PILL_BOX, event.open ? 1 : 0);
+}
+
+void NetworkManager::onUsbStateChanged(const UsbStateEvent& event) {
+    liveStatus.set(LIVE_USB, event.connected ? 1 : 0);
+}
+
+void NetworkManager::onSensorSample(const SensorSampleEvent& event) {
+    if (event.channel == HISTORY_LIGHT) {
+        liveStatus.set(LIVE_LIGHT, event.value, LIVE_LIGHT_DEADBAND);
+    }
+}
+
+// Helper methods
+bool NetworkManager::loadWiFiCredentials() {
+    ssid = preferences.getString("ssid", "");
+    password = preferences.getString("password", "");
+    
+    return !ssid.isEmpty();
+}
+
+void NetworkManager::saveWiFiCredentials(const String& newSsid, const String& newPassword) {
+    preferences.putString("ssid", newSsid);
+    preferences.putString("password", newPassword);
+}
+
+String NetworkManager::getLocalIP() const {
+    if (currentState == NETWORK_CONNECTED) {
+        return WiFi.localIP().toString();
+    } else if (currentState == NETWORK_AP_MODE) {
+        return WiFi.softAPIP().toString();
+    }
+    return "Not connected";
+}
+
+int NetworkManager::getSignalStrength() const {
+    if (currentState == NETWORK_CONNECTED) {
+        return WiFi.RSSI();
     }
     return 0;
 }
@@ -555,22 +2115,37 @@ String NetworkManager::getNetworkInfo() {
         info += "SSID: " + WiFi.SSID() + "\n";
         info += "IP: " + WiFi.localIP().toString() + "\n";
         info += "RSSI: " + String(WiFi.RSSI()) + " dBm\n";
+        info += "Connect: " + String(lastConnectMs) + " ms " + (lastConnectFast ? "(cached AP)" : "(scan)") +
+                ", " + String(fastConnects) + " fast / " + String(scanConnects) + " scanned\n";
     } else if (currentState == NETWORK_AP_MODE) {
         info += "AP IP: " + WiFi.softAPIP().toString() + "\n";
         info += "Stations: " + String(WiFi.softAPgetStationNum()) + "\n";
     }
     
+    static const char* const radioModes[] = {"off", "modem sleep", "full power"};
+    info += "Radio: " + String(radioModes[radioMode]) + ", on " +
+            String(radioPolicy.getOnTimeLastHour(millis()) / 1000) + " s this hour, " +
+            String(radioPolicy.getWakeCount()) + " quiet-window wakes\n";
+    
+    if (clockDiscipline.isSynchronized()) {
+        info += "Time: drift " + String(clockDiscipline.getDriftPpm(), 2) + " ppm (+-" +
+                String(clockDiscipline.getDriftUncertaintyPpm(), 2) + "), sync every " +
+                String(clockDiscipline.getPollInterval()) + " s\n";
+    } else {
+        info += "Time: not synchronized\n";
+    }
+    
     return info;
 }
 
 bool NetworkManager::isTimeValid() const {
-    return timeClient && timeClient->isTimeSet();
+    return clockDiscipline.isSynchronized();
 }
 
 void NetworkManager::enableWebInterface(bool enable) {
-    if (enable && !webServer) {
+    if (enable) {
         startWebServer();
-    } else if (!enable && webServer) {
+    } else {
         stopWebServer();
     }
 }
@@ -606,18 +2181,18 @@ void NetworkManager::performNetworkTest() {
         }
     }
     
-    // Test time sync
-    if (timeClient) {
-        if (timeClient->update()) {
-            if (logger) {
-                logger->logInfo(EVENT_SYSTEM_START, "NTP time sync test", "Success");
-            }
-        } else {
-            if (logger) {
-                logger->logWarning(EVENT_SYSTEM_START, "NTP time sync test", "Failed");
-            }
+    // Report time sync; a fresh poll is requested rather than waited for
+    if (clockDiscipline.isSynchronized()) {
+        if (logger) {
+            logger->logInfo(EVENT_SYSTEM_START, "NTP time sync test",
+                            "Offset " + String((int32_t)(clockDiscipline.getLastOffsetUs() / 1000)) +
+                            " ms, " + String(sntpClient.getReplyCount()) + "/" +
+                            String(sntpClient.getRequestCount()) + " replies");
         }
+    } else if (logger) {
+        logger->logWarning(EVENT_SYSTEM_START, "NTP time sync test", "Not synchronized yet");
     }
+    syncTime();
     
     if (logger) {
         logger->logInfo(EVENT_SYSTEM_START, "Network test completed");
@@ -628,6 +2203,7 @@ void NetworkManager::resetNetworkSettings() {
     preferences.clear();
     ssid = "";
     password = "";
+    memset(&wifiCache, 0, sizeof(wifiCache));
     
     if (logger) {
         logger->logInfo(EVENT_SYSTEM_START, "Network settings reset");
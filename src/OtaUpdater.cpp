@@ -0,0 +1,449 @@
+/**
+ * @file OtaUpdater.cpp
+ * @brief Streaming firmware update implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "OtaUpdater.h"
+#include <esp_partition.h>
+
+uint8_t OtaUpdater::chunk[OTA_WRITE_CHUNK];
+
+// The Arduino core confirms a pending image on its own before setup() unless this says otherwise
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+OtaUpdater::OtaUpdater(Logger* log) {
+    logger = log;
+    running = nullptr;
+
+    state = OTA_IDLE;
+    target = nullptr;
+    handle = 0;
+    handleOpen = false;
+    hasExpectedDigest = false;
+    memset(digest, 0, sizeof(digest));
+    digestReady = false;
+    transferSize = 0;
+    transferred = 0;
+    patching = false;
+    delta.begin(readRunningImage, writeNewImage, this);
+    expectedSize = 0;
+    received = 0;
+    buffered = 0;
+    startedAt = 0;
+    finishedAt = 0;
+    heapAtStart = 0;
+    heapLowest = 0;
+    error = "";
+
+    trial = false;
+    trialBoots = 0;
+    loggedState = OTA_IDLE;
+    restartAt = 0;
+    lastRollback[0] = '\0';
+}
+
+OtaUpdater::~OtaUpdater() {
+    abort("Shutting down");
+    preferences.end();
+}
+
+bool OtaUpdater::begin() {
+    running = esp_ota_get_running_partition();
+    if (!preferences.begin("ota", false)) {
+        if (logger) logger->logError(EVENT_OTA_FAILED, "Failed to open OTA preferences");
+        return false;
+    }
+    preferences.getString("rollback", lastRollback, sizeof(lastRollback));
+    if (lastRollback[0] && logger) {
+        logger->logWarning(EVENT_OTA_FAILED, "Running the previous firmware after a rollback", lastRollback);
+    }
+
+    // On trial: an image installed by us that was never confirmed, or one the bootloader holds for verification
+    esp_ota_img_states_t imageState;
+    bool pendingVerify = running && esp_ota_get_state_partition(running, &imageState) == ESP_OK &&
+                         imageState == ESP_OTA_IMG_PENDING_VERIFY;
+    bool installed = running && preferences.getString("trial", "") == running->label;
+    if (!pendingVerify && !installed) {
+        return true;
+    }
+
+    trial = true;
+    trialBoots = preferences.getUChar("boots", 0) + 1;
+    preferences.putUChar("boots", trialBoots);
+    if (trialBoots > OTA_TRIAL_MAX_BOOTS) {
+        rollBack("Restarted before the health check passed");
+        return true;    // Nothing to roll back to; rollBack() gave up the trial
+    }
+    if (logger) {
+        logger->logWarning(EVENT_OTA_START, "New firmware on trial",
+                           String(getRunningPartition()) + ", boot " + String(trialBoots) + " of " +
+                           String(OTA_TRIAL_MAX_BOOTS));
+    }
+    return true;
+}
+
+void OtaUpdater::update(unsigned long currentTime, bool networkHealthy) {
+    // What the upload did, logged here rather than on the AsyncTCP task
+    OtaState current = state;
+    if (current != loggedState) {
+        loggedState = current;
+        if (logger && current == OTA_RECEIVING) {
+            logger->logInfo(EVENT_OTA_START, patching ? "Delta update started" : "Firmware upload started",
+                            String((unsigned long)transferSize) + " bytes");
+        } else if (logger && current == OTA_READY) {
+            OtaUploadStats stats = getUploadStats();
+            logger->logInfo(EVENT_OTA_SUCCESS, "Firmware verified",
+                            String(stats.bytes) + (patching ? " byte patch for " + String(stats.imageBytes) : String("")) +
+                            " bytes in " + String(stats.durationMs) + " ms, " +
+                            String(stats.bytesPerSecond / 1024) + " KB/s, heap +" + String(stats.heapUsed));
+        } else if (logger && current == OTA_FAILED) {
+            logger->logError(EVENT_OTA_FAILED, "Firmware upload failed", error);
+        }
+    }
+
+    if (restartAt != 0 && (long)(currentTime - restartAt) >= 0) {
+        preferences.end();
+        ESP.restart();
+    }
+
+    if (!trial) {
+        return;
+    }
+    bool healthy = networkHealthy && ESP.getFreeHeap() >= OTA_HEALTH_MIN_HEAP;
+    if (healthy && currentTime >= OTA_HEALTH_MIN_UPTIME_MS) {
+        confirm(currentTime);
+    } else if (currentTime >= OTA_HEALTH_TIMEOUT_MS) {
+        rollBack(networkHealthy ? "Free heap too low" : "Network did not come up");
+    }
+}
+
+void OtaUpdater::confirm(unsigned long currentTime) {
+    esp_ota_mark_app_valid_cancel_rollback();
+    preferences.remove("trial");
+    preferences.remove("boots");
+    preferences.remove("rollback");
+    lastRollback[0] = '\0';
+    trial = false;
+    if (logger) {
+        logger->logInfo(EVENT_OTA_SUCCESS, "New firmware confirmed",
+                        String(getRunningPartition()) + " after " + String(currentTime / 1000) + " s");
+    }
+}
+
+void OtaUpdater::rollBack(const char* reason) {
+    snprintf(lastRollback, sizeof(lastRollback), "%s: %s", getRunningPartition(), reason);
+    preferences.putString("rollback", lastRollback);
+    preferences.remove("trial");
+    preferences.remove("boots");
+    if (logger) logger->logError(EVENT_OTA_FAILED, "Rolling back new firmware", reason);
+
+    // With two slots the next one is the one we came from
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(nullptr);
+
+    // Marks this image invalid and restarts into the previous one where the bootloader tracks image states
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+
+    // Otherwise select the previous slot ourselves; this fails unless it holds a valid image
+    if (previous && esp_ota_set_boot_partition(previous) == ESP_OK) {
+        preferences.end();
+        ESP.restart();
+    }
+
+    // Nothing to go back to: keep what runs
+    trial = false;
+    if (logger) logger->logError(EVENT_OTA_FAILED, "No previous firmware to roll back to, keeping this one");
+}
+
+bool OtaUpdater::start(size_t size, const char* sha256Hex) {
+    if (isBusy()) {
+        return false;       // Leaves the running upload's state alone
+    }
+    beginUpload(size);
+    
+    uint8_t expected[OTA_SHA256_BYTES];
+    bool checked = sha256Hex && sha256Hex[0];
+    if (checked && !parseHex(sha256Hex, expected, OTA_SHA256_BYTES)) {
+        return fail("Malformed sha256");
+    }
+    return openTarget(size, checked ? expected : nullptr);
+}
+
+bool OtaUpdater::startPatch(size_t size) {
+    if (isBusy()) {
+        return false;
+    }
+    beginUpload(size);
+    
+    // The target is opened once the patch header has said what it is for
+    patching = true;
+    delta.reset();
+    state = OTA_RECEIVING;
+    return true;
+}
+
+void OtaUpdater::beginUpload(size_t size) {
+    state = OTA_IDLE;
+    target = nullptr;
+    patching = false;
+    transferSize = size;
+    transferred = 0;
+    expectedSize = 0;
+    received = 0;
+    buffered = 0;
+    digestReady = false;
+    startedAt = millis();
+    finishedAt = startedAt;
+    heapAtStart = ESP.getFreeHeap();
+    heapLowest = heapAtStart;
+    error = "";
+}
+
+bool OtaUpdater::openTarget(size_t size, const uint8_t* sha256) {
+    target = esp_ota_get_next_update_partition(nullptr);
+    if (!target) {
+        return fail("No OTA partition");
+    }
+    if (size == 0 || size > target->size) {
+        return fail("Image size does not fit the OTA partition");
+    }
+    hasExpectedDigest = sha256 != nullptr;
+    if (hasExpectedDigest) {
+        memcpy(expectedDigest, sha256, OTA_SHA256_BYTES);
+    }
+    
+    // Sectors are erased as the writes reach them, so no single call stalls for the whole partition
+    if (esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &handle) != ESP_OK) {
+        return fail("Could not open the OTA partition");
+    }
+    handleOpen = true;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    
+    expectedSize = size;
+    state = OTA_RECEIVING;
+    return true;
+}
+
+bool OtaUpdater::openPatchTarget() {
+    const DeltaHeader& header = delta.getHeader();
+    if (!running || header.sourceSize > running->size) {
+        return fail("Patch is for a different firmware");
+    }
+    
+    // A patch only rebuilds the image it was made from; hashed through the chunk buffer, still empty here
+    uint8_t sourceDigest[OTA_SHA256_BYTES];
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    bool readable = true;
+    for (uint32_t offset = 0; offset < header.sourceSize && readable; offset += OTA_WRITE_CHUNK) {
+        uint32_t length = header.sourceSize - offset < OTA_WRITE_CHUNK ? header.sourceSize - offset : OTA_WRITE_CHUNK;
+        readable = esp_partition_read(running, offset, chunk, length) == ESP_OK;
+        mbedtls_sha256_update_ret(&sha, chunk, length);
+    }
+    mbedtls_sha256_finish_ret(&sha, sourceDigest);
+    mbedtls_sha256_free(&sha);
+    if (!readable) {
+        return fail("Could not read the running firmware");
+    }
+    if (memcmp(sourceDigest, header.sourceSha256, OTA_SHA256_BYTES) != 0) {
+        return fail("Patch is for a different firmware");
+    }
+    
+    return openTarget(header.targetSize, header.targetSha256);
+}
+
+bool OtaUpdater::write(const uint8_t* data, size_t length) {
+    if (state != OTA_RECEIVING) {
+        return false;
+    }
+    if (transferred + length > transferSize) {
+        return fail("More data than announced");
+    }
+    transferred += length;
+    
+    if (!(patching ? writePatch(data, length) : writeImage(data, length))) {
+        return false;
+    }
+    
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < heapLowest) {
+        heapLowest = heap;
+    }
+    return true;
+}
+
+bool OtaUpdater::writePatch(const uint8_t* data, size_t length) {
+    while (length > 0) {
+        size_t used = 0;
+        DeltaStatus status = delta.feed(data, length, &used);
+        data += used;
+        length -= used;
+        if (status == DELTA_ERROR) {
+            // A failed image write has already said why
+            return state == OTA_FAILED ? false : fail(delta.getError());
+        }
+        if (status == DELTA_HEADER && !openPatchTarget()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OtaUpdater::writeImage(const uint8_t* data, size_t length) {
+    if (state != OTA_RECEIVING || !handleOpen) {
+        return false;
+    }
+    if (received + length > expectedSize) {
+        return fail("Image larger than announced");
+    }
+    
+    while (length > 0) {
+        size_t taken = OTA_WRITE_CHUNK - buffered;
+        if (taken > length) {
+            taken = length;
+        }
+        memcpy(chunk + buffered, data, taken);
+        buffered += taken;
+        received += taken;
+        data += taken;
+        length -= taken;
+        if (buffered == OTA_WRITE_CHUNK && !flushChunk()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OtaUpdater::flushChunk() {
+    mbedtls_sha256_update_ret(&sha, chunk, buffered);
+    esp_err_t result = esp_ota_write(handle, chunk, buffered);
+    buffered = 0;
+    if (result != ESP_OK) {
+        return fail(result == ESP_ERR_OTA_VALIDATE_FAILED ? "Not an ESP32 firmware image" : "Flash write failed");
+    }
+    return true;
+}
+
+bool OtaUpdater::finish() {
+    if (state != OTA_RECEIVING) {
+        return false;
+    }
+    if (transferred != transferSize || (patching && !delta.isComplete()) || received != expectedSize) {
+        return fail("Upload incomplete");
+    }
+    if (buffered > 0 && !flushChunk()) {
+        return false;
+    }
+    mbedtls_sha256_finish_ret(&sha, digest);
+    digestReady = true;
+    finishedAt = millis();
+
+    if (hasExpectedDigest && memcmp(digest, expectedDigest, OTA_SHA256_BYTES) != 0) {
+        return fail("SHA-256 mismatch");
+    }
+
+    // Checks the image structure and its appended checksum; frees the handle either way
+    handleOpen = false;
+    mbedtls_sha256_free(&sha);
+    if (esp_ota_end(handle) != ESP_OK) {
+        return fail("Image failed validation");
+    }
+    if (esp_ota_set_boot_partition(target) != ESP_OK) {
+        return fail("Could not select the new image");
+    }
+    state = OTA_READY;
+    return true;
+}
+
+void OtaUpdater::abort(const char* reason) {
+    if (state == OTA_RECEIVING) {
+        fail(reason);
+    }
+}
+
+void OtaUpdater::cancelInstall(const char* reason) {
+    if (state != OTA_READY || restartAt != 0) {
+        return;
+    }
+    
+    // Selected, but without the trial record restartIntoUpdate() writes it would boot unwatched
+    fail(running && esp_ota_set_boot_partition(running) == ESP_OK ? reason : "Could not select the running image again");
+}
+
+bool OtaUpdater::fail(const char* reason) {
+    if (handleOpen) {
+        esp_ota_abort(handle);
+        mbedtls_sha256_free(&sha);
+        handleOpen = false;
+    }
+    finishedAt = millis();
+    error = reason;
+    state = OTA_FAILED;
+    return false;
+}
+
+void OtaUpdater::restartIntoUpdate(unsigned long currentTime) {
+    if (state != OTA_READY || restartAt != 0) {
+        return;
+    }
+
+    // The new image starts on trial; its label tells begin() that it is the one we installed
+    preferences.putString("trial", target->label);
+    preferences.putUChar("boots", 0);
+    restartAt = currentTime + OTA_RESTART_DELAY_MS;
+    if (logger) logger->logInfo(EVENT_OTA_SUCCESS, "Restarting into new firmware", target->label);
+}
+
+size_t OtaUpdater::getMaxImageSize() const {
+    const esp_partition_t* next = esp_ota_get_next_update_partition(nullptr);
+    return next ? next->size : 0;
+}
+
+OtaUploadStats OtaUpdater::getUploadStats() const {
+    OtaUploadStats stats;
+    stats.bytes = transferred;
+    stats.imageBytes = received;
+    stats.durationMs = (state == OTA_RECEIVING ? millis() : finishedAt) - startedAt;
+    stats.bytesPerSecond = stats.durationMs > 0 ? (uint32_t)((uint64_t)transferred * 1000 / stats.durationMs) : 0;
+    stats.heapUsed = heapAtStart - heapLowest;
+    return stats;
+}
+
+void OtaUpdater::getDigestHex(char* out) const {
+    out[0] = '\0';
+    if (!digestReady) {
+        return;
+    }
+    for (size_t i = 0; i < OTA_SHA256_BYTES; i++) {
+        sprintf(out + 2 * i, "%02x", digest[i]);
+    }
+}
+
+bool OtaUpdater::readRunningImage(void* context, uint32_t offset, uint8_t* buffer, size_t length) {
+    OtaUpdater* updater = static_cast<OtaUpdater*>(context);
+    return esp_partition_read(updater->running, offset, buffer, length) == ESP_OK;
+}
+
+bool OtaUpdater::writeNewImage(void* context, const uint8_t* data, size_t length) {
+    return static_cast<OtaUpdater*>(context)->writeImage(data, length);
+}
+
+bool OtaUpdater::parseHex(const char* hex, uint8_t* out, size_t bytes) {
+    if (strlen(hex) != bytes * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < bytes * 2; i++) {
+        char c = hex[i];
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+        else return false;
+        out[i / 2] = (i % 2) ? (out[i / 2] | nibble) : (uint8_t)(nibble << 4);
+    }
+    return true;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file PatternCode.cpp
+ * @brief Buzzer pattern bytecode validation and writer implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "PatternCode.h"
+
+namespace PatternCode {
+
+bool validate(const uint8_t* code, uint16_t length, uint32_t* durationMs) {
+    if (!code || length == 0 || length > PATTERN_MAX_BYTES) {
+        return false;
+    }
+
+    // Per nesting level: repeat count, ticks so far, whether the body is timed
+    uint32_t repeat[PATTERN_MAX_LOOP_DEPTH + 1];
+    uint64_t total[PATTERN_MAX_LOOP_DEPTH + 1];
+    bool timed[PATTERN_MAX_LOOP_DEPTH + 1];
+    uint8_t depth = 0;
+    repeat[0] = 1;
+    total[0] = 0;
+    timed[0] = false;
+
+    uint16_t pc = 0;
+    while (pc < length && code[pc] != PC_OP_END) {
+        uint8_t op = code[pc];
+        uint8_t operands;
+        uint32_t ticks = 0;
+        bool isTimed = true;
+
+        switch (op & 0xC0) {
+            case PC_CLASS_NOTE: operands = 1; break;
+            case PC_CLASS_TONE: operands = 2; break;
+            case PC_CLASS_REST: operands = 1; break;
+            default:
+                isTimed = false;
+                operands = (op == PC_OP_ENDLOOP) ? 0 : (op == PC_OP_FADE) ? 2 : 1;
+                if (op > PC_OP_FADE) {
+                    return false;
+                }
+                break;
+        }
+        if (pc + operands >= length) {
+            return false;
+        }
+
+        switch (op & 0xC0) {
+            case PC_CLASS_NOTE:
+                if (code[pc + 1] == 0) return false;
+                ticks = code[pc + 1];
+                break;
+            case PC_CLASS_TONE:
+                if (code[pc + 2] == 0) return false;
+                ticks = code[pc + 2];
+                break;
+            case PC_CLASS_REST:
+                ticks = ((uint32_t)(op & 0x3F) << 8) | code[pc + 1];
+                if (ticks == 0) return false;
+                break;
+            default:
+                if (op == PC_OP_FADE) {
+                    if (code[pc + 1] == 0 || code[pc + 2] == 0) return false;
+                    ticks = code[pc + 2];
+                    isTimed = true;
+                } else if (op == PC_OP_LOOP) {
+                    if (code[pc + 1] == 0 || depth == PATTERN_MAX_LOOP_DEPTH) return false;
+                    depth++;
+                    repeat[depth] = code[pc + 1];
+                    total[depth] = 0;
+                    timed[depth] = false;
+                } else if (op == PC_OP_ENDLOOP) {
+                    if (depth == 0 || !timed[depth]) return false;
+                    total[depth - 1] += total[depth] * repeat[depth];
+                    timed[depth - 1] = true;
+                    depth--;
+                }
+                break;
+        }
+
+        if (isTimed) {
+            total[depth] += ticks;
+            timed[depth] = true;
+        }
+        pc += 1 + operands;
+    }
+
+    if (depth != 0 || !timed[0]) {
+        return false;
+    }
+    if (durationMs) {
+        *durationMs = (uint32_t)(total[0] * PC_TICK_MS);
+    }
+    return true;
+}
+
+} // namespace PatternCode
+
+PatternWriter::PatternWriter(uint8_t* out, uint16_t outCapacity) {
+    buffer = out;
+    capacity = outCapacity;
+    length = 0;
+    gapTicks = 0;
+    duty = PC_DEFAULT_DUTY;
+    overflowed = false;
+}
+
+void PatternWriter::put(uint8_t value) {
+    if (length < capacity) {
+        buffer[length++] = value;
+    } else {
+        overflowed = true;
+    }
+}
+
+void PatternWriter::toneTicks(uint8_t opcode, uint8_t operand, bool isNote, uint32_t ticks) {
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    // The gap belongs at the end of the whole tone, not of every split piece
+    bool splitGap = gapTicks > 0 && ticks > PC_MAX_TONE_TICKS;
+    uint8_t savedGap = gapTicks;
+    if (splitGap) {
+        gap(0);
+    }
+
+    while (ticks > 0) {
+        uint32_t piece = ticks > PC_MAX_TONE_TICKS ? PC_MAX_TONE_TICKS : ticks;
+        ticks -= piece;
+        if (splitGap && ticks == 0) {
+            gap(savedGap * PC_TICK_MS);
+        }
+        put(opcode);
+        if (!isNote) {
+            put(operand);
+        }
+        put((uint8_t)piece);
+    }
+}
+
+void PatternWriter::tone(uint32_t frequency, uint32_t ms) {
+    if (frequency == 0) {
+        rest(ms);
+        return;
+    }
+    if (frequency > PC_MAX_FREQUENCY) {
+        frequency = PC_MAX_FREQUENCY;
+    }
+    toneTicks(PC_CLASS_TONE | (uint8_t)(frequency >> 8), (uint8_t)(frequency & 0xFF), false,
+              PatternCode::ticks(ms));
+}
+
+void PatternWriter::note(uint8_t note, uint32_t ms) {
+    if (note > PC_MAX_NOTE) {
+        note = PC_MAX_NOTE;
+    }
+    toneTicks(PC_CLASS_NOTE | note, 0, true, PatternCode::ticks(ms));
+}
+
+void PatternWriter::rest(uint32_t ms) {
+    uint32_t ticks = PatternCode::ticks(ms);
+    while (ticks > 0) {
+        uint32_t piece = ticks > PC_MAX_REST_TICKS ? PC_MAX_REST_TICKS : ticks;
+        ticks -= piece;
+        put(PC_CLASS_REST | (uint8_t)(piece >> 8));
+        put((uint8_t)(piece & 0xFF));
+    }
+}
+
+void PatternWriter::volume(uint8_t level) {
+    duty = level > 0 ? level : 1;
+    put(PC_OP_VOLUME);
+    put(duty);
+}
+
+void PatternWriter::gap(uint32_t ms) {
+    uint32_t ticks = PatternCode::ticks(ms);
+    gapTicks = ticks > 255 ? 255 : (uint8_t)ticks;
+    put(PC_OP_GAP);
+    put(gapTicks);
+}
+
+void PatternWriter::fade(uint8_t level, uint32_t ms) {
+    uint8_t from = duty;
+    uint8_t target = level > 0 ? level : 1;
+    uint32_t ticks = PatternCode::ticks(ms);
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    // Longer fades become several pieces along the same straight line
+    uint32_t pieces = (ticks + PC_MAX_TONE_TICKS - 1) / PC_MAX_TONE_TICKS;
+    uint32_t done = 0;
+    for (uint32_t i = 1; i <= pieces; i++) {
+        uint32_t end = ticks * i / pieces;
+        put(PC_OP_FADE);
+        put((uint8_t)((int32_t)from + ((int32_t)target - (int32_t)from) * (int32_t)i / (int32_t)pieces));
+        put((uint8_t)(end - done));
+        done = end;
+    }
+    duty = target;
+}
+
+void PatternWriter::loop(uint8_t count) {
+    put(PC_OP_LOOP);
+    put(count > 0 ? count : 1);
+}
+
+void PatternWriter::endLoop() {
+    put(PC_OP_ENDLOOP);
+}
+
+void PatternWriter::end() {
+    put(PC_OP_END);
+}
@@ -0,0 +1,371 @@
+/**
+ * @file PatternCompiler.cpp
+ * @brief RTTTL and pattern DSL compiler implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "PatternCompiler.h"
+#include <string.h>
+
+static char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Parses decimal digits; false if there are none or the value exceeds maximum
+static bool parseNumber(const char*& p, const char* end, uint32_t maximum, uint32_t* value) {
+    uint32_t result = 0;
+    const char* start = p;
+    while (p < end && isDigit(*p)) {
+        result = result * 10 + (uint32_t)(*p - '0');
+        if (result > maximum) {
+            return false;
+        }
+        p++;
+    }
+    *value = result;
+    return p > start;
+}
+
+static bool tokenEquals(const char* token, uint8_t length, const char* word) {
+    uint8_t i = 0;
+    for (; i < length && word[i]; i++) {
+        if (lower(token[i]) != word[i]) {
+            return false;
+        }
+    }
+    return i == length && word[i] == '\0';
+}
+
+bool PatternCompiler::compile(const char* source, PatternFormat format, uint8_t* out, uint16_t capacity,
+                              PatternCompileResult* result) {
+    result->length = 0;
+    result->durationMs = 0;
+    result->error = nullptr;
+    result->errorOffset = 0;
+
+    if (!source || strlen(source) > PATTERN_MAX_SOURCE) {
+        return fail(result, "Source too large", source, source);
+    }
+    if (format == PATTERN_FORMAT_AUTO) {
+        format = detectFormat(source);
+    }
+
+    PatternWriter writer(out, capacity);
+    bool ok = format == PATTERN_FORMAT_RTTTL ? compileRtttl(source, writer, result)
+                                             : compileDsl(source, writer, result);
+    if (!ok) {
+        return false;
+    }
+
+    writer.end();
+    if (writer.overflow()) {
+        return fail(result, "Pattern too large", source, source);
+    }
+    if (!PatternCode::validate(out, writer.size(), &result->durationMs)) {
+        return fail(result, "Pattern plays nothing", source, source);
+    }
+
+    result->length = writer.size();
+    return true;
+}
+
+PatternFormat PatternCompiler::detectFormat(const char* source) {
+    const char* first = strchr(source, ':');
+    if (!first) {
+        return PATTERN_FORMAT_DSL;
+    }
+    const char* second = strchr(first + 1, ':');
+    if (!second) {
+        return PATTERN_FORMAT_DSL;
+    }
+    for (const char* p = first + 1; p < second; p++) {
+        if (*p == '=') {
+            return PATTERN_FORMAT_RTTTL;
+        }
+    }
+    return PATTERN_FORMAT_DSL;
+}
+
+int PatternCompiler::parseNoteName(const char* text, uint8_t length) {
+    static const int8_t semitones[7] = {9, 11, 0, 2, 4, 5, 7};   // a..g
+    if (length < 2) {
+        return -1;
+    }
+
+    char letter = lower(text[0]);
+    if (letter < 'a' || letter > 'g') {
+        return -1;
+    }
+    int note = semitones[letter - 'a'];
+    uint8_t i = 1;
+    if (text[i] == '#') {
+        note++;
+        i++;
+    }
+    if (i + 1 != length || !isDigit(text[i])) {
+        return -1;
+    }
+
+    note += (text[i] - '0' - 4) * 12;
+    return (note >= 0 && note <= PC_MAX_NOTE) ? note : -1;
+}
+
+bool PatternCompiler::fail(PatternCompileResult* result, const char* error, const char* source, const char* at) {
+    result->error = error;
+    result->errorOffset = (source && at >= source) ? (uint16_t)(at - source) : 0;
+    result->length = 0;
+    return false;
+}
+
+bool PatternCompiler::compileRtttl(const char* source, PatternWriter& writer, PatternCompileResult* result) {
+    // name:defaults:notes
+    const char* defaults = strchr(source, ':');
+    const char* notes = defaults ? strchr(defaults + 1, ':') : nullptr;
+    if (!notes) {
+        return fail(result, "RTTTL needs name:defaults:notes", source, source);
+    }
+    defaults++;
+
+    uint32_t duration = 4;
+    uint32_t octave = 6;
+    uint32_t bpm = 63;
+
+    const char* p = defaults;
+    while (p < notes) {
+        while (p < notes && (isSpace(*p) || *p == ',')) p++;
+        if (p >= notes) break;
+
+        char key = lower(*p++);
+        while (p < notes && isSpace(*p)) p++;
+        if (p >= notes || *p != '=') {
+            return fail(result, "Expected key=value", source, p);
+        }
+        p++;
+        while (p < notes && isSpace(*p)) p++;
+
+        uint32_t value;
+        const char* at = p;
+        if (!parseNumber(p, notes, 900, &value) || value == 0) {
+            return fail(result, "Invalid default", source, at);
+        }
+        switch (key) {
+            case 'd': duration = value; break;
+            case 'o': octave = value; break;
+            case 'b': bpm = value; break;
+            default: return fail(result, "Unknown default", source, at);
+        }
+    }
+
+    writer.gap(RTTTL_GAP_MS);
+
+    const char* end = source + strlen(source);
+    p = notes + 1;
+    while (p < end) {
+        while (p < end && (isSpace(*p) || *p == ',')) p++;
+        if (p >= end) break;
+        const char* at = p;
+
+        uint32_t noteDuration = duration;
+        if (isDigit(*p) && !parseNumber(p, end, 64, &noteDuration)) {
+            return fail(result, "Invalid duration", source, at);
+        }
+        if (noteDuration == 0) {
+            return fail(result, "Invalid duration", source, at);
+        }
+
+        char letter = p < end ? lower(*p) : '\0';
+        if (letter != 'p' && (letter < 'a' || letter > 'g')) {
+            return fail(result, "Expected note", source, p);
+        }
+        p++;
+
+        char name[3] = {letter, 0, 0};
+        uint8_t nameLength = 1;
+        if (p < end && *p == '#') {
+            name[nameLength++] = '#';
+            p++;
+        }
+
+        bool dotted = false;
+        if (p < end && *p == '.') {
+            dotted = true;
+            p++;
+        }
+        uint32_t noteOctave = octave;
+        if (p < end && isDigit(*p)) {
+            noteOctave = (uint32_t)(*p++ - '0');
+        }
+        if (p < end && *p == '.') {
+            dotted = true;
+            p++;
+        }
+        if (p < end && !isSpace(*p) && *p != ',') {
+            return fail(result, "Unexpected character", source, p);
+        }
+
+        // Whole note = 4 beats
+        uint32_t ms = 240000 / (bpm * noteDuration);
+        if (dotted) {
+            ms += ms / 2;
+        }
+
+        if (letter == 'p') {
+            writer.rest(ms);
+            continue;
+        }
+
+        char text[4] = {name[0], name[1], name[2], 0};
+        text[nameLength] = (char)('0' + (noteOctave % 10));
+        int note = parseNoteName(text, nameLength + 1);
+        if (note < 0 || noteOctave > 9) {
+            return fail(result, "Note out of range", source, at);
+        }
+        writer.note((uint8_t)note, ms);
+    }
+
+    return true;
+}
+
+bool PatternCompiler::compileDsl(const char* source, PatternWriter& writer, PatternCompileResult* result) {
+    const char* end = source + strlen(source);
+    const char* p = source;
+    uint8_t depth = 0;
+    bool expectRepeatCount = false;
+    bool expectBrace = false;
+
+    while (p < end) {
+        // Separators and comments
+        if (isSpace(*p) || *p == ',' || *p == ';') {
+            p++;
+            continue;
+        }
+        if (*p == '#') {
+            while (p < end && *p != '\n') p++;
+            continue;
+        }
+
+        const char* token = p;
+        if (*p == '{' || *p == '}') {
+            p++;
+        } else {
+            while (p < end && !isSpace(*p) && *p != ',' && *p != ';' && *p != '{' && *p != '}') p++;
+        }
+        uint8_t length = (uint8_t)((p - token) > 255 ? 255 : (p - token));
+
+        if (expectRepeatCount) {
+            uint32_t count;
+            const char* q = token;
+            if (!parseNumber(q, p, 255, &count) || q != p || count == 0) {
+                return fail(result, "Repeat count must be 1-255", source, token);
+            }
+            writer.loop((uint8_t)count);
+            expectRepeatCount = false;
+            expectBrace = true;
+            continue;
+        }
+        if (expectBrace) {
+            if (*token != '{') {
+                return fail(result, "Expected {", source, token);
+            }
+            expectBrace = false;
+            continue;
+        }
+
+        if (*token == '{') {
+            return fail(result, "Unexpected {", source, token);
+        }
+        if (*token == '}') {
+            if (depth == 0) {
+                return fail(result, "Unmatched }", source, token);
+            }
+            writer.endLoop();
+            depth--;
+            continue;
+        }
+        if (tokenEquals(token, length, "repeat")) {
+            if (depth == PATTERN_MAX_LOOP_DEPTH) {
+                return fail(result, "Repeat nested too deep", source, token);
+            }
+            depth++;
+            expectRepeatCount = true;
+            continue;
+        }
+
+        // key:value
+        const char* colon = token;
+        while (colon < p && *colon != ':') colon++;
+        if (colon >= p) {
+            return fail(result, "Expected key:value", source, token);
+        }
+        uint8_t keyLength = (uint8_t)(colon - token);
+        uint32_t value;
+        const char* q = colon + 1;
+
+        if (tokenEquals(token, keyLength, "fade")) {
+            uint32_t duty;
+            if (!parseNumber(q, p, 255, &duty) || duty < 1 || q >= p || *q != ':') {
+                return fail(result, "Expected fade:duty:ms", source, colon + 1);
+            }
+            const char* durationStart = ++q;
+            if (!parseNumber(q, p, 600000, &value) || q != p || PatternCode::ticks(value) == 0) {
+                return fail(result, "Invalid fade duration", source, durationStart);
+            }
+            writer.fade((uint8_t)duty, value);
+            continue;
+        }
+        if (!parseNumber(q, p, 600000, &value) || q != p) {
+            return fail(result, "Invalid number", source, colon + 1);
+        }
+
+        bool isVolume = tokenEquals(token, keyLength, "vol");
+        bool isGap = tokenEquals(token, keyLength, "gap");
+        if (!isVolume && !isGap && PatternCode::ticks(value) == 0) {
+            // A tone shorter than one tick would vanish from the pattern
+            return fail(result, "Duration must be at least 10 ms", source, colon + 1);
+        }
+
+        if (tokenEquals(token, keyLength, "rest") || tokenEquals(token, keyLength, "r")) {
+            writer.rest(value);
+        } else if (isVolume) {
+            if (value < 1 || value > 255) {
+                return fail(result, "Volume must be 1-255", source, colon + 1);
+            }
+            writer.volume((uint8_t)value);
+        } else if (isGap) {
+            if (value > 255 * PC_TICK_MS) {
+                return fail(result, "Gap too long", source, colon + 1);
+            }
+            writer.gap(value);
+        } else if (keyLength > 0 && isDigit(*token)) {
+            uint32_t frequency;
+            const char* f = token;
+            if (!parseNumber(f, colon, PC_MAX_FREQUENCY, &frequency) || f != colon) {
+                return fail(result, "Frequency must be 0-16383 Hz", source, token);
+            }
+            writer.tone(frequency, value);
+        } else {
+            int note = parseNoteName(token, keyLength);
+            if (note < 0) {
+                return fail(result, "Unknown token", source, token);
+            }
+            writer.note((uint8_t)note, value);
+        }
+    }
+
+    if (expectRepeatCount || expectBrace) {
+        return fail(result, "Incomplete repeat", source, end);
+    }
+    if (depth != 0) {
+        return fail(result, "Missing }", source, end);
+    }
+    return true;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file PatternLibrary.cpp
+ * @brief Uploaded buzzer patterns stored on LittleFS implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "PatternLibrary.h"
+
+static const uint8_t PATTERN_MAGIC[3] = {'N', 'B', 'P'};
+
+PatternLibrary::PatternLibrary(Logger* log) {
+    logger = log;
+    mounted = false;
+    reservedNames = nullptr;
+    reservedCount = 0;
+}
+
+bool PatternLibrary::begin() {
+    if (!LittleFS.begin(true)) {
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Failed to mount LittleFS for patterns");
+        return false;
+    }
+    mounted = true;
+
+    if (!LittleFS.exists(PATTERN_DIRECTORY)) {
+        LittleFS.mkdir(PATTERN_DIRECTORY);
+    }
+
+    if (logger) {
+        logger->logInfo(EVENT_SYSTEM_START, "PatternLibrary initialized", "Patterns: " + String(count()));
+    }
+    return true;
+}
+
+bool PatternLibrary::store(const String& name, const uint8_t* code, uint16_t length) {
+    if (!mounted || !isValidName(name) || isReservedName(name) ||
+        !PatternCode::validate(code, length)) {
+        return false;
+    }
+    if (!exists(name) && count() >= PATTERN_LIBRARY_MAX) {
+        if (logger) logger->logWarning(EVENT_SYSTEM_START, "Pattern library full", name);
+        return false;
+    }
+
+    // Write a temporary file and rename it, so a failed write keeps the old pattern
+    String finalPath = path(name);
+    String tempPath = finalPath + ".tmp";
+    File file = LittleFS.open(tempPath, FILE_WRITE);
+    if (!file) {
+        return false;
+    }
+
+    uint8_t header[4] = {PATTERN_MAGIC[0], PATTERN_MAGIC[1], PATTERN_MAGIC[2], FORMAT_VERSION};
+    size_t written = file.write(header, sizeof(header));
+    written += file.write(code, length);
+    file.close();
+
+    if (written != sizeof(header) + length) {
+        LittleFS.remove(tempPath);
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Pattern write failed", name);
+        return false;
+    }
+
+    LittleFS.remove(finalPath);
+    if (!LittleFS.rename(tempPath, finalPath)) {
+        LittleFS.remove(tempPath);
+        return false;
+    }
+
+    if (logger) {
+        logger->logInfo(EVENT_SYSTEM_START, "Pattern stored", name + " (" + String(length) + " bytes)");
+    }
+    return true;
+}
+
+uint16_t PatternLibrary::load(const String& name, uint8_t* out, uint16_t capacity) {
+    if (!mounted || !isValidName(name)) {
+        return 0;
+    }
+
+    File file = LittleFS.open(path(name), FILE_READ);
+    if (!file) {
+        return 0;
+    }
+
+    uint8_t header[4];
+    size_t size = file.size();
+    if (size <= sizeof(header) || size - sizeof(header) > capacity ||
+        file.read(header, sizeof(header)) != sizeof(header) ||
+        header[0] != PATTERN_MAGIC[0] || header[1] != PATTERN_MAGIC[1] ||
+        header[2] != PATTERN_MAGIC[2] || header[3] != FORMAT_VERSION) {
+        file.close();
+        if (logger) logger->logWarning(EVENT_SYSTEM_START, "Pattern file invalid", name);
+        return 0;
+    }
+
+    uint16_t length = (uint16_t)file.read(out, size - sizeof(header));
+    file.close();
+
+    if (length != size - sizeof(header) || !PatternCode::validate(out, length)) {
+        if (logger) logger->logWarning(EVENT_SYSTEM_START, "Pattern file invalid", name);
+        return 0;
+    }
+    return length;
+}
+
+bool PatternLibrary::remove(const String& name) {
+    if (!mounted || !isValidName(name)) {
+        return false;
+    }
+    return LittleFS.remove(path(name));
+}
+
+bool PatternLibrary::exists(const String& name) {
+    return mounted && isValidName(name) && LittleFS.exists(path(name));
+}
+
+uint8_t PatternLibrary::count() {
+    uint8_t total = 0;
+    File directory = LittleFS.open(PATTERN_DIRECTORY);
+    if (!directory || !directory.isDirectory()) {
+        return 0;
+    }
+
+    File entry = directory.openNextFile();
+    while (entry) {
+        if (String(entry.name()).endsWith(".pat")) {
+            total++;
+        }
+        entry = directory.openNextFile();
+    }
+    return total;
+}
+
+String PatternLibrary::list() {
+    String json = "[";
+    bool first = true;
+    for (uint8_t i = 0; i < reservedCount; i++) {
+        if (!first) json += ',';
+        json += "{\"name\":\"" + String(reservedNames[i]) + "\",\"builtin\":true}";
+        first = false;
+    }
+
+    File directory = LittleFS.open(PATTERN_DIRECTORY);
+    if (directory && directory.isDirectory()) {
+        File entry = directory.openNextFile();
+        while (entry) {
+            String fileName = entry.name();
+            if (fileName.endsWith(".pat")) {
+                if (!first) json += ',';
+                json += "{\"name\":\"" + fileName.substring(0, fileName.length() - 4) +
+                        "\",\"bytes\":" + String(entry.size() > 4 ? entry.size() - 4 : 0) + "}";
+                first = false;
+            }
+            entry = directory.openNextFile();
+        }
+    }
+    json += ']';
+    return json;
+}
+
+void PatternLibrary::setReservedNames(const char* const* names, uint8_t count) {
+    reservedNames = names;
+    reservedCount = count;
+}
+
+bool PatternLibrary::isReservedName(const String& name) const {
+    for (uint8_t i = 0; i < reservedCount; i++) {
+        if (name == reservedNames[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PatternLibrary::isValidName(const String& name) {
+    if (name.isEmpty() || name.length() > PATTERN_NAME_MAX) {
+        return false;
+    }
+    for (size_t i = 0; i < name.length(); i++) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+String PatternLibrary::path(const String& name) {
+    return String(PATTERN_DIRECTORY) + "/" + name + ".pat";
+}
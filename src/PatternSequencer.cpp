@@ -0,0 +1,225 @@
+/**
+ * @file PatternSequencer.cpp
+ * @brief Deadline-based buzzer pattern sequencing implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "PatternSequencer.h"
+
+PatternSequencer::PatternSequencer() {
+    code = nullptr;
+    length = 0;
+    looping = false;
+    running = false;
+    deadline = 0;
+    startUs = 0;
+    ramp.durationS = 0;
+    ramp.startLevel = 255;
+    ramp.shape = RAMP_NONE;
+    resetProgramState();
+}
+
+void PatternSequencer::resetProgramState() {
+    pc = 0;
+    depth = 0;
+    duty = DEFAULT_DUTY;
+    gapTicks = 0;
+    pendingGap = 0;
+    timedSinceWrap = false;
+    toneFrequency = 0;
+    fadeCount = 0;
+    fadeIndex = 0;
+    fadeFrom = DEFAULT_DUTY;
+}
+
+bool PatternSequencer::start(const uint8_t* pattern, uint16_t patternLength, bool loop,
+                             uint64_t nowUs, ToneOutput* out, const RampProfile* rampProfile) {
+    code = pattern;
+    length = pattern ? patternLength : 0;
+    looping = loop;
+    running = true;
+    deadline = nowUs;
+    startUs = nowUs;
+    if (rampProfile) {
+        ramp = *rampProfile;
+    } else {
+        ramp.durationS = 0;
+        ramp.shape = RAMP_NONE;
+    }
+    resetProgramState();
+    return execute(out);
+}
+
+bool PatternSequencer::advance(ToneOutput* out) {
+    if (!running) {
+        return finish(out);
+    }
+
+    // Tone finished: the articulation gap comes before the next instruction
+    if (pendingGap > 0) {
+        uint8_t ticks = pendingGap;
+        pendingGap = 0;
+        return shape(0, 0, 0, 0, (uint32_t)ticks * PC_TICK_MS, out);
+    }
+
+    if (fadeIndex < fadeCount) {
+        return emitFade(out);
+    }
+
+    return execute(out);
+}
+
+bool PatternSequencer::emit(uint32_t frequency, uint32_t ticks, ToneOutput* out) {
+    timedSinceWrap = true;
+    if (frequency) {
+        toneFrequency = frequency;
+    }
+
+    if (frequency && gapTicks > 0 && ticks > gapTicks) {
+        pendingGap = gapTicks;
+        ticks -= gapTicks;
+    }
+    return shape(frequency, duty, duty, 0, ticks * PC_TICK_MS, out);
+}
+
+bool PatternSequencer::emitFade(ToneOutput* out) {
+    const FadeSegment& segment = fadeSegments[fadeIndex++];
+    uint8_t from = fadeFrom;
+    fadeFrom = segment.duty;
+    return shape(toneFrequency, from, segment.duty, segment.fadeMs, segment.durationMs, out);
+}
+
+bool PatternSequencer::shape(uint32_t frequency, uint8_t fromDuty, uint8_t toDuty, uint32_t fadeMs,
+                             uint32_t durationMs, ToneOutput* out) {
+    uint64_t endUs = deadline + (uint64_t)durationMs * 1000;
+    out->frequency = frequency;
+    out->fadeMs = 0;
+
+    if (frequency == 0) {
+        out->duty = 0;
+        out->fadeDuty = 0;
+    } else {
+        // The envelope moves by its level at the step's start and end; the
+        // hardware fade covers both that and any FADE instruction
+        out->duty = FadePlanner::scaleDuty(fromDuty, FadePlanner::rampLevel(ramp, elapsedMs(deadline)));
+        out->fadeDuty = FadePlanner::scaleDuty(toDuty, FadePlanner::rampLevel(ramp, elapsedMs(endUs)));
+
+        if (out->fadeDuty != out->duty) {
+            uint32_t delta = out->fadeDuty > out->duty ? out->fadeDuty - out->duty : out->duty - out->fadeDuty;
+            uint32_t limit = FadePlanner::maxFadeMs(delta, frequency);
+            uint32_t window = fadeMs > 0 ? fadeMs : durationMs;
+            if (window > limit) window = limit;
+            if (window > FADE_SEGMENT_MAX_MS) window = FADE_SEGMENT_MAX_MS;
+            out->fadeMs = window;
+        }
+    }
+
+    deadline = endUs;
+    return true;
+}
+
+bool PatternSequencer::finish(ToneOutput* out) {
+    out->frequency = 0;
+    out->duty = 0;
+    out->fadeDuty = 0;
+    out->fadeMs = 0;
+    running = false;
+    return false;
+}
+
+uint32_t PatternSequencer::elapsedMs(uint64_t atUs) const {
+    uint64_t elapsed = atUs > startUs ? (atUs - startUs) / 1000 : 0;
+    return elapsed > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)elapsed;
+}
+
+bool PatternSequencer::execute(ToneOutput* out) {
+    // Control instructions take no time; the guard stops malformed programs
+    for (uint16_t guard = 0; guard <= length + PATTERN_MAX_LOOP_DEPTH; guard++) {
+        if (pc >= length || code[pc] == PC_OP_END) {
+            if (!looping || !timedSinceWrap) {
+                return finish(out);
+            }
+            resetProgramState();
+            continue;
+        }
+
+        uint8_t op = code[pc];
+        switch (op & 0xC0) {
+            case PC_CLASS_NOTE:
+                if (pc + 1 >= length) return finish(out);
+                pc += 2;
+                if (code[pc - 1] == 0) continue;
+                return emit(PatternCode::noteFrequency(op & 0x3F), code[pc - 1], out);
+
+            case PC_CLASS_TONE:
+                if (pc + 2 >= length) return finish(out);
+                pc += 3;
+                if (code[pc - 1] == 0) continue;
+                return emit(((uint32_t)(op & 0x3F) << 8) | code[pc - 2], code[pc - 1], out);
+
+            case PC_CLASS_REST: {
+                if (pc + 1 >= length) return finish(out);
+                uint32_t ticks = ((uint32_t)(op & 0x3F) << 8) | code[pc + 1];
+                pc += 2;
+                if (ticks == 0) continue;
+                return emit(0, ticks, out);
+            }
+
+            default:
+                break;
+        }
+
+        if (op == PC_OP_ENDLOOP) {
+            if (depth > 0 && loops[depth - 1].remaining > 0) {
+                loops[depth - 1].remaining--;
+                pc = loops[depth - 1].start;
+            } else {
+                if (depth > 0) depth--;
+                pc++;
+            }
+            continue;
+        }
+
+        if (op == PC_OP_FADE) {
+            if (pc + 2 >= length) return finish(out);
+            uint8_t target = code[pc + 1];
+            uint8_t ticks = code[pc + 2];
+            pc += 3;
+            if (target == 0 || ticks == 0) continue;
+
+            // Planned once; each segment becomes one output and one hardware fade
+            timedSinceWrap = true;
+            fadeFrom = duty;
+            fadeCount = FadePlanner::plan(duty, target, (uint32_t)ticks * PC_TICK_MS, toneFrequency,
+                                          fadeSegments, FADE_MAX_SEGMENTS);
+            fadeIndex = 0;
+            duty = target;
+            return emitFade(out);
+        }
+
+        if (pc + 1 >= length) return finish(out);
+        uint8_t operand = code[pc + 1];
+        pc += 2;
+
+        switch (op) {
+            case PC_OP_LOOP:
+                if (depth < PATTERN_MAX_LOOP_DEPTH) {
+                    loops[depth].start = pc;
+                    loops[depth].remaining = operand > 0 ? operand - 1 : 0;
+                    depth++;
+                }
+                break;
+            case PC_OP_VOLUME:
+                duty = operand > 0 ? operand : DEFAULT_DUTY;
+                break;
+            case PC_OP_GAP:
+                gapTicks = operand;
+                break;
+            default:
+                return finish(out);     // Unknown opcode
+        }
+    }
+
+    return finish(out);
+}
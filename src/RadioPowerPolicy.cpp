@@ -0,0 +1,143 @@
+/**
+ * @file RadioPowerPolicy.cpp
+ * @brief WiFi radio duty cycle implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "RadioPowerPolicy.h"
+
+#define MS_PER_HOUR 3600000UL
+
+RadioPowerPolicy::RadioPowerPolicy() {
+    quietStart = RADIO_QUIET_START_MIN;
+    quietEnd = RADIO_QUIET_END_MIN;
+
+    mode = RADIO_DOZE;
+    quiet = false;
+    waking = false;
+    wakeStarted = 0;
+    lastWanted = 0;
+    holdingOff = false;
+    holdOffUntil = 0;
+    wakes = 0;
+    cutOff = 0;
+
+    for (int i = 0; i < RADIO_HISTORY_HOURS; i++) {
+        hourlyOnMs[i] = 0;
+    }
+    currentHour = 0;
+    lastUpdate = 0;
+    started = false;
+}
+
+void RadioPowerPolicy::setQuietWindow(uint16_t startMinute, uint16_t endMinute) {
+    quietStart = startMinute % 1440;
+    quietEnd = endMinute % 1440;
+}
+
+bool RadioPowerPolicy::isQuietTime(int16_t minuteOfDay) const {
+    if (minuteOfDay < 0 || !hasQuietWindow()) {
+        return false;
+    }
+    // The window may wrap past midnight (23:00-06:00)
+    if (quietStart < quietEnd) {
+        return minuteOfDay >= quietStart && minuteOfDay < quietEnd;
+    }
+    return minuteOfDay >= quietStart || minuteOfDay < quietEnd;
+}
+
+RadioMode RadioPowerPolicy::update(uint32_t now, int16_t minuteOfDay, const RadioDemand& demand) {
+    // The time since the last call is charged to the mode that was in force during it
+    advanceHour(now / MS_PER_HOUR);
+    if (started && mode != RADIO_OFF) {
+        uint32_t elapsed = now - lastUpdate;
+        hourlyOnMs[currentHour % RADIO_HISTORY_HOURS] += elapsed < MS_PER_HOUR ? elapsed : MS_PER_HOUR;
+    }
+    lastUpdate = now;
+    started = true;
+
+    quiet = isQuietTime(minuteOfDay);
+    bool wanted = demand.syncDue || demand.flushDue || demand.outboundPending;
+
+    if (!demand.allowed) {
+        waking = false;
+        mode = RADIO_OFF;
+    } else if (demand.alarmActive || demand.uiActive) {
+        waking = false;
+        mode = RADIO_FULL;
+    } else if (!quiet) {
+        // Associated and reachable; modem sleep costs little and wakes for every buffered frame
+        waking = false;
+        holdingOff = false;
+        mode = RADIO_DOZE;
+    } else {
+        if (wanted) {
+            lastWanted = now;
+        }
+        if (holdingOff && (int32_t)(now - holdOffUntil) >= 0) {
+            holdingOff = false;
+        }
+        if (!waking && wanted && !holdingOff) {
+            waking = true;
+            wakeStarted = now;
+            wakes++;
+        }
+
+        if (waking && now - wakeStarted >= RADIO_WAKE_MAX_MS) {
+            // Whatever it was waiting for is not coming; try again much later
+            waking = false;
+            holdingOff = true;
+            holdOffUntil = now + RADIO_WAKE_RETRY_MS;
+            cutOff++;
+        } else if (waking && !wanted && now - lastWanted >= RADIO_WAKE_LINGER_MS) {
+            waking = false;
+        }
+
+        // A short burst at full power gets the radio off sooner than the same work in modem sleep
+        mode = waking ? RADIO_FULL : RADIO_OFF;
+    }
+    return mode;
+}
+
+uint32_t RadioPowerPolicy::getOnTimeInHour(uint32_t now, uint8_t hoursAgo) const {
+    uint32_t hour = now / MS_PER_HOUR;
+    if (hoursAgo >= RADIO_HISTORY_HOURS || hoursAgo > hour) {
+        return 0;
+    }
+
+    // Hours the policy has not reached yet had no time charged; older ones have been reused
+    uint32_t target = hour - hoursAgo;
+    if (target > currentHour || currentHour - target >= RADIO_HISTORY_HOURS) {
+        return 0;
+    }
+    return hourlyOnMs[target % RADIO_HISTORY_HOURS];
+}
+
+void RadioPowerPolicy::fillReport(uint32_t now, RadioReport* report) const {
+    report->mode = mode;
+    report->quiet = quiet;
+    report->quietStart = quietStart;
+    report->quietEnd = quietEnd;
+    report->wakes = wakes;
+    report->cutOff = cutOff;
+    for (uint8_t i = 0; i < RADIO_HISTORY_HOURS; i++) {
+        report->onMs[i] = getOnTimeInHour(now, i);
+    }
+}
+
+void RadioPowerPolicy::advanceHour(uint32_t hour) {
+    if (hour == currentHour) {
+        return;
+    }
+
+    // Clear the slots of every hour that passed since the last update
+    uint32_t elapsed = hour - currentHour;
+    if (elapsed > RADIO_HISTORY_HOURS) {
+        elapsed = RADIO_HISTORY_HOURS;
+    }
+    for (uint32_t i = 1; i <= elapsed; i++) {
+        hourlyOnMs[(hour - elapsed + i) % RADIO_HISTORY_HOURS] = 0;
+    }
+    currentHour = hour;
+}
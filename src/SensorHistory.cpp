@@ -0,0 +1,171 @@
+/**
+ * @file SensorHistory.cpp
+ * @brief Fixed-memory multi-resolution sensor history implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "SensorHistory.h"
+#include <string.h>
+
+// Whole store must stay a few KB; grow the rings only with this budget in mind
+static_assert(sizeof(SensorHistory) <= 8192, "SensorHistory exceeds its 8 KB memory budget");
+
+SensorHistory::SensorHistory() {
+    clear();
+}
+
+void SensorHistory::clear() {
+    for (int c = 0; c < HISTORY_CHANNEL_COUNT; c++) {
+        for (int r = 0; r < HISTORY_RESOLUTION_COUNT; r++) {
+            clearTier((HistoryChannel)c, (HistoryResolution)r);
+        }
+    }
+}
+
+void SensorHistory::record(HistoryChannel channel, uint32_t timestamp, uint8_t value) {
+    if (channel >= HISTORY_CHANNEL_COUNT) {
+        return;
+    }
+
+    addToTier(channel, HISTORY_MINUTE, timestamp, value);
+    addToTier(channel, HISTORY_HOUR, timestamp, value);
+    addToTier(channel, HISTORY_DAY, timestamp, value);
+}
+
+void SensorHistory::addToTier(HistoryChannel channel, HistoryResolution resolution,
+                              uint32_t timestamp, uint8_t value) {
+    uint32_t index = timestamp / periodSeconds(resolution);
+    uint16_t cap = capacity(resolution);
+    HistoryBucket* buckets = ring(channel, resolution);
+    Accumulator& acc = open[channel][resolution];
+
+    if (!started[channel][resolution] || index < head[channel][resolution]) {
+        // First sample, or the clock was stepped backwards: start over
+        clearTier(channel, resolution);
+        started[channel][resolution] = true;
+        head[channel][resolution] = index;
+        tail[channel][resolution] = index;
+    } else if (index != head[channel][resolution]) {
+        // Freeze the open bucket and blank any periods that had no samples
+        uint32_t previous = head[channel][resolution];
+        buckets[previous % cap] = toBucket(acc);
+
+        uint32_t gap = index - previous;
+        if (gap > cap) {
+            gap = cap;
+        }
+        for (uint32_t i = 1; i < gap; i++) {
+            memset(&buckets[(index - i) % cap], 0, sizeof(HistoryBucket));
+        }
+        memset(&buckets[index % cap], 0, sizeof(HistoryBucket));
+
+        memset(&acc, 0, sizeof(acc));
+        head[channel][resolution] = index;
+    }
+
+    if (acc.count == 0) {
+        acc.minValue = value;
+        acc.maxValue = value;
+    } else {
+        if (value < acc.minValue) acc.minValue = value;
+        if (value > acc.maxValue) acc.maxValue = value;
+    }
+    acc.sum += value;
+    acc.count++;
+}
+
+size_t SensorHistory::query(HistoryChannel channel, HistoryResolution resolution,
+                            uint32_t from, uint32_t to,
+                            HistoryBucket* out, size_t maxOut, uint32_t* firstBucketTime) const {
+    if (channel >= HISTORY_CHANNEL_COUNT || resolution >= HISTORY_RESOLUTION_COUNT ||
+        !started[channel][resolution] || from > to || maxOut == 0) {
+        return 0;
+    }
+
+    uint32_t period = periodSeconds(resolution);
+    uint16_t cap = capacity(resolution);
+    uint32_t newest = head[channel][resolution];
+    uint32_t oldest = newest >= (uint32_t)(cap - 1) ? newest - (cap - 1) : 0;
+    if (oldest < tail[channel][resolution]) {
+        oldest = tail[channel][resolution];
+    }
+
+    // Clamp the requested range to what the ring still holds
+    uint32_t first = from / period;
+    uint32_t last = to / period;
+    if (first < oldest) first = oldest;
+    if (last > newest) last = newest;
+    if (first > last) {
+        return 0;
+    }
+    if (last - first + 1 > maxOut) {
+        first = last - (uint32_t)(maxOut - 1); // Keep the most recent buckets
+    }
+
+    const HistoryBucket* buckets = ring(channel, resolution);
+    size_t written = 0;
+    for (uint32_t index = first; index <= last; index++) {
+        out[written++] = (index == newest) ? toBucket(open[channel][resolution]) : buckets[index % cap];
+    }
+
+    if (firstBucketTime) {
+        *firstBucketTime = first * period;
+    }
+    return written;
+}
+
+HistoryBucket* SensorHistory::ring(HistoryChannel channel, HistoryResolution resolution) {
+    switch (resolution) {
+        case HISTORY_MINUTE: return minuteBuckets[channel];
+        case HISTORY_HOUR: return hourBuckets[channel];
+        default: return dayBuckets[channel];
+    }
+}
+
+const HistoryBucket* SensorHistory::ring(HistoryChannel channel, HistoryResolution resolution) const {
+    return const_cast<SensorHistory*>(this)->ring(channel, resolution);
+}
+
+void SensorHistory::clearTier(HistoryChannel channel, HistoryResolution resolution) {
+    memset(ring(channel, resolution), 0, capacity(resolution) * sizeof(HistoryBucket));
+    memset(&open[channel][resolution], 0, sizeof(Accumulator));
+    head[channel][resolution] = 0;
+    tail[channel][resolution] = 0;
+    started[channel][resolution] = false;
+}
+
+HistoryBucket SensorHistory::toBucket(const Accumulator& acc) {
+    HistoryBucket bucket;
+    bucket.count = acc.count > 0xFFFF ? 0xFFFF : (uint16_t)acc.count;
+    bucket.minValue = acc.minValue;
+    bucket.maxValue = acc.maxValue;
+    bucket.avgValue = acc.count ? (uint8_t)((acc.sum + acc.count / 2) / acc.count) : 0;
+    bucket.reserved = 0;
+    return bucket;
+}
+
+uint32_t SensorHistory::periodSeconds(HistoryResolution resolution) {
+    switch (resolution) {
+        case HISTORY_MINUTE: return 60;
+        case HISTORY_HOUR: return 3600;
+        default: return 86400;
+    }
+}
+
+uint16_t SensorHistory::capacity(HistoryResolution resolution) {
+    switch (resolution) {
+        case HISTORY_MINUTE: return HISTORY_MINUTE_BUCKETS;
+        case HISTORY_HOUR: return HISTORY_HOUR_BUCKETS;
+        default: return HISTORY_DAY_BUCKETS;
+    }
+}
+
+const char* SensorHistory::channelName(HistoryChannel channel) {
+    switch (channel) {
+        case HISTORY_LIGHT: return "light";
+        case HISTORY_USB: return "usb";
+        case HISTORY_PILL_BOX: return "pillbox";
+        default: return "unknown";
+    }
+}
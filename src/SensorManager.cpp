@@ -7,7 +7,18 @@
 
 #include "SensorManager.h"
 
-SensorManager::SensorManager(Logger* log) {
+SensorManager::SensorManager(Logger* log)
+    : lightSampler(LIGHT_SENSOR_MIN_INTERVAL_MS, LIGHT_SENSOR_MAX_INTERVAL_MS,
+                   LIGHT_SENSOR_INTERVAL_MS, LIGHT_ACTIVITY_THRESHOLD),
+      usbSampler(USB_DETECT_MIN_INTERVAL_MS, USB_DETECT_MAX_INTERVAL_MS,
+                 USB_DETECT_INTERVAL_MS, USB_ACTIVITY_THRESHOLD),
+      pillBoxSampler(PILL_BOX_CHECK_INTERVAL_MS, PILL_BOX_MAX_INTERVAL_MS,
+                     PILL_BOX_CHECK_INTERVAL_MS, PILL_BOX_ACTIVITY_THRESHOLD),
+      batteryPolicy(LOW_BATTERY_THRESHOLD * 1000, CRITICAL_BATTERY_THRESHOLD * 1000,
+                    BATTERY_HYSTERESIS * 1000, BATTERY_PRESENT_THRESHOLD * 1000,
+                    BATTERY_MAX_PLAUSIBLE * 1000, BATTERY_MAX_STEP * 1000, BATTERY_CONFIRM_SAMPLES),
+      lightTrend(BEDTIME_LIGHT_THRESHOLD, LIGHT_TREND_DWELL_S),
+      sleepTracker(SLEEP_MIN_DURATION_S, SLEEP_MAX_DURATION_S, SLEEP_MERGE_GAP_S) {
     logger = log;
     
     // Initialize sensor states
@@ -17,9 +28,13 @@ SensorManager::SensorManager(Logger* log) {
     previousPillBoxState = false;
     
     // Initialize timing
-    lastLightRead = 0;
-    lastUsbRead = 0;
-    lastPillBoxRead = 0;
+    alarmState = ALARM_IDLE;
+    inBedtimeWindow = false;
+    lastClockCheck = 0;
+    lastSamplingPublish = 0;
+    lastBatteryRead = 0;
+    snapshotBatteryVoltage = 0.0;
+    portMUX_INITIALIZE(&historyLock);
     pillBoxDebounceTime = 0;
     pillBoxRawState = false;
     
@@ -30,6 +45,15 @@ SensorManager::SensorManager(Logger* log) {
     for (int i = 0; i < LIGHT_SAMPLES; i++) {
         lightReadings[i] = 0;
     }
+    
+    // Initialize calibration and diagnostics state machines
+    calibrationState = CALIBRATION_IDLE;
+    calibrationStep = 0;
+    lastCalibrationStep = 0;
+    diagnosticState = DIAGNOSTIC_IDLE;
+    diagnosticStep = 0;
+    lastDiagnosticStep = 0;
+    testResult = SensorTestResult();
 }
 
 SensorManager::~SensorManager() {
@@ -43,49 +67,110 @@ bool SensorManager::begin() {
     // ADC pins don't need pinMode configuration on ESP32
     // GPIO36 and GPIO39 are input-only pins, perfect for ADC
     
-    // Initialize light sensor samples
-    initializeLightSamples();
+    // Boost pill box sampling while an alarm is active
+    EventBus::subscribe<AlarmStateEvent, SensorManager, &SensorManager::onAlarmStateChanged>(this);
+    
+    // Seed the light filter with a single reading so begin() never blocks;
+    // the full calibration then runs in the background from update()
+    seedLightSamples();
     
-    // Read initial states
-    readLightSensor();
+    // Read initial states; without the divider GPIO35 floats, so the battery is not read at all
+#if BATTERY_SENSE_ENABLED
+    battery.begin();
+    readBattery();
+#endif
     readUsbState();
     readPillBoxState();
+    publishSnapshot();
     
     if (logger) {
         logger->logInfo(EVENT_SYSTEM_START, "SensorManager initialized",
                        "Light: " + String(currentLightLevel) + 
                        ", USB: " + (currentUsbState ? "Connected" : "Disconnected") +
-                       ", PillBox: " + (currentPillBoxState ? "Open" : "Closed"));
+                       ", PillBox: " + (currentPillBoxState ? "Open" : "Closed") +
+                       ", Battery: " + String(battery.getVoltage(), 2) + "V (" +
+                       battery.getCalibrationSource() + ")");
     }
     
+    calibrateLightSensor();
+    
     return true;
 }
 
 void SensorManager::update() {
     unsigned long currentTime = millis();
     
-    // Read light sensor at specified interval
-    if (currentTime - lastLightRead >= LIGHT_SENSOR_INTERVAL_MS) {
+    // Advance background calibration and self-test by at most one step each
+    updateCalibration(currentTime);
+    updateDiagnostics(currentTime);
+    
+    // Re-evaluate time-of-day boosts
+    updateSamplingPolicy(currentTime);
+    
+    // Read light sensor when due (calibration owns the filter while running)
+    if (calibrationState == CALIBRATION_IDLE && lightSampler.isDue(currentTime)) {
         readLightSensor();
-        lastLightRead = currentTime;
     }
     
-    // Read USB state at specified interval
-    if (currentTime - lastUsbRead >= USB_DETECT_INTERVAL_MS) {
+    // Read USB state when due
+    if (usbSampler.isDue(currentTime)) {
         readUsbState();
-        lastUsbRead = currentTime;
     }
     
-    // Read pill box state frequently (important for alarm dismissal)
-    if (currentTime - lastPillBoxRead >= PILL_BOX_CHECK_INTERVAL_MS) {
+    // Read pill box state (fast while an alarm waits for it)
+    if (pillBoxSampler.isDue(currentTime)) {
         readPillBoxState();
-        lastPillBoxRead = currentTime;
     }
+    
+#if BATTERY_SENSE_ENABLED
+    // Battery changes slowly; its interval stretches with the power profile
+    if (currentTime - lastBatteryRead >= BATTERY_SAMPLE_INTERVAL_MS * batteryPolicy.getProfile().samplingSlowdown) {
+        readBattery();
+    }
+#endif
+    
+    if (lastSamplingPublish == 0 || currentTime - lastSamplingPublish >= SAMPLING_STATS_PUBLISH_MS) {
+        publishSamplingStats(currentTime);
+    }
+}
+
+void SensorManager::updateSamplingPolicy(unsigned long currentTime) {
+    if (lastClockCheck != 0 && currentTime - lastClockCheck < SAMPLING_CLOCK_CHECK_MS) {
+        return;
+    }
+    lastClockCheck = currentTime;
+    
+    struct tm timeinfo;
+    if (!getLocalTime(&timeinfo, 0)) {
+        inBedtimeWindow = false;
+    } else {
+        // Hours from bedtime, wrapping around midnight
+        int distance = abs(timeinfo.tm_hour - BEDTIME_REMINDER_HOUR);
+        distance = min(distance, 24 - distance);
+        inBedtimeWindow = distance <= BEDTIME_WINDOW_HOURS;
+    }
+    
+    // Dusk near bedtime is when light and charging changes matter most
+    lightSampler.setBoost(inBedtimeWindow);
+    usbSampler.setBoost(inBedtimeWindow);
+}
+
+void SensorManager::setAlarmState(AlarmState state) {
+    alarmState = state;
+    
+    // Dismissal by pill box must be detected immediately while an alarm is active
+    pillBoxSampler.setBoost(state == ALARM_TRIGGERED || state == ALARM_WAITING_FOR_PILL_BOX);
+}
+
+void SensorManager::onAlarmStateChanged(const AlarmStateEvent& event) {
+    setAlarmState(event.state);
 }
 
 void SensorManager::readLightSensor() {
     // Read raw ADC value
     int rawReading = analogRead(LIGHT_SENSOR_PIN);
+    lightSampler.recordSample(millis(), rawReading);
+    recordSample(HISTORY_LIGHT, rawReading);
     
     // Add to rolling average buffer
     lightTotal = lightTotal - lightReadings[lightReadIndex];
@@ -96,16 +181,14 @@ void SensorManager::readLightSensor() {
     // Calculate average
     int newLightLevel = lightTotal / LIGHT_SAMPLES;
     
+    // Every filtered sample feeds the trend detector
+    updateLightTrend(newLightLevel);
+    
     // Check for significant change or first reading
     if (!lightSamplesInitialized || abs(newLightLevel - currentLightLevel) > 50) {
-        bool wasDark = currentLightLevel < BEDTIME_LIGHT_THRESHOLD;
         currentLightLevel = newLightLevel;
         bool isDark = currentLightLevel < BEDTIME_LIGHT_THRESHOLD;
-        
-        // Trigger bedtime callback if transition from light to dark
-        if (!wasDark && isDark && bedtimeCallback) {
-            bedtimeCallback(true);
-        }
+        publishSnapshot();
         
         if (logger && lightSamplesInitialized) {
             logger->logDebug(EVENT_SENSOR_ERROR, "Light level changed",
@@ -117,19 +200,48 @@ void SensorManager::readLightSensor() {
     lightSamplesInitialized = true;
 }
 
+void SensorManager::updateLightTrend(int level) {
+    LightTrendResult trend = lightTrend.update(time(nullptr), level);
+    if (trend.change == LIGHT_TREND_NONE) {
+        return;
+    }
+    
+    bool dark = trend.change == LIGHT_TREND_LIGHTS_OUT;
+    
+    if (logger) {
+        logger->logInfo(EVENT_BEDTIME_REMINDER, dark ? "Lights out detected" : "Lights on detected",
+                       "Level: " + String(trend.level) + ", Confidence: " + String(trend.confidence) + "%");
+    }
+    
+    // Sleep starts only on a confident lights out; any confirmed rise
+    // (including a gradual sunrise) ends it
+    if (dark) {
+        if (trend.confidence >= LIGHT_TREND_MIN_CONFIDENCE) {
+            sleepTracker.onLightsOut(trend.changeTime);
+        }
+    } else if (sleepTracker.onLightsOn(trend.changeTime) && logger) {
+        logger->logInfo(EVENT_BEDTIME_REMINDER, "Sleep recorded",
+                       "Duration: " + String(sleepTracker.getLastNightMinutes()) + " min");
+    }
+    
+    BedtimeEvent event = {dark, trend.level, trend.confidence, trend.changeTime};
+    EventBus::publish(event);
+}
+
 void SensorManager::readUsbState() {
     // Read ADC value from USB detection pin
     int usbReading = analogRead(USB_DETECT_PIN);
+    usbSampler.recordSample(millis(), usbReading);
     bool newUsbState = usbReading > USB_VOLTAGE_THRESHOLD;
+    recordSample(HISTORY_USB, newUsbState ? 1 : 0);
     
     // Check for state change
     if (newUsbState != currentUsbState) {
         currentUsbState = newUsbState;
+        publishSnapshot();
         
-        // Trigger callback
-        if (usbStateCallback) {
-            usbStateCallback(currentUsbState);
-        }
+        UsbStateEvent event = {currentUsbState};
+        EventBus::publish(event);
         
         if (logger) {
             logger->logInfo(currentUsbState ? EVENT_USB_CONNECTED : EVENT_USB_DISCONNECTED,
@@ -144,6 +256,7 @@ void SensorManager::readPillBoxState() {
     
     // Read raw digital state (LOW = pressed/closed, HIGH = open due to pullup)
     bool rawState = digitalRead(PILL_BOX_SWITCH_PIN) == HIGH;
+    pillBoxSampler.recordSample(currentTime, rawState ? 100 : 0);
     
     // Debouncing logic
     if (rawState != pillBoxRawState) {
@@ -156,11 +269,10 @@ void SensorManager::readPillBoxState() {
         if (pillBoxRawState != currentPillBoxState) {
             previousPillBoxState = currentPillBoxState;
             currentPillBoxState = pillBoxRawState;
+            publishSnapshot();
             
-            // Trigger callback
-            if (pillBoxCallback) {
-                pillBoxCallback(currentPillBoxState);
-            }
+            PillBoxEvent event = {currentPillBoxState};
+            EventBus::publish(event);
             
             if (logger) {
                 logger->logInfo(currentPillBoxState ? EVENT_PILL_BOX_OPENED : EVENT_PILL_BOX_CLOSED,
@@ -168,50 +280,201 @@ void SensorManager::readPillBoxState() {
             }
         }
     }
+    
+    recordSample(HISTORY_PILL_BOX, currentPillBoxState ? 1 : 0);
 }
 
-void SensorManager::initializeLightSamples() {
-    // Fill the light sensor buffer with initial readings
+void SensorManager::readBattery() {
+    lastBatteryRead = millis();
+    uint16_t millivolts = battery.sample();
+    
+    // Ignore ADC noise so readers are not told about meaningless changes
+    if (abs((int)millivolts - (int)(snapshotBatteryVoltage * 1000)) >= 10) {
+        snapshotBatteryVoltage = millivolts / 1000.0f;
+        publishSnapshot();
+    }
+    
+    if (!batteryPolicy.update(millivolts)) {
+        return;
+    }
+    
+    // Level changed: degrade (or restore) sampling rates
+    PowerProfile profile = batteryPolicy.getProfile();
+    lightSampler.setSlowdown(profile.samplingSlowdown);
+    usbSampler.setSlowdown(profile.samplingSlowdown);
+    
+    if (logger) {
+        String data = "Voltage: " + String(millivolts / 1000.0f, 2) + "V";
+        if (profile.level == BATTERY_LOW || profile.level == BATTERY_CRITICAL) {
+            logger->logWarning(EVENT_LOW_BATTERY, String("Battery ") + BatteryPolicy::levelName(profile.level), data);
+        } else {
+            logger->logInfo(EVENT_SYSTEM_START, String("Battery ") + BatteryPolicy::levelName(profile.level), data);
+        }
+    }
+    
+    // Deferred: consumers may tear down WiFi, which should not happen mid-update
+    PowerProfileEvent event = {profile};
+    EventBus::post(event);
+}
+
+size_t SensorManager::queryHistory(HistoryChannel channel, HistoryResolution resolution, uint32_t from, uint32_t to,
+                                   HistoryBucket* out, size_t maxOut, uint32_t* firstBucketTime) const {
+    // At most one ring's worth of buckets is copied; record() never waits longer than that
+    portENTER_CRITICAL(&historyLock);
+    size_t count = history.query(channel, resolution, from, to, out, maxOut, firstBucketTime);
+    portEXIT_CRITICAL(&historyLock);
+    return count;
+}
+
+void SensorManager::recordSample(HistoryChannel channel, uint16_t value) {
+    uint32_t timestamp = time(nullptr);
+    
+    // History buckets use a 0-255 scale
+    portENTER_CRITICAL(&historyLock);
+    history.record(channel, timestamp, channel == HISTORY_LIGHT ? (uint8_t)(value >> 4) : (value ? 255 : 0));
+    portEXIT_CRITICAL(&historyLock);
+    
+    SensorSampleEvent event = {channel, timestamp, value};
+    EventBus::publish(event);
+}
+
+void SensorManager::seedLightSamples() {
+    // Fill the whole light sensor buffer with one reading
+    int reading = analogRead(LIGHT_SENSOR_PIN);
     for (int i = 0; i < LIGHT_SAMPLES; i++) {
-        lightReadings[i] = analogRead(LIGHT_SENSOR_PIN);
-        lightTotal += lightReadings[i];
-        delay(LIGHT_SAMPLE_DELAY_MS);
+        lightReadings[i] = reading;
+    }
+    lightTotal = reading * LIGHT_SAMPLES;
+    lightReadIndex = 0;
+    currentLightLevel = reading;
+    lightSamplesInitialized = true;
+}
+
+void SensorManager::updateCalibration(unsigned long currentTime) {
+    if (calibrationState != CALIBRATION_SAMPLING) {
+        return;
+    }
+    
+    if (calibrationStep > 0 && currentTime - lastCalibrationStep < LIGHT_SAMPLE_DELAY_MS) {
+        return;
+    }
+    
+    // Take one sample per step
+    lightReadings[calibrationStep] = analogRead(LIGHT_SENSOR_PIN);
+    lightTotal += lightReadings[calibrationStep];
+    calibrationStep++;
+    lastCalibrationStep = currentTime;
+    
+    if (calibrationStep < LIGHT_SAMPLES) {
+        return;
     }
+    
+    // Buffer is full: publish the new baseline
+    lightReadIndex = 0;
     currentLightLevel = lightTotal / LIGHT_SAMPLES;
+    lightSamplesInitialized = true;
+    calibrationState = CALIBRATION_IDLE;
+    publishSnapshot();
+    
+    if (logger) {
+        logger->logInfo(EVENT_SYSTEM_START, "Light sensor calibrated",
+                       "New baseline: " + String(currentLightLevel));
+    }
+    
+    LightCalibratedEvent event = {currentLightLevel};
+    EventBus::publish(event);
+}
+
+void SensorManager::updateDiagnostics(unsigned long currentTime) {
+    switch (diagnosticState) {
+        case DIAGNOSTIC_IDLE:
+            break;
+            
+        case DIAGNOSTIC_LIGHT: {
+            if (diagnosticStep > 0 && currentTime - lastDiagnosticStep < SENSOR_TEST_SAMPLE_INTERVAL_MS) {
+                break;
+            }
+            
+            int reading = analogRead(LIGHT_SENSOR_PIN);
+            testResult.lightMin = min(testResult.lightMin, reading);
+            testResult.lightMax = max(testResult.lightMax, reading);
+            diagnosticStep++;
+            lastDiagnosticStep = currentTime;
+            
+            if (diagnosticStep >= SENSOR_TEST_SAMPLES) {
+                if (logger) {
+                    logger->logInfo(EVENT_SYSTEM_START, "Light sensor test complete",
+                                   "Min: " + String(testResult.lightMin) + ", Max: " + String(testResult.lightMax) +
+                                   ", Range: " + String(testResult.lightMax - testResult.lightMin));
+                }
+                diagnosticState = DIAGNOSTIC_USB;
+            }
+            break;
+        }
+            
+        case DIAGNOSTIC_USB:
+            testResult.usbReading = analogRead(USB_DETECT_PIN);
+            testResult.usbConnected = testResult.usbReading > USB_VOLTAGE_THRESHOLD;
+            if (logger) {
+                logger->logInfo(EVENT_SYSTEM_START, "USB detection test",
+                               "ADC Reading: " + String(testResult.usbReading) + 
+                               " (" + (testResult.usbConnected ? "Connected" : "Disconnected") + ")");
+            }
+            diagnosticState = DIAGNOSTIC_PILL_BOX;
+            break;
+            
+        case DIAGNOSTIC_PILL_BOX:
+            testResult.pillBoxOpen = digitalRead(PILL_BOX_SWITCH_PIN) == HIGH;
+            if (logger) {
+                logger->logInfo(EVENT_SYSTEM_START, "Pill box switch test",
+                               "State: " + String(testResult.pillBoxOpen ? "Open" : "Closed"));
+                logger->logInfo(EVENT_SYSTEM_START, "Sensor diagnostic test completed");
+            }
+            diagnosticState = DIAGNOSTIC_IDLE;
+            
+            SensorTestEvent event = {testResult};
+            EventBus::publish(event);
+            break;
+    }
 }
 
 int SensorManager::getAverageLightLevel() {
     return lightSamplesInitialized ? (lightTotal / LIGHT_SAMPLES) : currentLightLevel;
 }
 
-SensorReadings SensorManager::getCurrentReadings() {
+SensorReadings SensorManager::getCurrentReadings() const {
+    SensorReadings readings;
+    readings.version = snapshot.read(&readings);
+    return readings;
+}
+
+void SensorManager::publishSnapshot() {
+    // Only the sensor path writes; readers copy without blocking it
     SensorReadings readings;
     readings.lightLevel = currentLightLevel;
     readings.usbConnected = currentUsbState;
     readings.pillBoxOpen = currentPillBoxState;
-    readings.batteryVoltage = 0.0; // TODO: Implement battery voltage reading
+    readings.batteryVoltage = snapshotBatteryVoltage;
     readings.timestamp = millis();
+    readings.version = snapshot.getVersion() + 1;
     
-    return readings;
+    snapshot.publish(readings);
 }
 
 void SensorManager::calibrateLightSensor() {
+    if (calibrationState != CALIBRATION_IDLE) {
+        return;
+    }
+    
     if (logger) {
         logger->logInfo(EVENT_SYSTEM_START, "Starting light sensor calibration");
     }
     
-    // Reset the light sensor buffer
+    // Reset the light sensor buffer; samples are taken one per update()
     lightTotal = 0;
     lightReadIndex = 0;
-    lightSamplesInitialized = false;
-    
-    // Take new samples
-    initializeLightSamples();
-    
-    if (logger) {
-        logger->logInfo(EVENT_SYSTEM_START, "Light sensor calibrated",
-                       "New baseline: " + String(currentLightLevel));
-    }
+    calibrationStep = 0;
+    calibrationState = CALIBRATION_SAMPLING;
 }
 
 void SensorManager::setLightThreshold(int threshold) {
@@ -231,47 +494,81 @@ String SensorManager::getSensorStatus() {
     status += ")\n";
     status += "USB Connected: " + String(currentUsbState ? "Yes" : "No") + "\n";
     status += "Pill Box: " + String(currentPillBoxState ? "Open" : "Closed") + "\n";
+    status += "Battery: " + String(battery.getVoltage(), 2) + "V (" +
+              BatteryPolicy::levelName(batteryPolicy.getLevel()) + ")\n";
     status += "Last Update: " + String(millis()) + "ms\n";
     
     return status;
 }
 
-void SensorManager::performSensorTest() {
-    if (logger) {
-        logger->logInfo(EVENT_SYSTEM_START, "Starting sensor diagnostic test");
-    }
+String SensorManager::getSamplingStats() {
+    unsigned long currentTime = millis();
+    String stats = "Sampling Stats (samples this hour / last hour, interval):\n";
+    stats += "Light: " + String(lightSampler.getSamplesInHour(currentTime, 0)) + " / " +
+             String(lightSampler.getSamplesInHour(currentTime, 1)) + ", " +
+             String(lightSampler.getInterval()) + "ms\n";
+    stats += "USB: " + String(usbSampler.getSamplesInHour(currentTime, 0)) + " / " +
+             String(usbSampler.getSamplesInHour(currentTime, 1)) + ", " +
+             String(usbSampler.getInterval()) + "ms\n";
+    stats += "Pill Box: " + String(pillBoxSampler.getSamplesInHour(currentTime, 0)) + " / " +
+             String(pillBoxSampler.getSamplesInHour(currentTime, 1)) + ", " +
+             String(pillBoxSampler.getInterval()) + "ms\n";
+    stats += String("Bedtime window: ") + (inBedtimeWindow ? "Yes" : "No") + "\n";
     
-    // Test light sensor
-    int lightMin = 4095, lightMax = 0;
-    for (int i = 0; i < 10; i++) {
-        int reading = analogRead(LIGHT_SENSOR_PIN);
-        lightMin = min(lightMin, reading);
-        lightMax = max(lightMax, reading);
-        delay(100);
-    }
+    return stats;
+}
+
+void SensorManager::publishSamplingStats(unsigned long currentTime) {
+    lastSamplingPublish = currentTime;
     
-    if (logger) {
-        logger->logInfo(EVENT_SYSTEM_START, "Light sensor test complete",
-                       "Min: " + String(lightMin) + ", Max: " + String(lightMax) +
-                       ", Range: " + String(lightMax - lightMin));
+    SamplingStats stats;
+    AdaptiveSampler* samplers[] = {&lightSampler, &usbSampler, &pillBoxSampler};
+    SamplerStats* outputs[] = {&stats.light, &stats.usb, &stats.pillBox};
+    for (int i = 0; i < 3; i++) {
+        outputs[i]->intervalMs = samplers[i]->getInterval();
+        outputs[i]->samplesThisHour = samplers[i]->getSamplesInHour(currentTime, 0);
+        outputs[i]->samplesLastHour = samplers[i]->getSamplesInHour(currentTime, 1);
+        outputs[i]->boosted = samplers[i]->isBoosted();
     }
+    stats.bedtimeWindow = inBedtimeWindow;
+    samplingSnapshot.publish(stats);
+}
+
+SamplingStats SensorManager::getSamplingSnapshot() const {
+    SamplingStats stats;
+    samplingSnapshot.read(&stats);
+    return stats;
+}
+
+String SensorManager::getSleepStats() {
+    const char* regimeName = lightTrend.getRegime() == LIGHT_REGIME_DARK ? "Dark" :
+                             lightTrend.getRegime() == LIGHT_REGIME_LIT ? "Lit" : "Unknown";
+    String stats = "Sleep Stats:\n";
+    stats += String("Room: ") + regimeName + " (lit ~" + String(lightTrend.getLitBaseline()) +
+             ", dark ~" + String(lightTrend.getDarkBaseline()) + ")\n";
+    stats += String("Asleep: ") + (sleepTracker.isAsleep() ? "Yes" : "No") + "\n";
+    stats += "Nights recorded: " + String(sleepTracker.getNightCount()) + "\n";
+    stats += "Last night: " + String(sleepTracker.getLastNightMinutes()) + " min\n";
+    stats += "Average: " + String(sleepTracker.getAverageMinutes()) + " min\n";
     
-    // Test USB detection
-    int usbReading = analogRead(USB_DETECT_PIN);
-    if (logger) {
-        logger->logInfo(EVENT_SYSTEM_START, "USB detection test",
-                       "ADC Reading: " + String(usbReading) + 
-                       " (" + (usbReading > USB_VOLTAGE_THRESHOLD ? "Connected" : "Disconnected") + ")");
+    return stats;
+}
+
+void SensorManager::performSensorTest() {
+    if (diagnosticState != DIAGNOSTIC_IDLE) {
+        return;
     }
     
-    // Test pill box switch
-    bool switchState = digitalRead(PILL_BOX_SWITCH_PIN) == HIGH;
     if (logger) {
-        logger->logInfo(EVENT_SYSTEM_START, "Pill box switch test",
-                       "State: " + String(switchState ? "Open" : "Closed"));
+        logger->logInfo(EVENT_SYSTEM_START, "Starting sensor diagnostic test");
     }
     
-    if (logger) {
-        logger->logInfo(EVENT_SYSTEM_START, "Sensor diagnostic test completed");
-    }
-}
+    // Results are collected step by step from update()
+    testResult.lightMin = 4095;
+    testResult.lightMax = 0;
+    testResult.usbReading = 0;
+    testResult.usbConnected = false;
+    testResult.pillBoxOpen = false;
+    diagnosticStep = 0;
+    diagnosticState = DIAGNOSTIC_LIGHT;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+/**
+ * @file SleepTracker.cpp
+ * @brief Sleep duration statistics implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "SleepTracker.h"
+
+SleepTracker::SleepTracker(uint32_t minSeconds, uint32_t maxSeconds, uint32_t mergeSeconds) {
+    minSleepSeconds = minSeconds;
+    maxSleepSeconds = maxSeconds;
+    mergeGapSeconds = mergeSeconds;
+    asleep = false;
+    sleepStart = 0;
+    lastWake = 0;
+    canMerge = false;
+    recorded = false;
+    head = 0;
+    count = 0;
+    for (int i = 0; i < SLEEP_HISTORY_NIGHTS; i++) {
+        nightMinutes[i] = 0;
+    }
+}
+
+void SleepTracker::onLightsOut(uint32_t timestamp) {
+    if (asleep) {
+        return;
+    }
+    asleep = true;
+
+    // Short interruption: keep the original start so the night is extended
+    if (canMerge && timestamp - lastWake < mergeGapSeconds) {
+        return;
+    }
+    sleepStart = timestamp;
+    recorded = false;
+}
+
+bool SleepTracker::onLightsOn(uint32_t timestamp) {
+    if (!asleep) {
+        return false;
+    }
+    asleep = false;
+    lastWake = timestamp;
+
+    uint32_t duration = timestamp - sleepStart;
+    if (duration > maxSleepSeconds) {
+        // Lights left off (e.g. away from home); not a night's sleep
+        canMerge = false;
+        return false;
+    }
+    canMerge = true;
+
+    if (recorded) {
+        // Same night continued after an interruption: overwrite the newest entry
+        nightMinutes[(head + SLEEP_HISTORY_NIGHTS - 1) % SLEEP_HISTORY_NIGHTS] = duration / 60;
+        return true;
+    }
+
+    if (duration < minSleepSeconds) {
+        // Too short for a night (so far); it may still be continued
+        return false;
+    }
+
+    nightMinutes[head] = duration / 60;
+    head = (head + 1) % SLEEP_HISTORY_NIGHTS;
+    if (count < SLEEP_HISTORY_NIGHTS) {
+        count++;
+    }
+    recorded = true;
+    return true;
+}
+
+uint16_t SleepTracker::getLastNightMinutes() const {
+    if (count == 0) {
+        return 0;
+    }
+    return nightMinutes[(head + SLEEP_HISTORY_NIGHTS - 1) % SLEEP_HISTORY_NIGHTS];
+}
+
+uint16_t SleepTracker::getAverageMinutes() const {
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        total += nightMinutes[(head + SLEEP_HISTORY_NIGHTS - 1 - i) % SLEEP_HISTORY_NIGHTS];
+    }
+    return total / count;
+}
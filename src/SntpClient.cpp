@@ -0,0 +1,157 @@
+/**
+ * @file SntpClient.cpp
+ * @brief Non-blocking SNTP client state machine implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "SntpClient.h"
+#include <string.h>
+
+static const int64_t NTP_UNIX_OFFSET_S = 2208988800LL;     // 1900-01-01 to 1970-01-01
+static const uint8_t NTP_MODE_CLIENT = 3;
+static const uint8_t NTP_MODE_SERVER = 4;
+static const uint8_t NTP_VERSION = 4;
+static const uint8_t NTP_LEAP_UNSYNCHRONIZED = 3;
+
+static uint64_t readTimestamp(const uint8_t* p) {
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+SntpClient::SntpClient() {
+    sendPacket = nullptr;
+    receivePacket = nullptr;
+    context = nullptr;
+    waiting = false;
+    sentMonotonicUs = 0;
+    sentClockUs = 0;
+    sentTimestamp = 0;
+    nextPollUs = 0;
+    pollIntervalS = SNTP_MIN_POLL_S;
+    retryS = SNTP_RETRY_MIN_S;
+    memset(&sample, 0, sizeof(sample));
+    requests = 0;
+    replies = 0;
+}
+
+void SntpClient::begin(SendFunction send, ReceiveFunction receive, void* ctx) {
+    sendPacket = send;
+    receivePacket = receive;
+    context = ctx;
+}
+
+void SntpClient::requestNow() {
+    nextPollUs = 0;
+    retryS = SNTP_RETRY_MIN_S;
+}
+
+void SntpClient::setPollInterval(uint32_t seconds) {
+    pollIntervalS = seconds;
+}
+
+void SntpClient::backOff(uint64_t monotonicUs) {
+    nextPollUs = monotonicUs + (uint64_t)retryS * 1000000;
+    retryS = retryS * 2 < pollIntervalS ? retryS * 2 : pollIntervalS;
+}
+
+SntpStatus SntpClient::update(uint64_t monotonicUs, int64_t clockUs) {
+    if (!sendPacket || !receivePacket) {
+        return SNTP_IDLE;
+    }
+
+    if (waiting) {
+        uint8_t packet[SNTP_PACKET_BYTES + 20];     // Room for an optional key ID and digest
+        size_t length;
+        while ((length = receivePacket(context, packet, sizeof(packet))) > 0) {
+            // Anything that does not answer our outstanding request is dropped
+            if (length < SNTP_PACKET_BYTES || (packet[0] & 0x07) != NTP_MODE_SERVER ||
+                readTimestamp(packet + 24) != sentTimestamp) {
+                continue;
+            }
+            waiting = false;
+            replies++;
+
+            uint8_t leap = packet[0] >> 6;
+            uint8_t stratum = packet[1];
+            if (leap == NTP_LEAP_UNSYNCHRONIZED || stratum == 0 || stratum > 15) {
+                backOff(monotonicUs);       // Stratum 0 is a kiss-o'-death
+                return SNTP_REJECTED;
+            }
+
+            // t1/t4 on our clock (t4 via the monotonic clock, immune to slewing), t2/t3 on the server's
+            int64_t t1 = sentClockUs;
+            int64_t t4 = sentClockUs + (int64_t)(monotonicUs - sentMonotonicUs);
+            int64_t t2 = fromNtpTime(readTimestamp(packet + 32));
+            int64_t t3 = fromNtpTime(readTimestamp(packet + 40));
+            int64_t delay = (t4 - t1) - (t3 - t2);
+
+            sample.offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+            sample.delayUs = delay > 0 ? (uint32_t)delay : 0;
+            sample.monotonicUs = monotonicUs;
+            sample.stratum = stratum;
+
+            nextPollUs = monotonicUs + (uint64_t)pollIntervalS * 1000000;
+            retryS = SNTP_RETRY_MIN_S;
+            return SNTP_SAMPLE;
+        }
+
+        if (monotonicUs - sentMonotonicUs > (uint64_t)SNTP_TIMEOUT_MS * 1000) {
+            waiting = false;
+            backOff(monotonicUs);
+            return SNTP_TIMEOUT;
+        }
+        return SNTP_WAITING;
+    }
+
+    if (monotonicUs < nextPollUs) {
+        return SNTP_IDLE;
+    }
+
+    uint8_t packet[SNTP_PACKET_BYTES];
+    sentTimestamp = toNtpTime(clockUs);
+    writeRequest(sentTimestamp, packet);
+    if (!sendPacket(context, packet, sizeof(packet))) {
+        backOff(monotonicUs);
+        return SNTP_TIMEOUT;
+    }
+
+    waiting = true;
+    sentMonotonicUs = monotonicUs;
+    sentClockUs = clockUs;
+    requests++;
+    return SNTP_WAITING;
+}
+
+uint64_t SntpClient::toNtpTime(int64_t unixUs) {
+    int64_t seconds = unixUs / 1000000;
+    int64_t micros = unixUs % 1000000;
+    if (micros < 0) {
+        seconds--;
+        micros += 1000000;
+    }
+    uint64_t ntpSeconds = (uint64_t)(seconds + NTP_UNIX_OFFSET_S) & 0xFFFFFFFFULL;
+    uint64_t fraction = ((uint64_t)micros << 32) / 1000000;
+    return (ntpSeconds << 32) | fraction;
+}
+
+int64_t SntpClient::fromNtpTime(uint64_t ntpTime) {
+    uint32_t ntpSeconds = (uint32_t)(ntpTime >> 32);
+    int64_t seconds = (int64_t)ntpSeconds - NTP_UNIX_OFFSET_S;
+    if (ntpSeconds < 0x80000000UL) {
+        seconds += 0x100000000LL;       // Era 1, from February 2036
+    }
+    int64_t micros = (int64_t)(((ntpTime & 0xFFFFFFFFULL) * 1000000 + 0x80000000ULL) >> 32);
+    return seconds * 1000000 + micros;
+}
+
+void SntpClient::writeRequest(uint64_t transmitTime, uint8_t* packet) {
+    memset(packet, 0, SNTP_PACKET_BYTES);
+    packet[0] = (NTP_VERSION << 3) | NTP_MODE_CLIENT;
+    for (uint8_t i = 0; i < 8; i++) {
+        packet[40 + i] = (uint8_t)(transmitTime >> (56 - 8 * i));
+    }
+}
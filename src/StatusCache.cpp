@@ -0,0 +1,135 @@
+/**
+ * @file StatusCache.cpp
+ * @brief Cached /status document implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "StatusCache.h"
+#include <stdio.h>
+#include <string.h>
+
+static_assert(STATUS_FIELD_MAX <= 32, "Field selections are 32-bit masks");
+
+StatusCache::StatusCache() {
+    memset(document, 0, sizeof(document));
+    fieldCount = 0;
+    length = 0;
+    renders = 0;
+}
+
+void StatusCache::beginRender(JsonWriter& json) {
+    length = 0;
+    fieldCount = 0;
+    json.beginObject();
+}
+
+void StatusCache::field(JsonWriter& json, const char* name) {
+    if (fieldCount > 0) {
+        fieldEnds[fieldCount - 1] = json.size();
+    }
+    if (fieldCount >= STATUS_FIELD_MAX) {
+        fieldCount = STATUS_FIELD_MAX + 1;      // Marks the render as failed
+        return;
+    }
+    fieldNames[fieldCount++] = name;
+    json.key(name);
+}
+
+bool StatusCache::finish(JsonWriter& json) {
+    if (fieldCount > 0 && fieldCount <= STATUS_FIELD_MAX) {
+        fieldEnds[fieldCount - 1] = json.size();
+    }
+    json.endObject();
+    if (json.overflowed() || !json.isComplete() || fieldCount == 0 || fieldCount > STATUS_FIELD_MAX) {
+        fieldCount = 0;
+        return false;
+    }
+    length = json.size();
+    renders++;
+    return true;
+}
+
+uint32_t StatusCache::parseFields(const char* list) const {
+    uint32_t mask = 0;
+    const char* name = list;
+    while (*name) {
+        const char* end = strchr(name, ',');
+        size_t nameLength = end ? (size_t)(end - name) : strlen(name);
+        if (nameLength > 0) {
+            uint8_t i = 0;
+            while (i < fieldCount && (strncmp(fieldNames[i], name, nameLength) != 0 ||
+                                      fieldNames[i][nameLength] != '\0')) {
+                i++;
+            }
+            if (i == fieldCount) {
+                return 0;
+            }
+            mask |= 1u << i;
+        }
+        if (!end) {
+            break;
+        }
+        name = end + 1;
+    }
+    return mask;
+}
+
+size_t StatusCache::emit(uint32_t mask, char* out, size_t size, uint32_t* hash) const {
+    uint32_t h = 2166136261u;
+    size_t written = 0;
+    bool first = true;
+
+    // A field runs from just after the comma (or brace) before its key to the end of its value
+    for (uint8_t i = 0; i <= fieldCount + 1; i++) {
+        const char* from;
+        size_t count;
+        if (i == 0) {
+            from = "{";
+            count = 1;
+        } else if (i == fieldCount + 1) {
+            from = "}";
+            count = 1;
+        } else if (mask & (1u << (i - 1))) {
+            size_t start = i == 1 ? 1 : fieldEnds[i - 2] + 1;
+            if (!first) {
+                h = (h ^ ',') * 16777619u;
+                if (out && written < size) {
+                    out[written] = ',';
+                }
+                written++;
+            }
+            first = false;
+            from = document + start;
+            count = fieldEnds[i - 1] - start;
+        } else {
+            continue;
+        }
+
+        for (size_t j = 0; j < count; j++) {
+            h = (h ^ (uint8_t)from[j]) * 16777619u;
+        }
+        if (out && written + count <= size) {
+            memcpy(out + written, from, count);
+        }
+        written += count;
+    }
+
+    *hash = h;
+    return written;
+}
+
+void StatusCache::formatETag(uint32_t mask, char* out) const {
+    uint32_t hash;
+    emit(mask, nullptr, 0, &hash);
+    snprintf(out, 12, "\"%08x\"", (unsigned int)hash);
+}
+
+size_t StatusCache::copy(uint32_t mask, char* out, size_t size) const {
+    if (!isValid()) {
+        return 0;
+    }
+    uint32_t hash;
+    size_t written = emit(mask, out, size, &hash);
+    return written <= size ? written : 0;
+}
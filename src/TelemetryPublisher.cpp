@@ -0,0 +1,385 @@
+/**
+ * @file TelemetryPublisher.cpp
+ * @brief MQTT telemetry implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "TelemetryPublisher.h"
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <time.h>
+#include "EventBus.h"
+#include "NetworkManager.h"
+#include "SensorManager.h"
+#include "AlarmManager.h"
+
+#define TELEMETRY_DIRECTORY "/littlefs/telemetry"     // Through the VFS, so plain stdio works
+
+// Only ever used from update(), so one buffer is enough
+static char payloadBuffer[TELEMETRY_PAYLOAD_MAX];
+
+TelemetryPublisher::TelemetryPublisher(Logger* log, NetworkManager* networkManager, const SensorManager* sensorManager) {
+    logger = log;
+    network = networkManager;
+    sensors = sensorManager;
+    deviceId[0] = '\0';
+    topic[0] = '\0';
+
+    linkState = TELEMETRY_OFFLINE;
+    wifiUp = false;
+    socketFd = -1;
+    stateSince = 0;
+    nextAttempt = 0;
+    failures = 0;
+    brokerAddress = 0;
+    resolving = false;
+
+    batchInFlight = false;
+    batchLastSequence = 0;
+    batchCount = 0;
+
+    lastMetrics = 0;
+    lastFlush = 0;
+    sequenceReserved = 0;
+    batchesSent = 0;
+    recordsSent = 0;
+}
+
+TelemetryPublisher::~TelemetryPublisher() {
+    closeLink(nullptr);
+    preferences.end();
+}
+
+bool TelemetryPublisher::begin() {
+    if (!isEnabled()) {
+        if (logger) logger->logInfo(EVENT_SYSTEM_START, "Telemetry disabled (no MQTT_BROKER)");
+        return true;
+    }
+    if (!preferences.begin("telemetry", false)) {
+        if (logger) logger->logError(EVENT_SYSTEM_START, "Failed to open telemetry preferences");
+        return false;
+    }
+
+    // Events only go to flash if it mounts; RAM alone still works
+    const char* directory = LittleFS.begin(true) ? TELEMETRY_DIRECTORY : nullptr;
+    if (!spool.begin(directory, preferences.getUInt("sequence", 1)) || !directory) {
+        if (logger) logger->logWarning(EVENT_SENSOR_ERROR, "Telemetry spool has no flash, keeping records in RAM only");
+    }
+    reserveSequences();
+
+    snprintf(deviceId, sizeof(deviceId), "%012llx", (unsigned long long)ESP.getEfuseMac());
+    snprintf(topic, sizeof(topic), "%s/%s/telemetry", MQTT_TOPIC_PREFIX, deviceId);
+    char clientId[MQTT_CLIENT_ID_MAX + 1];
+    snprintf(clientId, sizeof(clientId), "nb-%s", deviceId);
+    mqtt.setClientId(clientId);
+    mqtt.begin(&TelemetryPublisher::sendBytes, &TelemetryPublisher::receiveBytes, this);
+
+    wifiUp = network && network->isConnected();
+    lastFlush = millis();
+
+    EventBus::subscribe<AlarmStateEvent, TelemetryPublisher, &TelemetryPublisher::onAlarmStateChanged>(this);
+    EventBus::subscribe<PillBoxEvent, TelemetryPublisher, &TelemetryPublisher::onPillBoxChanged>(this);
+    EventBus::subscribe<UsbStateEvent, TelemetryPublisher, &TelemetryPublisher::onUsbStateChanged>(this);
+    EventBus::subscribe<BedtimeEvent, TelemetryPublisher, &TelemetryPublisher::onBedtime>(this);
+    EventBus::subscribe<NetworkStateEvent, TelemetryPublisher, &TelemetryPublisher::onNetworkStateChanged>(this);
+
+    if (logger) {
+        logger->logInfo(EVENT_SYSTEM_START, "Telemetry to " + String(MQTT_BROKER) + ":" + String(MQTT_PORT) + " on " +
+                        String(topic) + ", " + String(spool.size()) + " records queued");
+    }
+    return true;
+}
+
+void TelemetryPublisher::update() {
+    if (!isEnabled()) {
+        return;
+    }
+    unsigned long currentTime = millis();
+
+    if (currentTime - lastMetrics >= TELEMETRY_METRICS_INTERVAL_MS) {
+        lastMetrics = currentTime;
+        sampleMetrics();
+    }
+
+    updateLink(currentTime);
+
+    if (linkState == TELEMETRY_SESSION) {
+        switch (mqtt.update(currentTime)) {
+            case MQTT_SESSION_UP:
+                if (logger) logger->logInfo(EVENT_WIFI_CONNECTED, "Telemetry session up, " + String(spool.size()) + " records queued");
+                failures = 0;
+                break;
+
+            case MQTT_PUBLISHED:
+                spool.acknowledge(batchLastSequence);
+                batchInFlight = false;
+                batchesSent++;
+                recordsSent += batchCount;
+                break;
+
+            case MQTT_LOST: {
+                static const char* const reasons[] = {"closed", "refused", "timeout", "transport error", "protocol error"};
+                closeLink(reasons[mqtt.getLastError()]);
+                break;
+            }
+
+            default:
+                break;
+        }
+        publishNext(currentTime);
+    }
+
+    // Events want out soon; metrics can wait for the next flush
+    if (spool.isEmpty()) {
+        lastFlush = currentTime;
+    }
+    if (network) {
+        network->setOutboundPending(spool.eventCount() > 0);
+        network->setNextTelemetryFlush(spool.isEmpty() ? 0 : lastFlush + TELEMETRY_FLUSH_INTERVAL_MS);
+    }
+}
+
+void TelemetryPublisher::updateLink(unsigned long currentTime) {
+    switch (linkState) {
+        case TELEMETRY_OFFLINE: {
+            // Connect only with something to send; the session then stays up while WiFi does
+            if (!wifiUp || spool.isEmpty() || (long)(currentTime - nextAttempt) < 0) {
+                return;
+            }
+            stateSince = currentTime;
+
+            // Answered from the DNS cache (or an address literal) or later through the callback
+            ip_addr_t address;
+            brokerAddress = 0;
+            resolving = true;
+            err_t result = dns_gethostbyname(MQTT_BROKER, &address, &TelemetryPublisher::onBrokerResolved, this);
+            if (result == ERR_OK) {
+                resolving = false;
+                brokerAddress = ip_addr_get_ip4_u32(&address);
+                startConnect(currentTime);
+            } else if (result == ERR_INPROGRESS) {
+                linkState = TELEMETRY_RESOLVING;
+            } else {
+                resolving = false;
+                closeLink("DNS lookup failed");
+            }
+            break;
+        }
+
+        case TELEMETRY_RESOLVING:
+            if (brokerAddress != 0) {
+                startConnect(currentTime);
+            } else if (!resolving || currentTime - stateSince > MQTT_CONNECT_TIMEOUT_MS) {
+                closeLink("broker name not resolved");
+            }
+            break;
+
+        case TELEMETRY_CONNECTING: {
+            // Writable once the handshake is done, one way or the other
+            fd_set writable;
+            FD_ZERO(&writable);
+            FD_SET(socketFd, &writable);
+            struct timeval noWait = {0, 0};
+            if (select(socketFd + 1, nullptr, &writable, nullptr, &noWait) > 0) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                if (getsockopt(socketFd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+                    closeLink("connection refused");
+                    return;
+                }
+                linkState = TELEMETRY_SESSION;
+                stateSince = currentTime;
+                mqtt.startSession(currentTime);
+            } else if (currentTime - stateSince > MQTT_CONNECT_TIMEOUT_MS) {
+                closeLink("connect timeout");
+            }
+            break;
+        }
+
+        case TELEMETRY_SESSION:
+            break;
+    }
+}
+
+void TelemetryPublisher::startConnect(unsigned long currentTime) {
+    socketFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socketFd < 0) {
+        closeLink("no socket");
+        return;
+    }
+    fcntl(socketFd, F_SETFL, fcntl(socketFd, F_GETFL, 0) | O_NONBLOCK);
+    int noDelay = 1;
+    setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(MQTT_PORT);
+    address.sin_addr.s_addr = brokerAddress;    // Already in network order
+
+    if (connect(socketFd, (struct sockaddr*)&address, sizeof(address)) != 0 && errno != EINPROGRESS) {
+        closeLink("connect failed");
+        return;
+    }
+    linkState = TELEMETRY_CONNECTING;
+    stateSince = currentTime;
+}
+
+void TelemetryPublisher::closeLink(const char* reason) {
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+    mqtt.reset();
+    batchInFlight = false;      // Its records are still in the spool and go out again
+    linkState = TELEMETRY_OFFLINE;
+
+    // No reason: WiFi went away, which says nothing about the broker
+    if (!reason) {
+        nextAttempt = millis();
+        return;
+    }
+
+    if (failures < 16) {
+        failures++;
+    }
+    uint32_t backoff = MQTT_RETRY_MIN_MS;
+    for (uint8_t i = 1; i < failures && backoff < MQTT_RETRY_MAX_MS; i++) {
+        backoff *= 2;
+    }
+    if (backoff > MQTT_RETRY_MAX_MS) {
+        backoff = MQTT_RETRY_MAX_MS;
+    }
+    uint32_t jitter = backoff / 4;
+    backoff = backoff - jitter + esp_random() % (2 * jitter + 1);
+    nextAttempt = millis() + backoff;
+
+    if (logger) {
+        logger->logWarning(EVENT_WIFI_DISCONNECTED, "Telemetry link lost: " + String(reason) + ", retry in " +
+                           String(backoff / 1000) + " s");
+    }
+}
+
+void TelemetryPublisher::publishNext(unsigned long currentTime) {
+    if (batchInFlight || !mqtt.canPublish()) {
+        return;
+    }
+
+    TelemetryRecord batch[TELEMETRY_BATCH_RECORDS];
+    size_t count = spool.peek(batch, TELEMETRY_BATCH_RECORDS);
+    if (count == 0) {
+        return;
+    }
+
+    size_t length = 0;
+    size_t encoded = TelemetrySpool::encodeBatch(deviceId, batch, count, payloadBuffer, sizeof(payloadBuffer), &length);
+    if (encoded == 0) {
+        // Cannot happen with the configured sizes, but a record that never fits must not stall the rest
+        spool.acknowledge(batch[0].sequence);
+        return;
+    }
+
+    if (mqtt.publish(topic, (const uint8_t*)payloadBuffer, length, currentTime)) {
+        batchInFlight = true;
+        batchLastSequence = batch[encoded - 1].sequence;
+        batchCount = encoded;
+    }
+}
+
+void TelemetryPublisher::reserveSequences() {
+    // Numbers are reserved in NVS a block ahead, so a restart never reuses one and NVS sees one write per block
+    if (spool.getNextSequence() + TELEMETRY_BATCH_RECORDS < sequenceReserved) {
+        return;
+    }
+    sequenceReserved = spool.getNextSequence() + TELEMETRY_SEQUENCE_BLOCK;
+    preferences.putUInt("sequence", sequenceReserved);
+}
+
+void TelemetryPublisher::record(TelemetryKind kind, const int32_t* values, uint8_t count) {
+    uint32_t timestamp = network && network->isTimeValid() ? (uint32_t)time(nullptr) : 0;
+    spool.push(kind, timestamp, values, count);
+    reserveSequences();
+}
+
+void TelemetryPublisher::sampleMetrics() {
+    int32_t values[4] = {0, 0, 0, 0};
+    if (sensors) {
+        SensorReadings readings = sensors->getCurrentReadings();
+        values[0] = readings.lightLevel;
+        values[1] = (int32_t)(readings.batteryVoltage * 1000.0f + 0.5f);
+    }
+    values[2] = (int32_t)ESP.getFreeHeap();
+    values[3] = wifiUp ? WiFi.RSSI() : 0;
+    record(TELEMETRY_METRICS, values, 4);
+}
+
+int TelemetryPublisher::sendBytes(void* context, const uint8_t* data, size_t length) {
+    TelemetryPublisher* self = static_cast<TelemetryPublisher*>(context);
+    int sent = send(self->socketFd, data, length, MSG_DONTWAIT);
+    if (sent >= 0) {
+        return sent;
+    }
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+int TelemetryPublisher::receiveBytes(void* context, uint8_t* data, size_t capacity) {
+    TelemetryPublisher* self = static_cast<TelemetryPublisher*>(context);
+    int received = recv(self->socketFd, data, capacity, MSG_DONTWAIT);
+    if (received > 0) {
+        return received;
+    }
+    if (received == 0) {
+        return -1;      // Closed by the broker
+    }
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+void TelemetryPublisher::onBrokerResolved(const char* name, const ip_addr_t* address, void* context) {
+    // lwIP task
+    TelemetryPublisher* self = static_cast<TelemetryPublisher*>(context);
+    self->brokerAddress = address ? ip_addr_get_ip4_u32(address) : 0;
+    self->resolving = false;
+}
+
+void TelemetryPublisher::onAlarmStateChanged(const AlarmStateEvent& event) {
+    int32_t values[3] = {(int32_t)event.state, (int32_t)event.previous, (int32_t)event.alarmId};
+    record(TELEMETRY_ALARM, values, 3);
+}
+
+void TelemetryPublisher::onPillBoxChanged(const PillBoxEvent& event) {
+    int32_t values[1] = {event.open ? 1 : 0};
+    record(TELEMETRY_PILL_BOX, values, 1);
+}
+
+void TelemetryPublisher::onUsbStateChanged(const UsbStateEvent& event) {
+    int32_t values[1] = {event.connected ? 1 : 0};
+    record(TELEMETRY_USB, values, 1);
+}
+
+void TelemetryPublisher::onBedtime(const BedtimeEvent& event) {
+    int32_t values[3] = {event.dark ? 1 : 0, (int32_t)event.lightLevel, (int32_t)event.confidence};
+    record(TELEMETRY_BEDTIME, values, 3);
+}
+
+void TelemetryPublisher::onNetworkStateChanged(const NetworkStateEvent& event) {
+    wifiUp = event.connected;
+    if (!wifiUp && linkState != TELEMETRY_OFFLINE) {
+        closeLink(nullptr);
+    }
+}
+
+String TelemetryPublisher::getStats() const {
+    if (!isEnabled()) {
+        return "Telemetry: disabled\n";
+    }
+    static const char* const states[] = {"offline", "resolving", "connecting", "connected"};
+    String stats = "Telemetry: ";
+    stats += states[linkState];
+    stats += ", " + String(spool.size()) + " queued (" + String(spool.flashSize()) + " in flash)\n";
+    stats += "Sent: " + String(recordsSent) + " records in " + String(batchesSent) + " batches\n";
+    stats += "Dropped: " + String(spool.getDroppedEvents()) + " events, " + String(spool.getDroppedMetrics()) +
+             " metrics, " + String(spool.getFlashErrors()) + " flash errors\n";
+    return stats;
+}
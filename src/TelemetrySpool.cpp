@@ -0,0 +1,360 @@
+/**
+ * @file TelemetrySpool.cpp
+ * @brief Bounded RAM and flash queue for outgoing telemetry implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "TelemetrySpool.h"
+#include "JsonWriter.h"
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+TelemetrySpool::TelemetrySpool() {
+    ramHead = 0;
+    ramCount = 0;
+    ramEvents = 0;
+
+    directory[0] = '\0';
+    flashEnabled = false;
+    firstSegment = 0;
+    nextSegment = 0;
+    firstSegmentRead = 0;
+    firstSegmentSize = 0;
+    flashRecords = 0;
+    peekedFlash = false;
+
+    nextSequence = 1;
+    droppedEvents = 0;
+    droppedMetrics = 0;
+    flashErrors = 0;
+}
+
+bool TelemetrySpool::begin(const char* path, uint32_t firstSequence) {
+    nextSequence = firstSequence ? firstSequence : 1;
+    if (!path || strlen(path) >= sizeof(directory)) {
+        flashEnabled = false;
+        return path == nullptr;
+    }
+    strcpy(directory, path);
+    mkdir(directory, 0755);     // Usually there already
+
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        flashEnabled = false;
+        return false;
+    }
+
+    // Segment numbers are the file names in hex; anything else is left alone
+    bool found = false;
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        char* end;
+        uint32_t number = (uint32_t)strtoul(entry->d_name, &end, 16);
+        if (end == entry->d_name || strcmp(end, ".tlm") != 0) {
+            continue;
+        }
+        if (!found || number < lowest) lowest = number;
+        if (!found || number > highest) highest = number;
+        found = true;
+    }
+    closedir(dir);
+    flashEnabled = true;
+
+    if (!found) {
+        firstSegment = nextSegment = 0;
+        return true;
+    }
+    firstSegment = lowest;
+    nextSegment = highest + 1;
+
+    char file[TELEMETRY_PATH_MAX];
+    flashRecords = 0;
+    for (uint32_t segment = firstSegment; segment < nextSegment; segment++) {
+        segmentPath(segment, file);
+        flashRecords += recordsInFile(file);
+    }
+    openFirstSegment();
+
+    // Carry on after the newest record flash still holds
+    segmentPath(highest, file);
+    uint32_t records = recordsInFile(file);
+    FILE* last = records > 0 ? fopen(file, "rb") : nullptr;
+    if (last) {
+        TelemetryRecord record;
+        if (fseek(last, (long)((records - 1) * sizeof(record)), SEEK_SET) == 0 &&
+            fread(&record, sizeof(record), 1, last) == 1 && record.sequence >= nextSequence) {
+            nextSequence = record.sequence + 1;
+        }
+        fclose(last);
+    }
+    return true;
+}
+
+uint32_t TelemetrySpool::push(TelemetryKind kind, uint32_t timestamp, const int32_t* values, uint8_t count) {
+    if (ramCount == TELEMETRY_RAM_RECORDS) {
+        makeRoom();
+    }
+
+    TelemetryRecord& record = ram[(ramHead + ramCount) % TELEMETRY_RAM_RECORDS];
+    memset(&record, 0, sizeof(record));
+    record.sequence = nextSequence++;
+    record.timestamp = timestamp;
+    record.kind = kind;
+    record.valueCount = count > TELEMETRY_MAX_VALUES ? TELEMETRY_MAX_VALUES : count;
+    memcpy(record.values, values, record.valueCount * sizeof(int32_t));
+    ramCount++;
+    if (kind != TELEMETRY_METRICS) {
+        ramEvents++;
+    }
+    return record.sequence;
+}
+
+void TelemetrySpool::makeRoom() {
+    // Events wait for at least half a segment, so flash is not spent on files of one or two records
+    if (ramEvents >= TELEMETRY_SEGMENT_RECORDS / 2 && flashEnabled) {
+        if (nextSegment - firstSegment >= TELEMETRY_FLASH_SEGMENTS) {
+            dropOldestSegment();
+        }
+        if (spillEvents()) {
+            return;
+        }
+    }
+
+    // Nowhere to move events: the oldest metric goes, or the oldest event if there is none
+    uint16_t victim = 0;
+    for (uint16_t i = 0; i < ramCount; i++) {
+        if (ramAt(i).kind == TELEMETRY_METRICS) {
+            victim = i;
+            break;
+        }
+    }
+    if (ramAt(victim).kind == TELEMETRY_METRICS) {
+        droppedMetrics++;
+    } else {
+        droppedEvents++;
+    }
+    removeFromRam(victim);
+}
+
+bool TelemetrySpool::spillEvents() {
+    TelemetryRecord segment[TELEMETRY_SEGMENT_RECORDS];
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < ramCount && count < TELEMETRY_SEGMENT_RECORDS; i++) {
+        if (ramAt(i).kind != TELEMETRY_METRICS) {
+            segment[count++] = ramAt(i);
+        }
+    }
+
+    // Written in one go and never touched again
+    char file[TELEMETRY_PATH_MAX];
+    segmentPath(nextSegment, file);
+    FILE* out = fopen(file, "wb");
+    bool written = out && fwrite(segment, sizeof(TelemetryRecord), count, out) == count;
+    if (out && fclose(out) != 0) {
+        written = false;
+    }
+    if (!written) {
+        remove(file);
+        flashErrors++;
+        return false;
+    }
+
+    if (firstSegment == nextSegment) {
+        firstSegmentRead = 0;
+        firstSegmentSize = count;
+    }
+    nextSegment++;
+    flashRecords += count;
+
+    // Keep the rest in order: events moved out, metrics stay
+    uint16_t moved = 0;
+    for (uint16_t i = 0; i < ramCount && moved < count;) {
+        if (ramAt(i).kind != TELEMETRY_METRICS) {
+            removeFromRam(i);
+            moved++;
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
+
+void TelemetrySpool::dropOldestSegment() {
+    uint32_t lost = firstSegmentSize - firstSegmentRead;
+    droppedEvents += lost;
+    flashRecords -= lost;
+
+    char file[TELEMETRY_PATH_MAX];
+    segmentPath(firstSegment, file);
+    remove(file);
+    firstSegment++;
+    openFirstSegment();
+}
+
+void TelemetrySpool::removeFromRam(uint16_t index) {
+    if (ramAt(index).kind != TELEMETRY_METRICS) {
+        ramEvents--;
+    }
+    if (index == 0) {
+        ramHead = (ramHead + 1) % TELEMETRY_RAM_RECORDS;
+        ramCount--;
+        return;
+    }
+    for (uint16_t i = index; i + 1 < ramCount; i++) {
+        ram[(ramHead + i) % TELEMETRY_RAM_RECORDS] = ram[(ramHead + i + 1) % TELEMETRY_RAM_RECORDS];
+    }
+    ramCount--;
+}
+
+void TelemetrySpool::openFirstSegment() {
+    // Empty files (a write cut short by a reset) are skipped and removed
+    firstSegmentRead = 0;
+    firstSegmentSize = 0;
+    char file[TELEMETRY_PATH_MAX];
+    while (firstSegment < nextSegment) {
+        segmentPath(firstSegment, file);
+        firstSegmentSize = recordsInFile(file);
+        if (firstSegmentSize > 0) {
+            return;
+        }
+        remove(file);
+        firstSegment++;
+    }
+}
+
+size_t TelemetrySpool::peek(TelemetryRecord* records, size_t max) {
+    peekedFlash = false;
+    while (flashRecords > 0) {
+        char file[TELEMETRY_PATH_MAX];
+        segmentPath(firstSegment, file);
+        size_t wanted = firstSegmentSize - firstSegmentRead;
+        if (wanted > max) {
+            wanted = max;
+        }
+
+        FILE* in = fopen(file, "rb");
+        size_t count = 0;
+        if (in) {
+            if (fseek(in, (long)(firstSegmentRead * sizeof(TelemetryRecord)), SEEK_SET) == 0) {
+                count = fread(records, sizeof(TelemetryRecord), wanted, in);
+            }
+            fclose(in);
+        }
+        if (count == wanted) {
+            peekedFlash = true;
+            return count;
+        }
+
+        // Unreadable: its events are lost, but the rest of the spool still goes out
+        flashErrors++;
+        dropOldestSegment();
+    }
+
+    size_t count = ramCount < max ? ramCount : max;
+    for (size_t i = 0; i < count; i++) {
+        records[i] = ramAt((uint16_t)i);
+    }
+    return count;
+}
+
+void TelemetrySpool::acknowledge(uint32_t lastSequence) {
+    // A batch from RAM may have been moved to flash while it was out, so both are checked then
+    while (flashRecords > 0) {
+        char file[TELEMETRY_PATH_MAX];
+        segmentPath(firstSegment, file);
+        FILE* in = fopen(file, "rb");
+        TelemetryRecord record;
+        bool read = in && fseek(in, (long)(firstSegmentRead * sizeof(record)), SEEK_SET) == 0 &&
+                    fread(&record, sizeof(record), 1, in) == 1;
+        uint32_t acknowledged = 0;
+        while (read && record.sequence <= lastSequence) {
+            acknowledged++;
+            if (firstSegmentRead + acknowledged == firstSegmentSize) {
+                break;
+            }
+            read = fread(&record, sizeof(record), 1, in) == 1;
+        }
+        if (in) {
+            fclose(in);
+        }
+
+        firstSegmentRead += acknowledged;
+        flashRecords -= acknowledged;
+        if (firstSegmentRead < firstSegmentSize) {
+            break;
+        }
+        remove(file);
+        firstSegment++;
+        openFirstSegment();
+    }
+
+    if (peekedFlash) {
+        return;     // Older metrics still in RAM were not part of a flash batch
+    }
+    while (ramCount > 0 && ramAt(0).sequence <= lastSequence) {
+        removeFromRam(0);
+    }
+}
+
+void TelemetrySpool::segmentPath(uint32_t segment, char* path) const {
+    snprintf(path, TELEMETRY_PATH_MAX, "%s/%08lx.tlm", directory, (unsigned long)segment);
+}
+
+uint32_t TelemetrySpool::recordsInFile(const char* path) {
+    // A record cut short at the end is ignored
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        return 0;
+    }
+    return (uint32_t)(info.st_size / sizeof(TelemetryRecord));
+}
+
+size_t TelemetrySpool::encodeBatch(const char* device, const TelemetryRecord* records, size_t count, char* out,
+                                   size_t size, size_t* length) {
+    JsonWriter json(out, size);
+    json.beginObject();
+    json.key("dev");
+    json.string(device);
+    json.key("r");
+    json.beginArray();
+
+    // Whole records only; the closing brackets are always kept free
+    size_t written = 0;
+    for (; written < count; written++) {
+        const TelemetryRecord& record = records[written];
+        JsonWriter::Mark before = json.mark();
+        json.beginArray();
+        json.unsignedNumber(record.sequence);
+        json.unsignedNumber(record.timestamp);
+        json.string(kindName(record.kind));
+        for (uint8_t i = 0; i < record.valueCount; i++) {
+            json.number(record.values[i]);
+        }
+        json.endArray();
+        if (json.overflowed()) {
+            json.rollback(before);
+            break;
+        }
+    }
+    json.endArray();
+    json.endObject();
+
+    *length = json.isComplete() ? json.size() : 0;
+    return *length > 0 ? written : 0;
+}
+
+const char* TelemetrySpool::kindName(uint8_t kind) {
+    switch (kind) {
+        case TELEMETRY_METRICS: return "m";
+        case TELEMETRY_ALARM: return "alarm";
+        case TELEMETRY_PILL_BOX: return "pill";
+        case TELEMETRY_USB: return "usb";
+        case TELEMETRY_BEDTIME: return "bed";
+        default: return "?";
+    }
+}
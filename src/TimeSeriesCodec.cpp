@@ -0,0 +1,201 @@
+/**
+ * @file TimeSeriesCodec.cpp
+ * @brief Gorilla-style block codec implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "TimeSeriesCodec.h"
+#include <string.h>
+
+static uint32_t zigzagEncode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t zigzagDecode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Bit streams are written MSB first
+void BitWriter::reset(uint8_t* data, size_t sizeBytes) {
+    buffer = data;
+    capacityBits = sizeBytes * 8;
+    position = 0;
+    memset(buffer, 0, sizeBytes);
+}
+
+void BitWriter::write(uint32_t value, uint8_t bits) {
+    for (int i = bits - 1; i >= 0; i--) {
+        if (position >= capacityBits) {
+            return;
+        }
+        if ((value >> i) & 1) {
+            buffer[position >> 3] |= (uint8_t)(0x80 >> (position & 7));
+        }
+        position++;
+    }
+}
+
+bool BitReader::read(uint8_t bits, uint32_t* value) {
+    if (position + bits > capacityBits) {
+        return false;
+    }
+
+    uint32_t result = 0;
+    for (uint8_t i = 0; i < bits; i++) {
+        result = (result << 1) | ((buffer[position >> 3] >> (7 - (position & 7))) & 1);
+        position++;
+    }
+    *value = result;
+    return true;
+}
+
+TimeSeriesBlockEncoder::TimeSeriesBlockEncoder() {
+    reset();
+}
+
+void TimeSeriesBlockEncoder::reset() {
+    writer.reset(block + TS_BLOCK_HEADER_SIZE, TS_BLOCK_SIZE - TS_BLOCK_HEADER_SIZE);
+    memset(block, 0, TS_BLOCK_HEADER_SIZE);
+    sampleCount = 0;
+    firstTimestamp = 0;
+    firstValue = 0;
+    lastTimestamp = 0;
+    lastDelta = 0;
+    lastValue = 0;
+}
+
+bool TimeSeriesBlockEncoder::append(uint32_t timestamp, uint16_t value) {
+    if (sampleCount == 0) {
+        // First sample lives in the header
+        firstTimestamp = timestamp;
+        firstValue = value;
+        lastTimestamp = timestamp;
+        lastValue = value;
+        sampleCount = 1;
+        return true;
+    }
+
+    if (writer.bitsFree() < TS_MAX_SAMPLE_BITS || sampleCount == UINT16_MAX) {
+        return false;
+    }
+
+    // Timestamp: delta of delta
+    int32_t delta = (int32_t)(timestamp - lastTimestamp);
+    int32_t dod = delta - lastDelta;
+    uint32_t zz = zigzagEncode(dod);
+    if (dod == 0) {
+        writer.write(0x0, 1);
+    } else if (zz < (1u << 7)) {
+        writer.write(0x2, 2);
+        writer.write(zz, 7);
+    } else if (zz < (1u << 9)) {
+        writer.write(0x6, 3);
+        writer.write(zz, 9);
+    } else if (zz < (1u << 12)) {
+        writer.write(0xE, 4);
+        writer.write(zz, 12);
+    } else {
+        writer.write(0xF, 4);
+        writer.write(zz, 32);
+    }
+
+    // Value: zigzag delta, or the raw value when the delta is large
+    int32_t valueDelta = (int32_t)value - (int32_t)lastValue;
+    uint32_t vz = zigzagEncode(valueDelta);
+    if (valueDelta == 0) {
+        writer.write(0x0, 1);
+    } else if (vz < (1u << 6)) {
+        writer.write(0x2, 2);
+        writer.write(vz, 6);
+    } else if (vz < (1u << 9)) {
+        writer.write(0x6, 3);
+        writer.write(vz, 9);
+    } else {
+        writer.write(0x7, 3);
+        writer.write(value, 16);
+    }
+
+    lastDelta = delta;
+    lastTimestamp = timestamp;
+    lastValue = value;
+    sampleCount++;
+    return true;
+}
+
+void TimeSeriesBlockEncoder::writeHeader() {
+    block[0] = sampleCount & 0xFF;
+    block[1] = sampleCount >> 8;
+    block[2] = firstValue & 0xFF;
+    block[3] = firstValue >> 8;
+    block[4] = firstTimestamp & 0xFF;
+    block[5] = (firstTimestamp >> 8) & 0xFF;
+    block[6] = (firstTimestamp >> 16) & 0xFF;
+    block[7] = firstTimestamp >> 24;
+}
+
+const uint8_t* TimeSeriesBlockEncoder::data() {
+    writeHeader();
+    return block;
+}
+
+TimeSeriesBlockDecoder::TimeSeriesBlockDecoder(const uint8_t* data, size_t sizeBytes)
+    : reader(data + TS_BLOCK_HEADER_SIZE, sizeBytes > TS_BLOCK_HEADER_SIZE ? sizeBytes - TS_BLOCK_HEADER_SIZE : 0) {
+    decoded = 0;
+    lastDelta = 0;
+    if (sizeBytes < TS_BLOCK_HEADER_SIZE) {
+        sampleCount = 0;
+        lastTimestamp = 0;
+        lastValue = 0;
+        return;
+    }
+    sampleCount = (uint16_t)(data[0] | (data[1] << 8));
+    lastValue = (uint16_t)(data[2] | (data[3] << 8));
+    lastTimestamp = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+                    ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+}
+
+bool TimeSeriesBlockDecoder::next(uint32_t* timestamp, uint16_t* value) {
+    if (decoded >= sampleCount) {
+        return false;
+    }
+
+    if (decoded > 0) {
+        // Timestamp prefix: count leading ones (max 4)
+        uint32_t bit = 0;
+        int ones = 0;
+        while (ones < 4) {
+            if (!reader.read(1, &bit)) return false;
+            if (bit == 0) break;
+            ones++;
+        }
+
+        static const uint8_t dodBits[] = {0, 7, 9, 12, 32};
+        uint32_t zz = 0;
+        if (ones > 0 && !reader.read(dodBits[ones], &zz)) return false;
+        lastDelta += zigzagDecode(zz);
+        lastTimestamp += (uint32_t)lastDelta;
+
+        // Value prefix: count leading ones (max 3)
+        ones = 0;
+        while (ones < 3) {
+            if (!reader.read(1, &bit)) return false;
+            if (bit == 0) break;
+            ones++;
+        }
+
+        uint32_t raw = 0;
+        if (ones == 3) {
+            if (!reader.read(16, &raw)) return false;
+            lastValue = (uint16_t)raw;
+        } else if (ones > 0) {
+            if (!reader.read(ones == 1 ? 6 : 9, &raw)) return false;
+            lastValue = (uint16_t)((int32_t)lastValue + zigzagDecode(raw));
+        }
+    }
+
+    decoded++;
+    *timestamp = lastTimestamp;
+    *value = lastValue;
+    return true;
+}
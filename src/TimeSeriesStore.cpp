@@ -0,0 +1,250 @@
+/**
+ * @file TimeSeriesStore.cpp
+ * @brief Append-only compressed sensor time series implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "TimeSeriesStore.h"
+
+TimeSeriesStore::TimeSeriesStore(Logger* log) {
+    logger = log;
+    mounted = false;
+    
+    for (int i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+        blockCount[i] = 0;
+        lastValue[i] = 0;
+        lastTimestamp[i] = 0;
+        samplesWritten[i] = 0;
+    }
+}
+
+TimeSeriesStore::~TimeSeriesStore() {
+    flush();
+}
+
+bool TimeSeriesStore::begin() {
+    if (!LittleFS.begin(true)) {
+        if (logger) logger->logError(EVENT_SENSOR_ERROR, "Failed to mount LittleFS for time series");
+        return false;
+    }
+    mounted = true;
+    
+    if (!LittleFS.exists(TS_DIRECTORY)) {
+        LittleFS.mkdir(TS_DIRECTORY);
+    }
+    
+    // Resume block counting from the existing index files
+    for (int i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+        File index = LittleFS.open(indexPath((HistoryChannel)i), FILE_READ);
+        if (index) {
+            blockCount[i] = index.size() / sizeof(TimeSeriesIndexEntry);
+            index.close();
+        }
+    }
+    
+    if (logger) {
+        logger->logInfo(EVENT_SYSTEM_START, "TimeSeriesStore initialized",
+                       "Blocks: " + String(blockCount[HISTORY_LIGHT]) + "/" +
+                       String(blockCount[HISTORY_USB]) + "/" + String(blockCount[HISTORY_PILL_BOX]) +
+                       ", Used: " + String(LittleFS.usedBytes()) + "/" + String(LittleFS.totalBytes()));
+    }
+    
+    return true;
+}
+
+void TimeSeriesStore::append(HistoryChannel channel, uint32_t timestamp, uint16_t value) {
+    if (!mounted || channel >= HISTORY_CHANNEL_COUNT) {
+        return;
+    }
+    
+    // Skip repeats so slow-changing binary channels cost almost nothing
+    TimeSeriesBlockEncoder& encoder = encoders[channel];
+    if ((samplesWritten[channel] > 0 || !encoder.isEmpty()) && value == lastValue[channel] &&
+        timestamp - lastTimestamp[channel] < TS_UNCHANGED_KEEPALIVE_S) {
+        return;
+    }
+    
+    if (!encoder.append(timestamp, value)) {
+        // Block is full: persist it and start the next one with this sample
+        writeBlock(channel);
+        encoder.reset();
+        encoder.append(timestamp, value);
+    }
+    
+    lastValue[channel] = value;
+    lastTimestamp[channel] = timestamp;
+    samplesWritten[channel]++;
+}
+
+void TimeSeriesStore::flush() {
+    if (!mounted) {
+        return;
+    }
+    
+    for (int i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+        if (!encoders[i].isEmpty()) {
+            writeBlock((HistoryChannel)i);
+            encoders[i].reset();
+        }
+    }
+}
+
+bool TimeSeriesStore::writeBlock(HistoryChannel channel) {
+    if (blockCount[channel] >= TS_MAX_BLOCKS_PER_FILE) {
+        rotate(channel);
+    }
+    
+    TimeSeriesBlockEncoder& encoder = encoders[channel];
+    
+    // Data first, then index: a crash in between only leaves an unindexed block
+    File data = LittleFS.open(dataPath(channel), FILE_APPEND);
+    if (!data) {
+        if (logger) logger->logError(EVENT_SENSOR_ERROR, "Time series write failed", dataPath(channel));
+        return false;
+    }
+    TimeSeriesIndexEntry entry;
+    entry.offset = data.size();
+    size_t written = data.write(encoder.data(), TS_BLOCK_SIZE);
+    data.close();
+    
+    if (written != TS_BLOCK_SIZE) {
+        if (logger) logger->logError(EVENT_SENSOR_ERROR, "Time series block truncated", dataPath(channel));
+        return false;
+    }
+    
+    entry.firstTimestamp = encoder.getFirstTimestamp();
+    entry.lastTimestamp = encoder.getLastTimestamp();
+    entry.sampleCount = encoder.getSampleCount();
+    entry.reserved = 0;
+    
+    File index = LittleFS.open(indexPath(channel), FILE_APPEND);
+    if (!index) {
+        return false;
+    }
+    index.write((const uint8_t*)&entry, sizeof(entry));
+    index.close();
+    
+    blockCount[channel]++;
+    return true;
+}
+
+void TimeSeriesStore::rotate(HistoryChannel channel) {
+    LittleFS.remove(dataPath(channel, true));
+    LittleFS.remove(indexPath(channel, true));
+    LittleFS.rename(dataPath(channel), dataPath(channel, true));
+    LittleFS.rename(indexPath(channel), indexPath(channel, true));
+    blockCount[channel] = 0;
+    
+    if (logger) {
+        logger->logInfo(EVENT_SYSTEM_START, "Time series rotated", SensorHistory::channelName(channel));
+    }
+}
+
+size_t TimeSeriesStore::readRange(HistoryChannel channel, uint32_t from, uint32_t to,
+                                  std::function<bool(uint32_t, uint16_t)> visitor) {
+    if (!mounted || channel >= HISTORY_CHANNEL_COUNT || from > to) {
+        return 0;
+    }
+    
+    bool stop = false;
+    size_t visited = readFile(channel, true, from, to, visitor, &stop);
+    if (!stop) {
+        visited += readFile(channel, false, from, to, visitor, &stop);
+    }
+    
+    // Samples still waiting in the open block
+    TimeSeriesBlockEncoder& encoder = encoders[channel];
+    if (!stop && !encoder.isEmpty() && encoder.getLastTimestamp() >= from && encoder.getFirstTimestamp() <= to) {
+        TimeSeriesBlockDecoder decoder(encoder.data(), TS_BLOCK_SIZE);
+        uint32_t timestamp;
+        uint16_t value;
+        while (decoder.next(&timestamp, &value)) {
+            if (timestamp < from) continue;
+            if (timestamp > to || !visitor(timestamp, value)) break;
+            visited++;
+        }
+    }
+    
+    return visited;
+}
+
+size_t TimeSeriesStore::readFile(HistoryChannel channel, bool rotated, uint32_t from, uint32_t to,
+                                 std::function<bool(uint32_t, uint16_t)> visitor, bool* stop) {
+    File index = LittleFS.open(indexPath(channel, rotated), FILE_READ);
+    if (!index) {
+        return 0;
+    }
+    File data = LittleFS.open(dataPath(channel, rotated), FILE_READ);
+    if (!data) {
+        index.close();
+        return 0;
+    }
+    
+    // Binary search for the first block that ends at or after 'from'
+    uint32_t entries = index.size() / sizeof(TimeSeriesIndexEntry);
+    uint32_t low = 0, high = entries;
+    TimeSeriesIndexEntry entry;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        index.seek(mid * sizeof(entry));
+        index.read((uint8_t*)&entry, sizeof(entry));
+        if (entry.lastTimestamp < from) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    size_t visited = 0;
+    uint8_t block[TS_BLOCK_SIZE];
+    for (uint32_t i = low; i < entries && !*stop; i++) {
+        index.seek(i * sizeof(entry));
+        if (index.read((uint8_t*)&entry, sizeof(entry)) != sizeof(entry) || entry.firstTimestamp > to) {
+            break;
+        }
+        
+        data.seek(entry.offset);
+        if (data.read(block, TS_BLOCK_SIZE) != TS_BLOCK_SIZE) {
+            break;
+        }
+        
+        TimeSeriesBlockDecoder decoder(block, TS_BLOCK_SIZE);
+        uint32_t timestamp;
+        uint16_t value;
+        while (decoder.next(&timestamp, &value)) {
+            if (timestamp < from) continue;
+            if (timestamp > to) break;
+            if (!visitor(timestamp, value)) {
+                *stop = true;
+                break;
+            }
+            visited++;
+        }
+    }
+    
+    data.close();
+    index.close();
+    return visited;
+}
+
+String TimeSeriesStore::dataPath(HistoryChannel channel, bool rotated) {
+    return String(TS_DIRECTORY) + "/" + SensorHistory::channelName(channel) + (rotated ? ".old.dat" : ".dat");
+}
+
+String TimeSeriesStore::indexPath(HistoryChannel channel, bool rotated) {
+    return String(TS_DIRECTORY) + "/" + SensorHistory::channelName(channel) + (rotated ? ".old.idx" : ".idx");
+}
+
+String TimeSeriesStore::getStats() {
+    String stats = "Time Series Store:\n";
+    for (int i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+        stats += String(SensorHistory::channelName((HistoryChannel)i)) + ": " +
+                 String(blockCount[i]) + " blocks, " + String(samplesWritten[i]) + " samples this boot, " +
+                 String(encoders[i].getEncodedBytes()) + "B open\n";
+    }
+    if (mounted) {
+        stats += "Flash: " + String(LittleFS.usedBytes()) + "/" + String(LittleFS.totalBytes()) + " bytes\n";
+    }
+    return stats;
+}
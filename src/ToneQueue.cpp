@@ -0,0 +1,98 @@
+/**
+ * @file ToneQueue.cpp
+ * @brief Bounded priority queue of buzzer sequences implementation
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ */
+
+#include "ToneQueue.h"
+
+ToneQueue::ToneQueue() {
+    count = 0;
+    playing = false;
+    dropped = 0;
+    current.pattern = nullptr;
+    current.length = 0;
+    current.loop = false;
+    current.priority = TONE_PRIORITY_FEEDBACK;
+    current.tag = 0;
+    current.enqueuedAt = 0;
+}
+
+ToneDecision ToneQueue::submit(const ToneRequest& request) {
+    // Higher priority preempts; a looping sound is replaced by a newer one of its priority
+    if (!playing || request.priority > current.priority ||
+        (request.priority == current.priority && current.loop)) {
+        current = request;
+        playing = true;
+        return TONE_START_NOW;
+    }
+
+    if (count == TONE_QUEUE_SIZE) {
+        // Make room by dropping the newest entry of the lowest priority, if it is lower
+        if (entries[count - 1].priority >= request.priority) {
+            dropped++;
+            return TONE_REJECTED;
+        }
+        removeAt(count - 1);
+        dropped++;
+    }
+
+    // Insert after everything of equal or higher priority
+    uint8_t position = count;
+    while (position > 0 && entries[position - 1].priority < request.priority) {
+        entries[position] = entries[position - 1];
+        position--;
+    }
+    entries[position] = request;
+    count++;
+    return TONE_QUEUED;
+}
+
+bool ToneQueue::next(uint32_t now, uint32_t maxAgeMs) {
+    playing = false;
+
+    while (count > 0) {
+        ToneRequest candidate = entries[0];
+        removeAt(0);
+
+        // A beep queued behind a long alarm is no longer meaningful
+        if (now - candidate.enqueuedAt > maxAgeMs) {
+            dropped++;
+            continue;
+        }
+
+        current = candidate;
+        playing = true;
+        return true;
+    }
+    return false;
+}
+
+bool ToneQueue::removePriority(uint8_t priority) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].priority != priority) {
+            entries[kept++] = entries[i];
+        }
+    }
+    count = kept;
+
+    if (playing && current.priority == priority) {
+        playing = false;
+        return true;
+    }
+    return false;
+}
+
+void ToneQueue::clear() {
+    count = 0;
+    playing = false;
+}
+
+void ToneQueue::removeAt(uint8_t index) {
+    for (uint8_t i = index; i + 1 < count; i++) {
+        entries[i] = entries[i + 1];
+    }
+    count--;
+}
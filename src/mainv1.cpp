@@ -20,6 +20,15 @@
 // #include "SensorManager.h"
 // #include "BuzzerController.h"
 // #include "NetworkManager.h"
+// #include "TelemetryPublisher.h"
+// #include "OtaUpdater.h"
+// #include "TimeSeriesStore.h"
+// #include "PatternLibrary.h"
+// #include "EventBus.h"
+// #include "CommandQueue.h"
+// #if ENABLE_AUDIO_ENGINE
+// #include "AudioEngine.h"
+// #endif
 
 // // Global instances
 // Logger* logger;
@@ -28,22 +37,32 @@
 // SensorManager* sensorManager;
 // BuzzerController* buzzerController;
 // NetworkManager* networkManager;
+// TelemetryPublisher* telemetryPublisher;
+// OtaUpdater* otaUpdater;
+// TimeSeriesStore* timeSeriesStore;
+// PatternLibrary* patternLibrary;
+// CommandQueue commandQueue;      // Static: a few KB that must never fail to allocate
+// #if ENABLE_AUDIO_ENGINE
+// AudioEngine* audioEngine;
+// #endif
 
 // // System state
 // bool systemInitialized = false;
-// unsigned long lastBedtimeCheck = 0;
+// int lastBedtimeReminderDay = -1;
 // unsigned long lastSystemUpdate = 0;
 
 // // Function prototypes
 // void initializeSystem();
 // void updateSystem();
-// void checkBedtimeReminder();
-// void onBuzzerControl(bool enabled);
+// void onBuzzerControl(const BuzzerEvent& event);
 // bool onPillBoxCheck();
-// void onBedtimeDetected(bool isDark);
-// void onUsbStateChanged(bool connected);
-// void onNetworkStateChanged(bool connected);
-// void onNetworkCommand(const String& command, const String& data);
+// void onBedtimeDetected(const BedtimeEvent& event);
+// void onUsbStateChanged(const UsbStateEvent& event);
+// void onNetworkStateChanged(const NetworkStateEvent& event);
+// void onPowerProfileChanged(const PowerProfileEvent& event);
+// void onSensorSample(const SensorSampleEvent& event);
+// void processCommands();
+// bool executeCommand(const CommandOp& op, int32_t* value, const char** error);
 // void printSystemStatus();
 // void handleSerialCommands();
 
@@ -76,9 +95,6 @@
 //     // Update all system components
 //     updateSystem();
     
-//     // Check bedtime reminder
-//     checkBedtimeReminder();
-    
 //     // Handle serial commands for debugging/testing
 //     handleSerialCommands();
     
@@ -109,10 +125,34 @@
 //         return;
 //     }
     
+//     // Before anything else that could crash: a new firmware on trial may be rolled back here
+//     otaUpdater = new OtaUpdater(logger);
+//     if (otaUpdater && otaUpdater->begin()) {
+//         Serial.println("✓ OTA updater initialized (" + String(otaUpdater->getRunningPartition()) +
+//                        (otaUpdater->isOnTrial() ? ", on trial)" : ")"));
+//     } else {
+//         Serial.println("✗ OTA updater initialization failed");
+//     }
+    
 //     // Initialize Buzzer Controller
 //     buzzerController = new BuzzerController(logger);
 //     if (buzzerController && buzzerController->begin()) {
 //         Serial.println("✓ Buzzer controller initialized");
+        
+//         // Uploaded patterns, usable as alarm sounds
+//         patternLibrary = new PatternLibrary(logger);
+//         if (patternLibrary->begin()) {
+//             buzzerController->setPatternLibrary(patternLibrary);
+//         }
+        
+// #if ENABLE_AUDIO_ENGINE
+//         // Sampled alarm clips; the buzzer stays available for everything else
+//         audioEngine = new AudioEngine(logger);
+//         if (!audioEngine->begin()) {
+//             delete audioEngine;
+//             audioEngine = nullptr;
+//         }
+// #endif
 //     } else {
 //         Serial.println("✗ Buzzer controller initialization failed");
 //         if (logger) logger->logError(EVENT_SYSTEM_START, "Buzzer controller init failed");
@@ -124,9 +164,15 @@
 //     if (sensorManager && sensorManager->begin()) {
 //         Serial.println("✓ Sensor manager initialized");
         
-//         // Set up sensor callbacks
-//         sensorManager->setBedtimeCallback(onBedtimeDetected);
-//         sensorManager->setUsbStateCallback(onUsbStateChanged);
+//         // Subscribe to sensor events
+//         EventBus::subscribe(onBedtimeDetected);
+//         EventBus::subscribe(onUsbStateChanged);
+        
+//         // Persist raw samples to flash
+//         timeSeriesStore = new TimeSeriesStore(logger);
+//         if (timeSeriesStore->begin()) {
+//             EventBus::subscribe(onSensorSample);
+//         }
 //     } else {
 //         Serial.println("✗ Sensor manager initialization failed");
 //         if (logger) logger->logError(EVENT_SYSTEM_START, "Sensor manager init failed");
@@ -138,8 +184,8 @@
 //     if (alarmManager && alarmManager->begin()) {
 //         Serial.println("✓ Alarm manager initialized");
         
-//         // Set up alarm callbacks
-//         alarmManager->setBuzzerCallback(onBuzzerControl);
+//         // Set up alarm events and pill box query
+//         EventBus::subscribe(onBuzzerControl);
 //         alarmManager->setPillBoxCallback(onPillBoxCheck);
 //     } else {
 //         Serial.println("✗ Alarm manager initialization failed");
@@ -152,15 +198,37 @@
 //     if (networkManager && networkManager->begin()) {
 //         Serial.println("✓ Network manager initialized");
         
-//         // Set up network callbacks
-//         networkManager->setConnectionCallback(onNetworkStateChanged);
-//         networkManager->setCommandCallback(onNetworkCommand);
+//         // Set up network events and commands
+//         EventBus::subscribe(onNetworkStateChanged);
+//         networkManager->setCommandQueue(&commandQueue);
+//         networkManager->setPatternLibrary(patternLibrary);
+//         networkManager->setAlarmManager(alarmManager);
+//         networkManager->setSensorManager(sensorManager);
+//         networkManager->setOtaUpdater(otaUpdater);
+        
+//         // Live status starts from the current state; events keep it up to date
+//         SensorReadings readings = sensorManager->getCurrentReadings();
+//         networkManager->updateLiveStatus(LIVE_ALARM_STATE, alarmManager->getState());
+//         networkManager->updateLiveStatus(LIVE_PILL_BOX, readings.pillBoxOpen);
+//         networkManager->updateLiveStatus(LIVE_USB, readings.usbConnected);
+//         networkManager->updateLiveStatus(LIVE_LIGHT, readings.lightLevel);
+        
+//         // Degrade radio and logging as the battery runs down
+//         EventBus::subscribe(onPowerProfileChanged);
 //     } else {
 //         Serial.println("✗ Network manager initialization failed");
 //         if (logger) logger->logError(EVENT_SYSTEM_START, "Network manager init failed");
 //         return;
 //     }
     
+//     // Telemetry is optional: without it the alarm works the same
+//     telemetryPublisher = new TelemetryPublisher(logger, networkManager, sensorManager);
+//     if (telemetryPublisher && telemetryPublisher->begin()) {
+//         Serial.println("✓ Telemetry publisher initialized");
+//     } else {
+//         Serial.println("✗ Telemetry publisher initialization failed");
+//     }
+    
 //     systemInitialized = true;
 //     Serial.println("\n🎉 All systems initialized successfully!");
     
@@ -190,48 +258,49 @@
     
 //     // Lower priority updates
 //     if (networkManager) networkManager->update();
+//     if (telemetryPublisher) telemetryPublisher->update();
     
-//     // Watchdog reset (ESP32 has hardware watchdog that we need to feed)
-//     yield();
-// }
-
-// void checkBedtimeReminder() {
-//     unsigned long currentTime = millis();
+//     // Commands from the web server and other tasks run here, between component updates
+//     processCommands();
     
-//     // Check bedtime reminder every minute
-//     if (currentTime - lastBedtimeCheck >= BEDTIME_CHECK_INTERVAL_MS) {
-//         if (rtc && sensorManager) {
-//             struct tm timeinfo;
-//             if (getLocalTime(&timeinfo)) {
-//                 // Check if it's bedtime hour and environment is dark
-//                 if (timeinfo.tm_hour == BEDTIME_REMINDER_HOUR && 
-//                     timeinfo.tm_min == BEDTIME_REMINDER_MINUTE &&
-//                     sensorManager->isDarkEnvironment()) {
-                    
-//                     // Trigger bedtime reminder
-//                     if (buzzerController) {
-//                         buzzerController->playPattern(PATTERN_NOTIFICATION);
-//                     }
-                    
-//                     if (logger) {
-//                         logger->logInfo(EVENT_BEDTIME_REMINDER, "Bedtime reminder triggered",
-//                                        "Light level: " + String(sensorManager->getLightLevel()));
-//                     }
-//                 }
-//             }
-//         }
-        
-//         lastBedtimeCheck = currentTime;
+//     // A new firmware counts as healthy once the network is back up
+//     if (otaUpdater) {
+//         otaUpdater->update(currentTime, networkManager && (networkManager->isConnected() ||
+//                                                            networkManager->getState() == NETWORK_AP_MODE));
 //     }
+    
+//     // Deliver events posted during this pass
+//     EventBus::dispatchPending();
+    
+//     // Watchdog reset (ESP32 has hardware watchdog that we need to feed)
+//     yield();
 // }
 
 // // Callback functions
-// void onBuzzerControl(bool enabled) {
+// void onBuzzerControl(const BuzzerEvent& event) {
 //     if (buzzerController) {
-//         if (enabled) {
-//             buzzerController->playPattern(PATTERN_ALARM);
+//         if (event.active) {
+//             // Each alarm can have its own sound; unknown names fall back to the default
+//             Alarm* alarm = alarmManager ? alarmManager->getAlarm(event.alarmId) : nullptr;
+//             String sound = alarm ? alarm->sound : "";
+//             RampProfile ramp = alarm ? alarm->ramp() : RampProfile{0, 255, RAMP_NONE};
+// #if ENABLE_AUDIO_ENGINE
+//             // A sound naming a clip plays through the audio engine instead of the buzzer
+//             if (audioEngine && audioEngine->hasClip(sound)) {
+//                 audioEngine->stop();
+//                 if (audioEngine->play(sound, true, &ramp)) {
+//                     return;
+//                 }
+//             }
+// #endif
+//             if (!buzzerController->playSound(sound, TONE_PRIORITY_ALARM, true, &ramp)) {
+//                 buzzerController->playPattern(PATTERN_ALARM);
+//             }
 //         } else {
-//             buzzerController->stopPattern();
+// #if ENABLE_AUDIO_ENGINE
+//             if (audioEngine) audioEngine->stop();
+// #endif
+//             buzzerController->stopPriority(TONE_PRIORITY_ALARM);
 //         }
 //     }
 // }
@@ -240,13 +309,38 @@
 //     return sensorManager ? sensorManager->isPillBoxOpen() : false;
 // }
 
-// void onBedtimeDetected(bool isDark) {
-//     if (isDark && logger) {
-//         logger->logInfo(EVENT_BEDTIME_REMINDER, "Dark environment detected");
+// void onBedtimeDetected(const BedtimeEvent& event) {
+//     // Remind once per night when the lights go out around bedtime
+//     if (!event.dark || event.confidence < LIGHT_TREND_MIN_CONFIDENCE) {
+//         return;
+//     }
+    
+//     struct tm timeinfo;
+//     if (!getLocalTime(&timeinfo, 0)) {
+//         return;
+//     }
+    
+//     int minutesNow = timeinfo.tm_hour * 60 + timeinfo.tm_min;
+//     int minutesBedtime = BEDTIME_REMINDER_HOUR * 60 + BEDTIME_REMINDER_MINUTE;
+//     int distance = abs(minutesNow - minutesBedtime);
+//     if (distance > 12 * 60) distance = 24 * 60 - distance;
+    
+//     if (distance <= BEDTIME_WINDOW_HOURS * 60 && timeinfo.tm_yday != lastBedtimeReminderDay) {
+//         lastBedtimeReminderDay = timeinfo.tm_yday;
+        
+//         if (buzzerController) {
+//             buzzerController->playPattern(PATTERN_NOTIFICATION);
+//         }
+        
+//         if (logger) {
+//             logger->logInfo(EVENT_BEDTIME_REMINDER, "Bedtime reminder triggered",
+//                            "Lights out, confidence: " + String(event.confidence) + "%");
+//         }
 //     }
 // }
 
-// void onUsbStateChanged(bool connected) {
+// void onUsbStateChanged(const UsbStateEvent& event) {
+//     bool connected = event.connected;
 //     if (logger) {
 //         logger->logInfo(connected ? EVENT_USB_CONNECTED : EVENT_USB_DISCONNECTED,
 //                        connected ? "Phone charging started" : "Phone charging stopped");
@@ -258,12 +352,9 @@
 //     }
 // }
 
-// void onNetworkStateChanged(bool connected) {
-//     if (connected) {
-//         // Network connected - sync time
-//         if (networkManager) {
-//             networkManager->syncTime();
-//         }
+// void onNetworkStateChanged(const NetworkStateEvent& event) {
+//     if (event.connected) {
+//         // Time sync runs inside NetworkManager on its own schedule
         
 //         // Play success sound
 //         if (buzzerController) {
@@ -277,33 +368,106 @@
 //     }
 // }
 
-// void onNetworkCommand(const String& command, const String& data) {
-//     if (command == "SETALARM") {
-//         // Parse alarm data: "SETALARM:hour:minute:days:label"
-//         int firstColon = data.indexOf(':', 9); // Skip "SETALARM:"
-//         int secondColon = data.indexOf(':', firstColon + 1);
-//         int thirdColon = data.indexOf(':', secondColon + 1);
-//         int fourthColon = data.indexOf(':', thirdColon + 1);
-        
-//         if (firstColon > 0 && secondColon > 0 && thirdColon > 0) {
-//             int hour = data.substring(firstColon + 1, secondColon).toInt();
-//             int minute = data.substring(secondColon + 1, thirdColon).toInt();
-//             String days = data.substring(thirdColon + 1, fourthColon > 0 ? fourthColon : data.length());
-//             String label = fourthColon > 0 ? data.substring(fourthColon + 1) : "";
-            
-//             if (alarmManager) {
-//                 uint8_t dayMask = AlarmManager::stringToDayMask(days);
-//                 if (alarmManager->addAlarm(hour, minute, dayMask, label)) {
-//                     if (logger) {
-//                         logger->logInfo(EVENT_ALARM_SET, "Alarm added via network",
-//                                        "Time: " + String(hour) + ":" + String(minute) +
-//                                        ", Days: " + days + ", Label: " + label);
-//                     }
-//                 }
+// void onPowerProfileChanged(const PowerProfileEvent& event) {
+//     if (logger) logger->setMinLevel((LogLevel)event.profile.minLogLevel);
+//     if (networkManager) networkManager->applyPowerProfile(event.profile);
+// }
+
+// void onSensorSample(const SensorSampleEvent& event) {
+//     timeSeriesStore->append(event.channel, event.timestamp, event.value);
+// }
+
+// // Runs queued commands; each stops at its first failed operation
+// void processCommands() {
+//     Command command;
+//     uint32_t ticket;
+//     while (commandQueue.pop(&command, &ticket)) {
+//         CommandResult result = {};
+//         result.status = COMMAND_DONE;
+//         for (uint8_t i = 0; i < command.count; i++) {
+//             result.values[i] = -1;
+//         }
+//         while (result.completed < command.count) {
+//             if (!executeCommand(command.ops[result.completed], &result.values[result.completed], &result.error)) {
+//                 result.status = COMMAND_FAILED;
+//                 break;
 //             }
+//             result.completed++;
 //         }
+//         commandQueue.complete(ticket, result);
 //     }
-//     // Add more network commands as needed
+// }
+
+// bool executeCommand(const CommandOp& op, int32_t* value, const char** error) {
+//     switch (op.type) {
+//         case CMD_ADD_ALARM:
+//         case CMD_UPDATE_ALARM:
+//         case CMD_DELETE_ALARM: {
+//             if (!alarmManager) {
+//                 *error = "Alarms not available";
+//                 return false;
+//             }
+//             if (op.type == CMD_DELETE_ALARM) {
+//                 *error = "Alarm not found";
+//                 return alarmManager->removeAlarm(op.alarm.id);
+//             }
+//             if (op.type == CMD_UPDATE_ALARM) {
+//                 Alarm alarm;
+//                 alarm.hour = op.alarm.hour;
+//                 alarm.minute = op.alarm.minute;
+//                 alarm.dayMask = op.alarm.dayMask;
+//                 alarm.enabled = op.alarm.enabled;
+//                 alarm.label = op.alarm.label;
+//                 alarm.sound = op.alarm.sound;
+//                 alarm.rampSeconds = op.alarm.rampSeconds;
+//                 alarm.rampShape = op.alarm.rampShape;
+//                 *error = "Alarm not found";
+//                 return alarmManager->updateAlarm(op.alarm.id, alarm);
+//             }
+//             if (!alarmManager->addAlarm(op.alarm.hour, op.alarm.minute, op.alarm.dayMask, op.alarm.label,
+//                                         op.alarm.sound, op.alarm.rampSeconds, op.alarm.rampShape)) {
+//                 *error = "Alarm limit reached";
+//                 return false;
+//             }
+//             // New alarms go last; the caller gets the id it can update or delete later
+//             AlarmTable table;
+//             alarmManager->readAlarmTable(&table);
+//             *value = table.count > 0 ? table.alarms[table.count - 1].id : -1;
+//             return true;
+//         }
+//         case CMD_SET_WIFI:
+//             if (!networkManager->connectWiFi(op.wifi.ssid, op.wifi.password)) {
+//                 *error = "WiFi connection failed";
+//                 return false;
+//             }
+//             return true;
+//         case CMD_CLEAR_LOGS:
+//             if (logger) logger->clearLogs();
+//             return true;
+//         case CMD_SET_LOG_LEVEL:
+//             if (logger) logger->setMinLevel((LogLevel)op.logLevel);
+//             return true;
+//         case CMD_SET_QUIET_WINDOW:
+//             networkManager->setQuietWindow(op.quiet.startMinute, op.quiet.endMinute);
+//             return true;
+//         case CMD_OTA_RESTART:
+//             if (otaUpdater) otaUpdater->restartIntoUpdate(millis());
+//             return true;
+//         case CMD_STORE_PATTERN:
+//             if (!patternLibrary || !patternLibrary->store(op.pattern.name, op.pattern.code, op.pattern.length)) {
+//                 *error = "Pattern could not be stored";
+//                 return false;
+//             }
+//             return true;
+//         case CMD_DELETE_PATTERN:
+//             if (!patternLibrary || !patternLibrary->remove(op.pattern.name)) {
+//                 *error = "Pattern not found";
+//                 return false;
+//             }
+//             return true;
+//     }
+//     *error = "Unknown command";
+//     return false;
 // }
 
 // void printSystemStatus() {
@@ -320,8 +484,14 @@
 //         Serial.println("Network: " + networkManager->getNetworkInfo());
 //     }
     
+//     if (telemetryPublisher) {
+//         Serial.print(telemetryPublisher->getStats());
+//     }
+    
 //     if (sensorManager) {
 //         Serial.println(sensorManager->getSensorStatus());
+//         Serial.println(sensorManager->getSamplingStats());
+//         Serial.println(sensorManager->getSleepStats());
 //     }
     
 //     if (alarmManager) {
@@ -0,0 +1,212 @@
+/**
+ * @file audio_bench.cpp
+ * @brief Host check and benchmark for ClipDecoder and AudioMixer
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Encodes a synthetic clip (chirp plus a chime) as PCM and IMA ADPCM, decodes
+ * both through ClipDecoder from an in-memory reader and checks the signal to
+ * noise ratio. Then times decoding, mixing and rendering of
+ * AUDIO_MAX_VOICES ADPCM voices into DMA frames, the work AudioEngine does per
+ * buffer, and reports it as a share of one core at AUDIO_SAMPLE_RATE. On the
+ * device AudioEngine::getLoadPermille() reports the same measurement.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Iinclude tools/audio_bench.cpp src/ClipDecoder.cpp \
+ *       src/AudioMixer.cpp -o audio_bench
+ *   ./audio_bench [seconds_of_audio]
+ *
+ * Exits non-zero if decoding is wrong or the host cannot keep real time.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "ClipDecoder.h"
+#include "AudioMixer.h"
+
+static const int16_t stepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+static const int8_t indexTable[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+// Host-side IMA encoder, same block layout as tools/make_clip.py
+static uint8_t encodeSample(int32_t sample, int32_t* predictor, int32_t* index) {
+    int32_t step = stepTable[*index];
+    int32_t diff = sample - *predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { code |= 4; diff -= step; }
+    if (diff >= step >> 1) { code |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) { code |= 1; }
+
+    // Track the decoder's reconstruction, not the input, so errors do not build up
+    int32_t delta = step >> 3;
+    if (code & 4) delta += step;
+    if (code & 2) delta += step >> 1;
+    if (code & 1) delta += step >> 2;
+    *predictor += (code & 8) ? -delta : delta;
+    if (*predictor > 32767) *predictor = 32767;
+    if (*predictor < -32768) *predictor = -32768;
+    *index += indexTable[code];
+    if (*index < 0) *index = 0;
+    if (*index > 88) *index = 88;
+    return code;
+}
+
+static void putHeader(std::vector<uint8_t>& out, uint8_t format, uint32_t samples) {
+    const uint8_t header[CLIP_HEADER_BYTES] = {
+        'N', 'B', 'A', CLIP_FORMAT_VERSION, format, 0,
+        (uint8_t)(AUDIO_SAMPLE_RATE & 0xFF), (uint8_t)(AUDIO_SAMPLE_RATE >> 8),
+        (uint8_t)samples, (uint8_t)(samples >> 8), (uint8_t)(samples >> 16), (uint8_t)(samples >> 24)
+    };
+    out.insert(out.end(), header, header + CLIP_HEADER_BYTES);
+}
+
+static std::vector<uint8_t> encodeAdpcm(const std::vector<int16_t>& pcm) {
+    std::vector<uint8_t> out;
+    putHeader(out, CLIP_IMA_ADPCM, (uint32_t)pcm.size());
+    int32_t predictor = 0;
+    int32_t index = 0;
+    for (size_t start = 0; start < pcm.size(); start += CLIP_ADPCM_BLOCK_SAMPLES) {
+        out.push_back((uint8_t)(predictor & 0xFF));
+        out.push_back((uint8_t)((predictor >> 8) & 0xFF));
+        out.push_back((uint8_t)index);
+        out.push_back(0);
+        size_t end = start + CLIP_ADPCM_BLOCK_SAMPLES < pcm.size() ? start + CLIP_ADPCM_BLOCK_SAMPLES : pcm.size();
+        for (size_t i = start; i < end; i += 2) {
+            uint8_t low = encodeSample(pcm[i], &predictor, &index);
+            uint8_t high = i + 1 < end ? encodeSample(pcm[i + 1], &predictor, &index) : 0;
+            out.push_back((uint8_t)(low | (high << 4)));
+        }
+    }
+    return out;
+}
+
+static std::vector<uint8_t> encodePcm(const std::vector<int16_t>& pcm) {
+    std::vector<uint8_t> out;
+    putHeader(out, CLIP_PCM_U8, (uint32_t)pcm.size());
+    for (int16_t sample : pcm) {
+        out.push_back((uint8_t)((sample >> 8) + 128));
+    }
+    return out;
+}
+
+struct MemoryReader {
+    const std::vector<uint8_t>* data;
+    size_t position;
+};
+
+static size_t readMemory(void* context, uint8_t* buffer, size_t length) {
+    MemoryReader* reader = static_cast<MemoryReader*>(context);
+    size_t available = reader->data->size() - reader->position;
+    if (length > available) length = available;
+    memcpy(buffer, reader->data->data() + reader->position, length);
+    reader->position += length;
+    return length;
+}
+
+static double snrDb(const std::vector<int16_t>& reference, const std::vector<uint8_t>& clip) {
+    MemoryReader reader = {&clip, 0};
+    ClipDecoder decoder;
+    if (!decoder.begin(readMemory, &reader)) {
+        return -1;
+    }
+
+    std::vector<int16_t> decoded(reference.size() + 16);
+    size_t total = 0;
+    uint16_t got;
+    while ((got = decoder.read(decoded.data() + total, 100)) > 0) {
+        total += got;
+    }
+    if (total != reference.size() || !decoder.finished()) {
+        printf("  decoded %zu samples, expected %zu\n", total, reference.size());
+        return -1;
+    }
+
+    double signal = 0;
+    double noise = 0;
+    for (size_t i = 0; i < total; i++) {
+        double error = (double)decoded[i] - reference[i];
+        signal += (double)reference[i] * reference[i];
+        noise += error * error;
+    }
+    return 10 * log10(signal / (noise > 0 ? noise : 1));
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 600;
+    bool ok = true;
+
+    // Two-second test clip: 300 Hz -> 3 kHz chirp, then a decaying 880 Hz chime
+    std::vector<int16_t> pcm(2 * AUDIO_SAMPLE_RATE + 123);
+    double phase = 0;
+    for (size_t i = 0; i < pcm.size(); i++) {
+        double t = (double)i / AUDIO_SAMPLE_RATE;
+        double frequency = t < 1 ? 300 + 2700 * t : 880;
+        double envelope = t < 1 ? 0.8 : 0.8 * exp(-3 * (t - 1));
+        phase += 2 * M_PI * frequency / AUDIO_SAMPLE_RATE;
+        pcm[i] = (int16_t)(32767 * envelope * sin(phase));
+    }
+
+    std::vector<uint8_t> adpcm = encodeAdpcm(pcm);
+    std::vector<uint8_t> pcm8 = encodePcm(pcm);
+    double adpcmSnr = snrDb(pcm, adpcm);
+    double pcmSnr = snrDb(pcm, pcm8);
+    printf("decode         ADPCM %zu bytes, SNR %.1f dB; PCM8 %zu bytes, SNR %.1f dB\n",
+           adpcm.size(), adpcmSnr, pcm8.size(), pcmSnr);
+    ok &= adpcmSnr > 20 && pcmSnr > 30;
+
+    // Mixer: a full-level voice and a ramping one, rendered as DAC frames
+    static uint16_t frames[AUDIO_DMA_FRAMES * 2];
+    AudioMixer mixer;
+    MemoryReader readers[AUDIO_MAX_VOICES];
+    ClipDecoder decoders[AUDIO_MAX_VOICES];
+    for (uint8_t v = 0; v < AUDIO_MAX_VOICES; v++) {
+        readers[v].data = &adpcm;
+        readers[v].position = 0;
+        decoders[v].begin(readMemory, &readers[v]);
+        mixer.attach(&decoders[v], v == 0 ? 255 : 0);
+    }
+
+    uint64_t buffers = (uint64_t)(seconds * AUDIO_SAMPLE_RATE / AUDIO_DMA_FRAMES);
+    uint32_t checksum = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (uint64_t b = 0; b < buffers; b++) {
+        for (uint8_t v = 0; v < AUDIO_MAX_VOICES; v++) {
+            if (mixer.isFinished(v)) {
+                readers[v].position = 0;
+                decoders[v].begin(readMemory, &readers[v]);
+            }
+        }
+        mixer.setLevel(1, (uint8_t)(b & 0xFF));
+        mixer.render(frames, AUDIO_DMA_FRAMES, AUDIO_OUTPUT_DAC);
+        checksum += frames[b % AUDIO_DMA_FRAMES];
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    double frameCount = (double)buffers * AUDIO_DMA_FRAMES;
+    double nsPerFrame = elapsed * 1e9 / frameCount;
+    double load = nsPerFrame * AUDIO_SAMPLE_RATE / 1e7;    // Percent of one core
+    printf("mix            %u voices, %.0f s of audio in %.3f s: %.1f ns/frame, %.3f%% of a host core at %u Hz"
+           " (checksum %u)\n", AUDIO_MAX_VOICES, (double)buffers * AUDIO_DMA_FRAMES / AUDIO_SAMPLE_RATE,
+           elapsed, nsPerFrame, load, AUDIO_SAMPLE_RATE, checksum);
+    printf("               5%% of a 240 MHz ESP32 at %u Hz is %u cycles per frame\n", AUDIO_SAMPLE_RATE,
+           240000000u / 20 / AUDIO_SAMPLE_RATE);
+    ok &= load < 100;
+
+    printf("%s\n", ok ? "All checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
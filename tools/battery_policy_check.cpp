@@ -0,0 +1,272 @@
+/**
+ * @file battery_policy_check.cpp
+ * @brief Host checks for BatteryPolicy levels and power profiles
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Uses the thresholds from config.h, as SensorManager does, and checks
+ * that:
+ *   - a battery level applies only after BATTERY_CONFIRM_SAMPLES steady
+ *     readings agree, and a lower level the same way; rising levels need
+ *     the hysteresis margin, so a voltage wandering around a threshold
+ *     does not flap between levels;
+ *   - each level selects its power profile, and every change of level is
+ *     reported exactly once;
+ *   - a battery running down (normal, low, critical), then charging back
+ *     up, recovers through low to normal, and pulling it out falls back
+ *     to external power;
+ *   - a sense pin with no divider behind it (out of range, jumping, or
+ *     ADC noise through the same filter as BatteryMonitor) is external
+ *     power and never switches the radio off.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -Iinclude tools/battery_policy_check.cpp src/BatteryPolicy.cpp \
+ *       -o battery_policy_check
+ *   ./battery_policy_check
+ *
+ * Exits non-zero if any check failed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "BatteryPolicy.h"
+
+static const uint16_t LOW_MV = LOW_BATTERY_THRESHOLD * 1000;
+static const uint16_t CRITICAL_MV = CRITICAL_BATTERY_THRESHOLD * 1000;
+static const uint16_t HYSTERESIS_MV = BATTERY_HYSTERESIS * 1000;
+static const uint16_t PRESENT_MV = BATTERY_PRESENT_THRESHOLD * 1000;
+static const uint16_t MAX_MV = BATTERY_MAX_PLAUSIBLE * 1000;
+static const uint16_t STEP_MV = BATTERY_MAX_STEP * 1000;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what, uint16_t millivolts) {
+    if (!condition) {
+        printf("  FAIL %s (%u mV)\n", what, millivolts);
+        failures++;
+    }
+}
+
+static BatteryPolicy makePolicy() {
+    return BatteryPolicy(LOW_MV, CRITICAL_MV, HYSTERESIS_MV, PRESENT_MV, MAX_MV, STEP_MV, BATTERY_CONFIRM_SAMPLES);
+}
+
+// Feeds one reading and checks the level it leaves and whether a change was reported
+static void expect(BatteryPolicy& policy, uint16_t millivolts, BatteryLevel level, bool changed, const char* what) {
+    bool reported = policy.update(millivolts);
+    if (policy.getLevel() != level || reported != changed) {
+        printf("  FAIL %s (%u mV): %s%s, expected %s%s\n", what, millivolts,
+               BatteryPolicy::levelName(policy.getLevel()), reported ? " (changed)" : "",
+               BatteryPolicy::levelName(level), changed ? " (changed)" : "");
+        failures++;
+    }
+}
+
+// A change that needs confirming: the level holds until the last of BATTERY_CONFIRM_SAMPLES readings
+static void confirmed(BatteryPolicy& policy, uint16_t millivolts, BatteryLevel level, const char* what) {
+    BatteryLevel before = policy.getLevel();
+    for (int i = 1; i < BATTERY_CONFIRM_SAMPLES; i++) {
+        expect(policy, millivolts, before, false, what);
+    }
+    expect(policy, millivolts, level, true, what);
+}
+
+// A battery that has been steady at millivolts for a while (critical is confirmed after low)
+static BatteryPolicy settled(uint16_t millivolts) {
+    BatteryPolicy policy = makePolicy();
+    policy.update(millivolts);
+    for (int i = 0; i < 2 * BATTERY_CONFIRM_SAMPLES; i++) {
+        policy.update(millivolts);
+    }
+    return policy;
+}
+
+static void checkHysteresis() {
+    printf("Hysteresis and confirmation\n");
+    BatteryPolicy policy = makePolicy();
+    check(policy.getLevel() == BATTERY_EXTERNAL, "starts on external power", 0);
+
+    expect(policy, LOW_MV + 100, BATTERY_EXTERNAL, false, "first reading has nothing to compare with");
+    confirmed(policy, LOW_MV + 100, BATTERY_NORMAL, "battery found");
+    expect(policy, LOW_MV, BATTERY_NORMAL, false, "at the low threshold");
+    confirmed(policy, LOW_MV - 1, BATTERY_LOW, "below low, confirmed");
+
+    // Around the threshold, inside the margin: stays low
+    for (uint16_t mv = LOW_MV - 10; mv < LOW_MV + HYSTERESIS_MV; mv += 5) {
+        expect(policy, mv, BATTERY_LOW, false, "low inside the margin");
+    }
+    expect(policy, LOW_MV + HYSTERESIS_MV, BATTERY_NORMAL, true, "low past the margin, at once");
+
+    // The same around the critical threshold, reached in steady steps
+    expect(policy, LOW_MV, BATTERY_NORMAL, false, "normal down to the low threshold");
+    expect(policy, LOW_MV - 60, BATTERY_NORMAL, false, "one reading below low is not enough");
+    for (int i = 2; i < BATTERY_CONFIRM_SAMPLES; i++) {
+        expect(policy, CRITICAL_MV - 1, BATTERY_NORMAL, false, "low and critical readings pending");
+    }
+    expect(policy, CRITICAL_MV - 1, BATTERY_LOW, true, "low and critical readings settle on low");
+    confirmed(policy, CRITICAL_MV - 1, BATTERY_CRITICAL, "below critical, confirmed");
+    for (uint16_t mv = CRITICAL_MV - 10; mv < CRITICAL_MV + HYSTERESIS_MV; mv += 5) {
+        expect(policy, mv, BATTERY_CRITICAL, false, "critical inside the margin");
+    }
+    expect(policy, CRITICAL_MV + HYSTERESIS_MV, BATTERY_LOW, true, "critical past the margin, at once");
+    confirmed(policy, CRITICAL_MV - 1, BATTERY_CRITICAL, "low below critical, confirmed");
+    expect(policy, CRITICAL_MV + 10, BATTERY_CRITICAL, false, "critical just above the threshold");
+    expect(policy, CRITICAL_MV + 10 + STEP_MV - 5, BATTERY_LOW, true, "critical up to low");
+    expect(policy, LOW_MV + HYSTERESIS_MV, BATTERY_NORMAL, true, "low up to normal");
+
+    // A noisy reading flapping across a threshold never confirms the lower level
+    BatteryPolicy noisy = settled(LOW_MV + 15);
+    int changes = 0;
+    for (int i = 0; i < 100; i++) {
+        uint16_t mv = (i % 2) ? LOW_MV - 15 : LOW_MV + 15;
+        changes += noisy.update(mv) ? 1 : 0;
+    }
+    check(changes == 0 && noisy.getLevel() == BATTERY_NORMAL, "noise around low not confirmed", LOW_MV);
+}
+
+static void checkProfiles() {
+    printf("Profiles\n");
+    PowerProfile external = BatteryPolicy::profileFor(BATTERY_EXTERNAL);
+    PowerProfile normal = BatteryPolicy::profileFor(BATTERY_NORMAL);
+    PowerProfile low = BatteryPolicy::profileFor(BATTERY_LOW);
+    PowerProfile critical = BatteryPolicy::profileFor(BATTERY_CRITICAL);
+
+    check(external.samplingSlowdown == 1 && external.radioEnabled && !external.radioPowerSave,
+          "external runs at full rate", 0);
+    check(normal.samplingSlowdown == 1 && normal.radioEnabled && !normal.radioPowerSave,
+          "normal runs at full rate", 0);
+    check(low.samplingSlowdown > normal.samplingSlowdown && low.radioEnabled && low.radioPowerSave,
+          "low samples slower and sleeps the modem", 0);
+    check(critical.samplingSlowdown > low.samplingSlowdown && !critical.radioEnabled,
+          "critical samples slowest with the radio off", 0);
+    check(normal.minLogLevel <= low.minLogLevel && low.minLogLevel <= critical.minLogLevel,
+          "logging only narrows as the battery drains", 0);
+
+    // getProfile() follows the level as it changes
+    BatteryPolicy policy = makePolicy();
+    const uint16_t readings[] = {LOW_MV + 80, LOW_MV - 1, CRITICAL_MV - 1, CRITICAL_MV + HYSTERESIS_MV,
+                                 LOW_MV + HYSTERESIS_MV, 0};
+    for (size_t i = 0; i < sizeof(readings) / sizeof(readings[0]); i++) {
+        for (int j = 0; j <= BATTERY_CONFIRM_SAMPLES; j++) {
+            policy.update(readings[i]);
+        }
+        PowerProfile profile = policy.getProfile();
+        PowerProfile expected = BatteryPolicy::profileFor(policy.getLevel());
+        check(profile.level == policy.getLevel() && profile.samplingSlowdown == expected.samplingSlowdown &&
+              profile.radioEnabled == expected.radioEnabled && profile.radioPowerSave == expected.radioPowerSave &&
+              profile.minLogLevel == expected.minLogLevel, "profile matches the level", readings[i]);
+    }
+
+    for (int level = BATTERY_EXTERNAL; level <= BATTERY_CRITICAL; level++) {
+        check(BatteryPolicy::levelName((BatteryLevel)level)[0] != 'U', "every level has a name", level);
+    }
+}
+
+static void checkDischargeAndCharge() {
+    printf("Discharge, charge, unplug\n");
+    BatteryPolicy policy = settled(4100);
+    BatteryLevel levels[4];
+    uint16_t at[4];
+    int changes = 0;
+
+    // Runs down 5 mV per reading, then charges back 5 mV per reading
+    uint16_t mv = 4100;
+    for (; mv > CRITICAL_MV - 100; mv -= 5) {
+        if (policy.update(mv) && changes < 4) {
+            at[changes] = mv;
+            levels[changes++] = policy.getLevel();
+        }
+    }
+    check(changes == 2 && levels[0] == BATTERY_LOW && levels[1] == BATTERY_CRITICAL,
+          "discharge goes low, then critical", mv);
+    check(changes == 2 && at[0] < LOW_MV && at[0] >= LOW_MV - 5 * BATTERY_CONFIRM_SAMPLES,
+          "low once confirmed below the threshold", changes > 0 ? at[0] : 0);
+    check(!policy.getProfile().radioEnabled, "radio off when critical", mv);
+
+    changes = 0;
+    uint16_t recoveredLow = 0;
+    uint16_t recoveredNormal = 0;
+    for (; mv <= 4200; mv += 5) {
+        if (policy.update(mv)) {
+            changes++;
+            if (policy.getLevel() == BATTERY_LOW) recoveredLow = mv;
+            if (policy.getLevel() == BATTERY_NORMAL) recoveredNormal = mv;
+        }
+    }
+    check(changes == 2, "charging changes the level twice", mv);
+    check(recoveredLow >= CRITICAL_MV + HYSTERESIS_MV && recoveredLow < CRITICAL_MV + HYSTERESIS_MV + 5,
+          "back to low once past critical plus the margin", recoveredLow);
+    check(recoveredNormal >= LOW_MV + HYSTERESIS_MV && recoveredNormal < LOW_MV + HYSTERESIS_MV + 5,
+          "back to normal once past low plus the margin", recoveredNormal);
+    check(policy.getProfile().radioEnabled && policy.getProfile().samplingSlowdown == 1, "full profile recovered", mv);
+
+    // Battery pulled: the divider reads near zero
+    expect(policy, 40, BATTERY_EXTERNAL, true, "battery removed");
+    expect(policy, PRESENT_MV - 1, BATTERY_EXTERNAL, false, "below the presence threshold");
+
+    // A flat one fitted: the jump is not a cell yet, steady readings find it as low, then confirm critical
+    expect(policy, CRITICAL_MV - 1, BATTERY_EXTERNAL, false, "jump on fitting");
+    confirmed(policy, CRITICAL_MV - 1, BATTERY_LOW, "flat battery found");
+    check(policy.getProfile().radioEnabled, "radio stays on when a battery is found", CRITICAL_MV - 1);
+    confirmed(policy, CRITICAL_MV - 1, BATTERY_CRITICAL, "flat battery confirmed");
+}
+
+static void checkFloatingPin() {
+    printf("No battery fitted\n");
+
+    // Out of range either way, however steady
+    BatteryPolicy high = makePolicy();
+    BatteryPolicy low = makePolicy();
+    for (int i = 0; i < 100; i++) {
+        high.update(MAX_MV + 200);
+        low.update(PRESENT_MV - 300);
+    }
+    check(high.getLevel() == BATTERY_EXTERNAL, "above a cell's voltage is external", MAX_MV + 200);
+    check(low.getLevel() == BATTERY_EXTERNAL, "below a cell's voltage is external", PRESENT_MV - 300);
+
+    // Jumping between critical and normal readings: never a battery
+    BatteryPolicy jumping = makePolicy();
+    for (int i = 0; i < 100; i++) {
+        jumping.update((i % 2) ? CRITICAL_MV - 100 : LOW_MV + 200);
+        check(jumping.getLevel() == BATTERY_EXTERNAL, "jumping readings stay external", CRITICAL_MV - 100);
+    }
+
+    // A battery that starts jumping drops to external (radio back on) at once
+    BatteryPolicy failing = settled(CRITICAL_MV - 50);
+    check(failing.getLevel() == BATTERY_CRITICAL, "settled critical", CRITICAL_MV - 50);
+    expect(failing, CRITICAL_MV - 50 + STEP_MV + 1, BATTERY_EXTERNAL, true, "jump back to external");
+
+    // ADC noise on an open pin, through the same EWMA (alpha 1/4) as BatteryMonitor; pin up to 3.3 V
+    srand(7);
+    BatteryPolicy open = makePolicy();
+    uint32_t filtered = 0;
+    int radioCuts = 0;
+    int batteryLevels = 0;
+    const int readings = 100000;
+    for (int i = 0; i < readings; i++) {
+        uint32_t pin = rand() % 3300;
+        filtered = i == 0 ? pin * 16 : (filtered * 3 + pin * 16) / 4;
+        open.update((uint16_t)((filtered * BATTERY_DIVIDER_RATIO + 8) / 16));
+        if (!open.getProfile().radioEnabled) radioCuts++;
+        if (open.getLevel() != BATTERY_EXTERNAL) batteryLevels++;
+    }
+    printf("  open pin: %d of %d readings taken for a battery\n", batteryLevels, readings);
+    check(radioCuts == 0, "open pin never cuts the radio", 0);
+}
+
+int main() {
+    printf("Thresholds: low %u mV, critical %u mV, hysteresis %u mV, present %u-%u mV, step %u mV, confirm %d\n",
+           LOW_MV, CRITICAL_MV, HYSTERESIS_MV, PRESENT_MV, MAX_MV, STEP_MV, BATTERY_CONFIRM_SAMPLES);
+    checkHysteresis();
+    checkProfiles();
+    checkDischargeAndCharge();
+    checkFloatingPin();
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
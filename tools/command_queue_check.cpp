@@ -0,0 +1,195 @@
+/**
+ * @file command_queue_check.cpp
+ * @brief Host checks for CommandQueue under concurrent producers
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Four producer threads push commands of one to COMMAND_MAX_OPS
+ * operations as fast as they can, retrying when the queue is full, while
+ * one consumer thread pops them, as the main loop does, and completes each
+ * with a result derived from its contents. Producers poll the results of
+ * their own tickets. Checks that:
+ *   - every command arrives exactly once, whole, and in the order its
+ *     producer pushed it;
+ *   - tickets are unique and match what pop() reports;
+ *   - a result read back belongs to that ticket (never a torn or reused
+ *     slot), and a ticket reads PENDING until it completes;
+ *   - a full queue rejects instead of blocking.
+ * Build with -fsanitize=thread: results are copied through atomic words,
+ * so ThreadSanitizer should stay silent; any report is a bug.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -pthread -fsanitize=thread -Iinclude tools/command_queue_check.cpp \
+ *       src/CommandQueue.cpp -o command_queue_check
+ *   ./command_queue_check
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "CommandQueue.h"
+
+#define PRODUCERS 4
+#define COMMANDS_PER_PRODUCER 50000
+
+static std::atomic<int> failures(0);
+
+static void check(bool condition, const char* what) {
+    if (!condition && failures.fetch_add(1) < 10) {
+        printf("FAIL: %s\n", what);
+    }
+}
+
+// Producer and sequence number go into every operation, so a torn copy shows
+static void fillCommand(Command* command, uint8_t producer, uint32_t sequence) {
+    uint8_t count = 1 + sequence % COMMAND_MAX_OPS;
+    for (uint8_t i = 0; i < count; i++) {
+        CommandOp* op = command->add(CMD_UPDATE_ALARM);
+        op->alarm.id = producer;
+        op->alarm.hour = i;
+        op->alarm.rampSeconds = sequence & 0xFFFF;
+        op->alarm.dayMask = (sequence >> 16) & 0xFF;
+        snprintf(op->alarm.label, sizeof(op->alarm.label), "%u:%u", producer, sequence);
+    }
+}
+
+static uint32_t sequenceOf(const CommandOp& op) {
+    return op.alarm.rampSeconds | ((uint32_t)op.alarm.dayMask << 16);
+}
+
+int main() {
+    static CommandQueue queue;
+    std::atomic<bool> producing(true);
+    std::atomic<uint32_t> fullRetries(0);
+    std::atomic<uint32_t> resultsChecked(0);
+    std::atomic<uint32_t> resultsExpired(0);
+
+    // Single consumer, as the main loop
+    uint32_t lastSequence[PRODUCERS];
+    for (int p = 0; p < PRODUCERS; p++) {
+        lastSequence[p] = UINT32_MAX;
+    }
+    uint32_t received = 0;
+    uint32_t lastTicket = 0;
+    std::thread consumer([&]() {
+        Command command;
+        uint32_t ticket;
+        while (producing.load() || received < (uint32_t)PRODUCERS * COMMANDS_PER_PRODUCER) {
+            if (!queue.pop(&command, &ticket)) {
+                std::this_thread::yield();
+                continue;
+            }
+            received++;
+            check(ticket == lastTicket + 1, "tickets come out in order");
+            lastTicket = ticket;
+
+            uint8_t producer = command.ops[0].alarm.id;
+            uint32_t sequence = sequenceOf(command.ops[0]);
+            check(producer < PRODUCERS, "producer id intact");
+            if (producer >= PRODUCERS) {
+                continue;
+            }
+            check(command.count == 1 + sequence % COMMAND_MAX_OPS, "operation count intact");
+            check(sequence == lastSequence[producer] + 1, "each producer's commands in order, none lost");
+            lastSequence[producer] = sequence;
+
+            CommandResult result = {};
+            char label[ALARM_LABEL_MAX + 1];
+            snprintf(label, sizeof(label), "%u:%u", producer, sequence);
+            for (uint8_t i = 0; i < command.count; i++) {
+                const AlarmOperation& op = command.ops[i].alarm;
+                check(op.id == producer && op.hour == i && sequenceOf(command.ops[i]) == sequence &&
+                      strcmp(op.label, label) == 0, "operation contents intact");
+                result.values[i] = (int32_t)(sequence * COMMAND_MAX_OPS + i);
+            }
+            result.completed = command.count;
+            result.status = COMMAND_DONE;
+            queue.complete(ticket, result);
+        }
+    });
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (uint8_t p = 0; p < PRODUCERS; p++) {
+        producers.push_back(std::thread([&, p]() {
+            std::vector<uint32_t> tickets;
+            for (uint32_t sequence = 0; sequence < COMMANDS_PER_PRODUCER; sequence++) {
+                Command command;
+                fillCommand(&command, p, sequence);
+                uint32_t ticket;
+                while ((ticket = queue.push(command)) == 0) {
+                    fullRetries.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                }
+                tickets.push_back(ticket);
+
+                // Look back at a recent command of our own
+                if (sequence >= 8 && sequence % 8 == 0) {
+                    uint32_t earlier = sequence - 8;
+                    CommandResult result;
+                    CommandStatus status = queue.getResult(tickets[earlier], &result);
+                    if (status == COMMAND_DONE) {
+                        check(result.completed == 1 + earlier % COMMAND_MAX_OPS, "result count is the ticket's");
+                        check(result.values[0] == (int32_t)(earlier * COMMAND_MAX_OPS), "result values are the ticket's");
+                        resultsChecked.fetch_add(1, std::memory_order_relaxed);
+                    } else if (status == COMMAND_UNKNOWN) {
+                        resultsExpired.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        check(status == COMMAND_PENDING, "status is pending, done or expired");
+                    }
+                }
+            }
+
+            // The last ticket must complete
+            CommandResult result;
+            CommandStatus status;
+            while ((status = queue.getResult(tickets.back(), &result)) == COMMAND_PENDING) {
+                std::this_thread::yield();
+            }
+            check(status == COMMAND_DONE || status == COMMAND_UNKNOWN, "last command completes");
+        }));
+    }
+    for (size_t i = 0; i < producers.size(); i++) {
+        producers[i].join();
+    }
+    producing.store(false);
+    consumer.join();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    check(received == (uint32_t)PRODUCERS * COMMANDS_PER_PRODUCER, "every command received");
+    for (int p = 0; p < PRODUCERS; p++) {
+        check(lastSequence[p] == COMMANDS_PER_PRODUCER - 1, "every producer's last command received");
+    }
+
+    // A full queue rejects at once, and nothing can be read for tickets never issued
+    Command command;
+    fillCommand(&command, 0, 0);
+    uint32_t accepted = 0;
+    while (queue.push(command) != 0) {
+        accepted++;
+    }
+    check(accepted == COMMAND_QUEUE_SIZE, "queue holds exactly COMMAND_QUEUE_SIZE commands");
+    check(queue.getRejectedCount() > 0, "rejections counted");
+    CommandResult result;
+    check(queue.getResult(lastTicket + COMMAND_QUEUE_SIZE + 1, &result) == COMMAND_UNKNOWN, "future ticket unknown");
+    check(queue.getResult(lastTicket + 1, &result) == COMMAND_PENDING, "queued ticket pending");
+    check(queue.getResult(0, &result) == COMMAND_UNKNOWN, "ticket 0 unknown");
+    Command empty;
+    check(queue.push(empty) == 0, "empty command refused");
+
+    printf("%u commands from %d producers in %.0f ms (%.2f us each), %u full-queue retries, "
+           "%u results read back, %u already reused\n",
+           received, PRODUCERS, ms, ms * 1000 / received, fullRetries.load(), resultsChecked.load(),
+           resultsExpired.load());
+    printf("queue %zu bytes, command %zu bytes\n", sizeof(CommandQueue), sizeof(Command));
+    if (failures.load() > 0) {
+        printf("%d check(s) failed\n", failures.load());
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
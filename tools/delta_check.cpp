@@ -0,0 +1,204 @@
+/**
+ * @file delta_check.cpp
+ * @brief Host checks for DeltaDecoder against patches from make_delta.py
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Applies a patch the way OtaUpdater does, in network-sized pieces of
+ * random length with the source read through the decoder's window, and
+ * checks that the result is the new image byte for byte. Then feeds
+ * truncated and corrupted copies of the patch: each must end in an error
+ * or in an image of the right size (the device's SHA-256 check catches
+ * the rest), and none may read outside the source or write more than the
+ * target. Build with -fsanitize=address to have out-of-bounds accesses
+ * caught as well.
+ *
+ * Build and run from the repository root, with any two images:
+ *   g++ -std=gnu++11 -O2 -fsanitize=address -Iinclude tools/delta_check.cpp \
+ *       src/DeltaDecoder.cpp -o delta_check
+ *   python3 tools/make_delta.py old.bin new.bin update.nbd
+ *   ./delta_check old.bin new.bin update.nbd
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "DeltaDecoder.h"
+
+#define CORRUPT_RUNS 2000
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>* data) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("Cannot open %s\n", path);
+        return false;
+    }
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data->insert(data->end(), buffer, buffer + count);
+    }
+    fclose(file);
+    return true;
+}
+
+struct Target {
+    const std::vector<uint8_t>* source;
+    std::vector<uint8_t> image;
+    size_t limit;               // Target size from the header
+    size_t reads;
+    size_t largestWrite;
+    bool outOfBounds;
+};
+
+static bool readSource(void* context, uint32_t offset, uint8_t* buffer, size_t length) {
+    Target* target = static_cast<Target*>(context);
+    target->reads++;
+    if (offset + length > target->source->size()) {
+        target->outOfBounds = true;
+        return false;
+    }
+    memcpy(buffer, target->source->data() + offset, length);
+    return true;
+}
+
+static bool writeTarget(void* context, const uint8_t* data, size_t length) {
+    Target* target = static_cast<Target*>(context);
+    if (target->image.size() + length > target->limit) {
+        target->outOfBounds = true;
+        return false;
+    }
+    if (length > target->largestWrite) {
+        target->largestWrite = length;
+    }
+    target->image.insert(target->image.end(), data, data + length);
+    return true;
+}
+
+// Feeds the patch in pieces of 1 to maxPiece bytes; returns the final status
+static DeltaStatus apply(DeltaDecoder& decoder, Target& target, const std::vector<uint8_t>& patch,
+                         const std::vector<uint8_t>& source, size_t maxPiece) {
+    target.source = &source;
+    target.image.clear();
+    target.limit = 0;
+    target.reads = 0;
+    target.largestWrite = 0;
+    target.outOfBounds = false;
+    decoder.reset();
+
+    DeltaStatus status = DELTA_MORE;
+    size_t at = 0;
+    while (at < patch.size()) {
+        size_t piece = 1 + rand() % maxPiece;
+        if (piece > patch.size() - at) {
+            piece = patch.size() - at;
+        }
+        size_t used = 0;
+        status = decoder.feed(patch.data() + at, piece, &used);
+        at += used;
+        if (status == DELTA_ERROR) {
+            return status;
+        }
+        if (status == DELTA_HEADER) {
+            // Where OtaUpdater checks the source and opens the partition
+            target.limit = decoder.getHeader().targetSize;
+            target.image.reserve(target.limit);
+        }
+    }
+    return status;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        printf("Usage: %s old.bin new.bin patch.nbd\n", argv[0]);
+        return 2;
+    }
+    std::vector<uint8_t> source;
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> patch;
+    if (!readFile(argv[1], &source) || !readFile(argv[2], &expected) || !readFile(argv[3], &patch)) {
+        return 2;
+    }
+    srand(1);
+
+    DeltaDecoder decoder;
+    Target target;
+    decoder.begin(readSource, writeTarget, &target);
+
+    // 1. Intact patch, in pieces from single bytes up to a few TCP segments
+    static const size_t pieces[] = {1, 7, 536, 1460, 5840};
+    for (size_t i = 0; i < sizeof(pieces) / sizeof(pieces[0]); i++) {
+        auto started = std::chrono::steady_clock::now();
+        DeltaStatus status = apply(decoder, target, patch, source, pieces[i]);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        check(status == DELTA_DONE, "intact patch completes");
+        check(decoder.isComplete() && decoder.getConsumed() == patch.size(), "whole patch consumed");
+        check(target.image == expected, "result matches the new image");
+        check(!target.outOfBounds, "intact patch stays in bounds");
+        check(target.largestWrite <= DELTA_OUTPUT_BUFFER || pieces[i] > DELTA_OUTPUT_BUFFER,
+              "writes no larger than the output buffer or the piece");
+        printf("pieces up to %5zu bytes: %zu -> %zu bytes, %zu source reads, largest write %zu, %.1f ms\n",
+               pieces[i], patch.size(), target.image.size(), target.reads, target.largestWrite, ms);
+    }
+
+    // 2. The wrong source: every output byte is wrong, the SHA-256 check on the device rejects it
+    std::vector<uint8_t> wrongSource(source);
+    for (size_t i = 0; i < wrongSource.size(); i += 97) {
+        wrongSource[i] ^= 0x5A;
+    }
+    apply(decoder, target, patch, wrongSource, 1460);
+    check(!target.outOfBounds && target.image != expected, "different source gives a different image");
+
+    // 3. Truncated patches never complete
+    size_t truncatedDone = 0;
+    for (int run = 0; run < CORRUPT_RUNS / 4; run++) {
+        std::vector<uint8_t> truncated(patch.begin(), patch.begin() + rand() % patch.size());
+        if (apply(decoder, target, truncated, source, 1460) == DELTA_DONE) {
+            truncatedDone++;
+        }
+        check(!target.outOfBounds, "truncated patch stays in bounds");
+    }
+    check(truncatedDone == 0, "truncated patch never completes");
+
+    // 4. Corrupted patches: flipped bytes after the header
+    size_t errors = 0;
+    size_t wrongImages = 0;
+    for (int run = 0; run < CORRUPT_RUNS; run++) {
+        std::vector<uint8_t> corrupt(patch);
+        int flips = 1 + rand() % 4;
+        for (int f = 0; f < flips; f++) {
+            corrupt[DELTA_HEADER_BYTES + rand() % (corrupt.size() - DELTA_HEADER_BYTES)] ^= 1 << (rand() % 8);
+        }
+        DeltaStatus status = apply(decoder, target, corrupt, source, 1460);
+        check(!target.outOfBounds, "corrupted patch stays in bounds");
+        check(target.image.size() <= target.limit, "corrupted patch writes no more than the target");
+        if (status == DELTA_ERROR || status == DELTA_MORE) {
+            errors++;
+        } else if (target.image != expected) {
+            wrongImages++;
+        }
+    }
+    printf("%d corrupted patches: %zu rejected or incomplete, %zu complete with a wrong image "
+           "(left to the SHA-256 check)\n", CORRUPT_RUNS, errors, wrongImages);
+
+    printf("decoder state %zu bytes\n", sizeof(DeltaDecoder));
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
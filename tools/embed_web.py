@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Gzips the web interface in web/ and embeds it in include/WebAssets.h.
+
+    python3 tools/embed_web.py
+
+Also runs before every PlatformIO build (extra_scripts in platformio.ini), and
+only rewrites the header when an asset changed. The generated header is
+committed, so a build without Python still has the current assets.
+
+Each asset is gzipped deterministically and named by the SHA-256 of the
+compressed bytes. That hash is the strong ETag. Stylesheets and scripts are
+served under "/<name>.<hash>.<ext>" with a one-year immutable Cache-Control;
+pages refer to them as {{style.css}}, {{app.js}}, ... and get the hashed path
+substituted. Pages keep their fixed URL ("/" for index.html, "/ota" for
+ota.html) and are revalidated on every load, which the device answers with
+304 while the hash matches.
+"""
+
+import gzip
+import hashlib
+import io
+import os
+import re
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".json": "application/json",
+}
+PAGE_PATHS = {"index.html": "/"}
+CACHE_PAGE = "no-cache"
+CACHE_IMMUTABLE = "public, max-age=31536000, immutable"
+PLACEHOLDER = re.compile(r"\{\{([A-Za-z0-9_.-]+)\}\}")
+
+
+def compress(data):
+    # Fixed mtime and no file name, so unchanged input gives unchanged output
+    buffer = io.BytesIO()
+    with gzip.GzipFile(filename="", mode="wb", compresslevel=9, fileobj=buffer, mtime=0) as out:
+        out.write(data)
+    return buffer.getvalue()
+
+
+def symbol(name):
+    return "WEB_" + re.sub(r"[^A-Za-z0-9]", "_", name).upper() + "_GZ"
+
+
+def build_assets(web_dir):
+    names = sorted(n for n in os.listdir(web_dir) if os.path.splitext(n)[1] in CONTENT_TYPES)
+    pages = [n for n in names if n.endswith(".html")]
+    others = [n for n in names if not n.endswith(".html")]
+
+    assets = []
+    hashed_paths = {}
+    for name in others:
+        with open(os.path.join(web_dir, name), "rb") as f:
+            data = compress(f.read())
+        digest = hashlib.sha256(data).hexdigest()
+        stem, ext = os.path.splitext(name)
+        hashed_paths[name] = "/%s.%s%s" % (stem, digest[:8], ext)
+        assets.append((name, hashed_paths[name], CACHE_IMMUTABLE, digest, data))
+
+    for name in pages:
+        with open(os.path.join(web_dir, name), encoding="utf-8") as f:
+            text = f.read()
+
+        def substitute(match):
+            if match.group(1) not in hashed_paths:
+                raise SystemExit("%s: unknown asset {{%s}}" % (name, match.group(1)))
+            return hashed_paths[match.group(1)]
+
+        data = compress(PLACEHOLDER.sub(substitute, text).encode("utf-8"))
+        path = PAGE_PATHS.get(name, "/" + os.path.splitext(name)[0])
+        assets.append((name, path, CACHE_PAGE, hashlib.sha256(data).hexdigest(), data))
+
+    return assets
+
+
+def render_header(assets):
+    lines = [
+        "/**",
+        " * @file WebAssets.h",
+        " * @brief Gzipped web interface, generated by tools/embed_web.py from web/",
+        " * @author Nighty Byte Team",
+        " * @date 2025-08-25",
+        " *",
+        " * Do not edit; change the files in web/ and rebuild.",
+        " */",
+        "",
+        "#ifndef WEB_ASSETS_H",
+        "#define WEB_ASSETS_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "struct WebAsset {",
+        "    const char* path;",
+        "    const char* contentType;",
+        "    const char* cacheControl;",
+        "    const char* etag;           // Quoted SHA-256 prefix of the gzipped body",
+        "    const uint8_t* data;        // gzip, served from flash",
+        "    uint32_t length;",
+        "};",
+        "",
+    ]
+
+    for name, path, cache, digest, data in assets:
+        lines.append("// %s, %d bytes gzipped" % (name, len(data)))
+        lines.append("static const uint8_t %s[] PROGMEM = {" % symbol(name))
+        for start in range(0, len(data), 16):
+            chunk = data[start:start + 16]
+            lines.append("    " + ", ".join("0x%02x" % b for b in chunk) + ",")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("static const WebAsset WEB_ASSETS[] = {")
+    for name, path, cache, digest, data in assets:
+        content_type = CONTENT_TYPES[os.path.splitext(name)[1]]
+        lines.append('    {"%s", "%s", "%s", "\\"%s\\"", %s, %d},' %
+                     (path, content_type, cache, digest[:16], symbol(name), len(data)))
+    lines.append("};")
+    lines.append("")
+    lines.append("static const uint8_t WEB_ASSET_COUNT = %d;" % len(assets))
+    lines.append("")
+    lines.append("#endif // WEB_ASSETS_H")
+    return "\n".join(lines) + "\n"
+
+
+def main(root):
+    assets = build_assets(os.path.join(root, "web"))
+    header = render_header(assets)
+    path = os.path.join(root, "include", "WebAssets.h")
+
+    current = None
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            current = f.read()
+    if current == header:
+        return
+
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(header)
+    for name, asset_path, cache, digest, data in assets:
+        print("web asset %-12s -> %-22s %5d bytes gzipped, etag %s" % (name, asset_path, len(data), digest[:16]))
+
+
+try:
+    Import("env")  # noqa: F821 - defined when PlatformIO runs this as an extra script
+    main(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    main(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
@@ -0,0 +1,174 @@
+/**
+ * @file fade_planner_check.cpp
+ * @brief Host checks for FadePlanner and the sequencer's hardware fades
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Checks that every planned fade is something the LEDC fade engine can run
+ * (slow enough steps, never longer than its segment or FADE_SEGMENT_MAX_MS),
+ * that segments tile the requested duration and end on the target duty, and
+ * that ramp levels rise monotonically to full volume. Then plays the pulse
+ * pattern and a ramped continuous tone through PatternSequencer against a
+ * model of the fade engine, checking the volume never jumps between outputs
+ * and reporting how many register programmings each needed.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -Iinclude tools/fade_planner_check.cpp src/FadePlanner.cpp \
+ *       src/PatternSequencer.cpp src/PatternCode.cpp -o fade_planner_check
+ *   ./fade_planner_check
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <stdio.h>
+#include "FadePlanner.h"
+#include "PatternSequencer.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what, uint32_t a, uint32_t b) {
+    if (!condition) {
+        printf("  FAIL %s (%u, %u)\n", what, a, b);
+        failures++;
+    }
+}
+
+static void checkPlans() {
+    static const uint8_t duties[] = {1, 2, 17, 128, 200, 255};
+    static const uint32_t durations[] = {10, 100, 250, 700, 2550, 60000};
+    static const uint32_t frequencies[] = {262, 2000, 8000, 16383};
+    FadeSegment segments[FADE_MAX_SEGMENTS];
+    int plans = 0;
+
+    for (uint8_t from : duties) {
+        for (uint8_t to : duties) {
+            for (uint32_t duration : durations) {
+                for (uint32_t frequency : frequencies) {
+                    uint8_t count = FadePlanner::plan(from, to, duration, frequency, segments, FADE_MAX_SEGMENTS);
+                    check(count >= 1 && count <= FADE_MAX_SEGMENTS, "segment count", count, duration);
+
+                    uint32_t total = 0;
+                    uint8_t previous = from;
+                    for (uint8_t i = 0; i < count; i++) {
+                        const FadeSegment& s = segments[i];
+                        uint32_t delta = s.duty > previous ? s.duty - previous : previous - s.duty;
+                        check(s.fadeMs <= s.durationMs, "fade outlives its segment", s.fadeMs, s.durationMs);
+                        check(s.fadeMs <= FADE_SEGMENT_MAX_MS, "fade too long", s.fadeMs, FADE_SEGMENT_MAX_MS);
+                        check(s.fadeMs <= FadePlanner::maxFadeMs(delta, frequency), "fade slower than hardware",
+                              s.fadeMs, delta);
+                        check(delta == 0 || s.fadeMs > 0, "duty jump instead of fade", delta, s.fadeMs);
+                        check((s.duty >= previous) == (to >= from) || s.duty == previous, "not monotonic",
+                              s.duty, previous);
+                        total += s.durationMs;
+                        previous = s.duty;
+                    }
+                    check(total == duration, "segments do not tile the duration", total, duration);
+                    check(previous == to, "does not end on target", previous, to);
+                    plans++;
+                }
+            }
+        }
+    }
+    printf("plan           %d plans checked\n", plans);
+}
+
+static void checkRamps() {
+    static const uint8_t shapes[] = {RAMP_LINEAR, RAMP_PERCEPTUAL};
+    for (uint8_t shape : shapes) {
+        RampProfile profile = {300, ALARM_RAMP_START_LEVEL, shape};
+        uint8_t previous = FadePlanner::rampLevel(profile, 0);
+        check(previous == ALARM_RAMP_START_LEVEL, "ramp start level", previous, shape);
+        for (uint32_t ms = 0; ms <= 310000; ms += 100) {
+            uint8_t level = FadePlanner::rampLevel(profile, ms);
+            check(level >= previous, "ramp falls", level, ms);
+            previous = level;
+        }
+        check(previous == 255, "ramp does not reach full volume", previous, shape);
+    }
+
+    // Perceptual stays quieter through the first half
+    RampProfile linear = {300, 0, RAMP_LINEAR};
+    RampProfile perceptual = {300, 0, RAMP_PERCEPTUAL};
+    check(FadePlanner::rampLevel(perceptual, 75000) < FadePlanner::rampLevel(linear, 75000),
+          "perceptual ramp not gentler", FadePlanner::rampLevel(perceptual, 75000),
+          FadePlanner::rampLevel(linear, 75000));
+
+    RampProfile none = {300, 0, RAMP_NONE};
+    check(FadePlanner::rampLevel(none, 0) == 255, "RAMP_NONE not full volume", 0, 0);
+    check(FadePlanner::scaleDuty(128, 255) == 128, "full level changes duty", 128, 255);
+    check(FadePlanner::scaleDuty(1, 1) == 1, "audible duty scaled to silence", 1, 1);
+    check(FadePlanner::scaleDuty(0, 255) == 0, "silence scaled up", 0, 255);
+    printf("ramp           linear and perceptual checked\n");
+}
+
+// Plays a pattern against a model of the LEDC fade engine; returns programmings
+static uint32_t play(const char* name, const uint8_t* code, uint16_t length, const RampProfile* ramp,
+                     uint64_t durationUs) {
+    PatternSequencer sequencer;
+    ToneOutput output;
+    uint64_t now = 0;
+    uint32_t programmings = 0;
+    uint32_t fades = 0;
+    uint32_t hardwareDuty = 0;
+    uint32_t worstJump = 0;
+
+    bool running = sequencer.start(code, length, true, now, &output, ramp);
+    while (running && now < durationUs) {
+        uint64_t stepUs = sequencer.getDeadline() - now;
+
+        // Sounding steps that follow one another should continue the volume
+        if (output.frequency && hardwareDuty) {
+            uint32_t jump = output.duty > hardwareDuty ? output.duty - hardwareDuty : hardwareDuty - output.duty;
+            if (jump > worstJump) worstJump = jump;
+        }
+        programmings++;
+        if (output.fadeMs > 0) {
+            uint32_t delta = output.fadeDuty > output.duty ? output.fadeDuty - output.duty
+                                                           : output.duty - output.fadeDuty;
+            check((uint64_t)output.fadeMs * 1000 <= stepUs, "fade outlives its step", output.fadeMs,
+                  (uint32_t)(stepUs / 1000));
+            check(output.fadeMs <= FadePlanner::maxFadeMs(delta, output.frequency), "fade slower than hardware",
+                  output.fadeMs, delta);
+            fades++;
+        }
+        hardwareDuty = output.frequency ? (output.fadeMs > 0 ? output.fadeDuty : output.duty) : 0;
+
+        now = sequencer.getDeadline();
+        running = sequencer.advance(&output);
+    }
+
+    check(worstJump <= 1, "volume jumps between outputs", worstJump, 1);
+    printf("%-14s %u programmings (%u fades) in %llu s, largest jump %u\n", name, programmings, fades,
+           (unsigned long long)(durationUs / 1000000), worstJump);
+    return programmings;
+}
+
+int main() {
+    checkPlans();
+    checkRamps();
+
+    static const uint8_t pulseCode[] = {
+        PC_VOLUME(1), PC_TONE(2000, 100),
+        PC_FADE(255, 700), PC_FADE(1, 700),
+        PC_END
+    };
+    static const uint8_t continuousCode[] = {
+        PC_TONE(2000, 1000),
+        PC_END
+    };
+
+    // Software stepping needed a write every 100 ms: 10 per second
+    uint32_t pulse = play("pulse", pulseCode, sizeof(pulseCode), nullptr, 60ULL * 1000000);
+    check(pulse <= 60 * 10 / 2, "pulse needs as many writes as software stepping", pulse, 60 * 10);
+
+    RampProfile ramp = {300, ALARM_RAMP_START_LEVEL, RAMP_PERCEPTUAL};
+    play("crescendo", continuousCode, sizeof(continuousCode), &ramp, 300ULL * 1000000);
+    play("pulse ramped", pulseCode, sizeof(pulseCode), &ramp, 300ULL * 1000000);
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file json_writer_check.cpp
+ * @brief Host checks for JsonWriter and the web API buffer size
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Checks that JsonWriter never touches the heap, always produces valid JSON
+ * (also when the buffer runs out, at every possible buffer size), escapes
+ * strings correctly and pages lists with mark()/rollback(). Then builds the
+ * largest responses the web API can produce - /history with every minute
+ * bucket at its widest, /api/alarms with MAX_ALARMS labels made entirely of
+ * characters that need escaping - and checks they fit API_BUFFER_SIZE.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Iinclude tools/json_writer_check.cpp src/JsonWriter.cpp -o json_writer_check
+ *   ./json_writer_check
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "JsonWriter.h"
+#include "config.h"
+
+#define HISTORY_MINUTE_BUCKETS 180      // As in SensorHistory.h, which needs Arduino headers
+
+static int failures = 0;
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// --- Minimal JSON validator --------------------------------------------------
+
+static const char* parseValue(const char* p, const char* end);
+
+static const char* skipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+static const char* parseString(const char* p, const char* end) {
+    if (p >= end || *p != '"') return nullptr;
+    for (p++; p < end; p++) {
+        if (*p == '"') return p + 1;
+        if ((unsigned char)*p < 0x20) return nullptr;
+        if (*p == '\\') {
+            p++;
+            if (p >= end) return nullptr;
+            if (*p == 'u') {
+                for (int i = 0; i < 4; i++) {
+                    p++;
+                    if (p >= end || !strchr("0123456789abcdefABCDEF", *p)) return nullptr;
+                }
+            } else if (!strchr("\"\\/bfnrt", *p)) {
+                return nullptr;
+            }
+        }
+    }
+    return nullptr;
+}
+
+static const char* parseContainer(const char* p, const char* end, char close, bool object) {
+    p = skipSpace(p + 1, end);
+    if (p < end && *p == close) return p + 1;
+    for (;;) {
+        if (object) {
+            p = parseString(skipSpace(p, end), end);
+            if (!p) return nullptr;
+            p = skipSpace(p, end);
+            if (p >= end || *p != ':') return nullptr;
+            p++;
+        }
+        p = parseValue(p, end);
+        if (!p) return nullptr;
+        p = skipSpace(p, end);
+        if (p < end && *p == ',') { p++; continue; }
+        if (p < end && *p == close) return p + 1;
+        return nullptr;
+    }
+}
+
+static const char* parseValue(const char* p, const char* end) {
+    p = skipSpace(p, end);
+    if (p >= end) return nullptr;
+    if (*p == '{') return parseContainer(p, end, '}', true);
+    if (*p == '[') return parseContainer(p, end, ']', false);
+    if (*p == '"') return parseString(p, end);
+    const char* words[] = {"true", "false", "null"};
+    for (int i = 0; i < 3; i++) {
+        size_t n = strlen(words[i]);
+        if ((size_t)(end - p) >= n && memcmp(p, words[i], n) == 0) return p + n;
+    }
+    const char* start = p;
+    if (*p == '-') p++;
+    while (p < end && (strchr("0123456789.eE+-", *p))) p++;
+    return p > start ? p : nullptr;
+}
+
+static bool isValidJson(const char* text, size_t length) {
+    const char* end = text + length;
+    const char* p = parseValue(text, end);
+    return p && skipSpace(p, end) == end;
+}
+
+// --- Checks ------------------------------------------------------------------
+
+// A bit of everything: nesting, all value types, strings needing escapes
+static void writeSample(JsonWriter& json) {
+    json.beginObject();
+    json.key("name");
+    json.string("quote \" backslash \\ tab \t bell \x07 done");
+    json.key("n");
+    json.number(-2147483647 - 1);
+    json.key("u");
+    json.unsignedNumber(4294967295u);
+    json.key("f");
+    json.decimal(3.14159f, 2);
+    json.key("nan");
+    json.decimal(0.0f / 0.0f, 2);
+    json.key("list");
+    json.beginArray();
+    for (int i = 0; i < 12; i++) {
+        json.beginObject();
+        json.key("i");
+        json.number(i);
+        json.key("on");
+        json.boolean(i & 1);
+        json.key("x");
+        json.null();
+        json.endObject();
+    }
+    json.beginArray();
+    json.endArray();
+    json.endArray();
+    json.key("tail");
+    json.string(nullptr);
+    json.endObject();
+}
+
+static void checkWriter() {
+    char buffer[1024];
+    size_t before = allocations;
+    JsonWriter json(buffer, sizeof(buffer));
+    writeSample(json);
+    size_t fullLength = json.size();
+    check(allocations == before, "writer does not allocate");
+    check(!json.overflowed() && json.isComplete(), "sample fits");
+    check(isValidJson(json.data(), json.size()), "sample is valid JSON");
+    check(memmem(json.data(), json.size(), "\\\"", 2) && memmem(json.data(), json.size(), "\\u0007", 6),
+          "quotes and control characters escaped");
+    check(memmem(json.data(), json.size(), "\"nan\":null", 10) != nullptr, "NaN written as null");
+    check(memmem(json.data(), json.size(), "-2147483648", 11) != nullptr, "INT32_MIN");
+
+    // Every buffer size: either the whole sample or a shorter document that still parses
+    int truncatedValid = 0;
+    for (size_t size = 2; size <= fullLength; size++) {
+        JsonWriter small(buffer, size);
+        writeSample(small);
+        check(small.size() <= size, "never writes past the buffer");
+        check(small.isComplete(), "containers always closed");
+        check(isValidJson(small.data(), small.size()), "truncated output is valid JSON");
+        check(small.overflowed() == (size < fullLength), "overflow reported exactly when something was dropped");
+        truncatedValid += isValidJson(small.data(), small.size());
+    }
+    printf("writer         sample %zu bytes, valid at all %zu smaller buffer sizes: %s\n", fullLength,
+           fullLength - 2, truncatedValid == (int)(fullLength - 1) ? "yes" : "no");
+}
+
+static void checkPaging() {
+    // As /api/logs: whole entries only, then room for the closing fields
+    char buffer[300];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    json.key("logs");
+    json.beginArray();
+    int written = 0;
+    bool truncated = false;
+    for (int i = 0; i < 100; i++) {
+        JsonWriter::Mark before = json.mark();
+        json.beginObject();
+        json.key("t");
+        json.unsignedNumber(1000 * i);
+        json.key("msg");
+        json.string("WiFi connected");
+        json.endObject();
+        if (json.overflowed() || json.remaining() < API_PAGE_RESERVE) {
+            json.rollback(before);
+            truncated = true;
+            break;
+        }
+        written++;
+    }
+    json.endArray();
+    json.key("truncated");
+    json.boolean(truncated);
+    json.endObject();
+
+    printf("paging         %d entries in %zu bytes, truncated %s\n", written, sizeof(buffer),
+           truncated ? "yes" : "no");
+    check(truncated && written > 0, "page stops early");
+    check(!json.overflowed() && isValidJson(json.data(), json.size()), "page closes cleanly");
+    check(memmem(json.data(), json.size(), "\"truncated\":true", 16) != nullptr, "truncation reported");
+}
+
+static void checkWorstCaseSizes() {
+    static char buffer[API_BUFFER_SIZE];
+
+    // /history: every bucket at its widest
+    JsonWriter history(buffer, sizeof(buffer));
+    history.beginObject();
+    history.key("ch");
+    history.string("pillbox");
+    history.key("res");
+    history.unsignedNumber(86400);
+    history.key("t0");
+    history.unsignedNumber(4294967295u);
+    const char* columns[] = {"n", "min", "max", "avg"};
+    for (int column = 0; column < 4; column++) {
+        history.key(columns[column]);
+        history.beginArray();
+        for (int i = 0; i < HISTORY_MINUTE_BUCKETS; i++) {
+            history.unsignedNumber(column == 0 ? 65535 : 255);
+        }
+        history.endArray();
+    }
+    history.endObject();
+    printf("history        worst case %zu of %d bytes\n", history.size(), API_BUFFER_SIZE);
+    check(!history.overflowed(), "widest /history fits API_BUFFER_SIZE");
+
+    // /api/alarms: labels of control characters grow six-fold when escaped
+    char label[ALARM_LABEL_MAX + 1];
+    memset(label, '\x01', ALARM_LABEL_MAX);
+    label[ALARM_LABEL_MAX] = '\0';
+    char sound[PATTERN_NAME_MAX + 1];
+    memset(sound, 'z', PATTERN_NAME_MAX);
+    sound[PATTERN_NAME_MAX] = '\0';
+
+    JsonWriter alarms(buffer, sizeof(buffer));
+    alarms.beginObject();
+    alarms.key("max");
+    alarms.unsignedNumber(MAX_ALARMS);
+    alarms.key("alarms");
+    alarms.beginArray();
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        alarms.beginObject();
+        alarms.key("id");
+        alarms.unsignedNumber(255);
+        alarms.key("time");
+        alarms.string("23:59");
+        alarms.key("days");
+        alarms.unsignedNumber(127);
+        alarms.key("enabled");
+        alarms.boolean(false);
+        alarms.key("repeating");
+        alarms.boolean(false);
+        alarms.key("date");
+        alarms.unsignedNumber(4294967295u);
+        alarms.key("label");
+        alarms.string(label);
+        alarms.key("sound");
+        alarms.string(sound);
+        alarms.key("ramp");
+        alarms.unsignedNumber(ALARM_RAMP_MAX_S);
+        alarms.key("shape");
+        alarms.string("perceptual");
+        alarms.endObject();
+    }
+    alarms.endArray();
+    alarms.endObject();
+    printf("alarms         worst case %zu of %d bytes\n", alarms.size(), API_BUFFER_SIZE);
+    check(!alarms.overflowed(), "widest /api/alarms fits API_BUFFER_SIZE");
+    check(isValidJson(alarms.data(), alarms.size()), "escaped labels are valid JSON");
+
+    printf("static pool    %d x %d = %d bytes, no heap per response body\n", API_BUFFER_COUNT, API_BUFFER_SIZE,
+           API_BUFFER_COUNT * API_BUFFER_SIZE);
+}
+
+int main() {
+    checkWriter();
+    checkPaging();
+    checkWorstCaseSizes();
+    check(allocations == 0, "no heap allocations at all");
+
+    printf("%s\n", failures == 0 ? "All checks passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file light_replay.cpp
+ * @brief Host replay harness for LightTrendDetector and SleepTracker
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Feeds a light trace through the same moving average, detector and sleep
+ * tracker the firmware uses and prints every lights-out / lights-on event.
+ *
+ * A trace may say what it should produce in a comment line such as
+ *   # expect: out 23:10, on 03:05, out 03:11, on 07:00; within 5 min
+ * (UTC times of day, in order). The detected events must then be exactly
+ * those, each within the given number of minutes.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -Iinclude tools/light_replay.cpp src/LightTrendDetector.cpp \
+ *       src/SleepTracker.cpp -o light_replay
+ *   ./light_replay tools/light_traces/[a-z]*.csv
+ *
+ * Exits non-zero if any trace does not match its expectation.
+ *
+ * Input is CSV "timestamp,value" (epoch seconds, raw 0-4095 light ADC), the
+ * format tools/ts_decode.py writes, so a series downloaded from the device
+ * can be replayed directly (without an expectation, nothing is checked):
+ *   python3 tools/ts_decode.py light.idx light.dat | ./light_replay -
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "LightTrendDetector.h"
+#include "SleepTracker.h"
+
+#define MAX_EVENTS 16
+
+struct Event {
+    bool dark;
+    int minuteOfDay;
+};
+
+struct Expectation {
+    bool given;
+    Event events[MAX_EVENTS];
+    int count;
+    int withinMinutes;
+};
+
+static const char* formatTime(uint32_t timestamp) {
+    static char buffer[32];
+    time_t t = timestamp;
+    struct tm* tm = gmtime(&t);
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", tm);
+    return buffer;
+}
+
+// "# expect: out HH:MM, on HH:MM, ...; within N min"
+static bool parseExpectation(const char* line, Expectation* expect) {
+    const char* p = line + strlen("# expect:");
+    expect->count = 0;
+    expect->withinMinutes = 0;
+    while (expect->count < MAX_EVENTS) {
+        char kind[4];
+        int hour, minute, used;
+        if (sscanf(p, " %3[a-z] %d:%d%n", kind, &hour, &minute, &used) != 3 ||
+            (strcmp(kind, "out") != 0 && strcmp(kind, "on") != 0) ||
+            hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+            return false;
+        }
+        expect->events[expect->count].dark = strcmp(kind, "out") == 0;
+        expect->events[expect->count].minuteOfDay = hour * 60 + minute;
+        expect->count++;
+        p += used;
+        if (*p != ',') {
+            break;
+        }
+        p++;
+    }
+    expect->given = sscanf(p, " ; within %d min", &expect->withinMinutes) == 1 && expect->withinMinutes >= 0;
+    return expect->given;
+}
+
+// Minutes between two times of day, across midnight either way
+static int minutesApart(int a, int b) {
+    int difference = abs(a - b);
+    return difference > 720 ? 1440 - difference : difference;
+}
+
+// Returns the number of mismatches against the trace's expectation
+static int replay(FILE* input, const char* name) {
+    LightTrendDetector detector(BEDTIME_LIGHT_THRESHOLD, LIGHT_TREND_DWELL_S);
+    SleepTracker sleep(SLEEP_MIN_DURATION_S, SLEEP_MAX_DURATION_S, SLEEP_MERGE_GAP_S);
+    Expectation expect;
+    expect.given = false;
+    Event detected[MAX_EVENTS];
+    int mismatches = 0;
+
+    // Same rolling average as SensorManager::readLightSensor()
+    int window[LIGHT_SAMPLES];
+    int total = 0;
+    int index = 0;
+    bool seeded = false;
+
+    char line[128];
+    unsigned long samples = 0;
+    unsigned events = 0;
+
+    printf("== %s\n", name);
+    while (fgets(line, sizeof(line), input)) {
+        if (strncmp(line, "# expect:", 9) == 0 && !parseExpectation(line, &expect)) {
+            printf("FAIL: malformed expectation: %s", line);
+            mismatches++;
+        }
+        if (line[0] == '#' || line[0] < '0' || line[0] > '9') {
+            continue; // Header or comment
+        }
+
+        char* comma = strchr(line, ',');
+        if (!comma) {
+            continue;
+        }
+        uint32_t timestamp = strtoul(line, NULL, 10);
+        int raw = atoi(comma + 1);
+
+        if (!seeded) {
+            for (int i = 0; i < LIGHT_SAMPLES; i++) window[i] = raw;
+            total = raw * LIGHT_SAMPLES;
+            seeded = true;
+        }
+        total += raw - window[index];
+        window[index] = raw;
+        index = (index + 1) % LIGHT_SAMPLES;
+        samples++;
+
+        LightTrendResult result = detector.update(timestamp, total / LIGHT_SAMPLES);
+        if (result.change == LIGHT_TREND_NONE) {
+            continue;
+        }
+
+        bool dark = result.change == LIGHT_TREND_LIGHTS_OUT;
+        printf("%s  %-10s level %4d  confidence %3u%%  (confirmed %us later)\n",
+               formatTime(result.changeTime), dark ? "LIGHTS OUT" : "LIGHTS ON",
+               (int)result.level, result.confidence, timestamp - result.changeTime);
+        if (events < MAX_EVENTS) {
+            detected[events].dark = dark;
+            detected[events].minuteOfDay = (int)(result.changeTime % 86400) / 60;
+        }
+        events++;
+
+        // Same rules as SensorManager::updateLightTrend()
+        if (dark) {
+            if (result.confidence >= LIGHT_TREND_MIN_CONFIDENCE) {
+                sleep.onLightsOut(result.changeTime);
+            }
+        } else if (sleep.onLightsOn(result.changeTime)) {
+            printf("    sleep recorded: %u min\n", sleep.getLastNightMinutes());
+        }
+    }
+
+    printf("%lu samples, %u events, baselines lit %d / dark %d\n",
+           samples, events, (int)detector.getLitBaseline(), (int)detector.getDarkBaseline());
+    printf("nights %u, last %u min, average %u min\n",
+           sleep.getNightCount(), sleep.getLastNightMinutes(), sleep.getAverageMinutes());
+
+    if (!expect.given) {
+        return mismatches;
+    }
+    if ((int)events != expect.count) {
+        printf("FAIL: %u events, expected %d\n", events, expect.count);
+        mismatches++;
+    }
+    for (int i = 0; i < expect.count && i < (int)events && i < MAX_EVENTS; i++) {
+        const Event& want = expect.events[i];
+        const Event& got = detected[i];
+        if (got.dark != want.dark ||
+            minutesApart(got.minuteOfDay, want.minuteOfDay) > expect.withinMinutes) {
+            printf("FAIL: event %d is lights %s %02d:%02d, expected lights %s %02d:%02d within %d min\n",
+                   i + 1, got.dark ? "out" : "on", got.minuteOfDay / 60, got.minuteOfDay % 60,
+                   want.dark ? "out" : "on", want.minuteOfDay / 60, want.minuteOfDay % 60,
+                   expect.withinMinutes);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace.csv|-> ...\n", argv[0]);
+        return 1;
+    }
+
+    int failed = 0;
+    for (int i = 1; i < argc; i++) {
+        FILE* input = strcmp(argv[i], "-") == 0 ? stdin : fopen(argv[i], "r");
+        if (!input) {
+            perror(argv[i]);
+            return 1;
+        }
+        if (replay(input, argv[i]) > 0) {
+            failed++;
+        }
+        if (input != stdin) {
+            fclose(input);
+        }
+        printf("\n");
+    }
+
+    if (failed > 0) {
+        printf("%d trace(s) did not match their expectation\n", failed);
+        return 1;
+    }
+    printf("All traces matched\n");
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file live_status_check.cpp
+ * @brief Host checks for LiveStatus coalescing and per-client backpressure
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Drives LiveStatus through a burst of sensor and alarm changes with three
+ * simulated WebSocket clients: one always ready, one that only takes every
+ * fifth message and one that connects late. Checks that changes within one
+ * tick go out as one message, that deadband-sized light jitter is not pushed,
+ * that the slow client never has more than one message outstanding yet ends
+ * up with the same state as the fast one, and that the late client starts
+ * from a full snapshot.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -Iinclude tools/live_status_check.cpp src/LiveStatus.cpp -o live_status_check
+ *   ./live_status_check
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include "LiveStatus.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// What a browser would hold after merging every message it received
+struct SimClient {
+    std::map<std::string, int> state;
+    uint32_t messages;
+    uint32_t bytes;
+    uint32_t attempts;
+    uint32_t acceptEvery;       // 1 = always ready
+};
+
+static std::map<uint32_t, SimClient> clients;
+
+static void merge(SimClient& client, const char* message) {
+    // Flat {"key":int,...} objects only
+    const char* p = message;
+    while ((p = strchr(p, '"')) != nullptr) {
+        const char* end = strchr(p + 1, '"');
+        std::string key(p + 1, end - p - 1);
+        client.state[key] = atoi(end + 2);
+        p = strchr(end + 2, ',');
+        if (!p) break;
+    }
+}
+
+static bool sendTo(void* context, uint32_t clientId, const char* message, size_t length) {
+    (void)context;
+    SimClient& client = clients[clientId];
+    client.attempts++;
+    if (client.attempts % client.acceptEvery != 0) {
+        return false;   // Send queue full this time
+    }
+    check(length == strlen(message) && length < LIVE_MESSAGE_MAX, "message length");
+    merge(client, message);
+    client.messages++;
+    client.bytes += (uint32_t)length;
+    return true;
+}
+
+int main() {
+    LiveStatus live;
+    clients[1].acceptEvery = 1;
+    clients[2].acceptEvery = 5;
+    clients[3].acceptEvery = 1;
+    check(live.addClient(1) && live.addClient(2), "add clients");
+
+    // Nothing known yet: nothing to send
+    check(!live.commit() && live.flush(sendTo, nullptr) == 0, "empty status sends nothing");
+
+    // Initial state in one tick
+    live.set(LIVE_ALARM_STATE, 0);
+    live.set(LIVE_ALARM_ID, 0);
+    live.set(LIVE_PILL_BOX, 0);
+    live.set(LIVE_USB, 1);
+    live.set(LIVE_LIGHT, 2000, LIVE_LIGHT_DEADBAND);
+    live.set(LIVE_NETWORK, 2);
+    check(live.commit(), "first commit");
+    live.flush(sendTo, nullptr);
+    check(clients[1].messages == 1 && clients[1].state.size() == LIVE_FIELD_COUNT + 1, "first message is complete");
+
+    // Light jitter inside the deadband is not a change
+    uint32_t revision = live.getRevision();
+    for (int i = 0; i < 50; i++) {
+        live.set(LIVE_LIGHT, 2000 + (i % 2 ? 10 : -10), LIVE_LIGHT_DEADBAND);
+    }
+    check(!live.commit() && live.getRevision() == revision, "jitter is filtered");
+
+    // A burst within one tick is coalesced: several transitions, one message
+    uint32_t before = clients[1].messages;
+    live.set(LIVE_ALARM_STATE, 1);
+    live.set(LIVE_ALARM_ID, 3);
+    live.set(LIVE_ALARM_STATE, 3);
+    live.set(LIVE_PILL_BOX, 1);
+    live.commit();
+    live.flush(sendTo, nullptr);
+    check(clients[1].messages == before + 1, "burst is one message");
+    check(clients[1].state["alarm"] == 3 && clients[1].state["id"] == 3, "burst ends in the last state");
+
+    // Many ticks of changes: the slow client skips intermediate states
+    for (int tick = 0; tick < 200; tick++) {
+        live.set(LIVE_LIGHT, 500 + tick * 17, LIVE_LIGHT_DEADBAND);
+        live.set(LIVE_PILL_BOX, tick % 2);
+        if (tick == 120) {
+            check(live.addClient(3), "late client");
+        }
+        live.commit();
+        live.flush(sendTo, nullptr);
+    }
+    // Let the slow client catch up without further changes
+    for (int i = 0; i < 10; i++) {
+        live.flush(sendTo, nullptr);
+    }
+
+    check(clients[2].state == clients[1].state, "slow client converges");
+    check(clients[3].state == clients[1].state, "late client converges");
+    check(clients[2].messages < clients[1].messages / 3, "slow client drops intermediate states");
+    check(clients[3].messages < clients[1].messages, "late client starts from a snapshot");
+
+    live.removeClient(1);
+    check(live.clientCount() == 2, "remove client");
+    for (uint32_t id = 10; id < 10 + WS_MAX_CLIENTS; id++) {
+        live.addClient(id);
+    }
+    check(live.clientCount() == WS_MAX_CLIENTS, "client limit");
+
+    for (std::map<uint32_t, SimClient>::iterator it = clients.begin(); it != clients.end(); ++it) {
+        if (it->first > 3) continue;
+        printf("client %u: every %u  %4u messages  %5u bytes  (%u attempts)\n", it->first,
+               it->second.acceptEvery, it->second.messages, it->second.bytes, it->second.attempts);
+    }
+    printf("final revision %u\n", live.getRevision());
+    printf("%s\n", failures == 0 ? "All checks passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Converts a WAV file into an audio clip for AudioEngine (ENABLE_AUDIO_ENGINE).
+
+    python3 tools/make_clip.py wake.wav data/audio/wake.nba [--pcm] [--gain DB]
+
+The input is mixed down to mono and resampled to 16 kHz (AUDIO_SAMPLE_RATE).
+The output is IMA ADPCM (4 bits per sample) unless --pcm asks for unsigned
+8-bit PCM. Put clips under data/audio/ and upload the file system image
+(pio run -t uploadfs); an alarm whose sound is the clip name then plays it.
+
+The clip format is documented in include/ClipDecoder.h.
+"""
+
+import argparse
+import struct
+import sys
+import wave
+
+SAMPLE_RATE = 16000
+FORMAT_VERSION = 1
+PCM_U8 = 0
+IMA_ADPCM = 1
+BLOCK_BYTES = 256
+BLOCK_SAMPLES = (BLOCK_BYTES - 4) * 2
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def read_wav(path):
+    with wave.open(path, "rb") as wav:
+        channels = wav.getnchannels()
+        width = wav.getsampwidth()
+        rate = wav.getframerate()
+        raw = wav.readframes(wav.getnframes())
+
+    if width == 1:
+        values = [(b - 128) << 8 for b in raw]
+    elif width == 2:
+        values = list(struct.unpack("<%dh" % (len(raw) // 2), raw))
+    else:
+        sys.exit("Only 8-bit and 16-bit WAV files are supported")
+
+    mono = [sum(values[i:i + channels]) // channels for i in range(0, len(values), channels)]
+    return mono, rate
+
+
+def resample(samples, rate):
+    if rate == SAMPLE_RATE or not samples:
+        return samples
+    count = int(len(samples) * SAMPLE_RATE / rate)
+    out = []
+    for i in range(count):
+        position = i * rate / SAMPLE_RATE
+        base = int(position)
+        frac = position - base
+        nxt = samples[base + 1] if base + 1 < len(samples) else samples[base]
+        out.append(int(samples[base] + (nxt - samples[base]) * frac))
+    return out
+
+
+def clamp16(value):
+    return max(-32768, min(32767, int(value)))
+
+
+class ImaEncoder:
+    def __init__(self):
+        self.predictor = 0
+        self.index = 0
+
+    def encode(self, sample):
+        step = STEP_TABLE[self.index]
+        diff = sample - self.predictor
+        code = 0
+        if diff < 0:
+            code = 8
+            diff = -diff
+        if diff >= step:
+            code |= 4
+            diff -= step
+        if diff >= step >> 1:
+            code |= 2
+            diff -= step >> 1
+        if diff >= step >> 2:
+            code |= 1
+
+        # Follow the decoder's reconstruction so the error does not accumulate
+        delta = step >> 3
+        if code & 4:
+            delta += step
+        if code & 2:
+            delta += step >> 1
+        if code & 1:
+            delta += step >> 2
+        self.predictor = clamp16(self.predictor - delta if code & 8 else self.predictor + delta)
+        self.index = max(0, min(88, self.index + INDEX_TABLE[code]))
+        return code
+
+
+def encode_adpcm(samples):
+    encoder = ImaEncoder()
+    out = bytearray()
+    for start in range(0, len(samples), BLOCK_SAMPLES):
+        block = samples[start:start + BLOCK_SAMPLES]
+        out += struct.pack("<hBB", encoder.predictor, encoder.index, 0)
+        for i in range(0, len(block), 2):
+            low = encoder.encode(block[i])
+            high = encoder.encode(block[i + 1]) if i + 1 < len(block) else 0
+            out.append(low | (high << 4))
+    return bytes(out)
+
+
+def encode_pcm(samples):
+    return bytes((s >> 8) + 128 for s in samples)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("wav")
+    parser.add_argument("output")
+    parser.add_argument("--pcm", action="store_true", help="unsigned 8-bit PCM instead of IMA ADPCM")
+    parser.add_argument("--gain", type=float, default=0.0, help="gain in dB before encoding")
+    args = parser.parse_args()
+
+    samples, rate = read_wav(args.wav)
+    samples = resample(samples, rate)
+    if args.gain:
+        factor = 10 ** (args.gain / 20)
+        samples = [clamp16(s * factor) for s in samples]
+
+    fmt = PCM_U8 if args.pcm else IMA_ADPCM
+    data = encode_pcm(samples) if args.pcm else encode_adpcm(samples)
+    header = b"NBA" + struct.pack("<BBBHI", FORMAT_VERSION, fmt, 0, SAMPLE_RATE, len(samples))
+
+    with open(args.output, "wb") as out:
+        out.write(header + data)
+
+    seconds = len(samples) / SAMPLE_RATE
+    print("%s: %.2f s, %s, %d bytes" % (args.output, seconds, "PCM8" if args.pcm else "IMA ADPCM",
+                                        len(header) + len(data)))
+
+
+if __name__ == "__main__":
+    main()
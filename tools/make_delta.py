@@ -0,0 +1,271 @@
+#!/usr/bin/env python3
+"""
+Make an NBD1 delta patch that turns one firmware image into another.
+
+    python3 tools/make_delta.py old.bin new.bin update.nbd
+
+old.bin must be exactly the image the device runs (keep the .bin of every
+release you ship); the device checks its SHA-256 before applying anything.
+Upload the patch like a full image, with tools/ota_upload.py or on the
+/ota page; the device tells the two apart by the first bytes.
+
+The format is described in include/DeltaDecoder.h. Matching follows bsdiff
+(Colin Percival, "Naive differences of executable code"): stretches of the
+new image are paired with stretches of the old one that mostly agree, and
+only the byte differences are stored, so code that merely moved costs
+little even though its addresses changed. bsdiff then compresses with
+bzip2, which needs far more RAM than the device can spare while flashing;
+here the differences, mostly zero, are run-length coded instead, which the
+device undoes with a few hundred bytes.
+
+Exact matches are found through a hash of K-byte keys taken every STEP
+bytes of the old image, so matches shorter than K + STEP - 1 bytes may be
+missed; that only costs patch size. The patch is applied here again and
+compared with new.bin before it is written.
+"""
+
+import argparse
+import hashlib
+import re
+import struct
+import sys
+import time
+
+MAGIC = b"NBD1"
+K = 8                       # Bytes per hash key
+STEP = 4                    # Old image positions indexed
+MAX_CANDIDATES = 16         # Old positions kept per key
+MIN_ZERO_RUN = 3            # Shorter unchanged stretches stay inside an add token
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        out.append(byte | 0x80 if value else byte)
+        if not value:
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) ^ (value >> 63)
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+class Matcher:
+    def __init__(self, old, new):
+        self.old = old
+        self.new = new
+        self.index = {}
+        for i in range(0, len(old) - K + 1, STEP):
+            positions = self.index.setdefault(old[i:i + K], [])
+            if len(positions) < MAX_CANDIDATES:
+                positions.append(i)
+
+    def match_length(self, old_pos, new_pos):
+        """Length of the common prefix of old[old_pos:] and new[new_pos:]."""
+        old, new = self.old, self.new
+        limit = min(len(old) - old_pos, len(new) - new_pos)
+        matched = 0
+        step = 64
+        while matched < limit:
+            count = min(step, limit - matched)
+            if old[old_pos + matched:old_pos + matched + count] == new[new_pos + matched:new_pos + matched + count]:
+                matched += count
+                step *= 2
+                continue
+            # The first mismatch is in [matched, matched + count)
+            high = matched + count
+            while high - matched > 1:
+                middle = (matched + high) // 2
+                if old[old_pos + matched:old_pos + middle] == new[new_pos + matched:new_pos + middle]:
+                    matched = middle
+                else:
+                    high = middle
+            return matched
+        return matched
+
+    def search(self, scan):
+        """Longest exact match of new[scan:] in old, as (length, old position)."""
+        best_length, best_pos = 0, 0
+        for shift in range(STEP):
+            for candidate in self.index.get(self.new[scan + shift:scan + shift + K], ()):
+                pos = candidate - shift
+                if pos < 0:
+                    continue
+                length = self.match_length(pos, scan)
+                if length > best_length:
+                    best_length, best_pos = length, pos
+        return best_length, best_pos
+
+
+def encode_diff(diff):
+    """Diff bytes as tokens: (n << 1) for n unchanged bytes, (n << 1) | 1 followed by n added bytes."""
+    out = bytearray()
+    at = 0
+    for run in re.finditer(b"\x00{%d,}" % MIN_ZERO_RUN, diff):
+        if run.start() > at:
+            out += varint(((run.start() - at) << 1) | 1) + diff[at:run.start()]
+        out += varint((run.end() - run.start()) << 1)
+        at = run.end()
+    if at < len(diff):
+        out += varint(((len(diff) - at) << 1) | 1) + diff[at:]
+    return bytes(out)
+
+
+def make_patch(old, new):
+    matcher = Matcher(old, new)
+    old_size, new_size = len(old), len(new)
+    out = bytearray(MAGIC)
+    out += struct.pack("<I", old_size) + hashlib.sha256(old).digest()
+    out += struct.pack("<I", new_size) + hashlib.sha256(new).digest()
+    blocks = 0
+
+    # bsdiff's main loop, with the suffix array search replaced by Matcher.search()
+    scan = length = pos = 0
+    last_scan = last_pos = last_offset = 0
+    while scan < new_size:
+        old_score = 0
+        scan += length
+        scsc = scan
+        while scan < new_size:
+            length, pos = matcher.search(scan)
+            while scsc < scan + length:
+                if scsc + last_offset < old_size and old[scsc + last_offset] == new[scsc]:
+                    old_score += 1
+                scsc += 1
+            if (length == old_score and length != 0) or length > old_score + 8:
+                break
+            if scan + last_offset < old_size and old[scan + last_offset] == new[scan]:
+                old_score -= 1
+            scan += 1
+
+        if length == old_score and scan != new_size:
+            continue
+
+        # Extend the previous match forwards and this one backwards while they mostly agree
+        score = best = length_forward = 0
+        i = 0
+        while last_scan + i < scan and last_pos + i < old_size:
+            if old[last_pos + i] == new[last_scan + i]:
+                score += 1
+            i += 1
+            if score * 2 - i > best * 2 - length_forward:
+                best, length_forward = score, i
+
+        length_back = 0
+        if scan < new_size:
+            score = best = 0
+            i = 1
+            while scan >= last_scan + i and pos >= i:
+                if old[pos - i] == new[scan - i]:
+                    score += 1
+                if score * 2 - i > best * 2 - length_back:
+                    best, length_back = score, i
+                i += 1
+
+        if last_scan + length_forward > scan - length_back:
+            overlap = (last_scan + length_forward) - (scan - length_back)
+            score = best = split = 0
+            for i in range(overlap):
+                if new[last_scan + length_forward - overlap + i] == old[last_pos + length_forward - overlap + i]:
+                    score += 1
+                if new[scan - length_back + i] == old[pos - length_back + i]:
+                    score -= 1
+                if score > best:
+                    best, split = score, i + 1
+            length_forward += split - overlap
+            length_back -= split
+
+        diff = bytes((new[last_scan + i] - old[last_pos + i]) & 0xFF for i in range(length_forward))
+        extra = new[last_scan + length_forward:scan - length_back]
+        seek = (pos - length_back) - (last_pos + length_forward)
+        out += varint(length_forward) + varint(len(extra)) + varint(zigzag(seek))
+        out += encode_diff(diff) + extra
+        blocks += 1
+
+        last_scan = scan - length_back
+        last_pos = pos - length_back
+        last_offset = pos - scan
+
+    return bytes(out), blocks
+
+
+def read_varint(patch, at):
+    value = shift = 0
+    while True:
+        byte = patch[at]
+        at += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, at
+
+
+def apply_patch(old, patch):
+    """What the device does, for checking: returns the new image."""
+    if patch[:4] != MAGIC:
+        raise ValueError("not an NBD1 patch")
+    old_size, = struct.unpack_from("<I", patch, 4)
+    new_size, = struct.unpack_from("<I", patch, 40)
+    if old_size != len(old) or patch[8:40] != hashlib.sha256(old).digest():
+        raise ValueError("patch is for a different source image")
+    out = bytearray()
+    at = 76
+    old_pos = 0
+    while len(out) < new_size:
+        diff_length, at = read_varint(patch, at)
+        extra_length, at = read_varint(patch, at)
+        seek, at = read_varint(patch, at)
+        end = old_pos + diff_length
+        while old_pos < end:
+            token, at = read_varint(patch, at)
+            count = token >> 1
+            if token & 1:
+                out += bytes((old[old_pos + i] + patch[at + i]) & 0xFF for i in range(count))
+                at += count
+            else:
+                out += old[old_pos:old_pos + count]
+            old_pos += count
+        out += patch[at:at + extra_length]
+        at += extra_length
+        old_pos += unzigzag(seek)
+    if at != len(patch):
+        raise ValueError("data after the end of the patch")
+    if hashlib.sha256(out).digest() != patch[44:76]:
+        raise ValueError("result does not match the target SHA-256")
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("old", help="image the device runs now")
+    parser.add_argument("new", help="image to install")
+    parser.add_argument("patch", help="output")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    started = time.monotonic()
+    patch, blocks = make_patch(old, new)
+    elapsed = time.monotonic() - started
+    if apply_patch(old, patch) != new:
+        print("internal error: the patch does not rebuild the new image", file=sys.stderr)
+        return 1
+
+    with open(args.patch, "wb") as f:
+        f.write(patch)
+    print(f"{args.patch}: {len(patch)} bytes for a {len(new)} byte image ({len(new) / len(patch):.1f}x smaller), "
+          f"{blocks} blocks, {elapsed:.1f} s")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,820 @@
+/**
+ * @file mqtt_check.cpp
+ * @brief Host checks for MqttClient and TelemetrySpool
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Drives the spool and the client the way TelemetryPublisher does: records
+ * go into the spool, batches of it are published at QoS 1 and acknowledged
+ * out of it on PUBACK, and the session is restarted with a backoff when it
+ * is lost.
+ *
+ * Without arguments: an in-process broker over a simulated link that takes
+ * partial writes, stalls, loses 10% of the PUBACKs and drops the connection
+ * now and then.
+ *   1. Two days with a few hours of outage: every record reaches the broker
+ *      at least once, nothing is dropped.
+ *   2. Four days of outage with an event every two minutes and a restart
+ *      halfway: flash never holds more than TELEMETRY_FLASH_SEGMENTS
+ *      segments, every record that does not arrive is counted as dropped
+ *      (or was in RAM at the restart), the events that do arrive are the
+ *      newest ones, and sequence numbers keep increasing across the restart.
+ * Every payload must be valid JSON of the documented shape and fit
+ * TELEMETRY_PAYLOAD_MAX, and no single step may take long enough to hold
+ * up the alarm loop.
+ *
+ * With a broker: publishes through a real TCP connection and checks with a
+ * second, subscribing connection that every record arrives, e.g.
+ *   python3 tools/mqtt_standin.py --port 18830 --drop-ack 0.1 --disconnect-every 7
+ *   ./mqtt_check 127.0.0.1 18830
+ * (or mosquitto on port 1883).
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Iinclude tools/mqtt_check.cpp src/MqttClient.cpp \
+ *       src/TelemetrySpool.cpp src/JsonWriter.cpp -o mqtt_check
+ *   ./mqtt_check
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "MqttClient.h"
+#include "TelemetrySpool.h"
+
+#define SPOOL_DIRECTORY "/tmp/mqtt_check_spool"
+#define TOPIC "nightybyte/check/telemetry"
+#define STEP_MS 200
+#define STEP_LIMIT_US 20000         // Far more than a step needs, far less than the alarm loop tolerates
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static double uniform(double low, double high) {
+    return low + (high - low) * (double)rand() / RAND_MAX;
+}
+
+static void clearDirectory(const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] != '.') {
+            std::string file = std::string(path) + "/" + entry->d_name;
+            remove(file.c_str());
+        }
+    }
+    closedir(dir);
+}
+
+static int countSegments(const char* path) {
+    int count = 0;
+    DIR* dir = opendir(path);
+    if (!dir) {
+        return 0;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strstr(entry->d_name, ".tlm")) {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+// --- Payloads ----------------------------------------------------------------
+
+struct PayloadParser {
+    const char* p;
+    const char* end;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\n')) p++;
+    }
+    bool value() {
+        skipSpace();
+        if (p >= end) return false;
+        if (*p == '{') {
+            p++;
+            skipSpace();
+            if (p < end && *p == '}') { p++; return true; }
+            for (;;) {
+                skipSpace();
+                if (!string()) return false;
+                skipSpace();
+                if (p >= end || *p++ != ':') return false;
+                if (!value()) return false;
+                skipSpace();
+                if (p < end && *p == ',') { p++; continue; }
+                return p < end && *p++ == '}';
+            }
+        }
+        if (*p == '[') {
+            p++;
+            skipSpace();
+            if (p < end && *p == ']') { p++; return true; }
+            for (;;) {
+                if (!value()) return false;
+                skipSpace();
+                if (p < end && *p == ',') { p++; continue; }
+                return p < end && *p++ == ']';
+            }
+        }
+        if (*p == '"') return string();
+        char* stop;
+        strtod(p, &stop);
+        if (stop == p) return false;
+        p = stop;
+        return true;
+    }
+    bool string() {
+        if (p >= end || *p++ != '"') return false;
+        while (p < end && *p != '"') {
+            if (*p == '\\') p++;
+            p++;
+        }
+        return p < end && *p++ == '"';
+    }
+};
+
+// Validates the JSON and its shape; returns the sequence numbers of the records in it
+static bool parsePayload(const uint8_t* data, size_t length, std::vector<uint32_t>& sequences) {
+    const char* text = (const char*)data;
+    PayloadParser parser = {text, text + length};
+    if (!parser.value()) {
+        return false;
+    }
+    parser.skipSpace();
+    if (parser.p != parser.end) {
+        return false;
+    }
+
+    std::string json(text, length);
+    size_t at = json.find("\"r\":[");
+    if (json.compare(0, 8, "{\"dev\":\"") != 0 || at == std::string::npos) {
+        return false;
+    }
+    const char* p = json.c_str() + at + 5;
+    while (*p == '[') {
+        char* stop;
+        unsigned long sequence = strtoul(p + 1, &stop, 10);
+        if (*stop != ',') return false;
+        strtoul(stop + 1, &stop, 10);
+        if (stop[0] != ',' || stop[1] != '"') return false;
+        sequences.push_back((uint32_t)sequence);
+        p = strchr(stop, ']');
+        if (!p) return false;
+        p++;
+        if (*p == ',') p++;
+    }
+    return *p == ']';
+}
+
+// --- Publisher ---------------------------------------------------------------
+
+// What TelemetryPublisher does with the spool and the client, minus the socket
+struct Publisher {
+    TelemetrySpool* spool;
+    MqttClient mqtt;
+    bool batchInFlight;
+    uint32_t batchLastSequence;
+    uint32_t nextAttempt;
+    uint32_t batches;
+    uint32_t records;
+    uint32_t sessions;
+    uint32_t lost;
+    char payload[TELEMETRY_PAYLOAD_MAX];
+
+    Publisher() : spool(nullptr), batchInFlight(false), batchLastSequence(0), nextAttempt(0),
+                  batches(0), records(0), sessions(0), lost(0) {}
+
+    // Returns false when the session was lost and the transport has to be closed
+    bool step(uint32_t now) {
+        MqttEvent event = mqtt.update(now);
+        if (event == MQTT_LOST) {
+            batchInFlight = false;
+            lost++;
+            nextAttempt = now + MQTT_RETRY_MIN_MS;
+            return false;
+        }
+        if (event == MQTT_PUBLISHED) {
+            spool->acknowledge(batchLastSequence);
+            batchInFlight = false;
+        }
+        if (!batchInFlight && mqtt.canPublish()) {
+            TelemetryRecord batch[TELEMETRY_BATCH_RECORDS];
+            size_t count = spool->peek(batch, TELEMETRY_BATCH_RECORDS);
+            size_t length = 0;
+            size_t encoded = count ? TelemetrySpool::encodeBatch("check", batch, count, payload, sizeof(payload), &length) : 0;
+            check(count == 0 || encoded > 0, "a batch encodes");
+            if (encoded > 0 && mqtt.publish(TOPIC, (const uint8_t*)payload, length, now)) {
+                batchInFlight = true;
+                batchLastSequence = batch[encoded - 1].sequence;
+                batches++;
+                records += encoded;
+            }
+        }
+        return true;
+    }
+};
+
+// --- Simulation --------------------------------------------------------------
+
+struct SimBroker {
+    bool connected;
+    double dropAck;
+    double stallChance;
+    std::vector<uint8_t> toBroker;
+    std::vector<uint8_t> toClient;
+    std::vector<uint32_t> delivered;        // Counts per sequence number
+    uint32_t published;
+    uint32_t acksDropped;
+    bool badPayload;
+    size_t largestPayload;
+
+    void reply(const uint8_t* data, size_t length) {
+        toClient.insert(toClient.end(), data, data + length);
+    }
+
+    void process() {
+        for (;;) {
+            if (toBroker.size() < 2) return;
+            size_t remaining = 0;
+            size_t header = 1;
+            for (int shift = 0;; shift += 7) {
+                if (header >= toBroker.size()) return;
+                uint8_t byte = toBroker[header++];
+                remaining |= (size_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            if (toBroker.size() < header + remaining) return;
+            const uint8_t* body = &toBroker[header];
+
+            switch (toBroker[0]) {
+                case 0x10: {
+                    check(remaining >= 12 && memcmp(body, "\0\4MQTT\4", 7) == 0, "CONNECT is MQTT 3.1.1");
+                    uint8_t connack[4] = {0x20, 2, 0, 0};
+                    reply(connack, 4);
+                    break;
+                }
+                case 0x32: {
+                    size_t topicLength = (size_t)body[0] << 8 | body[1];
+                    check(topicLength == strlen(TOPIC) && memcmp(body + 2, TOPIC, topicLength) == 0, "PUBLISH topic");
+                    const uint8_t* id = body + 2 + topicLength;
+                    const uint8_t* payload = id + 2;
+                    size_t length = remaining - (payload - body);
+                    if (length > largestPayload) largestPayload = length;
+
+                    std::vector<uint32_t> sequences;
+                    if (!parsePayload(payload, length, sequences)) {
+                        badPayload = true;
+                    }
+                    for (size_t i = 0; i < sequences.size(); i++) {
+                        if (sequences[i] >= delivered.size()) delivered.resize(sequences[i] + 1, 0);
+                        delivered[sequences[i]]++;
+                    }
+                    published++;
+                    if (uniform(0, 1) < dropAck) {
+                        acksDropped++;
+                    } else {
+                        uint8_t puback[4] = {0x40, 2, id[0], id[1]};
+                        reply(puback, 4);
+                    }
+                    break;
+                }
+                case 0xC0: {
+                    uint8_t pingresp[2] = {0xD0, 0};
+                    reply(pingresp, 2);
+                    break;
+                }
+                default:
+                    check(false, "client sends only CONNECT, PUBLISH and PINGREQ");
+                    break;
+            }
+            toBroker.erase(toBroker.begin(), toBroker.begin() + header + remaining);
+        }
+    }
+
+    void open() {
+        connected = true;
+        toBroker.clear();
+        toClient.clear();
+    }
+};
+
+static int simSend(void* context, const uint8_t* data, size_t length) {
+    SimBroker* broker = static_cast<SimBroker*>(context);
+    if (!broker->connected) return -1;
+    if (uniform(0, 1) < broker->stallChance) return 0;     // Socket buffer full
+
+    size_t taken = 1 + (size_t)(uniform(0, 1) * length);
+    if (taken > length) taken = length;
+    broker->toBroker.insert(broker->toBroker.end(), data, data + taken);
+    broker->process();
+    return (int)taken;
+}
+
+static int simReceive(void* context, uint8_t* data, size_t capacity) {
+    SimBroker* broker = static_cast<SimBroker*>(context);
+    if (!broker->connected) return -1;
+    if (broker->toClient.empty()) return 0;
+
+    size_t given = 1 + (size_t)(uniform(0, 1) * broker->toClient.size());
+    if (given > capacity) given = capacity;
+    if (given > broker->toClient.size()) given = broker->toClient.size();
+    memcpy(data, broker->toClient.data(), given);
+    broker->toClient.erase(broker->toClient.begin(), broker->toClient.begin() + given);
+    return (int)given;
+}
+
+struct Outage {
+    uint32_t startMs;
+    uint32_t endMs;
+};
+
+struct ScenarioResult {
+    std::vector<uint8_t> kinds;         // Per sequence number, 0xFF when never pushed
+    std::vector<uint32_t> pushedAt;
+    std::vector<bool> lostAtRestart;
+    uint32_t droppedEvents;             // Over both lives of the spool
+    uint32_t droppedMetrics;
+};
+
+static bool arrivedAt(const SimBroker& broker, uint32_t sequence) {
+    return sequence < broker.delivered.size() && broker.delivered[sequence] > 0;
+}
+
+// Sequence numbers in the segment files, read the way the spool writes them
+static std::vector<bool> sequencesInFlash(size_t limit) {
+    std::vector<bool> inFlash(limit, false);
+    DIR* dir = opendir(SPOOL_DIRECTORY);
+    struct dirent* entry;
+    while (dir && (entry = readdir(dir)) != nullptr) {
+        if (!strstr(entry->d_name, ".tlm")) continue;
+        std::string file = std::string(SPOOL_DIRECTORY) + "/" + entry->d_name;
+        FILE* in = fopen(file.c_str(), "rb");
+        TelemetryRecord record;
+        while (in && fread(&record, sizeof(record), 1, in) == 1) {
+            if (record.sequence < limit) inFlash[record.sequence] = true;
+        }
+        if (in) fclose(in);
+    }
+    if (dir) closedir(dir);
+    return inFlash;
+}
+
+static void runScenario(const char* name, uint32_t durationMs, const Outage* outages, int outageCount,
+                        uint32_t eventEveryMs, uint32_t restartAtMs, SimBroker& broker, ScenarioResult& result) {
+    clearDirectory(SPOOL_DIRECTORY);
+    TelemetrySpool* spool = new TelemetrySpool();
+    check(spool->begin(SPOOL_DIRECTORY, 1), "spool opens its directory");
+
+    Publisher publisher;
+    publisher.spool = spool;
+    publisher.mqtt.begin(simSend, simReceive, &broker);
+    publisher.mqtt.setClientId("nb-check");
+
+    result.kinds.clear();
+    result.pushedAt.clear();
+    result.lostAtRestart.clear();
+    result.droppedEvents = 0;
+    result.droppedMetrics = 0;
+    long maxStepUs = 0;
+    uint32_t reserved = spool->getNextSequence() + TELEMETRY_SEQUENCE_BLOCK;
+    uint32_t lastSequence = 0;
+    bool sequencesIncrease = true;
+    int maxSegments = 0;
+
+    uint32_t nextMetrics = 0;
+    uint32_t nextEvent = eventEveryMs / 2;
+    bool restarted = false;
+
+    for (uint32_t now = 0; now < durationMs; now += STEP_MS) {
+        bool linkUp = true;
+        for (int i = 0; i < outageCount; i++) {
+            if (now >= outages[i].startMs && now < outages[i].endMs) linkUp = false;
+        }
+
+        if (restartAtMs && !restarted && now >= restartAtMs) {
+            // RAM is gone; flash and the reserved sequence block survive
+            // RAM holds the newest events that are neither at the broker nor in flash, and the newest
+            // metrics that are not at the broker (older ones were dropped or sent)
+            restarted = true;
+            size_t flashBefore = spool->flashSize();
+            std::vector<bool> inFlash = sequencesInFlash(result.kinds.size());
+            size_t eventsInRam = spool->eventCount() - spool->flashSize();
+            size_t metricsInRam = spool->ramSize() - eventsInRam;
+            for (uint32_t s = lastSequence; s > 0; s--) {
+                if (result.kinds[s] == 0xFF || arrivedAt(broker, s) || inFlash[s]) continue;
+                size_t& inRam = result.kinds[s] == TELEMETRY_METRICS ? metricsInRam : eventsInRam;
+                if (inRam > 0) {
+                    result.lostAtRestart[s] = true;
+                    inRam--;
+                }
+            }
+            result.droppedEvents += spool->getDroppedEvents();
+            result.droppedMetrics += spool->getDroppedMetrics();
+            delete spool;
+            spool = new TelemetrySpool();
+            check(spool->begin(SPOOL_DIRECTORY, reserved), "spool reopens after a restart");
+            check(spool->flashSize() == flashBefore, "flash records survive a restart");
+            check(spool->getNextSequence() > lastSequence, "sequence numbers continue after a restart");
+            reserved = spool->getNextSequence() + TELEMETRY_SEQUENCE_BLOCK;
+            publisher = Publisher();
+            publisher.spool = spool;
+            publisher.mqtt.begin(simSend, simReceive, &broker);
+            broker.connected = false;
+        }
+
+        auto started = std::chrono::steady_clock::now();
+
+        // Records, as the event handlers and sampleMetrics() make them
+        TelemetryKind kind = TELEMETRY_METRICS;
+        bool push = false;
+        if (now >= nextMetrics) {
+            nextMetrics += TELEMETRY_METRICS_INTERVAL_MS;
+            push = true;
+        } else if (now >= nextEvent) {
+            nextEvent += eventEveryMs / 2 + (uint32_t)uniform(0, eventEveryMs);
+            kind = (TelemetryKind)(1 + rand() % 4);
+            push = true;
+        }
+        if (push) {
+            int32_t values[4] = {rand() % 4096, 3000 + rand() % 1200, 150000 + rand() % 50000, -40 - rand() % 50};
+            uint32_t sequence = spool->push(kind, 1760000000 + now / 1000, values, kind == TELEMETRY_METRICS ? 4 : 3);
+            sequencesIncrease = sequencesIncrease && sequence > lastSequence;
+            lastSequence = sequence;
+            if (sequence >= result.kinds.size()) {
+                result.kinds.resize(sequence + 1, 0xFF);
+                result.pushedAt.resize(sequence + 1, 0);
+                result.lostAtRestart.resize(sequence + 1, false);
+            }
+            result.kinds[sequence] = kind;
+            result.pushedAt[sequence] = now;
+            if (spool->getNextSequence() + TELEMETRY_BATCH_RECORDS >= reserved) {
+                reserved = spool->getNextSequence() + TELEMETRY_SEQUENCE_BLOCK;
+            }
+        }
+
+        // Link: down for outages and now and then on its own; reconnect when there is something to send
+        if (!linkUp || (broker.connected && uniform(0, 1) < 0.0005)) {
+            broker.connected = false;
+        }
+        if (publisher.mqtt.getState() == MQTT_DISCONNECTED && !broker.connected && linkUp && !spool->isEmpty() &&
+            (int32_t)(now - publisher.nextAttempt) >= 0) {
+            broker.open();
+            publisher.mqtt.startSession(now);
+            publisher.sessions++;
+        }
+        if (publisher.mqtt.getState() != MQTT_DISCONNECTED && !publisher.step(now)) {
+            broker.connected = false;
+        }
+
+        long elapsed = (long)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started).count();
+        if (elapsed > maxStepUs) maxStepUs = elapsed;
+
+        int segments = countSegments(SPOOL_DIRECTORY);
+        if (segments > maxSegments) maxSegments = segments;
+    }
+
+    // Let whatever is left drain
+    for (uint32_t now = durationMs; !spool->isEmpty() && now < durationMs + 3600000UL; now += STEP_MS) {
+        if (publisher.mqtt.getState() == MQTT_DISCONNECTED && (int32_t)(now - publisher.nextAttempt) >= 0) {
+            broker.open();
+            publisher.mqtt.startSession(now);
+        }
+        if (publisher.mqtt.getState() != MQTT_DISCONNECTED && !publisher.step(now)) {
+            broker.connected = false;
+        }
+    }
+    check(spool->isEmpty(), "the spool drains once the link is back");
+    check(sequencesIncrease, "sequence numbers only increase");
+    check(maxSegments <= TELEMETRY_FLASH_SEGMENTS, "flash holds at most TELEMETRY_FLASH_SEGMENTS segments");
+    check(!broker.badPayload, "every payload is valid JSON of the documented shape");
+    check(broker.largestPayload <= TELEMETRY_PAYLOAD_MAX, "payloads fit TELEMETRY_PAYLOAD_MAX");
+    check(maxStepUs < STEP_LIMIT_US, "no step takes long");
+    result.droppedEvents += spool->getDroppedEvents();
+    result.droppedMetrics += spool->getDroppedMetrics();
+
+    // Everything pushed either arrived or is accounted for
+    uint32_t events = 0, metrics = 0, missingEvents = 0, missingMetrics = 0, restartLoss = 0, duplicates = 0;
+    for (uint32_t s = 0; s < result.kinds.size(); s++) {
+        if (result.kinds[s] == 0xFF) continue;
+        bool arrived = arrivedAt(broker, s);
+        if (arrived && broker.delivered[s] > 1) duplicates += broker.delivered[s] - 1;
+        if (result.kinds[s] == TELEMETRY_METRICS) metrics++; else events++;
+        if (arrived) continue;
+        if (result.lostAtRestart[s]) {
+            restartLoss++;
+        } else if (result.kinds[s] == TELEMETRY_METRICS) {
+            missingMetrics++;
+        } else {
+            missingEvents++;
+        }
+    }
+    check(missingEvents == result.droppedEvents, "every event that did not arrive is counted as dropped");
+    check(missingMetrics == result.droppedMetrics, "every metric that did not arrive is counted as dropped");
+
+    printf("%s: %u events, %u metrics; %u batches in %u sessions, %u records (%u repeated), %u acks lost\n",
+           name, events, metrics, publisher.batches, publisher.sessions, publisher.records, duplicates, broker.acksDropped);
+    printf("  dropped %u events, %u metrics, %u lost in RAM at restart; max %d segments, payload max %zu bytes, "
+           "step max %ld us\n", result.droppedEvents, result.droppedMetrics, restartLoss, maxSegments,
+           broker.largestPayload, maxStepUs);
+    delete spool;
+}
+
+static SimBroker newBroker() {
+    SimBroker broker;
+    broker.connected = false;
+    broker.dropAck = 0.1;
+    broker.stallChance = 0.2;
+    broker.published = 0;
+    broker.acksDropped = 0;
+    broker.badPayload = false;
+    broker.largestPayload = 0;
+    return broker;
+}
+
+static void simulate() {
+    // Encoder: a worst-case record fits on its own, a batch of typical ones mostly fits whole
+    TelemetryRecord worst;
+    memset(&worst, 0, sizeof(worst));
+    worst.sequence = 0xFFFFFFFF;
+    worst.timestamp = 0xFFFFFFFF;
+    worst.kind = TELEMETRY_BEDTIME;
+    worst.valueCount = TELEMETRY_MAX_VALUES;
+    for (int i = 0; i < TELEMETRY_MAX_VALUES; i++) worst.values[i] = -2147483647 - 1;
+    TelemetryRecord many[TELEMETRY_BATCH_RECORDS];
+    for (int i = 0; i < TELEMETRY_BATCH_RECORDS; i++) many[i] = worst;
+    char out[TELEMETRY_PAYLOAD_MAX];
+    size_t length = 0;
+    size_t encoded = TelemetrySpool::encodeBatch("0123456789ab", many, TELEMETRY_BATCH_RECORDS, out, sizeof(out), &length);
+    std::vector<uint32_t> sequences;
+    check(encoded > 0 && length <= sizeof(out), "worst-case records encode");
+    check(parsePayload((const uint8_t*)out, length, sequences) && sequences.size() == encoded,
+          "a truncated batch is still valid JSON");
+    check(TelemetrySpool::encodeBatch("0123456789ab", many, 1, out, 40, &length) == 0, "a record that does not fit is refused");
+
+    // 1. Two days, three outages of a few hours
+    {
+        SimBroker broker = newBroker();
+        ScenarioResult result;
+        Outage outages[] = {{3600000UL, 4 * 3600000UL}, {20 * 3600000UL, 24 * 3600000UL}, {40 * 3600000UL, 41 * 3600000UL}};
+        runScenario("Short outages", 48 * 3600000UL, outages, 3, 600000UL, 0, broker, result);
+        check(result.droppedEvents == 0 && result.droppedMetrics == 0, "nothing is dropped over a few hours of outage");
+    }
+
+    // 2. Four days without a broker, a restart halfway
+    {
+        SimBroker broker = newBroker();
+        ScenarioResult result;
+        Outage outages[] = {{3600000UL, 97 * 3600000UL}};
+        runScenario("Long outage", 100 * 3600000UL, outages, 1, 120000UL, 49 * 3600000UL, broker, result);
+        check(result.droppedEvents > 0, "a long outage drops events");
+
+        // Of the events from during the outage, the ones that arrive are the newest
+        bool seenDelivered = false;
+        bool suffix = true;
+        for (uint32_t s = 0; s < result.kinds.size(); s++) {
+            if (result.kinds[s] == 0xFF || result.kinds[s] == TELEMETRY_METRICS || result.lostAtRestart[s] ||
+                result.pushedAt[s] < outages[0].startMs || result.pushedAt[s] >= outages[0].endMs) {
+                continue;
+            }
+            if (arrivedAt(broker, s)) {
+                seenDelivered = true;
+            } else if (seenDelivered) {
+                suffix = false;
+            }
+        }
+        check(suffix, "the oldest events are the ones dropped");
+    }
+    clearDirectory(SPOOL_DIRECTORY);
+}
+
+// --- Real broker -------------------------------------------------------------
+
+static int connectTo(const char* host, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, host, &address.sin_addr);
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+static int socketSend(void* context, const uint8_t* data, size_t length) {
+    int sent = (int)send(*(int*)context, data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent >= 0) return sent;
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+static int socketReceive(void* context, uint8_t* data, size_t capacity) {
+    int received = (int)recv(*(int*)context, data, capacity, MSG_DONTWAIT);
+    if (received > 0) return received;
+    if (received == 0) return -1;
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+static uint32_t millisNow() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Subscriber at QoS 0 on a blocking socket; returns the bytes of everything it gets
+struct Subscriber {
+    int fd;
+    std::vector<uint8_t> buffer;
+
+    bool start(const char* host, int port) {
+        fd = connectTo(host, port);
+        if (fd < 0) return false;
+        struct timeval timeout = {5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        static const uint8_t connectPacket[] = {0x10, 20, 0, 4, 'M', 'Q', 'T', 'T', 4, 2, 0, 60,
+                                                0, 8, 'n', 'b', '-', 'c', 'h', 'e', 'c', 'k'};
+        uint8_t subscribe[64];
+        size_t topicLength = strlen(TOPIC);
+        subscribe[0] = 0x82;
+        subscribe[1] = (uint8_t)(2 + 2 + topicLength + 1);
+        subscribe[2] = 0;
+        subscribe[3] = 1;
+        subscribe[4] = 0;
+        subscribe[5] = (uint8_t)topicLength;
+        memcpy(subscribe + 6, TOPIC, topicLength);
+        subscribe[6 + topicLength] = 0;
+        if (send(fd, connectPacket, sizeof(connectPacket), 0) != (ssize_t)sizeof(connectPacket) ||
+            send(fd, subscribe, 7 + topicLength, 0) != (ssize_t)(7 + topicLength)) {
+            return false;
+        }
+
+        // CONNACK and SUBACK
+        uint8_t reply[9];
+        size_t got = 0;
+        while (got < sizeof(reply)) {
+            ssize_t n = recv(fd, reply + got, sizeof(reply) - got, 0);
+            if (n <= 0) return false;
+            got += (size_t)n;
+        }
+        return reply[0] == 0x20 && reply[3] == 0 && reply[4] == 0x90 && reply[8] != 0x80;
+    }
+
+    // Next PUBLISH payload, false on timeout
+    bool next(std::vector<uint8_t>& payload, int timeoutMs) {
+        struct timeval timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        for (;;) {
+            if (buffer.size() >= 2) {
+                size_t remaining = 0;
+                size_t header = 1;
+                bool complete = false;
+                for (int shift = 0; header < buffer.size(); shift += 7) {
+                    uint8_t byte = buffer[header++];
+                    remaining |= (size_t)(byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) { complete = true; break; }
+                }
+                if (complete && buffer.size() >= header + remaining) {
+                    uint8_t type = buffer[0] & 0xF0;
+                    bool found = false;
+                    if (type == 0x30) {
+                        size_t topicLength = (size_t)buffer[header] << 8 | buffer[header + 1];
+                        size_t skip = 2 + topicLength + ((buffer[0] & 0x06) ? 2 : 0);
+                        payload.assign(buffer.begin() + header + skip, buffer.begin() + header + remaining);
+                        found = true;
+                    }
+                    buffer.erase(buffer.begin(), buffer.begin() + header + remaining);
+                    if (found) return true;
+                    continue;
+                }
+            }
+            uint8_t chunk[1024];
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            buffer.insert(buffer.end(), chunk, chunk + n);
+        }
+    }
+};
+
+static void useBroker(const char* host, int port) {
+    // Twice, in case the broker refuses first connections
+    Subscriber subscriber;
+    if (!subscriber.start(host, port)) {
+        close(subscriber.fd);
+        check(subscriber.start(host, port), "subscriber connects and subscribes");
+    }
+    if (failures) return;
+
+    clearDirectory(SPOOL_DIRECTORY);
+    TelemetrySpool* spool = new TelemetrySpool();
+    spool->begin(SPOOL_DIRECTORY, 1);
+
+    int publisherFd = -1;
+    Publisher publisher;
+    publisher.spool = spool;
+    publisher.mqtt.begin(socketSend, socketReceive, &publisherFd);
+    publisher.mqtt.setClientId("nb-check-pub");
+
+    // More than RAM holds, so some of it goes by way of flash
+    const uint32_t total = 400;
+    std::vector<int> received(total + 1, 0);
+    uint32_t pushed = 0;
+    uint32_t started = millisNow();
+    uint32_t arrived = 0;
+    long maxStepUs = 0;
+    bool badPayload = false;
+
+    while (millisNow() - started < 120000) {
+        uint32_t now = millisNow();
+        if (pushed < total) {
+            for (int i = 0; i < 10 && pushed < total; i++) {
+                int32_t values[3] = {(int32_t)pushed, 1, 2};
+                spool->push((TelemetryKind)(1 + pushed % 4), 1760000000 + pushed, values, 3);
+                pushed++;
+            }
+        }
+
+        auto stepStarted = std::chrono::steady_clock::now();
+        if (publisher.mqtt.getState() == MQTT_DISCONNECTED && !spool->isEmpty() &&
+            (int32_t)(now - publisher.nextAttempt) >= 0) {
+            if (publisherFd >= 0) close(publisherFd);
+            publisherFd = connectTo(host, port);
+            if (publisherFd >= 0) {
+                fcntl(publisherFd, F_SETFL, fcntl(publisherFd, F_GETFL, 0) | O_NONBLOCK);
+                publisher.mqtt.startSession(now);
+                publisher.sessions++;
+            } else {
+                publisher.nextAttempt = now + 1000;
+            }
+        }
+        if (publisher.mqtt.getState() != MQTT_DISCONNECTED && !publisher.step(now)) {
+            publisher.nextAttempt = now + 500;      // Reconnect quickly here; the device backs off further
+        }
+        long elapsed = (long)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - stepStarted).count();
+        if (elapsed > maxStepUs) maxStepUs = elapsed;
+
+        // Drain whatever the subscriber has without waiting long
+        std::vector<uint8_t> payload;
+        while (subscriber.next(payload, 5)) {
+            std::vector<uint32_t> sequences;
+            if (!parsePayload(payload.data(), payload.size(), sequences)) badPayload = true;
+            for (size_t i = 0; i < sequences.size(); i++) {
+                if (sequences[i] <= total && received[sequences[i]]++ == 0) arrived++;
+            }
+        }
+        if (pushed == total && spool->isEmpty() && arrived == total) break;
+    }
+
+    check(!badPayload, "every payload is valid JSON of the documented shape");
+    check(arrived == total, "every record reaches the subscriber");
+    check(spool->getDroppedEvents() == 0, "nothing is dropped");
+    check(maxStepUs < STEP_LIMIT_US, "no step takes long");
+    printf("Broker %s:%d: %u of %u records arrived, %u batches in %u sessions (%u lost), step max %ld us\n",
+           host, port, arrived, total, publisher.batches, publisher.sessions, publisher.lost, maxStepUs);
+
+    if (publisherFd >= 0) close(publisherFd);
+    close(subscriber.fd);
+    delete spool;
+    clearDirectory(SPOOL_DIRECTORY);
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3) {
+        useBroker(argv[1], atoi(argv[2]));
+    } else {
+        srand(42);
+        simulate();
+    }
+
+    printf("%s\n", failures == 0 ? "All checks passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
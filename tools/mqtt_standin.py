@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+Minimal MQTT 3.1.1 broker for testing the telemetry publisher on Linux.
+
+    python3 tools/mqtt_standin.py [--port 18830] [--drop-ack 0.1]
+                                  [--disconnect-every 7] [--refuse-first] [--quiet]
+
+Accepts CONNECT, PUBLISH at QoS 0 and 1, SUBSCRIBE (exact topics and the
+'#' and '+' wildcards), PINGREQ and DISCONNECT, and forwards publishes to
+subscribers at QoS 0. No retained messages, no sessions, no auth.
+--drop-ack swallows that fraction of PUBACKs, --disconnect-every closes the
+publisher's connection after every Nth PUBLISH (before acknowledging it)
+and --refuse-first answers the first CONNECT of each client id with
+"server unavailable". Prints one line per publish unless --quiet. Point
+tools/mqtt_check.cpp at it, or a device by setting MQTT_BROKER/MQTT_PORT in
+config.h to this machine's address.
+"""
+
+import argparse
+import random
+import socket
+import threading
+
+lock = threading.Lock()
+subscriptions = {}      # socket -> list of topic filters
+refused = set()
+publish_count = 0
+
+
+def topic_matches(pattern, topic):
+    parts = pattern.split("/")
+    levels = topic.split("/")
+    for i, part in enumerate(parts):
+        if part == "#":
+            return True
+        if i >= len(levels) or (part != "+" and part != levels[i]):
+            return False
+    return len(parts) == len(levels)
+
+
+def read_exact(conn, count):
+    data = b""
+    while len(data) < count:
+        chunk = conn.recv(count - len(data))
+        if not chunk:
+            raise ConnectionError("closed")
+        data += chunk
+    return data
+
+
+def read_packet(conn):
+    header = read_exact(conn, 1)[0]
+    remaining = 0
+    shift = 0
+    while True:
+        byte = read_exact(conn, 1)[0]
+        remaining |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            break
+    return header, read_exact(conn, remaining) if remaining else b""
+
+
+def encode_length(length):
+    out = bytearray()
+    while True:
+        byte = length & 0x7F
+        length >>= 7
+        out.append(byte | 0x80 if length else byte)
+        if not length:
+            return bytes(out)
+
+
+def forward(topic, payload):
+    body = len(topic).to_bytes(2, "big") + topic + payload
+    packet = bytes([0x30]) + encode_length(len(body)) + body
+    with lock:
+        targets = [conn for conn, filters in subscriptions.items()
+                   if any(topic_matches(f, topic.decode(errors="replace")) for f in filters)]
+    for conn in targets:
+        try:
+            conn.sendall(packet)
+        except OSError:
+            pass
+
+
+def serve(conn, address, args):
+    global publish_count
+    client_id = "?"
+    try:
+        while True:
+            header, body = read_packet(conn)
+            kind = header & 0xF0
+
+            if kind == 0x10:
+                name_length = int.from_bytes(body[0:2], "big")
+                if body[2:2 + name_length] != b"MQTT" or body[2 + name_length] != 4:
+                    conn.sendall(bytes([0x20, 2, 0, 1]))      # Unacceptable protocol version
+                    return
+                at = 2 + name_length + 4
+                id_length = int.from_bytes(body[at:at + 2], "big")
+                client_id = body[at + 2:at + 2 + id_length].decode(errors="replace")
+                if args.refuse_first and client_id not in refused:
+                    refused.add(client_id)
+                    conn.sendall(bytes([0x20, 2, 0, 3]))      # Server unavailable
+                    return
+                conn.sendall(bytes([0x20, 2, 0, 0]))
+
+            elif kind == 0x30:
+                qos = (header >> 1) & 3
+                topic_length = int.from_bytes(body[0:2], "big")
+                topic = body[2:2 + topic_length]
+                at = 2 + topic_length
+                packet_id = body[at:at + 2] if qos else b""
+                payload = body[at + len(packet_id):]
+                with lock:
+                    publish_count += 1
+                    count = publish_count
+                if not args.quiet:
+                    print(f"{client_id} {topic.decode(errors='replace')} qos{qos} {len(payload)} bytes: "
+                          f"{payload[:100].decode(errors='replace')}")
+                forward(topic, payload)
+                if args.disconnect_every and count % args.disconnect_every == 0:
+                    return
+                if qos == 1 and random.random() >= args.drop_ack:
+                    conn.sendall(bytes([0x40, 2]) + packet_id)
+
+            elif kind == 0x80:
+                packet_id = body[0:2]
+                at = 2
+                filters = []
+                while at < len(body):
+                    length = int.from_bytes(body[at:at + 2], "big")
+                    filters.append(body[at + 2:at + 2 + length].decode(errors="replace"))
+                    at += 2 + length + 1
+                with lock:
+                    subscriptions.setdefault(conn, []).extend(filters)
+                conn.sendall(bytes([0x90, 2 + len(filters)]) + packet_id + bytes([0] * len(filters)))
+
+            elif kind == 0xC0:
+                conn.sendall(bytes([0xD0, 0]))
+
+            elif kind == 0xE0:
+                return
+
+            elif kind == 0x40:
+                pass        # PUBACK from a subscriber; we only forward at QoS 0
+
+            else:
+                print(f"{client_id}: unexpected packet type {header:#04x}, closing")
+                return
+    except (ConnectionError, OSError, IndexError):
+        pass
+    finally:
+        with lock:
+            subscriptions.pop(conn, None)
+        conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=18830)
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--drop-ack", type=float, default=0.0, help="fraction of PUBACKs not sent")
+    parser.add_argument("--disconnect-every", type=int, default=0, help="close after every Nth PUBLISH")
+    parser.add_argument("--refuse-first", action="store_true", help="refuse each client's first CONNECT")
+    parser.add_argument("--quiet", action="store_true")
+    args = parser.parse_args()
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((args.bind, args.port))
+    server.listen(8)
+    print(f"MQTT stand-in on {args.bind}:{args.port}")
+    while True:
+        conn, address = server.accept()
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        threading.Thread(target=serve, args=(conn, address, args), daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+Minimal NTP server for testing SntpClient on Linux.
+
+    python3 tools/ntp_standin.py [--port 12300] [--offset 2.5] [--drift-ppm 40]
+                                 [--drop 0.1] [--delay-ms 20] [--kod] [--unsynced]
+
+Answers mode 3 requests with this machine's clock shifted by --offset seconds
+and running --drift-ppm fast. --drop loses that fraction of requests,
+--delay-ms holds each reply back, --kod sends kiss-o'-death (stratum 0, RATE)
+and --unsynced sets the leap indicator to "clock not synchronized". Point
+tools/sntp_check.cpp at it, or a device by setting NTP_SERVER/NTP_PORT in
+config.h to this machine's address.
+"""
+
+import argparse
+import random
+import socket
+import struct
+import time
+
+NTP_UNIX_OFFSET = 2208988800
+
+
+def to_ntp(seconds):
+    whole = int(seconds)
+    fraction = int((seconds - whole) * (1 << 32)) & 0xFFFFFFFF
+    return ((whole + NTP_UNIX_OFFSET) & 0xFFFFFFFF) << 32 | fraction
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=12300)
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--offset", type=float, default=0.0, help="seconds added to the local clock")
+    parser.add_argument("--drift-ppm", type=float, default=0.0, help="server clock rate error")
+    parser.add_argument("--drop", type=float, default=0.0, help="fraction of requests ignored")
+    parser.add_argument("--delay-ms", type=float, default=0.0, help="extra time before each reply")
+    parser.add_argument("--kod", action="store_true", help="answer with kiss-o'-death")
+    parser.add_argument("--unsynced", action="store_true", help="leap indicator 3 (unsynchronized)")
+    args = parser.parse_args()
+
+    start = time.time()
+
+    def server_time():
+        now = time.time()
+        return now + args.offset + (now - start) * args.drift_ppm * 1e-6
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+    print("NTP stand-in on %s:%d, offset %+.3f s, drift %+.1f ppm" % (args.bind, args.port, args.offset,
+                                                                      args.drift_ppm))
+
+    while True:
+        data, address = sock.recvfrom(512)
+        received = server_time()
+        if len(data) < 48 or data[0] & 0x07 != 3:
+            continue
+        if random.random() < args.drop:
+            print("%s: dropped" % address[0])
+            continue
+        if args.delay_ms:
+            time.sleep(args.delay_ms / 1000)
+
+        leap = 3 if args.unsynced else 0
+        stratum = 0 if args.kod else 2
+        reference_id = b"RATE" if args.kod else b"LOCL"
+        originate = data[40:48]
+        header = struct.pack("!BBbb", (leap << 6) | (4 << 3) | 4, stratum, 6, -20)
+        reply = (header + struct.pack("!II", 0, 0) + reference_id +
+                 struct.pack("!Q", to_ntp(received)) + originate +
+                 struct.pack("!QQ", to_ntp(received), to_ntp(server_time())))
+        sock.sendto(reply, address)
+        print("%s: answered" % address[0])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Upload a firmware image or delta patch to the device over HTTP and follow it
+through the restart.
+
+    python3 tools/ota_upload.py .pio/build/esp32dev/firmware.bin 192.168.1.50
+                                [--user nightybyte] [--password nightybyte2025] [--no-sha]
+
+Sends the image to POST /api/ota with its SHA-256, so the device activates it
+only if every byte arrived intact. An NBD1 patch from tools/make_delta.py is
+sent the same way; it carries the SHA-256 of the image it rebuilds. Prints the throughput seen here and the
+one the device measured, with the heap the upload took. Then waits for the
+device to come back and reports the partition it runs from and whether the
+new image is still on trial; run it again with --status later to see it
+confirmed, or the reason it was rolled back.
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import sys
+import time
+import urllib.error
+import urllib.request
+
+
+def get_status(host, timeout=5):
+    with urllib.request.urlopen(f"http://{host}/api/ota", timeout=timeout) as response:
+        return json.load(response)
+
+
+def print_status(status):
+    print(f"running {status['partition']} {status['version']} built {status['built']}"
+          f"{' (on trial)' if status['trial'] else ''}")
+    if status.get("lastRollback"):
+        print(f"last rollback: {status['lastRollback']}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image", nargs="?", help="firmware .bin (not needed with --status)")
+    parser.add_argument("host")
+    parser.add_argument("--user", default="nightybyte", help="OTA_HTTP_USER")
+    parser.add_argument("--password", default="nightybyte2025", help="OTA_PASSWORD")
+    parser.add_argument("--no-sha", action="store_true", help="leave out the SHA-256 check")
+    parser.add_argument("--status", action="store_true", help="only show what the device runs")
+    args = parser.parse_args()
+
+    if args.status:
+        print_status(get_status(args.host))
+        return 0
+    if not args.image:
+        parser.error("image is required")
+
+    with open(args.image, "rb") as image:
+        data = image.read()
+    patch = data[:4] == b"NBD1"
+    if patch:
+        image_size = int.from_bytes(data[40:44], "little")
+        digest = data[44:76].hex()
+    else:
+        image_size = len(data)
+        digest = hashlib.sha256(data).hexdigest()
+    before = get_status(args.host)
+    print_status(before)
+    if image_size > before["maxImageSize"]:
+        print(f"{image_size} bytes do not fit the {before['maxImageSize']} byte OTA partition")
+        return 1
+
+    url = f"http://{args.host}/api/ota" + ("" if args.no_sha or patch else f"?sha256={digest}")
+    credentials = base64.b64encode(f"{args.user}:{args.password}".encode()).decode()
+    request = urllib.request.Request(url, data=data, method="POST", headers={
+        "Authorization": f"Basic {credentials}",
+        "Content-Type": "application/octet-stream",     # Anything form-encoded never reaches the updater
+    })
+    print(f"uploading {len(data)} byte {'patch for a ' + str(image_size) + ' byte image' if patch else 'image'}, "
+          f"sha256 {digest}")
+    started = time.monotonic()
+    try:
+        with urllib.request.urlopen(request, timeout=120) as response:
+            result = json.load(response)
+    except urllib.error.HTTPError as error:
+        body = error.read().decode(errors="replace")
+        print(f"HTTP {error.code}: {body}")
+        return 1
+    elapsed = time.monotonic() - started
+
+    print(f"client: {elapsed * 1000:.0f} ms, {len(data) / elapsed / 1024:.1f} KB/s")
+    print(f"device: {result['imageBytes']} bytes written in {result['ms']} ms, "
+          f"{result['bytesPerSecond'] / 1024:.1f} KB/s received, "
+          f"{result['bufferBytes']} byte buffer + {result['heapUsed']} bytes heap")
+    if result["sha256"] != digest:
+        print(f"device hashed {result['sha256']}")
+        return 1
+
+    # The device restarts about a second after answering
+    print("waiting for the restart", end="", flush=True)
+    time.sleep(3)
+    for _ in range(60):
+        try:
+            after = get_status(args.host, timeout=2)
+            break
+        except OSError:
+            print(".", end="", flush=True)
+            time.sleep(2)
+    else:
+        print("\ndevice did not come back")
+        return 1
+    print()
+    print_status(after)
+    if after["partition"] == before["partition"]:
+        print("still on the old partition: the new image did not boot")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
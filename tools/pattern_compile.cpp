@@ -0,0 +1,107 @@
+/**
+ * @file pattern_compile.cpp
+ * @brief Host compiler and disassembler for buzzer patterns
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Compiles RTTTL or pattern DSL with the firmware's PatternCompiler, prints
+ * the bytecode as a PC_* listing and plays it through PatternSequencer to
+ * confirm the played length matches PatternCode::validate(). Use it to check
+ * a pattern before uploading it to /patterns.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -Iinclude tools/pattern_compile.cpp src/PatternCompiler.cpp \
+ *       src/PatternCode.cpp src/PatternSequencer.cpp src/FadePlanner.cpp -o pattern_compile
+ *   ./pattern_compile "wake:d=8,o=6,b=140:c,e,g,2c7"
+ *   ./pattern_compile -f my_pattern.txt
+ *
+ * Exits non-zero if the source does not compile.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "PatternCompiler.h"
+#include "PatternSequencer.h"
+
+static void disassemble(const uint8_t* code, uint16_t length) {
+    int indent = 1;
+    for (uint16_t pc = 0; pc < length;) {
+        uint8_t op = code[pc];
+        if (op == PC_OP_ENDLOOP) indent--;
+        printf("%4u  %*s", pc, indent * 4, "");
+
+        switch (op & 0xC0) {
+            case PC_CLASS_NOTE:
+                printf("PC_NOTE(%u, %u)    // %u Hz\n", op & 0x3F, code[pc + 1] * PC_TICK_MS,
+                       PatternCode::noteFrequency(op & 0x3F));
+                pc += 2;
+                continue;
+            case PC_CLASS_TONE:
+                printf("PC_TONE(%u, %u)\n", ((op & 0x3F) << 8) | code[pc + 1], code[pc + 2] * PC_TICK_MS);
+                pc += 3;
+                continue;
+            case PC_CLASS_REST:
+                printf("PC_REST(%u)\n", (((op & 0x3F) << 8) | code[pc + 1]) * PC_TICK_MS);
+                pc += 2;
+                continue;
+            default:
+                break;
+        }
+
+        switch (op) {
+            case PC_OP_END: printf("PC_END\n"); pc += 1; break;
+            case PC_OP_ENDLOOP: printf("PC_ENDLOOP\n"); pc += 1; break;
+            case PC_OP_LOOP: printf("PC_LOOP(%u)\n", code[pc + 1]); pc += 2; indent++; break;
+            case PC_OP_VOLUME: printf("PC_VOLUME(%u)\n", code[pc + 1]); pc += 2; break;
+            case PC_OP_GAP: printf("PC_GAP(%u)\n", code[pc + 1] * PC_TICK_MS); pc += 2; break;
+            case PC_OP_FADE: printf("PC_FADE(%u, %u)\n", code[pc + 1], code[pc + 2] * PC_TICK_MS); pc += 3; break;
+            default: printf("?? 0x%02x\n", op); pc += 1; break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    static char source[PATTERN_MAX_SOURCE + 2];
+
+    if (argc == 3 && strcmp(argv[1], "-f") == 0) {
+        FILE* file = fopen(argv[2], "rb");
+        if (!file) {
+            fprintf(stderr, "Cannot open %s\n", argv[2]);
+            return 2;
+        }
+        size_t size = fread(source, 1, sizeof(source) - 1, file);
+        fclose(file);
+        source[size] = '\0';
+    } else if (argc == 2) {
+        strncpy(source, argv[1], sizeof(source) - 1);
+    } else {
+        fprintf(stderr, "Usage: %s <source> | -f <file>\n", argv[0]);
+        return 2;
+    }
+
+    uint8_t code[PATTERN_MAX_BYTES];
+    PatternCompileResult result;
+    PatternFormat format = PatternCompiler::detectFormat(source);
+    if (!PatternCompiler::compile(source, format, code, sizeof(code), &result)) {
+        fprintf(stderr, "error at offset %u: %s\n", result.errorOffset, result.error);
+        return 1;
+    }
+
+    printf("%s, %u bytes, %u ms per pass\n", format == PATTERN_FORMAT_RTTTL ? "RTTTL" : "DSL",
+           result.length, result.durationMs);
+    disassemble(code, result.length);
+
+    // Play once on a virtual clock; the end deadline must equal the reported length
+    PatternSequencer sequencer;
+    ToneOutput output;
+    uint32_t edges = 0;
+    bool running = sequencer.start(code, result.length, false, 0, &output);
+    while (running) {
+        edges++;
+        running = sequencer.advance(&output);
+    }
+    uint64_t playedMs = sequencer.getDeadline() / 1000;
+    printf("played %llu ms in %u steps\n", (unsigned long long)playedMs, edges);
+
+    return playedMs == result.durationMs ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file radio_policy_sim.cpp
+ * @brief Host simulation of RadioPowerPolicy over a day
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Runs the policy for 24 hours from noon with a 23:00-06:30 quiet window,
+ * one-second ticks and a model of the rest of the firmware: time syncs every
+ * 2048 s that take a second once the radio is associated, an hourly
+ * telemetry flush, a web UI session at 21:00, an alarm at 06:30 and an
+ * access point that is gone from 02:00 to 03:00 (so a wake never finishes).
+ * Checks that the radio is at full power whenever an alarm or the UI needs
+ * it, never off outside the quiet window, off inside it except for short
+ * wakes, that a wake that cannot finish is cut off and held back, and that
+ * the hourly on-time report matches the simulated radio. Prints radio-on
+ * minutes per hour.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Iinclude tools/radio_policy_sim.cpp src/RadioPowerPolicy.cpp -o radio_policy_sim
+ *   ./radio_policy_sim
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <stdio.h>
+#include "RadioPowerPolicy.h"
+
+#define QUIET_START (23 * 60)
+#define QUIET_END (6 * 60 + 30)
+#define SYNC_INTERVAL_MS 2048000UL
+#define CONNECT_MS 800              // Fast reconnect to the cached access point
+#define SYNC_MS 1000                // Request out, reply in
+#define FLUSH_MS 2000
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool between(int minute, int from, int to) {
+    return minute >= from && minute < to;
+}
+
+int main() {
+    RadioPowerPolicy policy;
+    policy.setQuietWindow(QUIET_START, QUIET_END);
+
+    const uint32_t tickMs = 1000;
+    const uint32_t dayMs = 86400000UL;
+    const int startMinute = 12 * 60;
+
+    uint32_t nextSync = 0;              // Due at once: the clock has just been set
+    uint32_t nextFlush = 3600000UL;
+    uint32_t onSince = 0;               // When the radio last came on
+    uint32_t workStarted = 0;           // When the current sync or flush got the link
+    bool working = false;
+    RadioMode mode = RADIO_DOZE;
+
+    uint32_t onMsTotal = 0;
+    uint32_t quietOnMs = 0;
+    uint32_t quietMs = 0;
+    uint32_t fullOutsideDemand = 0;
+    bool alarmAtFull = true;
+    bool uiAtFull = true;
+    bool offOutsideQuiet = false;
+    bool syncsKept = true;
+    uint32_t apBackAt = 0;
+    uint32_t cutOffAt = 0;
+    bool wokeDuringHoldOff = false;
+    uint32_t lastWakeCount = 0;
+
+    for (uint32_t now = 0; now < dayMs; now += tickMs) {
+        int minute = (startMinute + now / 60000) % 1440;
+        bool apGone = between(minute, 2 * 60, 3 * 60);
+
+        // The rest of the firmware, as NetworkManager sees it
+        bool associated = mode != RADIO_OFF && now - onSince >= CONNECT_MS && !apGone;
+        bool syncDue = (int32_t)(now + RADIO_WAKE_LEAD_MS - nextSync) >= 0;
+        bool flushDue = (int32_t)(now - nextFlush) >= 0;
+        if (associated && (syncDue || flushDue)) {
+            if (!working) {
+                working = true;
+                workStarted = now;
+            } else if (now - workStarted >= (flushDue ? FLUSH_MS : SYNC_MS)) {
+                working = false;
+                if (flushDue) {
+                    nextFlush += 3600000UL;
+                } else {
+                    nextSync = now + SYNC_INTERVAL_MS;
+                }
+            }
+        }
+        if (apGone) {
+            apBackAt = now;
+        }
+        uint32_t lateFrom = (int32_t)(nextSync - apBackAt) > 0 ? nextSync : apBackAt;
+        syncsKept = syncsKept && (apGone || (int32_t)(now - lateFrom) < (int32_t)(RADIO_WAKE_RETRY_MS + 60000));
+
+        RadioDemand demand;
+        demand.allowed = true;
+        demand.alarmActive = between(minute, 6 * 60 + 30, 6 * 60 + 35);
+        demand.uiActive = between(minute, 21 * 60, 21 * 60 + 15);
+        demand.syncDue = syncDue;
+        demand.flushDue = flushDue;
+        demand.outboundPending = false;
+
+        RadioMode previous = mode;
+        mode = policy.update(now, (int16_t)minute, demand);
+        if (previous == RADIO_OFF && mode != RADIO_OFF) {
+            onSince = now;
+            working = false;
+        }
+
+        bool quiet = policy.isQuietTime((int16_t)minute);
+        if (mode != RADIO_OFF) {
+            onMsTotal += tickMs;
+        }
+        if (quiet) {
+            quietMs += tickMs;
+            if (mode != RADIO_OFF) quietOnMs += tickMs;
+        }
+        if (demand.alarmActive && mode != RADIO_FULL) alarmAtFull = false;
+        if (demand.uiActive && mode != RADIO_FULL) uiAtFull = false;
+        if (!quiet && mode == RADIO_OFF) offOutsideQuiet = true;
+        if (!quiet && mode == RADIO_FULL && !demand.alarmActive && !demand.uiActive) fullOutsideDemand += tickMs;
+
+        // A wake that could not finish is cut off and not retried straight away
+        if (policy.getCutOffCount() > 0 && cutOffAt == 0) {
+            cutOffAt = now;
+        }
+        if (cutOffAt != 0 && now - cutOffAt < RADIO_WAKE_RETRY_MS && policy.getWakeCount() != lastWakeCount) {
+            wokeDuringHoldOff = true;
+        }
+        lastWakeCount = policy.getWakeCount();
+    }
+
+    // Hourly report, oldest first; the policy counts whole ticks per uptime hour
+    uint32_t reported = 0;
+    printf("hour  radio on\n");
+    for (int hoursAgo = RADIO_HISTORY_HOURS - 1; hoursAgo >= 0; hoursAgo--) {
+        uint32_t onMs = policy.getOnTimeInHour(dayMs - 1, (uint8_t)hoursAgo);
+        int clockHour = (startMinute / 60 + 23 - hoursAgo) % 24;
+        printf("%02d:00 %6.1f min\n", clockHour, onMs / 60000.0);
+        reported += onMs;
+    }
+
+    printf("radio on       %.1f of 24 h, quiet window %.1f of %.1f h (%.2f%%)\n", onMsTotal / 3.6e6,
+           quietOnMs / 3.6e6, quietMs / 3.6e6, 100.0 * quietOnMs / quietMs);
+    printf("wakes          %u, %u cut off\n", policy.getWakeCount(), policy.getCutOffCount());
+
+    check(alarmAtFull, "full power while the alarm is active");
+    check(uiAtFull, "full power while the UI is in use");
+    check(!offOutsideQuiet, "never off outside the quiet window");
+    check(fullOutsideDemand == 0, "modem sleep outside the quiet window when idle");
+    check(quietOnMs < quietMs / 50, "radio on less than 2% of the quiet window");
+    check(policy.getWakeCount() >= 10, "woken for syncs and flushes");
+    check(policy.getCutOffCount() >= 1, "a wake that cannot finish is cut off");
+    check(!wokeDuringHoldOff, "no wake during the hold-off");
+    check(syncsKept, "syncs late by at most one hold-off once the access point is back");
+    check(reported + tickMs >= onMsTotal && reported <= onMsTotal, "hourly report matches the radio-on time");
+
+    // Power profile overrides everything, the alarm included
+    RadioDemand denied = {false, true, true, true, true, true};
+    check(policy.update(dayMs, 0, denied) == RADIO_OFF, "off when the power profile forbids the radio");
+
+    printf("%s\n", failures == 0 ? "All checks passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
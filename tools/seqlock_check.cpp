@@ -0,0 +1,145 @@
+/**
+ * @file seqlock_check.cpp
+ * @brief Host checks for SeqLockSnapshot with one writer and several readers
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * One writer thread publishes a sensor-sized struct as fast as it can, as
+ * the main loop does, while reader threads copy it out, as the AsyncTCP
+ * and WebSocket tasks do. Every field of a published value is derived from
+ * its version, so a torn copy shows. Checks that:
+ *   - every value read is whole and belongs to the version read() returns;
+ *   - each reader sees versions that never go backwards;
+ *   - an unpublished snapshot reads as version 0 with a zeroed value;
+ *   - sizes that are not a multiple of four bytes round-trip exactly.
+ * Build with -fsanitize=thread: the payload is copied through atomic
+ * words, so ThreadSanitizer should stay silent; any report is a bug.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -pthread -fsanitize=thread -Iinclude tools/seqlock_check.cpp \
+ *       -o seqlock_check
+ *   ./seqlock_check
+ *
+ * Exits non-zero if any check failed.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "SeqLockSnapshot.h"
+
+#define READERS 3
+#define PUBLISHES 200000
+
+static std::atomic<int> failures(0);
+
+static void check(bool condition, const char* what) {
+    if (!condition && failures.fetch_add(1) < 10) {
+        printf("FAIL: %s\n", what);
+    }
+}
+
+// Roughly the size of SensorReadings, with a tail that is not a whole word
+struct Payload {
+    uint32_t version;
+    int32_t values[24];
+    float level;
+    bool flags[5];
+};
+
+struct Odd {
+    uint8_t bytes[7];
+};
+
+static void fill(Payload* payload, uint32_t version) {
+    memset(payload, 0, sizeof(Payload));
+    payload->version = version;
+    for (int i = 0; i < 24; i++) {
+        payload->values[i] = (int32_t)(version * 31 + i);
+    }
+    payload->level = (float)(version % 4096);
+    for (int i = 0; i < 5; i++) {
+        payload->flags[i] = ((version >> i) & 1) != 0;
+    }
+}
+
+// Version 0 is the zeroed value the snapshot starts with
+static bool whole(const Payload& payload, uint32_t version) {
+    Payload expected;
+    fill(&expected, version);
+    if (version == 0) {
+        memset(&expected, 0, sizeof(expected));
+    }
+    return payload.version == version && memcmp(payload.values, expected.values, sizeof(expected.values)) == 0 &&
+           payload.level == expected.level && memcmp(payload.flags, expected.flags, sizeof(expected.flags)) == 0;
+}
+
+int main() {
+    static SeqLockSnapshot<Payload> snapshot;
+
+    // Before anything is published
+    Payload first;
+    memset(&first, 0xAA, sizeof(first));
+    check(snapshot.read(&first) == 0 && whole(first, 0), "unpublished reads as zero");
+
+    // Odd sizes copy exactly their own bytes
+    SeqLockSnapshot<Odd> odd;
+    Odd in = {{1, 2, 3, 4, 5, 6, 7}};
+    Odd out = {{0}};
+    check(odd.publish(in) == 1 && odd.read(&out) == 1 && memcmp(&in, &out, sizeof(Odd)) == 0, "7-byte value round-trips");
+
+    std::atomic<bool> writing(true);
+    std::atomic<uint32_t> reads(0);
+    std::atomic<uint32_t> distinct(0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.push_back(std::thread([&]() {
+            Payload payload;
+            uint32_t last = 0;
+            uint32_t count = 0;
+            uint32_t changes = 0;
+            while (writing.load(std::memory_order_relaxed)) {
+                uint32_t version = snapshot.read(&payload);
+                check(whole(payload, version), "value is whole and matches its version");
+                check(version >= last, "versions never go backwards");
+                if (version != last) {
+                    changes++;
+                }
+                last = version;
+                count++;
+            }
+            reads.fetch_add(count);
+            distinct.fetch_add(changes);
+        }));
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    Payload payload;
+    for (uint32_t version = 1; version <= PUBLISHES; version++) {
+        fill(&payload, version);
+        check(snapshot.publish(payload) == version, "publish returns the next version");
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    writing.store(false);
+    for (size_t i = 0; i < readers.size(); i++) {
+        readers[i].join();
+    }
+
+    Payload last;
+    check(snapshot.read(&last) == PUBLISHES && whole(last, PUBLISHES), "last value readable");
+    check(snapshot.changedSince(PUBLISHES - 1) && !snapshot.changedSince(PUBLISHES), "changedSince follows versions");
+
+    printf("%d publishes in %.0f ms, %u reads by %d readers seeing %u version changes\n",
+           PUBLISHES, ms, reads.load(), READERS, distinct.load());
+    printf("snapshot %zu bytes for a %zu byte value\n", sizeof(snapshot), sizeof(Payload));
+    if (failures.load() > 0) {
+        printf("%d check(s) failed\n", failures.load());
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,367 @@
+/**
+ * @file sequencer_sim.cpp
+ * @brief Host virtual-timer check for PatternSequencer step timing
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Drives PatternSequencer the way BuzzerController's esp_timer does, but from
+ * a virtual clock that delivers every callback late by a random latency. Each
+ * output edge is compared with the ideal edge computed independently from
+ * the bytecode, so both per-step error and accumulated drift are caught.
+ * Volume (VOLUME, FADE segments) is not compared: consecutive outputs at the
+ * same pitch count as one edge. tools/fade_planner_check.cpp covers volume.
+ *
+ * Also replays the race where a timer callback waits on the sequencer lock
+ * while another task stops the pattern and starts a new one: the callback
+ * must find the new sequence's deadline still ahead and leave it alone, or,
+ * if it only gets the lock after that deadline, advance exactly once. And
+ * the case where a due callback finds the lock held through a whole fade:
+ * it re-arms instead of waiting and takes the step once the lock is free.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -Iinclude tools/sequencer_sim.cpp src/PatternSequencer.cpp \
+ *       src/PatternCode.cpp src/FadePlanner.cpp -o sequencer_sim
+ *   ./sequencer_sim [max_latency_us]
+ *
+ * Exits non-zero if any edge is off by more than the injected latency bound.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "PatternSequencer.h"
+
+struct Edge {
+    uint64_t time;
+    uint32_t frequency;
+};
+
+// Same shapes as the firmware tables: rests, loops, gaps, volume and one-shots
+static const uint8_t alarmPattern[] = {
+    PC_LOOP(2),
+        PC_TONE(2000, 500), PC_REST(200),
+        PC_TONE(2500, 500), PC_REST(200),
+    PC_ENDLOOP,
+    PC_REST(800),
+    PC_END
+};
+
+static const uint8_t notificationPattern[] = {
+    PC_TONE(1500, 200), PC_REST(200),
+    PC_TONE(1500, 200),
+    PC_END
+};
+
+static const uint8_t awkwardPattern[] = {
+    PC_GAP(20),
+    PC_LOOP(3),
+        PC_NOTE(9, 10),             // Shorter than the gap: played whole
+        PC_LOOP(2),
+            PC_VOLUME(40), PC_NOTE(21, 130),
+        PC_ENDLOOP,
+    PC_ENDLOOP,
+    PC_REST(40),
+    PC_TONE(3000, 10),
+    PC_END
+};
+
+static const uint8_t pulsePattern[] = {
+    PC_VOLUME(1), PC_TONE(2000, 100),
+    PC_FADE(255, 700), PC_FADE(1, 700),
+    PC_END
+};
+
+static const uint8_t fadePattern[] = {
+    PC_GAP(30),
+    PC_TONE(1000, 200),
+    PC_FADE(200, 2550),             // Split into several hardware fades
+    PC_REST(100),
+    PC_FADE(20, 300),               // After a rest: the last tone sounds again
+    PC_NOTE(12, 50),
+    PC_END
+};
+
+static uint32_t randomLatency(uint32_t maxLatencyUs) {
+    return maxLatencyUs ? (uint32_t)(rand() % (maxLatencyUs + 1)) : 0;
+}
+
+// Ideal edges by expanding the program recursively, independent of the sequencer
+static void expand(const uint8_t* code, uint16_t from, uint16_t to, uint8_t* gap, uint32_t* lastTone,
+                   uint64_t* t, Edge* edges, int* count, int maxEdges) {
+    uint16_t pc = from;
+    while (pc < to && code[pc] != PC_OP_END && *count < maxEdges) {
+        uint8_t op = code[pc];
+        if ((op & 0xC0) == PC_CLASS_REST) {
+            edges[*count].time = *t;
+            edges[(*count)++].frequency = 0;
+            *t += (uint64_t)(((op & 0x3F) << 8) | code[pc + 1]) * 10000;
+            pc += 2;
+        } else if ((op & 0xC0) != PC_CLASS_CONTROL) {
+            bool isNote = (op & 0xC0) == PC_CLASS_NOTE;
+            uint32_t frequency = isNote ? PatternCode::noteFrequency(op & 0x3F)
+                                        : ((uint32_t)(op & 0x3F) << 8) | code[pc + 1];
+            uint32_t ticks = code[pc + (isNote ? 1 : 2)];
+            uint32_t sounding = (*gap && ticks > *gap) ? ticks - *gap : ticks;
+            *lastTone = frequency;
+            edges[*count].time = *t;
+            edges[(*count)++].frequency = frequency;
+            if (sounding < ticks && *count < maxEdges) {
+                edges[*count].time = *t + (uint64_t)sounding * 10000;
+                edges[(*count)++].frequency = 0;
+            }
+            *t += (uint64_t)ticks * 10000;
+            pc += isNote ? 2 : 3;
+        } else if (op == PC_OP_LOOP) {
+            // Find the matching ENDLOOP, then expand the body n times
+            uint16_t body = pc + 2;
+            uint16_t scan = body;
+            int nesting = 1;
+            while (scan < to) {
+                uint8_t c = code[scan];
+                if (c == PC_OP_LOOP) nesting++;
+                if (c == PC_OP_ENDLOOP && --nesting == 0) break;
+                scan += ((c & 0xC0) == PC_CLASS_TONE || c == PC_OP_FADE) ? 3
+                        : (c == PC_OP_ENDLOOP || c == PC_OP_END) ? 1 : 2;
+            }
+            for (int i = 0; i < code[pc + 1]; i++) {
+                expand(code, body, scan, gap, lastTone, t, edges, count, maxEdges);
+            }
+            pc = scan + 1;
+        } else if (op == PC_OP_FADE) {
+            edges[*count].time = *t;
+            edges[(*count)++].frequency = *lastTone;
+            *t += (uint64_t)code[pc + 2] * 10000;
+            pc += 3;
+        } else if (op == PC_OP_GAP) {
+            *gap = code[pc + 1];
+            pc += 2;
+        } else {
+            pc += (op == PC_OP_ENDLOOP) ? 1 : 2;
+        }
+    }
+}
+
+static int idealEdges(const uint8_t* code, int length, bool loop, uint64_t until, Edge* edges, int maxEdges) {
+    int count = 0;
+    uint64_t t = 0;
+    do {
+        uint8_t gap = 0;
+        uint32_t lastTone = 0;
+        expand(code, 0, (uint16_t)length, &gap, &lastTone, &t, edges, &count, maxEdges);
+    } while (loop && t < until && count < maxEdges);
+
+    if (!loop && count < maxEdges) {
+        edges[count].time = t;          // Final silence when a one-shot ends
+        edges[count++].frequency = 0;
+    }
+    return count;
+}
+
+// Drops edges that do not change the pitch, keeping the first
+static int mergeEdges(Edge* edges, int count) {
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (kept == 0 || edges[kept - 1].frequency != edges[i].frequency) {
+            edges[kept++] = edges[i];
+        }
+    }
+    return kept;
+}
+
+// BuzzerController::handleStepTimer(): a callback whose deadline is still ahead is stale
+static bool stepCallback(PatternSequencer& sequencer, uint64_t now, ToneOutput* output) {
+    if (!sequencer.isRunning() || sequencer.getDeadline() > now) {
+        return false;
+    }
+    do {
+        sequencer.advance(output);
+    } while (sequencer.isRunning() && sequencer.getDeadline() <= now);
+    return true;
+}
+
+// Edge by edge; merged duplicate outputs count as one edge
+static bool compareEdges(const char* name, Edge* ideal, int idealCount, Edge* actual, int actualCount,
+                         uint64_t durationUs, uint32_t maxLatencyUs) {
+    idealCount = mergeEdges(ideal, idealCount);
+    actualCount = mergeEdges(actual, actualCount);
+    int compared = 0;
+    uint64_t worst = 0;
+    bool ok = true;
+    for (int i = 0, j = 0; i < idealCount && j < actualCount; i++, j++) {
+        if (ideal[i].time > durationUs) break;
+        if (ideal[i].frequency != actual[j].frequency) {
+            printf("  %s: edge %d frequency %u, expected %u\n", name, i, actual[j].frequency, ideal[i].frequency);
+            ok = false;
+            break;
+        }
+        uint64_t error = actual[j].time - ideal[i].time;
+        if (actual[j].time < ideal[i].time || error > maxLatencyUs) {
+            printf("  %s: edge %d at %llu us, expected %llu us\n", name, i,
+                   (unsigned long long)actual[j].time, (unsigned long long)ideal[i].time);
+            ok = false;
+            break;
+        }
+        if (error > worst) worst = error;
+        compared++;
+    }
+
+    printf("%-14s %s  %d edges, worst error %llu us\n", name, ok ? "PASS" : "FAIL",
+           compared, (unsigned long long)worst);
+    return ok;
+}
+
+static bool run(const char* name, const uint8_t* table, int length, bool loop,
+                uint64_t durationUs, uint32_t maxLatencyUs) {
+    static Edge ideal[20000];
+    static Edge actual[20000];
+    int idealCount = idealEdges(table, length, loop, durationUs, ideal, 20000);
+
+    PatternSequencer sequencer;
+    ToneOutput output;
+    uint64_t start = 1000000;   // Arbitrary non-zero epoch
+    int actualCount = 0;
+
+    bool running = sequencer.start(table, length, loop, start, &output);
+    actual[actualCount].time = 0;
+    actual[actualCount++].frequency = output.frequency;
+
+    // Virtual esp_timer: fires at the deadline plus a random latency
+    while (running && actualCount < 20000) {
+        uint64_t fire = sequencer.getDeadline() + randomLatency(maxLatencyUs);
+        if (fire - start > durationUs) break;
+        stepCallback(sequencer, fire, &output);
+        running = sequencer.isRunning();
+        actual[actualCount].time = fire - start;
+        actual[actualCount++].frequency = output.frequency;
+    }
+
+    return compareEdges(name, ideal, idealCount, actual, actualCount, durationUs, maxLatencyUs);
+}
+
+// The alarm's timer fires, but its callback waits lockDelayUs on the sequencer lock while
+// another task stops the alarm and starts the notification; the notification must still
+// play from the moment it started
+static bool runRestartRace(const char* name, uint32_t lockDelayUs) {
+    static Edge ideal[64];
+    static Edge actual[64];
+    uint64_t durationUs = 10ULL * 1000000;
+    int idealCount = idealEdges(notificationPattern, sizeof(notificationPattern), false, durationUs, ideal, 64);
+
+    PatternSequencer sequencer;
+    ToneOutput output;
+    sequencer.start(alarmPattern, sizeof(alarmPattern), true, 1000000, &output);
+    uint64_t fire = sequencer.getDeadline();
+
+    // stopPattern() and the new start hold the lock; the old callback is blocked behind them
+    uint64_t start = fire + 100;
+    sequencer.stop();
+    sequencer.start(notificationPattern, sizeof(notificationPattern), false, start, &output);
+    int actualCount = 0;
+    actual[actualCount].time = 0;
+    actual[actualCount++].frequency = output.frequency;
+    uint64_t armed = sequencer.getDeadline();
+
+    // The stale callback gets the lock, then the new sequence's own timer runs after it
+    uint64_t late = start + lockDelayUs;
+    bool advanced = stepCallback(sequencer, late, &output);
+    if (advanced) {
+        actual[actualCount].time = late - start;
+        actual[actualCount++].frequency = output.frequency;
+    }
+    if (advanced != (armed <= late)) {
+        printf("  %s: stale callback %s\n", name, advanced ? "advanced early" : "missed a due step");
+        return false;
+    }
+    uint64_t next = armed > late ? armed : late;
+    if (stepCallback(sequencer, next, &output)) {
+        if (advanced) {
+            printf("  %s: step advanced twice for one deadline\n", name);
+            return false;
+        }
+        actual[actualCount].time = next - start;
+        actual[actualCount++].frequency = output.frequency;
+    }
+
+    while (sequencer.isRunning() && actualCount < 64) {
+        uint64_t at = sequencer.getDeadline();
+        stepCallback(sequencer, at, &output);
+        actual[actualCount].time = at - start;
+        actual[actualCount++].frequency = output.frequency;
+    }
+
+    return compareEdges(name, ideal, idealCount, actual, actualCount, durationUs, lockDelayUs);
+}
+
+// A due callback finds the lock held (a stop waiting out a fade, say) for lockDelayUs. It must not
+// wait, so it re-arms every BUZZER_LOCK_RETRY_US; the step is taken once, by the first retry after
+// the lock is free, and the steps after it keep their own deadlines
+static bool runBusyLock(const char* name, uint32_t lockDelayUs) {
+    static Edge ideal[64];
+    static Edge actual[64];
+    uint64_t durationUs = 10ULL * 1000000;
+    int idealCount = idealEdges(notificationPattern, sizeof(notificationPattern), false, durationUs, ideal, 64);
+
+    PatternSequencer sequencer;
+    ToneOutput output;
+    uint64_t start = 1000000;
+    sequencer.start(notificationPattern, sizeof(notificationPattern), false, start, &output);
+    int actualCount = 0;
+    actual[actualCount].time = 0;
+    actual[actualCount++].frequency = output.frequency;
+
+    uint64_t due = sequencer.getDeadline();
+    uint64_t released = due + lockDelayUs;
+    uint64_t fire = due;
+    int retries = 0;
+    while (fire < released) {
+        fire += BUZZER_LOCK_RETRY_US;       // Lock busy: nothing advanced, timer re-armed
+        retries++;
+    }
+    if (!stepCallback(sequencer, fire, &output) || stepCallback(sequencer, fire, &output)) {
+        printf("  %s: busy step not taken exactly once\n", name);
+        return false;
+    }
+    actual[actualCount].time = fire - start;
+    actual[actualCount++].frequency = output.frequency;
+
+    while (sequencer.isRunning() && actualCount < 64) {
+        uint64_t at = sequencer.getDeadline();
+        stepCallback(sequencer, at, &output);
+        actual[actualCount].time = at - start;
+        actual[actualCount++].frequency = output.frequency;
+    }
+
+    // Steps shorter than the wait are skipped by the catch-up: expected is the tone in effect when
+    // the lock came free, from then, and every later edge on its own deadline
+    static Edge expected[64];
+    int expectedCount = 0;
+    uint64_t taken = fire - start;
+    expected[expectedCount++] = ideal[0];
+    int i = 1;
+    while (i < idealCount && ideal[i].time <= taken) {
+        i++;
+    }
+    expected[expectedCount].time = taken;
+    expected[expectedCount++].frequency = ideal[i - 1].frequency;
+    while (i < idealCount && expectedCount < 64) {
+        expected[expectedCount++] = ideal[i++];
+    }
+
+    printf("%-14s %d retries, step taken %llu us late\n", name, retries, (unsigned long long)(fire - due));
+    return compareEdges(name, expected, expectedCount, actual, actualCount, durationUs, 0);
+}
+
+int main(int argc, char** argv) {
+    uint32_t maxLatencyUs = argc > 1 ? (uint32_t)atoi(argv[1]) : 800;
+    srand(42);
+
+    bool ok = true;
+    ok &= run("alarm", alarmPattern, sizeof(alarmPattern), true, 3600ULL * 1000000, maxLatencyUs);
+    ok &= run("notification", notificationPattern, sizeof(notificationPattern), false, 10ULL * 1000000, maxLatencyUs);
+    ok &= run("awkward", awkwardPattern, sizeof(awkwardPattern), true, 60ULL * 1000000, maxLatencyUs);
+    ok &= run("pulse", pulsePattern, sizeof(pulsePattern), true, 600ULL * 1000000, maxLatencyUs);
+    ok &= run("fade", fadePattern, sizeof(fadePattern), true, 60ULL * 1000000, maxLatencyUs);
+    ok &= runRestartRace("restart race", 50);
+    ok &= runRestartRace("restart late", 250000);
+    ok &= runBusyLock("busy lock", FADE_SEGMENT_MAX_MS * 1000);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file sntp_check.cpp
+ * @brief Host checks for SntpClient and ClockDiscipline
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Without arguments: simulates three days of a crystal running 40 ppm fast
+ * (with a daily +-2 ppm temperature swing) against an ideal server over a
+ * link with random, asymmetric delays and 2% packet loss. The system clock
+ * is modelled like ESP-IDF's: adjtime() slews at 1/64 of elapsed time. Checks
+ * that after the first sync the clock never steps or runs backwards (so no
+ * alarm minute is skipped or repeated), stays within 2 x SNTP_TARGET_ERROR_MS
+ * of true time, that the drift estimate finds the crystal error and that the
+ * poll interval stretches.
+ *
+ * With a server: talks to a real NTP server over UDP, e.g. the stand-in
+ *   python3 tools/ntp_standin.py --port 12300 --offset 2.5
+ *   ./sntp_check 127.0.0.1 12300 --expect-offset-ms 2500
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Iinclude tools/sntp_check.cpp src/SntpClient.cpp \
+ *       src/ClockDiscipline.cpp -o sntp_check
+ *   ./sntp_check
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "SntpClient.h"
+#include "ClockDiscipline.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static double uniform(double low, double high) {
+    return low + (high - low) * (double)rand() / RAND_MAX;
+}
+
+// --- Simulation -----------------------------------------------------------
+
+struct SimLink {
+    double trueUs;              // Reference time
+    bool requestPending;
+    uint8_t request[SNTP_PACKET_BYTES];
+    bool replyPending;
+    double replyArrivesUs;
+    uint8_t reply[SNTP_PACKET_BYTES];
+};
+
+static void writeTimestamp(uint8_t* p, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(value >> (56 - 8 * i));
+    }
+}
+
+static bool simSend(void* context, const uint8_t* packet, size_t length) {
+    SimLink* link = static_cast<SimLink*>(context);
+    if (uniform(0, 1) < 0.02) {
+        return true;            // Lost on the way
+    }
+
+    // Server stamps true time; uplink and downlink delays differ
+    double up = uniform(2000, 40000);
+    double down = uniform(2000, 40000);
+    double received = link->trueUs + up;
+    double transmitted = received + 100;
+    memset(link->reply, 0, sizeof(link->reply));
+    link->reply[0] = (0 << 6) | (4 << 3) | 4;
+    link->reply[1] = 2;
+    memcpy(link->reply + 24, packet + 40, 8);
+    writeTimestamp(link->reply + 32, SntpClient::toNtpTime((int64_t)received));
+    writeTimestamp(link->reply + 40, SntpClient::toNtpTime((int64_t)transmitted));
+    link->replyPending = true;
+    link->replyArrivesUs = transmitted + down;
+    (void)length;
+    return true;
+}
+
+static size_t simReceive(void* context, uint8_t* packet, size_t capacity) {
+    SimLink* link = static_cast<SimLink*>(context);
+    if (!link->replyPending || link->trueUs < link->replyArrivesUs || capacity < SNTP_PACKET_BYTES) {
+        return 0;
+    }
+    link->replyPending = false;
+    memcpy(packet, link->reply, SNTP_PACKET_BYTES);
+    return SNTP_PACKET_BYTES;
+}
+
+static void simulate() {
+    const double tickUs = 20000;
+    const double days = 3;
+    const double crystalPpm = 40;           // Local clock runs fast
+
+    SimLink link = {};
+    link.trueUs = 1.7e15;                   // Some time in 2023
+    SntpClient client;
+    ClockDiscipline discipline;
+    client.begin(simSend, simReceive, &link);
+
+    double monotonicUs = 0;
+    double clockUs = 0;                     // Unset: 1970
+    double pendingUs = 0;                   // adjtime() still to apply
+    double lastDriftTick = 0;
+    double startUs = link.trueUs;
+
+    double maxError = 0;
+    double maxStepAfterSync = 0;
+    bool backwards = false;
+    uint32_t requestsLastDay = 0;
+    uint32_t requestsBeforeLastDay = 0;
+
+    while (link.trueUs - startUs < days * 86400e6) {
+        double hours = (link.trueUs - startUs) / 3.6e9;
+        double ppm = crystalPpm + 2 * sin(2 * M_PI * hours / 24);
+        double dMono = tickUs * (1 + ppm * 1e-6);
+
+        // adjtime model: slews at most 1/64 of elapsed time
+        double slew = pendingUs;
+        double limit = dMono / 64;
+        if (slew > limit) slew = limit;
+        if (slew < -limit) slew = -limit;
+        pendingUs -= slew;
+
+        double previousClock = clockUs;
+        link.trueUs += tickUs;
+        monotonicUs += dMono;
+        clockUs += dMono + slew;
+
+        if (discipline.isSynchronized()) {
+            double advance = clockUs - previousClock;
+            if (advance < 0) backwards = true;
+            if (fabs(advance - tickUs) > maxStepAfterSync) maxStepAfterSync = fabs(advance - tickUs);
+        }
+
+        SntpStatus status = client.update((uint64_t)monotonicUs, (int64_t)clockUs);
+        if (status == SNTP_SAMPLE) {
+            const SntpSample& sample = client.getSample();
+            ClockCorrection correction = discipline.addSample(sample.offsetUs, sample.delayUs,
+                                                              sample.monotonicUs, (int64_t)pendingUs);
+            if (correction.action == CLOCK_STEP) {
+                clockUs += correction.amountUs;
+                pendingUs = 0;
+            } else if (correction.action == CLOCK_SLEW) {
+                pendingUs += correction.amountUs;
+            }
+            client.setPollInterval(discipline.getPollInterval());
+        }
+
+        if (monotonicUs - lastDriftTick >= CLOCK_DRIFT_TICK_MS * 1000.0) {
+            pendingUs += discipline.driftCorrection((uint64_t)monotonicUs);
+            lastDriftTick = monotonicUs;
+        }
+
+        if (hours > 2) {
+            double error = fabs(clockUs - link.trueUs);
+            if (error > maxError) maxError = error;
+        }
+        if (hours >= 24 * (days - 1) && requestsBeforeLastDay == 0) {
+            requestsBeforeLastDay = client.getRequestCount();
+        }
+    }
+    requestsLastDay = client.getRequestCount() - requestsBeforeLastDay;
+
+    printf("simulation     %.0f days, crystal +%.0f ppm +-2 ppm daily\n", days, crystalPpm);
+    printf("  drift        estimate %+.2f ppm (+-%.2f), steps %u, samples %u\n", discipline.getDriftPpm(),
+           discipline.getDriftUncertaintyPpm(), discipline.getStepCount(), discipline.getSampleCount());
+    printf("  error        max %.1f ms after the first 2 h, final %.1f ms\n", maxError / 1000,
+           (clockUs - link.trueUs) / 1000);
+    printf("  clock rate   max deviation per %.0f ms tick %.0f us (slew only)\n", tickUs / 1000, maxStepAfterSync);
+    printf("  polling      interval %u s, %u requests on the last day (fixed %d s polling: %d)\n",
+           discipline.getPollInterval(), requestsLastDay, SNTP_MIN_POLL_S, 86400 / SNTP_MIN_POLL_S);
+
+    check(discipline.getStepCount() == 1, "only the first sync steps");
+    check(!backwards, "clock never runs backwards");
+    check(maxStepAfterSync <= tickUs / 64 + tickUs * 50e-6, "clock only slews after the first sync");
+    check(maxError < 2 * SNTP_TARGET_ERROR_MS * 1000.0, "error within twice the target");
+    check(fabs(discipline.getDriftPpm() + crystalPpm) < 3, "drift estimate finds the crystal error");
+    check(discipline.getPollInterval() >= 2048, "poll interval stretches");
+    check(requestsLastDay < 86400 / SNTP_MIN_POLL_S / 10, "far fewer wake-ups than fixed polling");
+}
+
+// --- Real server ----------------------------------------------------------
+
+struct UdpLink {
+    int socket;
+    sockaddr_in server;
+};
+
+static bool udpSend(void* context, const uint8_t* packet, size_t length) {
+    UdpLink* link = static_cast<UdpLink*>(context);
+    return sendto(link->socket, packet, length, 0, (const sockaddr*)&link->server, sizeof(link->server)) ==
+           (ssize_t)length;
+}
+
+static size_t udpReceive(void* context, uint8_t* packet, size_t capacity) {
+    UdpLink* link = static_cast<UdpLink*>(context);
+    ssize_t received = recv(link->socket, packet, capacity, MSG_DONTWAIT);
+    return received > 0 ? (size_t)received : 0;
+}
+
+static uint64_t nowUs(clockid_t id) {
+    timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void queryServer(const char* host, int port, bool expectOffset, double expectedMs) {
+    UdpLink link;
+    link.socket = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&link.server, 0, sizeof(link.server));
+    link.server.sin_family = AF_INET;
+    link.server.sin_port = htons((uint16_t)port);
+    inet_pton(AF_INET, host, &link.server.sin_addr);
+
+    SntpClient client;
+    ClockDiscipline discipline;
+    client.begin(udpSend, udpReceive, &link);
+    client.setPollInterval(1);
+
+    int samples = 0;
+    int timeouts = 0;
+    double sumOffsetMs = 0;
+    while (samples < 8 && timeouts < 5) {
+        SntpStatus status = client.update(nowUs(CLOCK_MONOTONIC), (int64_t)nowUs(CLOCK_REALTIME));
+        if (status == SNTP_SAMPLE) {
+            const SntpSample& sample = client.getSample();
+            ClockCorrection correction = discipline.addSample(sample.offsetUs, sample.delayUs, sample.monotonicUs);
+            printf("  sample %d     offset %+.3f ms, delay %.3f ms, stratum %u -> %s\n", samples,
+                   sample.offsetUs / 1000.0, sample.delayUs / 1000.0, sample.stratum,
+                   correction.action == CLOCK_STEP ? "step" : correction.action == CLOCK_SLEW ? "slew" : "ignore");
+            sumOffsetMs += sample.offsetUs / 1000.0;
+            samples++;
+            client.setPollInterval(1);      // Keep the check short; the host clock is not adjusted
+        } else if (status == SNTP_TIMEOUT || status == SNTP_REJECTED) {
+            printf("  %s\n", status == SNTP_TIMEOUT ? "timeout" : "rejected (kiss-o'-death or unsynchronized)");
+            timeouts++;
+            client.requestNow();
+        }
+        usleep(1000);
+    }
+    close(link.socket);
+
+    check(samples > 0, "server answered");
+    if (samples > 0) {
+        printf("server         %s:%d mean offset %+.3f ms over %d samples\n", host, port, sumOffsetMs / samples,
+               samples);
+        if (expectOffset) {
+            check(fabs(sumOffsetMs / samples - expectedMs) < 5, "offset matches the server's");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    // Timestamp conversion round trip, including the 2036 era rollover
+    int64_t times[] = {0, 1700000000123456LL, 2085978495999999LL, 2085978496000000LL, 2200000000000001LL};
+    for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+        int64_t back = SntpClient::fromNtpTime(SntpClient::toNtpTime(times[i]));
+        check(llabs(back - times[i]) <= 1, "NTP timestamp round trip");
+    }
+
+    if (argc >= 3) {
+        bool expect = argc >= 5 && strcmp(argv[3], "--expect-offset-ms") == 0;
+        queryServer(argv[1], atoi(argv[2]), expect, expect ? atof(argv[4]) : 0);
+    } else {
+        srand(42);
+        simulate();
+    }
+
+    printf("%s\n", failures == 0 ? "All checks passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file status_cache_check.cpp
+ * @brief Host checks for StatusCache field selection and ETags
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Renders a status-like document the way NetworkManager does and checks
+ * that:
+ *   - the whole selection is the rendered document byte for byte;
+ *   - every selection of fields equals the same fields rendered on their
+ *     own by JsonWriter, so it is valid JSON;
+ *   - a selection's ETag stays the same when only other fields change,
+ *     and changes when one of its own does;
+ *   - unknown or empty field lists, renders that do not fit and copies
+ *     into too small a buffer are refused.
+ * Also times a cached copy against a fresh render.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Iinclude tools/status_cache_check.cpp src/StatusCache.cpp \
+ *       src/JsonWriter.cpp -o status_cache_check
+ *   ./status_cache_check
+ *
+ * Exits non-zero on the first failed check.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "StatusCache.h"
+
+#define FIELDS 6
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+struct Status {
+    const char* wifi;
+    const char* time;
+    uint32_t alarms;
+    uint32_t uptime;
+    uint32_t heapFree;
+    const char* label;      // Needs escaping
+};
+
+static const char* const names[FIELDS] = {"wifi", "time", "alarms", "uptime", "heapFree", "label"};
+
+// Field i of the status, with a plain JsonWriter or through the cache
+static void writeValue(JsonWriter& json, const Status& status, int i) {
+    switch (i) {
+        case 0: json.string(status.wifi); break;
+        case 1: json.string(status.time); break;
+        case 2: json.unsignedNumber(status.alarms); break;
+        case 3: json.unsignedNumber(status.uptime); break;
+        case 4: json.unsignedNumber(status.heapFree); break;
+        case 5: json.string(status.label); break;
+    }
+}
+
+static bool render(StatusCache& cache, const Status& status) {
+    JsonWriter json(cache.getBuffer(), cache.getCapacity());
+    cache.beginRender(json);
+    for (int i = 0; i < FIELDS; i++) {
+        cache.field(json, names[i]);
+        writeValue(json, status, i);
+    }
+    return cache.finish(json);
+}
+
+static size_t renderSelection(const Status& status, uint32_t mask, char* out, size_t size) {
+    JsonWriter json(out, size);
+    json.beginObject();
+    for (int i = 0; i < FIELDS; i++) {
+        if (mask & (1u << i)) {
+            json.key(names[i]);
+            writeValue(json, status, i);
+        }
+    }
+    json.endObject();
+    return json.size();
+}
+
+int main() {
+    static StatusCache cache;
+    Status status = {"Connected (192.168.1.20)", "2025-08-25 07:30:00", 3, 86400, 181234, "pill \"A\"\n"};
+    check(!cache.isValid(), "empty until rendered");
+    check(render(cache, status), "render fits");
+    check(cache.isValid(), "valid after a render");
+
+    // 1. Every selection matches the same fields rendered directly
+    char copied[STATUS_CACHE_SIZE];
+    char expected[STATUS_CACHE_SIZE];
+    for (uint32_t mask = 1; mask < (1u << FIELDS); mask++) {
+        size_t length = cache.copy(mask, copied, sizeof(copied));
+        size_t expectedLength = renderSelection(status, mask, expected, sizeof(expected));
+        check(length == expectedLength && memcmp(copied, expected, length) == 0, "selection equals direct render");
+    }
+    size_t full = cache.copy(STATUS_ALL_FIELDS, copied, sizeof(copied));
+    check(full == renderSelection(status, (1u << FIELDS) - 1, expected, sizeof(expected)) &&
+          memcmp(copied, expected, full) == 0, "all fields equal the document");
+    printf("document: %.*s\n", (int)full, copied);
+
+    // 2. Field lists
+    check(cache.parseFields("wifi") == 1u, "single field");
+    check(cache.parseFields("alarms,wifi") == 5u, "any order, document order out");
+    check(cache.parseFields("wifi,,alarms,") == 5u, "empty names skipped");
+    check(cache.parseFields("") == 0, "empty list refused");
+    check(cache.parseFields("wif") == 0 && cache.parseFields("wifis") == 0, "prefixes are not names");
+    check(cache.parseFields("wifi,bogus") == 0, "unknown name refused");
+
+    // 3. ETags follow only the selected fields
+    uint32_t steady = cache.parseFields("wifi,alarms");
+    uint32_t moving = cache.parseFields("uptime");
+    char steadyTag[12];
+    char movingTag[12];
+    char fullTag[12];
+    cache.formatETag(steady, steadyTag);
+    cache.formatETag(moving, movingTag);
+    cache.formatETag(STATUS_ALL_FIELDS, fullTag);
+    check(strlen(steadyTag) == 10 && steadyTag[0] == '"' && steadyTag[9] == '"', "ETag is quoted hex");
+
+    status.uptime++;
+    status.time = "2025-08-25 07:30:01";
+    status.heapFree = 99;
+    render(cache, status);
+    char tag[12];
+    cache.formatETag(steady, tag);
+    check(strcmp(tag, steadyTag) == 0, "ETag kept while its fields are unchanged");
+    cache.formatETag(moving, tag);
+    check(strcmp(tag, movingTag) != 0, "ETag changes with its field");
+    cache.formatETag(STATUS_ALL_FIELDS, tag);
+    check(strcmp(tag, fullTag) != 0, "whole document ETag changes");
+
+    status.alarms = 4;
+    render(cache, status);
+    cache.formatETag(steady, tag);
+    check(strcmp(tag, steadyTag) != 0, "ETag changes when a selected field does");
+
+    // 4. Refusals
+    size_t current = cache.copy(STATUS_ALL_FIELDS, copied, sizeof(copied));
+    check(cache.copy(STATUS_ALL_FIELDS, copied, current - 1) == 0, "too small a buffer refused");
+    static char huge[STATUS_CACHE_SIZE];
+    memset(huge, 'x', sizeof(huge) - 1);
+    status.label = huge;
+    check(!render(cache, status) && !cache.isValid(), "render that does not fit leaves the cache empty");
+    check(cache.copy(STATUS_ALL_FIELDS, copied, sizeof(copied)) == 0, "nothing copied from an empty cache");
+    status.label = "pill";
+
+    // 5. Cost of a cached answer against rendering again
+    const int rounds = 200000;
+    size_t sink = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        status.uptime = i;
+        render(cache, status);
+        sink += cache.copy(STATUS_ALL_FIELDS, copied, sizeof(copied));
+    }
+    double renderNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    started = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        cache.formatETag(STATUS_ALL_FIELDS, tag);
+        sink += cache.copy(STATUS_ALL_FIELDS, copied, sizeof(copied)) + tag[1];
+    }
+    double cachedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    printf("render and copy %.0f ns, ETag and copy from the cache %.0f ns (%zu)\n",
+           renderNs / rounds, cachedNs / rounds, sink % 10);
+
+    printf("cache %zu bytes\n", sizeof(StatusCache));
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
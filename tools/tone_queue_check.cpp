@@ -0,0 +1,178 @@
+/**
+ * @file tone_queue_check.cpp
+ * @brief Host checks for ToneQueue arbitration between buzzer requests
+ * @author Nighty Byte Team
+ * @date 2025-08-25
+ *
+ * Submits feedback, notification and alarm requests, tagged so the order
+ * they play in can be followed, and checks that:
+ *   - a higher priority preempts the request playing;
+ *   - equal and lower priorities wait, and play in priority order, first
+ *     come first served within one priority;
+ *   - a looping sound is replaced at once by a newer one of its priority;
+ *   - a full queue rejects a request no higher than what it holds, and
+ *     makes room for a higher one by dropping the newest lowest entry;
+ *   - requests waiting longer than the maximum age are skipped;
+ *   - removePriority() stops and discards only its own priority.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -Iinclude tools/tone_queue_check.cpp src/ToneQueue.cpp -o tone_queue_check
+ *   ./tone_queue_check
+ *
+ * Exits non-zero if any check failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ToneQueue.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static ToneRequest makeRequest(uint8_t priority, uint8_t tag, bool loop = false, uint32_t at = 0) {
+    ToneRequest request;
+    memset(&request, 0, sizeof(request));
+    request.priority = priority;
+    request.tag = tag;
+    request.loop = loop;
+    request.enqueuedAt = at;
+    return request;
+}
+
+// Tags in the order they play once the current one finishes, then every next() after it
+static bool playsInOrder(ToneQueue& queue, const uint8_t* tags, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (!queue.isPlaying() || queue.getCurrent().tag != tags[i]) {
+            printf("  at %u: %s %u, expected %u\n", i, queue.isPlaying() ? "playing" : "idle",
+                   queue.isPlaying() ? queue.getCurrent().tag : 0, tags[i]);
+            return false;
+        }
+        queue.next(0, TONE_QUEUE_MAX_AGE_MS);
+    }
+    return !queue.isPlaying() && queue.size() == 0;
+}
+
+static void checkPreemption() {
+    printf("Preemption\n");
+    ToneQueue queue;
+    check(!queue.isPlaying() && queue.size() == 0, "starts idle and empty");
+    check(queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 1)) == TONE_START_NOW, "idle starts at once");
+    check(queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 2)) == TONE_START_NOW, "notification preempts feedback");
+    check(queue.submit(makeRequest(TONE_PRIORITY_ALARM, 3)) == TONE_START_NOW, "alarm preempts notification");
+    check(queue.getCurrent().tag == 3 && queue.size() == 0, "preempted requests are not queued again");
+    check(queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 4)) == TONE_QUEUED, "notification waits for the alarm");
+    check(queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 5)) == TONE_QUEUED, "feedback waits for the alarm");
+    check(queue.getCurrent().tag == 3, "the alarm keeps playing");
+}
+
+static void checkOrder() {
+    printf("Order\n");
+    ToneQueue queue;
+    queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 1));
+    check(queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 2)) == TONE_QUEUED, "lower priority waits");
+    check(queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 3)) == TONE_QUEUED, "equal priority waits");
+    queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 4));
+    queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 5));
+    queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 6));
+    check(queue.size() == 5, "five waiting");
+
+    // Notifications first, then feedback, each in the order submitted
+    const uint8_t order[] = {1, 3, 5, 2, 4, 6};
+    check(playsInOrder(queue, order, sizeof(order)), "priority order, FIFO within a priority");
+}
+
+static void checkLooping() {
+    printf("Looping\n");
+    ToneQueue queue;
+    queue.submit(makeRequest(TONE_PRIORITY_ALARM, 1, true));
+    check(queue.submit(makeRequest(TONE_PRIORITY_ALARM, 2, true)) == TONE_START_NOW, "newer alarm replaces a looping one");
+    check(queue.getCurrent().tag == 2 && queue.size() == 0, "the replaced alarm is gone");
+    check(queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 3)) == TONE_QUEUED, "lower priority still waits for a loop");
+
+    // Only a looping sound gives way to its own priority
+    queue.submit(makeRequest(TONE_PRIORITY_ALARM, 4, false));
+    check(queue.submit(makeRequest(TONE_PRIORITY_ALARM, 5, true)) == TONE_QUEUED, "a sound that ends is not replaced");
+    const uint8_t order[] = {4, 5, 3};
+    check(playsInOrder(queue, order, sizeof(order)), "queued after the one-shot alarm");
+}
+
+static void checkFull() {
+    printf("Full queue\n");
+    ToneQueue queue;
+    queue.submit(makeRequest(TONE_PRIORITY_ALARM, 100));
+    for (uint8_t i = 0; i < TONE_QUEUE_SIZE; i++) {
+        check(queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, i)) == TONE_QUEUED, "fills up");
+    }
+    check(queue.size() == TONE_QUEUE_SIZE, "queue full");
+    check(queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 200)) == TONE_REJECTED, "equal priority rejected");
+    check(queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 201)) == TONE_REJECTED, "lower priority rejected");
+    check(queue.getDroppedCount() == 2 && queue.size() == TONE_QUEUE_SIZE, "rejections counted, queue unchanged");
+
+    // A higher priority pushes out the newest of the lowest
+    check(queue.submit(makeRequest(TONE_PRIORITY_ALARM, 202)) == TONE_QUEUED, "higher priority makes room");
+    check(queue.getDroppedCount() == 3 && queue.size() == TONE_QUEUE_SIZE, "one notification dropped");
+    uint8_t order[TONE_QUEUE_SIZE + 1] = {100, 202};
+    for (uint8_t i = 0; i + 1 < TONE_QUEUE_SIZE; i++) {
+        order[i + 2] = i;
+    }
+    check(playsInOrder(queue, order, sizeof(order)), "the newest notification was the one dropped");
+}
+
+static void checkMaxAge() {
+    printf("Maximum age\n");
+    ToneQueue queue;
+    queue.submit(makeRequest(TONE_PRIORITY_ALARM, 1, false, 0));
+    queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 2, false, 0));
+    queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 3, false, 5000));
+    check(queue.next(TONE_QUEUE_MAX_AGE_MS + 1000, TONE_QUEUE_MAX_AGE_MS) && queue.getCurrent().tag == 3,
+          "stale request skipped, fresh one plays");
+    check(queue.getDroppedCount() == 1, "skipped request counted");
+    check(!queue.next(TONE_QUEUE_MAX_AGE_MS + 1000, TONE_QUEUE_MAX_AGE_MS) && !queue.isPlaying(), "idle when empty");
+}
+
+static void checkRemovePriority() {
+    printf("Remove a priority\n");
+    ToneQueue queue;
+    queue.submit(makeRequest(TONE_PRIORITY_ALARM, 1, true));
+    queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 2));
+    queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 3));
+    queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 4));
+    queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 5));
+
+    check(!queue.removePriority(TONE_PRIORITY_FEEDBACK), "removing waiting requests does not stop the current one");
+    check(queue.isPlaying() && queue.getCurrent().tag == 1 && queue.size() == 2, "only feedback removed");
+    check(queue.removePriority(TONE_PRIORITY_ALARM), "removing the current priority stops it");
+    check(!queue.isPlaying() && queue.size() == 2, "notifications still wait");
+    queue.next(0, TONE_QUEUE_MAX_AGE_MS);
+    const uint8_t order[] = {2, 4};
+    check(playsInOrder(queue, order, sizeof(order)), "notifications play after the alarm is stopped");
+
+    queue.submit(makeRequest(TONE_PRIORITY_NOTIFICATION, 6));
+    queue.submit(makeRequest(TONE_PRIORITY_FEEDBACK, 7));
+    check(!queue.removePriority(TONE_PRIORITY_ALARM) && queue.isPlaying() && queue.size() == 1,
+          "removing an absent priority changes nothing");
+    queue.clear();
+    check(!queue.isPlaying() && queue.size() == 0, "clear empties everything");
+}
+
+int main() {
+    checkPreemption();
+    checkOrder();
+    checkLooping();
+    checkFull();
+    checkMaxAge();
+    checkRemovePriority();
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
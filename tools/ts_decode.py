@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Host decoder for the on-flash sensor time series written by TimeSeriesStore.
+
+Fetch the raw files from the device, e.g.
+    curl -o light.idx "http://<device>/timeseries?ch=light&file=idx"
+    curl -o light.dat "http://<device>/timeseries?ch=light&file=dat"
+then decode them to CSV:
+    python3 tools/ts_decode.py light.idx light.dat [--from EPOCH] [--to EPOCH]
+
+The block format is documented in include/TimeSeriesCodec.h.
+"""
+
+import argparse
+import struct
+import sys
+
+BLOCK_SIZE = 256
+HEADER_SIZE = 8
+INDEX_ENTRY = struct.Struct("<IIIHH")  # firstTimestamp, lastTimestamp, offset, count, reserved
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, bits):
+        value = 0
+        for _ in range(bits):
+            byte = self.data[self.pos >> 3]
+            value = (value << 1) | ((byte >> (7 - (self.pos & 7))) & 1)
+            self.pos += 1
+        return value
+
+    def ones(self, limit):
+        count = 0
+        while count < limit and self.read(1):
+            count += 1
+        return count
+
+
+def zigzag_decode(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_block(block):
+    count, value, timestamp = struct.unpack_from("<HHI", block, 0)
+    if count == 0:
+        return
+    yield timestamp, value
+
+    reader = BitReader(block[HEADER_SIZE:])
+    delta = 0
+    for _ in range(count - 1):
+        prefix = reader.ones(4)
+        if prefix:
+            delta += zigzag_decode(reader.read((0, 7, 9, 12, 32)[prefix]))
+        timestamp = (timestamp + delta) & 0xFFFFFFFF
+
+        prefix = reader.ones(3)
+        if prefix == 3:
+            value = reader.read(16)
+        elif prefix:
+            value = (value + zigzag_decode(reader.read(6 if prefix == 1 else 9))) & 0xFFFF
+        yield timestamp, value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("index")
+    parser.add_argument("data")
+    parser.add_argument("--from", dest="start", type=int, default=0)
+    parser.add_argument("--to", dest="end", type=int, default=0xFFFFFFFF)
+    args = parser.parse_args()
+
+    with open(args.index, "rb") as f:
+        index = f.read()
+    with open(args.data, "rb") as f:
+        data = f.read()
+
+    entries = [INDEX_ENTRY.unpack_from(index, i) for i in range(0, len(index) - INDEX_ENTRY.size + 1, INDEX_ENTRY.size)]
+
+    out = sys.stdout
+    out.write("timestamp,value\n")
+    samples = 0
+    for first, last, offset, count, _ in entries:
+        if last < args.start or first > args.end:
+            continue
+        block = data[offset:offset + BLOCK_SIZE]
+        if len(block) < BLOCK_SIZE:
+            break
+        for timestamp, value in decode_block(block):
+            if args.start <= timestamp <= args.end:
+                out.write("%d,%d\n" % (timestamp, value))
+                samples += 1
+
+    blocks = len(entries)
+    if samples:
+        sys.stderr.write("%d blocks, %d samples, %.2f bytes/sample\n" %
+                         (blocks, samples, blocks * (BLOCK_SIZE + INDEX_ENTRY.size) / float(samples)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,163 @@
+// Live updates come over the status WebSocket; /status is polled only while it is down
+var POLL_MS = 5000;
+var ALARM_STATES = ['Idle', 'Ringing', 'Snoozed', 'Waiting for pill box'];
+var NETWORK_STATES = ['Idle', 'Connecting', 'Connected', 'AP Mode', 'Error'];
+
+var socket = null;
+var socketPort = null;
+var reconnectDelay = 1000;
+var pollTimer = null;
+var clockBase = null;     // Device time and the moment it was read, for the local clock
+
+function setText(id, value) {
+    var element = document.getElementById(id);
+    if (element && value !== undefined) {
+        element.textContent = value;
+    }
+}
+
+function updateStatus() {
+    fetch('/status?fields=wifi,time,alarms,otaPort,wsPort')
+        .then(response => response.json())
+        .then(data => {
+            setText('wifi-status', data.wifi);
+            setText('current-time', data.time);
+            setText('alarm-count', data.alarms);
+            setText('device-ip', location.hostname);
+            setText('ota-port', data.otaPort);
+            clockBase = {time: Date.parse(data.time.replace(' ', 'T')), at: Date.now()};
+            if (data.wsPort && socketPort === null) {
+                socketPort = data.wsPort;
+                connectSocket();
+            }
+        })
+        .catch(error => console.error('Error:', error));
+}
+
+function startPolling() {
+    if (pollTimer === null) {
+        pollTimer = setInterval(updateStatus, POLL_MS);
+    }
+    setText('live-mode', 'polling');
+}
+
+function stopPolling() {
+    if (pollTimer !== null) {
+        clearInterval(pollTimer);
+        pollTimer = null;
+    }
+    setText('live-mode', 'live');
+}
+
+// Messages carry only the fields that changed, e.g. {"r":42,"alarm":1,"id":3}
+function applyLive(data) {
+    if (data.alarm !== undefined) {
+        setText('alarm-state', ALARM_STATES[data.alarm] || data.alarm);
+    }
+    if (data.pill !== undefined) {
+        setText('pill-box', data.pill ? 'Open' : 'Closed');
+    }
+    if (data.usb !== undefined) {
+        setText('usb', data.usb ? 'Connected' : 'Disconnected');
+    }
+    if (data.light !== undefined) {
+        setText('light', data.light);
+    }
+    if (data.net !== undefined) {
+        setText('wifi-status', NETWORK_STATES[data.net] || data.net);
+    }
+}
+
+function connectSocket() {
+    if (!('WebSocket' in window)) {
+        return;
+    }
+    socket = new WebSocket('ws://' + location.hostname + ':' + socketPort + '/ws');
+    socket.onopen = function() {
+        reconnectDelay = 1000;
+        stopPolling();
+        updateStatus();
+    };
+    socket.onmessage = function(event) {
+        applyLive(JSON.parse(event.data));
+    };
+    socket.onclose = function() {
+        socket = null;
+        startPolling();
+        setTimeout(connectSocket, reconnectDelay);
+        reconnectDelay = Math.min(reconnectDelay * 2, 30000);
+    };
+}
+
+// The clock runs locally from the last /status reading
+setInterval(function() {
+    if (clockBase && !isNaN(clockBase.time)) {
+        var now = new Date(clockBase.time + Date.now() - clockBase.at);
+        setText('current-time', now.toLocaleString('sv').replace('T', ' '));
+    }
+}, 1000);
+
+// Firmware upload (ota.html)
+function updateOtaInfo() {
+    fetch('/api/ota')
+        .then(response => response.json())
+        .then(data => {
+            setText('ota-partition', data.partition + (data.trial ? ' (on trial)' : ''));
+            setText('ota-version', data.version + ', built ' + data.built);
+            setText('ota-rollback', data.lastRollback || 'none');
+        })
+        .catch(error => console.error('Error:', error));
+}
+
+function toHex(buffer) {
+    return Array.from(new Uint8Array(buffer), b => b.toString(16).padStart(2, '0')).join('');
+}
+
+function uploadFirmware() {
+    var file = document.getElementById('ota-file').files[0];
+    if (!file) {
+        setText('ota-result', 'Choose a firmware .bin first');
+        return;
+    }
+    var auth = 'Basic ' + btoa(document.getElementById('ota-user').value + ':' +
+                               document.getElementById('ota-password').value);
+    var button = document.getElementById('ota-upload');
+    button.disabled = true;
+    
+    // crypto.subtle only exists on https pages; without it the device still checks the image itself
+    var digest = window.crypto && crypto.subtle ?
+        file.arrayBuffer().then(data => crypto.subtle.digest('SHA-256', data)).then(toHex) :
+        Promise.resolve('');
+    var started = Date.now();
+    digest
+        .then(sha => {
+            setText('ota-result', 'Uploading ' + file.size + ' bytes...');
+            return fetch('/api/ota' + (sha ? '?sha256=' + sha : ''), {
+                method: 'POST',
+                headers: {'Authorization': auth, 'Content-Type': 'application/octet-stream'},
+                body: file
+            });
+        })
+        .then(response => response.headers.get('Content-Type') === 'application/json' ?
+                          response.json() : response.text().then(text => ({ok: false, error: text})))
+        .then(data => {
+            if (!data.ok) {
+                setText('ota-result', 'Update failed: ' + data.error);
+                return;
+            }
+            setText('ota-result', 'Verified ' + data.imageBytes + ' bytes' +
+                    (data.delta ? ' from a ' + data.bytes + ' byte patch' : '') + ' in ' + (Date.now() - started) + ' ms (' +
+                    Math.round(data.bytesPerSecond / 1024) + ' KB/s on the device, ' + data.heapUsed +
+                    ' bytes heap). Restarting...');
+            setTimeout(updateOtaInfo, 15000);
+        })
+        .catch(error => setText('ota-result', 'Upload failed: ' + error))
+        .then(() => { button.disabled = false; });
+}
+
+if (document.getElementById('ota-partition')) {
+    updateOtaInfo();
+}
+
+updateStatus();
+startPolling();